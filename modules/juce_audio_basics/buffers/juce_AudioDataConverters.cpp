@@ -472,6 +472,320 @@ void AudioDataConverters::deinterleaveSamples (const float* const source,
 }
 
 
+//==============================================================================
+namespace BlockConversionHelpers
+{
+    template <int bytesPerSample>
+    using ByteCount = std::integral_constant<int, bytesPerSample>;
+
+    // Each of these returns the sample's value sign-extended to 32 bits
+    static forcedinline int32 readSample (const char* p, bool bigEndian, ByteCount<2>) noexcept
+    {
+        return (int16) (bigEndian ? ByteOrder::bigEndianShort (p) : ByteOrder::littleEndianShort (p));
+    }
+
+    static forcedinline int32 readSample (const char* p, bool bigEndian, ByteCount<3>) noexcept
+    {
+        return bigEndian ? ByteOrder::bigEndian24Bit (p) : ByteOrder::littleEndian24Bit (p);
+    }
+
+    static forcedinline int32 readSample (const char* p, bool bigEndian, ByteCount<4>) noexcept
+    {
+        return (int32) (bigEndian ? ByteOrder::bigEndianInt (p) : ByteOrder::littleEndianInt (p));
+    }
+
+    static forcedinline void writeSample (char* p, int32 value, bool bigEndian, ByteCount<2>) noexcept
+    {
+        auto v = bigEndian ? ByteOrder::swapIfLittleEndian ((uint16) value) : ByteOrder::swapIfBigEndian ((uint16) value);
+        memcpy (p, &v, sizeof (v));
+    }
+
+    static forcedinline void writeSample (char* p, int32 value, bool bigEndian, ByteCount<3>) noexcept
+    {
+        if (bigEndian)
+            ByteOrder::bigEndian24BitToChars (value, p);
+        else
+            ByteOrder::littleEndian24BitToChars (value, p);
+    }
+
+    static forcedinline void writeSample (char* p, int32 value, bool bigEndian, ByteCount<4>) noexcept
+    {
+        auto v = bigEndian ? ByteOrder::swapIfLittleEndian ((uint32) value) : ByteOrder::swapIfBigEndian ((uint32) value);
+        memcpy (p, &v, sizeof (v));
+    }
+
+    // This matches the rounding and clipping that AudioData::Float32::getAsInt32() does
+    static forcedinline int32 floatToInt32 (float value) noexcept
+    {
+        return (int32) roundToInt (jlimit (-1.0, 1.0, (double) value) * (double) 0x7fffffff);
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    static forcedinline __m128i swapBytes16 (__m128i v) noexcept
+    {
+        return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+    }
+
+    static forcedinline __m128i swapBytes32 (__m128i v) noexcept
+    {
+        v = swapBytes16 (v);
+        return _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1)), _MM_SHUFFLE (2, 3, 0, 1));
+    }
+
+    static forcedinline int32 loadUnaligned32 (const char* p) noexcept
+    {
+        int32 v;
+        memcpy (&v, p, sizeof (v));
+        return v;
+    }
+
+    // Loads 4 samples, sign-extended to 32 bits
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static forcedinline __m128i load4 (const char* p, int stride) noexcept
+    {
+        if (bytesPerSample == 2 && contiguous)
+        {
+            auto v = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (p));
+
+            if (bigEndian)
+                v = swapBytes16 (v);
+
+            return _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+        }
+
+        if (bytesPerSample == 4 && contiguous)
+        {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p));
+            return bigEndian ? swapBytes32 (v) : v;
+        }
+
+        if (bytesPerSample == 3)
+        {
+            // Reads 4 bytes for each sample and then shifts away the extra one, so the
+            // caller has to make sure that there's at least one more byte after the last sample
+            auto v = _mm_setr_epi32 (loadUnaligned32 (p), loadUnaligned32 (p + stride),
+                                     loadUnaligned32 (p + 2 * stride), loadUnaligned32 (p + 3 * stride));
+
+            if (bigEndian)
+                return _mm_srai_epi32 (swapBytes32 (v), 8);
+
+            return _mm_srai_epi32 (_mm_slli_epi32 (v, 8), 8);
+        }
+
+        return _mm_setr_epi32 (readSample (p, bigEndian, ByteCount<bytesPerSample>()),
+                               readSample (p + stride, bigEndian, ByteCount<bytesPerSample>()),
+                               readSample (p + 2 * stride, bigEndian, ByteCount<bytesPerSample>()),
+                               readSample (p + 3 * stride, bigEndian, ByteCount<bytesPerSample>()));
+    }
+
+    // Stores 4 samples that have already been shifted down to the format's size
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static forcedinline void store4 (char* p, int stride, __m128i v) noexcept
+    {
+        if (bytesPerSample == 2 && contiguous)
+        {
+            v = _mm_packs_epi32 (v, v);
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (p), bigEndian ? swapBytes16 (v) : v);
+            return;
+        }
+
+        if (bytesPerSample == 4 && contiguous)
+        {
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (p), bigEndian ? swapBytes32 (v) : v);
+            return;
+        }
+
+        if (bytesPerSample == 3 && contiguous)
+        {
+            // Puts each sample's three bytes at the bottom of its lane in the order they're
+            // stored, joins the lanes up in pairs, and then joins the two pairs together
+            v = bigEndian ? _mm_srli_epi32 (swapBytes32 (v), 8)
+                          : _mm_and_si128 (v, _mm_set1_epi32 (0xffffff));
+
+            auto pairs = _mm_or_si128 (_mm_and_si128 (v, _mm_set_epi32 (0, -1, 0, -1)),
+                                       _mm_and_si128 (_mm_srli_epi64 (v, 8), _mm_set_epi32 (-1, ~0xffffff, -1, ~0xffffff)));
+            auto secondPair = _mm_srli_si128 (pairs, 8);
+
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (p), _mm_or_si128 (pairs, _mm_slli_epi64 (secondPair, 48)));
+            auto last = _mm_cvtsi128_si32 (_mm_srli_epi64 (secondPair, 16));
+            memcpy (p + 8, &last, sizeof (last));
+            return;
+        }
+
+        int32 values[4];
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (values), v);
+
+        for (int i = 0; i < 4; ++i)
+            writeSample (p + i * stride, values[i], bigEndian, ByteCount<bytesPerSample>());
+    }
+
+    // Does the same as floatToInt32() for 4 samples at a time. The maths has to be done
+    // in double precision to get the same rounding.
+    static forcedinline __m128i floatToInt32 (__m128 value) noexcept
+    {
+        const auto one = _mm_set1_pd (1.0), minusOne = _mm_set1_pd (-1.0), scale = _mm_set1_pd ((double) 0x7fffffff);
+
+        auto lo = _mm_cvtps_pd (value);
+        auto hi = _mm_cvtps_pd (_mm_movehl_ps (value, value));
+        lo = _mm_mul_pd (_mm_min_pd (_mm_max_pd (lo, minusOne), one), scale);
+        hi = _mm_mul_pd (_mm_min_pd (_mm_max_pd (hi, minusOne), one), scale);
+
+        return _mm_unpacklo_epi64 (_mm_cvtpd_epi32 (lo), _mm_cvtpd_epi32 (hi));
+    }
+   #endif
+
+    // The 24-bit loads read a byte past each sample, so they can't be used for the last one
+    template <int bytesPerSample>
+    static int getNumVectorisable (int numSamples) noexcept
+    {
+        return bytesPerSample == 3 ? numSamples - 1 : numSamples;
+    }
+
+    //==============================================================================
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static void toFloat (float* dest, const char* source, int stride, int numSamples) noexcept
+    {
+        const double scale = 1.0 / (double) ((int64) 1 << (8 * bytesPerSample - 1));
+
+        if (contiguous)
+            stride = bytesPerSample;
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const auto scaleVec = _mm_set1_ps ((float) scale);
+
+        for (auto num = getNumVectorisable<bytesPerSample> (numSamples); i <= num - 4; i += 4)
+            _mm_storeu_ps (dest + i, _mm_mul_ps (_mm_cvtepi32_ps (load4<bytesPerSample, bigEndian, contiguous> (source + i * stride, stride)), scaleVec));
+       #endif
+
+        for (; i < numSamples; ++i)
+            dest[i] = (float) (scale * readSample (source + i * stride, bigEndian, ByteCount<bytesPerSample>()));
+    }
+
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static void toInt32 (int32* dest, const char* source, int stride, int numSamples) noexcept
+    {
+        const int shift = 32 - 8 * bytesPerSample;
+
+        if (contiguous)
+            stride = bytesPerSample;
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (auto num = getNumVectorisable<bytesPerSample> (numSamples); i <= num - 4; i += 4)
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dest + i),
+                              _mm_slli_epi32 (load4<bytesPerSample, bigEndian, contiguous> (source + i * stride, stride), shift));
+       #endif
+
+        for (; i < numSamples; ++i)
+            dest[i] = (int32) ((uint32) readSample (source + i * stride, bigEndian, ByteCount<bytesPerSample>()) << shift);
+    }
+
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static void fromFloat (char* dest, int stride, const float* source, int numSamples) noexcept
+    {
+        const int shift = 32 - 8 * bytesPerSample;
+
+        if (contiguous)
+            stride = bytesPerSample;
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i <= numSamples - 4; i += 4)
+            store4<bytesPerSample, bigEndian, contiguous> (dest + i * stride, stride,
+                                                           _mm_srai_epi32 (floatToInt32 (_mm_loadu_ps (source + i)), shift));
+       #endif
+
+        for (; i < numSamples; ++i)
+            writeSample (dest + i * stride, floatToInt32 (source[i]) >> shift, bigEndian, ByteCount<bytesPerSample>());
+    }
+
+    template <int bytesPerSample, bool bigEndian, bool contiguous>
+    static void fromInt32 (char* dest, int stride, const int32* source, int numSamples) noexcept
+    {
+        const int shift = 32 - 8 * bytesPerSample;
+
+        if (contiguous)
+            stride = bytesPerSample;
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i <= numSamples - 4; i += 4)
+            store4<bytesPerSample, bigEndian, contiguous> (dest + i * stride, stride,
+                                                           _mm_srai_epi32 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (source + i)), shift));
+       #endif
+
+        for (; i < numSamples; ++i)
+            writeSample (dest + i * stride, source[i] >> shift, bigEndian, ByteCount<bytesPerSample>());
+    }
+
+    // Picks the version of a kernel that's specialised for the format, byte order and layout
+    template <template <int, bool, bool> class Kernel, int bytesPerSample, typename... Args>
+    static void dispatch (int stride, bool bigEndian, Args... args) noexcept
+    {
+        if (stride == bytesPerSample)
+        {
+            if (bigEndian)  Kernel<bytesPerSample, true, true>::call (args...);
+            else            Kernel<bytesPerSample, false, true>::call (args...);
+        }
+        else
+        {
+            if (bigEndian)  Kernel<bytesPerSample, true, false>::call (args...);
+            else            Kernel<bytesPerSample, false, false>::call (args...);
+        }
+    }
+
+    template <template <int, bool, bool> class Kernel, typename... Args>
+    static void dispatch (int bytesPerSample, int stride, bool bigEndian, Args... args) noexcept
+    {
+        switch (bytesPerSample)
+        {
+            case 2:   dispatch<Kernel, 2> (stride, bigEndian, args...); break;
+            case 3:   dispatch<Kernel, 3> (stride, bigEndian, args...); break;
+            case 4:   dispatch<Kernel, 4> (stride, bigEndian, args...); break;
+            default:  jassertfalse; break;
+        }
+    }
+
+    template <int b, bool e, bool c> struct ToFloat    { template <typename... Args> static void call (Args... args) noexcept { toFloat<b, e, c> (args...); } };
+    template <int b, bool e, bool c> struct ToInt32    { template <typename... Args> static void call (Args... args) noexcept { toInt32<b, e, c> (args...); } };
+    template <int b, bool e, bool c> struct FromFloat  { template <typename... Args> static void call (Args... args) noexcept { fromFloat<b, e, c> (args...); } };
+    template <int b, bool e, bool c> struct FromInt32  { template <typename... Args> static void call (Args... args) noexcept { fromInt32<b, e, c> (args...); } };
+}
+
+void AudioData::BlockConversion::toFloat (float* dest, const void* source, int sourceStride,
+                                          int numSamples, int bytesPerSample, bool isBigEndian) noexcept
+{
+    BlockConversionHelpers::dispatch<BlockConversionHelpers::ToFloat> (bytesPerSample, sourceStride, isBigEndian,
+                                                                       dest, static_cast<const char*> (source), sourceStride, numSamples);
+}
+
+void AudioData::BlockConversion::toInt32 (int32* dest, const void* source, int sourceStride,
+                                          int numSamples, int bytesPerSample, bool isBigEndian) noexcept
+{
+    BlockConversionHelpers::dispatch<BlockConversionHelpers::ToInt32> (bytesPerSample, sourceStride, isBigEndian,
+                                                                       dest, static_cast<const char*> (source), sourceStride, numSamples);
+}
+
+void AudioData::BlockConversion::fromFloat (void* dest, int destStride, const float* source,
+                                            int numSamples, int bytesPerSample, bool isBigEndian) noexcept
+{
+    BlockConversionHelpers::dispatch<BlockConversionHelpers::FromFloat> (bytesPerSample, destStride, isBigEndian,
+                                                                         static_cast<char*> (dest), destStride, source, numSamples);
+}
+
+void AudioData::BlockConversion::fromInt32 (void* dest, int destStride, const int32* source,
+                                            int numSamples, int bytesPerSample, bool isBigEndian) noexcept
+{
+    BlockConversionHelpers::dispatch<BlockConversionHelpers::FromInt32> (bytesPerSample, destStride, isBigEndian,
+                                                                         static_cast<char*> (dest), destStride, source, numSamples);
+}
+
+
 //==============================================================================
 #if JUCE_UNIT_TESTS
 
@@ -580,9 +894,85 @@ public:
         }
     };
 
+    template <class PackedFormat, class PackedEndianness, class NativeFormat>
+    struct BlockConversionTest
+    {
+        using Packed      = AudioData::Pointer<PackedFormat, PackedEndianness, AudioData::Interleaved, AudioData::NonConst>;
+        using PackedConst = AudioData::Pointer<PackedFormat, PackedEndianness, AudioData::Interleaved, AudioData::Const>;
+        using Native      = AudioData::Pointer<NativeFormat, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>;
+        using NativeConst = AudioData::Pointer<NativeFormat, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>;
+
+        template <class DestType, class SourceType>
+        static void convertOneAtATime (DestType dest, SourceType source, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i, ++dest, ++source)
+            {
+                if (DestType::isFloatingPoint())
+                    dest.setAsFloat (source.getAsFloat());
+                else
+                    dest.setAsInt32 (source.getAsInt32());
+            }
+        }
+
+        static void test (UnitTest& unitTest, Random& r)
+        {
+            const int numSamples = 1001;
+            const int bytesPerSample = PackedFormat::bytesPerSample;
+
+            for (int numChannels = 1; numChannels <= 3; numChannels += 2)
+            {
+                const size_t packedSize = (size_t) (numSamples * numChannels * bytesPerSample);
+                HeapBlock<char> packed (packedSize), expectedPacked (packedSize);
+                HeapBlock<int32> native (numSamples), expectedNative (numSamples);
+                auto* packedData = packed + (numChannels - 1) * bytesPerSample;
+                auto* expectedPackedData = expectedPacked + (numChannels - 1) * bytesPerSample;
+
+                r.fillBitsRandomly (packed, packedSize);
+
+                Native (native).convertSamples (PackedConst (packedData, numChannels), numSamples);
+                convertOneAtATime (Native (expectedNative), PackedConst (packedData, numChannels), numSamples);
+                unitTest.expect (memcmp (native, expectedNative, sizeof (int32) * (size_t) numSamples) == 0);
+
+                if (NativeConst::isFloatingPoint())
+                {
+                    auto* floats = reinterpret_cast<float*> (native.get());
+
+                    for (int i = 0; i < numSamples; ++i)
+                        floats[i] = (i % 50 == 0) ? (float) (i / 50 % 3) - 1.0f
+                                                  : r.nextFloat() * 2.4f - 1.2f;
+                }
+                else
+                {
+                    r.fillBitsRandomly (native, sizeof (int32) * (size_t) numSamples);
+                }
+
+                memcpy (expectedPacked, packed, packedSize);
+
+                Packed (packedData, numChannels).convertSamples (NativeConst (native), numSamples);
+                convertOneAtATime (Packed (expectedPackedData, numChannels), NativeConst (native), numSamples);
+                unitTest.expect (memcmp (packed, expectedPacked, packedSize) == 0);
+            }
+        }
+    };
+
+    template <class PackedFormat>
+    static void testBlockConversions (UnitTest& unitTest, Random& r)
+    {
+        BlockConversionTest<PackedFormat, AudioData::LittleEndian, AudioData::Float32>::test (unitTest, r);
+        BlockConversionTest<PackedFormat, AudioData::BigEndian,    AudioData::Float32>::test (unitTest, r);
+        BlockConversionTest<PackedFormat, AudioData::LittleEndian, AudioData::Int32>::test (unitTest, r);
+        BlockConversionTest<PackedFormat, AudioData::BigEndian,    AudioData::Int32>::test (unitTest, r);
+    }
+
     void runTest() override
     {
         Random r = getRandom();
+
+        beginTest ("Block conversions match sample-by-sample conversion");
+        testBlockConversions<AudioData::Int16> (*this, r);
+        testBlockConversions<AudioData::Int24> (*this, r);
+        testBlockConversions<AudioData::Int32> (*this, r);
+
         beginTest ("Round-trip conversion: Int8");
         Test1 <AudioData::Int8>::test (*this, r);
         beginTest ("Round-trip conversion: Int16");
@@ -598,6 +988,82 @@ public:
 
 static AudioConversionTests audioConversionUnitTests;
 
+//==============================================================================
+struct AudioConversionBenchmark  : public UnitTestBenchmark
+{
+    AudioConversionBenchmark()  : UnitTestBenchmark ("Audio data conversion") {}
+
+    static constexpr int numSamples = 4096;
+
+    template <class PackedFormat, class PackedEndianness, class NativeFormat>
+    void timePair (const String& packedName, const String& nativeName, int numChannels)
+    {
+        using Test = AudioConversionTests::BlockConversionTest<PackedFormat, PackedEndianness, NativeFormat>;
+
+        HeapBlock<char> packed ((size_t) (numSamples * numChannels * PackedFormat::bytesPerSample), true);
+        HeapBlock<float> native ((size_t) numSamples);
+        auto random = getRandom();
+
+        for (int i = 0; i < numSamples; ++i)
+            native[i] = random.nextFloat() * 2.0f - 1.0f;
+
+        // going through float first means that a packed Float32 can't end up holding NaNs
+        typename Test::Packed (packed, numChannels).convertSamples (AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian,
+                                                                                       AudioData::NonInterleaved, AudioData::Const> (native.getData()),
+                                                                    numSamples);
+        typename Test::Native (native).convertSamples (typename Test::PackedConst (packed, numChannels), numSamples);
+
+        auto toNative = packedName + " -> " + nativeName;
+        auto fromNative = nativeName + " -> " + packedName;
+
+        timeCalls (toNative, [&]
+        {
+            typename Test::Native (native).convertSamples (typename Test::PackedConst (packed, numChannels), numSamples);
+        }, 0.02);
+
+        timeCalls (toNative + ", one at a time", [&]
+        {
+            Test::convertOneAtATime (typename Test::Native (native), typename Test::PackedConst (packed, numChannels), numSamples);
+        }, 0.02);
+
+        timeCalls (fromNative, [&]
+        {
+            typename Test::Packed (packed, numChannels).convertSamples (typename Test::NativeConst (native), numSamples);
+        }, 0.02);
+
+        timeCalls (fromNative + ", one at a time", [&]
+        {
+            Test::convertOneAtATime (typename Test::Packed (packed, numChannels), typename Test::NativeConst (native), numSamples);
+        }, 0.02);
+    }
+
+    template <class PackedFormat>
+    void timeFormat (const String& formatName, int numChannels)
+    {
+        timePair<PackedFormat, AudioData::LittleEndian, AudioData::Float32> (formatName + "LE", "Float32", numChannels);
+        timePair<PackedFormat, AudioData::BigEndian,    AudioData::Float32> (formatName + "BE", "Float32", numChannels);
+        timePair<PackedFormat, AudioData::LittleEndian, AudioData::Int32>   (formatName + "LE", "Int32",   numChannels);
+        timePair<PackedFormat, AudioData::BigEndian,    AudioData::Int32>   (formatName + "BE", "Int32",   numChannels);
+    }
+
+    void runTest() override
+    {
+        for (auto numChannels : { 1, 2 })
+        {
+            beginTest (String (numSamples) + " samples, " + (numChannels == 1 ? "contiguous" : "interleaved stereo"));
+
+            timeFormat<AudioData::Int8>    ("Int8",    numChannels);
+            timeFormat<AudioData::UInt8>   ("UInt8",   numChannels);
+            timeFormat<AudioData::Int16>   ("Int16",   numChannels);
+            timeFormat<AudioData::Int24>   ("Int24",   numChannels);
+            timeFormat<AudioData::Int32>   ("Int32",   numChannels);
+            timeFormat<AudioData::Float32> ("Float32", numChannels);
+        }
+    }
+};
+
+static AudioConversionBenchmark audioConversionBenchmark;
+
 #endif
 
 } // namespace juce
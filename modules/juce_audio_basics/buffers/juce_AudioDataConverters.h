@@ -320,6 +320,80 @@ public:
         static inline void* toVoidPtr (VoidType* v) noexcept { return const_cast<void*> (v); }
         enum { isConst = 1 };
     };
+
+    //==============================================================================
+    /*  Vectorised loops for the most common conversions, between a packed integer format
+        and either native floats or native 32-bit ints. The native side has to be contiguous,
+        but the packed side can have any stride, so they also cover interleaved data. They
+        produce exactly the same results as converting each sample on its own.
+    */
+    struct BlockConversion
+    {
+        static void toFloat   (float* dest, const void* source, int sourceStride, int numSamples, int bytesPerSample, bool isBigEndian) noexcept;
+        static void toInt32   (int32* dest, const void* source, int sourceStride, int numSamples, int bytesPerSample, bool isBigEndian) noexcept;
+        static void fromFloat (void* dest, int destStride, const float* source, int numSamples, int bytesPerSample, bool isBigEndian) noexcept;
+        static void fromInt32 (void* dest, int destStride, const int32* source, int numSamples, int bytesPerSample, bool isBigEndian) noexcept;
+
+        template <class Format>
+        static constexpr bool isPackedInteger() noexcept
+        {
+            return ! Format::isFloat && Format::bytesPerSample >= 2
+                    && (int64) Format::maxValue == ((int64) 1 << (8 * Format::bytesPerSample - 1)) - 1;
+        }
+
+        template <class Format, class Endianness>
+        static constexpr bool isNativeFloat() noexcept
+        {
+            return Format::isFloat && (int) Endianness::isBigEndian == (int) NativeEndian::isBigEndian;
+        }
+
+        template <class Format, class Endianness>
+        static constexpr bool isNativeInt32() noexcept
+        {
+            return isPackedInteger<Format>() && Format::bytesPerSample == 4
+                    && (int) Endianness::isBigEndian == (int) NativeEndian::isBigEndian;
+        }
+
+        // Returns false if there's no fast path for this pair of formats
+        template <class DestFormat, class DestEndianness, class SourceFormat, class SourceEndianness>
+        static bool convert (void* dest, int destStride, const void* source, int sourceStride, int numSamples) noexcept
+        {
+            const int sourceBytes = SourceFormat::bytesPerSample, destBytes = DestFormat::bytesPerSample;
+            const bool sourceIsBigEndian = SourceEndianness::isBigEndian, destIsBigEndian = DestEndianness::isBigEndian;
+
+            if (isPackedInteger<SourceFormat>() && destStride == 4)
+            {
+                if (isNativeFloat<DestFormat, DestEndianness>())
+                {
+                    toFloat (static_cast<float*> (dest), source, sourceStride, numSamples, sourceBytes, sourceIsBigEndian);
+                    return true;
+                }
+
+                if (isNativeInt32<DestFormat, DestEndianness>())
+                {
+                    toInt32 (static_cast<int32*> (dest), source, sourceStride, numSamples, sourceBytes, sourceIsBigEndian);
+                    return true;
+                }
+            }
+
+            if (isPackedInteger<DestFormat>() && sourceStride == 4)
+            {
+                if (isNativeFloat<SourceFormat, SourceEndianness>())
+                {
+                    fromFloat (dest, destStride, static_cast<const float*> (source), numSamples, destBytes, destIsBigEndian);
+                    return true;
+                }
+
+                if (isNativeInt32<SourceFormat, SourceEndianness>())
+                {
+                    fromInt32 (dest, destStride, static_cast<const int32*> (source), numSamples, destBytes, destIsBigEndian);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    };
   #endif
 
     //==============================================================================
@@ -455,8 +529,8 @@ public:
         /** Writes a stream of samples into this pointer from another pointer.
             This will copy the specified number of samples, converting between formats appropriately.
         */
-        template <class OtherPointerType>
-        void convertSamples (OtherPointerType source, int numSamples) const noexcept
+        template <class OtherFormat, class OtherEndianness, class OtherInterleavingType, class OtherConstness>
+        void convertSamples (Pointer<OtherFormat, OtherEndianness, OtherInterleavingType, OtherConstness> source, int numSamples) const noexcept
         {
             // trying to write to a const pointer! For a writeable one, use AudioData::NonConst instead!
             static_assert (Constness::isConst == 0, "Attempt to write to a const pointer");
@@ -465,6 +539,11 @@ public:
 
             if (source.getRawData() != getRawData() || source.getNumBytesBetweenSamples() >= getNumBytesBetweenSamples())
             {
+                if (BlockConversion::convert<SampleFormat, Endianness, OtherFormat, OtherEndianness> (data.data, getNumBytesBetweenSamples(),
+                                                                                                       source.getRawData(), source.getNumBytesBetweenSamples(),
+                                                                                                       numSamples))
+                    return;
+
                 while (--numSamples >= 0)
                 {
                     Endianness::copyFrom (dest.data, source);
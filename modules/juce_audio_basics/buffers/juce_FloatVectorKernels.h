@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*  This file is included by juce_FloatVectorOperations.cpp once for each instruction set
+    that FloatVectorOperations can pick at runtime. Before including it, the caller opens a
+    namespace, defines the Ops32 and Ops64 structs for that instruction set, and turns on
+    code generation for it, so that everything in here gets compiled for the wider registers.
+
+    The arithmetic deliberately avoids fused multiply-adds, so that the results are identical
+    to the SSE and scalar code whichever version ends up being used.
+*/
+
+template <typename Ops>
+struct Kernels
+{
+    using Type = typename Ops::Type;
+    using ParallelType = typename Ops::ParallelType;
+
+    static void add (Type* dest, const Type* src, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::add (Ops::loadU (dest + i), Ops::loadU (src + i)));
+
+        for (; i < num; ++i)
+            dest[i] += src[i];
+    }
+
+    static void add (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::add (Ops::loadU (src1 + i), Ops::loadU (src2 + i)));
+
+        for (; i < num; ++i)
+            dest[i] = src1[i] + src2[i];
+    }
+
+    static void subtract (Type* dest, const Type* src, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::sub (Ops::loadU (dest + i), Ops::loadU (src + i)));
+
+        for (; i < num; ++i)
+            dest[i] -= src[i];
+    }
+
+    static void subtract (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::sub (Ops::loadU (src1 + i), Ops::loadU (src2 + i)));
+
+        for (; i < num; ++i)
+            dest[i] = src1[i] - src2[i];
+    }
+
+    static void multiply (Type* dest, const Type* src, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::mul (Ops::loadU (dest + i), Ops::loadU (src + i)));
+
+        for (; i < num; ++i)
+            dest[i] *= src[i];
+    }
+
+    static void multiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::mul (Ops::loadU (src1 + i), Ops::loadU (src2 + i)));
+
+        for (; i < num; ++i)
+            dest[i] = src1[i] * src2[i];
+    }
+
+    static void multiply (Type* dest, Type multiplier, int num) noexcept
+    {
+        const ParallelType mult = Ops::load1 (multiplier);
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::mul (Ops::loadU (dest + i), mult));
+
+        for (; i < num; ++i)
+            dest[i] *= multiplier;
+    }
+
+    static void copyWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept
+    {
+        const ParallelType mult = Ops::load1 (multiplier);
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::mul (mult, Ops::loadU (src + i)));
+
+        for (; i < num; ++i)
+            dest[i] = src[i] * multiplier;
+    }
+
+    static void addWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept
+    {
+        const ParallelType mult = Ops::load1 (multiplier);
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::add (Ops::loadU (dest + i), Ops::mul (mult, Ops::loadU (src + i))));
+
+        for (; i < num; ++i)
+            dest[i] += src[i] * multiplier;
+    }
+
+    static void addWithMultiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+            Ops::storeU (dest + i, Ops::add (Ops::loadU (dest + i), Ops::mul (Ops::loadU (src1 + i), Ops::loadU (src2 + i))));
+
+        for (; i < num; ++i)
+            dest[i] += src1[i] * src2[i];
+    }
+
+    static Range<Type> findMinAndMax (const Type* src, int num) noexcept
+    {
+        if (num < 2 * Ops::numParallel)
+            return Range<Type>::findMinAndMax (src, num);
+
+        ParallelType mn = Ops::loadU (src), mx = mn;
+        int i = Ops::numParallel;
+
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel)
+        {
+            const ParallelType v = Ops::loadU (src + i);
+            mn = Ops::min (mn, v);
+            mx = Ops::max (mx, v);
+        }
+
+        Range<Type> result (Ops::min (mn), Ops::max (mx));
+
+        for (; i < num; ++i)
+            result = result.getUnionWith (src[i]);
+
+        return result;
+    }
+};
+
+template <typename Type>
+const WideKernelTable<Type>* getKernelTable() noexcept
+{
+    using K = Kernels<typename std::conditional<std::is_same<Type, float>::value, Ops32, Ops64>::type>;
+
+    static const WideKernelTable<Type> table =
+    {
+        K::add, K::add, K::subtract, K::subtract,
+        K::multiply, K::multiply, K::multiply,
+        K::copyWithMultiply, K::addWithMultiply, K::addWithMultiply,
+        K::findMinAndMax
+    };
+
+    return &table;
+}
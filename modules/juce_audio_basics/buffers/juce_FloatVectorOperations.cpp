@@ -485,6 +485,217 @@ namespace FloatVectorHelpers
         }
     };
    #endif
+
+   #if JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH
+    //==============================================================================
+    /*  On x86, the most heavily used operations also have AVX and AVX-512 versions. Each of
+        these is compiled for its own instruction set using function-level target options, so
+        the rest of the binary still only needs SSE2, and the widest set that the CPU supports
+        is picked the first time that one of them gets called.
+    */
+    template <typename Type>
+    struct WideKernelTable
+    {
+        void (*add) (Type*, const Type*, int);
+        void (*addSrc1Src2) (Type*, const Type*, const Type*, int);
+        void (*subtract) (Type*, const Type*, int);
+        void (*subtractSrc1Src2) (Type*, const Type*, const Type*, int);
+        void (*multiply) (Type*, const Type*, int);
+        void (*multiplySrc1Src2) (Type*, const Type*, const Type*, int);
+        void (*multiplyByScalar) (Type*, Type, int);
+        void (*copyWithMultiply) (Type*, const Type*, Type, int);
+        void (*addWithMultiply) (Type*, const Type*, Type, int);
+        void (*addWithMultiplySrc1Src2) (Type*, const Type*, const Type*, int);
+        Range<Type> (*findMinAndMax) (const Type*, int);
+
+        // These return nullptr if the CPU doesn't support the instruction set
+        static const WideKernelTable* getAVX() noexcept;
+        static const WideKernelTable* getAVX512() noexcept;
+
+        static const WideKernelTable* getBest() noexcept
+        {
+            static const WideKernelTable* best = (getAVX512() != nullptr ? getAVX512() : getAVX());
+            return best;
+        }
+    };
+
+    //==============================================================================
+    namespace AVX
+    {
+       #if JUCE_CLANG
+        #pragma clang attribute push (__attribute__ ((target ("avx"))), apply_to = function)
+       #elif JUCE_GCC
+        #pragma GCC push_options
+        #pragma GCC target ("avx")
+       #endif
+
+        struct Ops32
+        {
+            using Type = float;
+            using ParallelType = __m256;
+            enum { numParallel = 8 };
+
+            static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm256_set1_ps (v); }
+            static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_ps (v); }
+            static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_ps (dest, a); }
+
+            static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_ps (a, b); }
+            static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm256_sub_ps (a, b); }
+            static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_ps (a, b); }
+            static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_ps (a, b); }
+            static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_ps (a, b); }
+
+            static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+            static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+        };
+
+        struct Ops64
+        {
+            using Type = double;
+            using ParallelType = __m256d;
+            enum { numParallel = 4 };
+
+            static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm256_set1_pd (v); }
+            static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_pd (v); }
+            static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_pd (dest, a); }
+
+            static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_pd (a, b); }
+            static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm256_sub_pd (a, b); }
+            static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_pd (a, b); }
+            static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_pd (a, b); }
+            static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_pd (a, b); }
+
+            static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmax (v[0], v[1], v[2], v[3]); }
+            static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmin (v[0], v[1], v[2], v[3]); }
+        };
+
+        #include "juce_FloatVectorKernels.h"
+
+       #if JUCE_CLANG
+        #pragma clang attribute pop
+       #elif JUCE_GCC
+        #pragma GCC pop_options
+       #endif
+    }
+
+    //==============================================================================
+    namespace AVX512
+    {
+       #if JUCE_CLANG
+        #pragma clang attribute push (__attribute__ ((target ("avx512f"))), apply_to = function)
+       #elif JUCE_GCC
+        #pragma GCC push_options
+        #pragma GCC target ("avx512f")
+       #endif
+
+        // (the all-lanes masked forms of min and max avoid a spurious uninitialised variable
+        // warning from the non-masked versions in some GCC 12 headers)
+        struct Ops32
+        {
+            using Type = float;
+            using ParallelType = __m512;
+            enum { numParallel = 16 };
+
+            static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm512_set1_ps (v); }
+            static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_ps (v); }
+            static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_ps (dest, a); }
+
+            static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_ps (a, b); }
+            static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm512_sub_ps (a, b); }
+            static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_ps (a, b); }
+            static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_max_ps (0xffff, a, b); }
+            static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_min_ps (0xffff, a, b); }
+
+            static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+            static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+        };
+
+        struct Ops64
+        {
+            using Type = double;
+            using ParallelType = __m512d;
+            enum { numParallel = 8 };
+
+            static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm512_set1_pd (v); }
+            static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_pd (v); }
+            static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_pd (dest, a); }
+
+            static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_pd (a, b); }
+            static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm512_sub_pd (a, b); }
+            static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_pd (a, b); }
+            static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_max_pd (0xff, a, b); }
+            static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_min_pd (0xff, a, b); }
+
+            static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+            static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+        };
+
+        #include "juce_FloatVectorKernels.h"
+
+       #if JUCE_CLANG
+        #pragma clang attribute pop
+       #elif JUCE_GCC
+        #pragma GCC pop_options
+       #endif
+    }
+
+    //==============================================================================
+    /*  The CPUID feature bits only say what the CPU can do. Before the wider registers can be
+        used, the OS must also have enabled XSAVE (reported by the OSXSAVE bit), and have set the
+        bits in XCR0 which make it save and restore that register state on a context switch.
+    */
+    static bool isRegisterStateEnabledByOS (uint64 requiredXCR0Bits) noexcept
+    {
+        constexpr uint32 osxsaveBit = 1u << 27;
+
+       #if JUCE_MSVC
+        int info[4];
+        __cpuid (info, 1);
+
+        if (((uint32) info[2] & osxsaveBit) == 0)
+            return false;
+
+        auto xcr0 = (uint64) _xgetbv (0);
+       #else
+        uint32 a = 0, b = 0, c = 0, d = 0;
+
+        if (__get_cpuid (1, &a, &b, &c, &d) == 0 || (c & osxsaveBit) == 0)
+            return false;
+
+        uint32 xcr0Low, xcr0High;
+        asm volatile ("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+        auto xcr0 = (uint64) xcr0Low | ((uint64) xcr0High << 32);
+       #endif
+
+        return (xcr0 & requiredXCR0Bits) == requiredXCR0Bits;
+    }
+
+    enum : uint64
+    {
+        xcr0AVXState    = 0x06,  // SSE and AVX registers
+        xcr0AVX512State = 0xe6   // SSE, AVX, opmask and all 32 of the 512-bit registers
+    };
+
+    template <typename Type>
+    const WideKernelTable<Type>* WideKernelTable<Type>::getAVX() noexcept
+    {
+        return SystemStats::hasAVX() && isRegisterStateEnabledByOS (xcr0AVXState)
+                 ? AVX::getKernelTable<Type>() : nullptr;
+    }
+
+    template <typename Type>
+    const WideKernelTable<Type>* WideKernelTable<Type>::getAVX512() noexcept
+    {
+        return SystemStats::hasAVX512F() && isRegisterStateEnabledByOS (xcr0AVX512State)
+                 ? AVX512::getKernelTable<Type>() : nullptr;
+    }
+
+    #define JUCE_DISPATCH_TO_WIDE_KERNEL(Type, kernel, ...) \
+        if (auto* wideKernels = FloatVectorHelpers::WideKernelTable<Type>::getBest()) \
+            return wideKernels->kernel (__VA_ARGS__);
+   #else
+    #define JUCE_DISPATCH_TO_WIDE_KERNEL(Type, kernel, ...)
+   #endif
 }
 
 //==============================================================================
@@ -552,6 +763,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (float* dest, const f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, copyWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -563,6 +775,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (double* dest, const
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, copyWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -612,6 +825,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, in
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, add, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -621,6 +835,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, add, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -630,6 +845,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, addSrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -639,6 +855,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src1,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, addSrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -648,6 +865,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsub (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, subtract, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i], Mode::sub (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -657,6 +875,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsubD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, subtract, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i], Mode::sub (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -666,6 +885,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsub (src2, 1, src1, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, subtractSrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] - src2[i], Mode::sub (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -675,6 +895,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsubD (src2, 1, src1, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, subtractSrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] - src2[i], Mode::sub (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -684,6 +905,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsma (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, addWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -695,6 +917,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmaD (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, addWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -706,6 +929,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vma ((float*) src1, 1, (float*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, addWithMultiplySrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -717,6 +941,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmaD ((double*) src1, 1, (double*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, addWithMultiplySrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -756,6 +981,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, multiply, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -765,6 +991,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmulD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, multiply, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -774,6 +1001,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, multiplySrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] * src2[i], Mode::mul (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -783,6 +1011,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmulD (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, multiplySrc1Src2, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] * src2[i], Mode::mul (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -792,6 +1021,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, float multiplie
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, multiplyByScalar, dest, multiplier, num)
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -802,6 +1032,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, multiplyByScalar, dest, multiplier, num)
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -977,6 +1208,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
 Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_TO_WIDE_KERNEL (float, findMinAndMax, src, num)
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinAndMax (src, num);
    #else
     return Range<float>::findMinAndMax (src, num);
@@ -986,6 +1218,7 @@ Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* sr
 Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_TO_WIDE_KERNEL (double, findMinAndMax, src, num)
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinAndMax (src, num);
    #else
     return Range<double>::findMinAndMax (src, num);
@@ -1283,6 +1516,85 @@ public:
         }
     };
 
+   #if JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH
+    template <typename ValueType>
+    struct WideKernelTestRunner
+    {
+        using Table = FloatVectorHelpers::WideKernelTable<ValueType>;
+
+        static void runTest (UnitTest& u, Random random, const Table& kernels)
+        {
+            const int num = random.nextInt (300);
+
+            HeapBlock<ValueType> buffer1 (num + 16), buffer2 (num + 16), buffer3 (num + 16), expected (num + 16);
+
+            ValueType* const src1 = addBytesToPointer (buffer1.get(), random.nextInt (16));
+            ValueType* const src2 = addBytesToPointer (buffer2.get(), random.nextInt (16));
+            ValueType* const dest = addBytesToPointer (buffer3.get(), random.nextInt (16));
+
+            TestRunner<ValueType>::fillRandomly (random, src1, num);
+            TestRunner<ValueType>::fillRandomly (random, src2, num);
+            const auto multiplier = (ValueType) (random.nextDouble() * 10.0);
+
+            for (int i = 0; i < num; ++i)  expected[i] = src1[i] + src2[i];
+            kernels.addSrc1Src2 (dest, src1, src2, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] += src1[i];
+            kernels.add (dest, src1, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] -= src2[i];
+            kernels.subtract (dest, src2, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] = src1[i] - src2[i];
+            kernels.subtractSrc1Src2 (dest, src1, src2, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] *= src1[i];
+            kernels.multiply (dest, src1, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] = src1[i] * src2[i];
+            kernels.multiplySrc1Src2 (dest, src1, src2, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] *= multiplier;
+            kernels.multiplyByScalar (dest, multiplier, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] = src1[i] * multiplier;
+            kernels.copyWithMultiply (dest, src1, multiplier, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] += src2[i] * multiplier;
+            kernels.addWithMultiply (dest, src2, multiplier, num);
+            u.expect (matches (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)  expected[i] += src1[i] * src2[i];
+            kernels.addWithMultiplySrc1Src2 (dest, src1, src2, num);
+            u.expect (matches (dest, expected, num));
+
+            u.expect (kernels.findMinAndMax (dest, num) == Range<ValueType>::findMinAndMax (dest, num));
+        }
+
+        static bool matches (const ValueType* d1, const ValueType* d2, int num)
+        {
+            // the wide kernels don't use fused multiply-adds, so should match exactly
+            return std::equal (d1, d1 + num, d2);
+        }
+
+        static void runTests (UnitTest& u, Random& random)
+        {
+            for (auto* kernels : { Table::getAVX(), Table::getAVX512() })
+                if (kernels != nullptr)
+                    for (int i = 100; --i >= 0;)
+                        runTest (u, random, *kernels);
+        }
+    };
+   #endif
+
     void runTest() override
     {
         beginTest ("FloatVectorOperations");
@@ -1292,6 +1604,14 @@ public:
             TestRunner<float>::runTest (*this, getRandom());
             TestRunner<double>::runTest (*this, getRandom());
         }
+
+       #if JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH
+        beginTest ("Runtime dispatched AVX kernels");
+
+        auto random = getRandom();
+        WideKernelTestRunner<float>::runTests (*this, random);
+        WideKernelTestRunner<double>::runTests (*this, random);
+       #endif
     }
 };
 
@@ -37,6 +37,10 @@ class ScopedNoDenormals;
     A collection of simple vector operations on arrays of floats, accelerated with
     SIMD instructions where possible.
 
+    On 64-bit x86 machines, the most commonly used operations will switch to AVX or
+    AVX-512 versions at runtime if the CPU supports them, so there's no need to build
+    with special compiler flags to get the benefit of the wider registers.
+
     @tags{Audio}
 */
 class JUCE_API  FloatVectorOperations
@@ -0,0 +1,498 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace PolyphaseResamplerHelpers
+{
+    struct Settings
+    {
+        int numTaps, numPhases;
+        double kaiserBeta, bandwidth;
+    };
+
+    static Settings getSettings (PolyphaseResampler::Quality quality) noexcept
+    {
+        switch (quality)
+        {
+            case PolyphaseResampler::Quality::low:      return { 16,  64,  6.0,  0.80 };
+            case PolyphaseResampler::Quality::medium:   return { 32,  128, 8.0,  0.87 };
+            case PolyphaseResampler::Quality::best:     return { 128, 512, 12.0, 0.95 };
+            case PolyphaseResampler::Quality::high:
+            default:                                    return { 64,  256, 10.0, 0.91 };
+        }
+    }
+
+    // The downsampling cutoffs are quantised into steps of a sixteenth of an octave, so
+    // that a ratio which wanders around doesn't keep needing new filters.
+    static constexpr int cutoffStepsPerOctave = 16;
+    static constexpr int maxCutoffStep = 8 * cutoffStepsPerOctave;
+
+    static int getCutoffStep (double speedRatio) noexcept
+    {
+        if (speedRatio <= 1.0)
+            return 0;
+
+        // rounding up means the cutoff is always at or below the new Nyquist frequency
+        return jmin (maxCutoffStep, (int) std::ceil (cutoffStepsPerOctave * std::log2 (speedRatio) - 1.0e-9));
+    }
+
+    static double besselI0 (double x) noexcept
+    {
+        auto ax = std::abs (x);
+
+        if (ax < 3.75)
+        {
+            auto y = x / 3.75;
+            y *= y;
+
+            return 1.0 + y * (3.5156229 + y * (3.0899424 + y * (1.2067492
+                    + y * (0.2659732 + y * (0.360768e-1 + y * 0.45813e-2)))));
+        }
+
+        auto y = 3.75 / ax;
+
+        return (std::exp (ax) / std::sqrt (ax))
+                 * (0.39894228 + y * (0.1328592e-1 + y * (0.225319e-2 + y * (-0.157565e-2 + y * (0.916281e-2
+                     + y * (-0.2057706e-1 + y * (0.2635537e-1 + y * (-0.1647633e-1 + y * 0.392377e-2))))))));
+    }
+
+    // Works out the two dot products of the input window with a pair of adjacent filter
+    // phases. The number of taps is always a multiple of 8.
+    static forcedinline void dotProducts (const float* x, const float* h0, const float* h1, int num,
+                                          float& result0, float& result1) noexcept
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        // two accumulators per result, to shorten the chains of dependent additions
+        auto sum0a = _mm_setzero_ps(), sum0b = _mm_setzero_ps();
+        auto sum1a = _mm_setzero_ps(), sum1b = _mm_setzero_ps();
+
+        for (int i = 0; i < num; i += 8)
+        {
+            auto va = _mm_loadu_ps (x + i);
+            auto vb = _mm_loadu_ps (x + i + 4);
+            sum0a = _mm_add_ps (sum0a, _mm_mul_ps (va, _mm_loadu_ps (h0 + i)));
+            sum0b = _mm_add_ps (sum0b, _mm_mul_ps (vb, _mm_loadu_ps (h0 + i + 4)));
+            sum1a = _mm_add_ps (sum1a, _mm_mul_ps (va, _mm_loadu_ps (h1 + i)));
+            sum1b = _mm_add_ps (sum1b, _mm_mul_ps (vb, _mm_loadu_ps (h1 + i + 4)));
+        }
+
+        auto sum0 = _mm_add_ps (sum0a, sum0b);
+        auto sum1 = _mm_add_ps (sum1a, sum1b);
+
+        // sums the four lanes of both accumulators at once
+        auto lo = _mm_unpacklo_ps (sum0, sum1);
+        auto hi = _mm_unpackhi_ps (sum0, sum1);
+        auto pairs = _mm_add_ps (lo, hi);
+        auto totals = _mm_add_ps (pairs, _mm_movehl_ps (pairs, pairs));
+
+        result0 = _mm_cvtss_f32 (totals);
+        result1 = _mm_cvtss_f32 (_mm_shuffle_ps (totals, totals, _MM_SHUFFLE (1, 1, 1, 1)));
+       #elif JUCE_USE_ARM_NEON
+        auto sum0a = vdupq_n_f32 (0), sum0b = vdupq_n_f32 (0);
+        auto sum1a = vdupq_n_f32 (0), sum1b = vdupq_n_f32 (0);
+
+        for (int i = 0; i < num; i += 8)
+        {
+            auto va = vld1q_f32 (x + i);
+            auto vb = vld1q_f32 (x + i + 4);
+            sum0a = vmlaq_f32 (sum0a, va, vld1q_f32 (h0 + i));
+            sum0b = vmlaq_f32 (sum0b, vb, vld1q_f32 (h0 + i + 4));
+            sum1a = vmlaq_f32 (sum1a, va, vld1q_f32 (h1 + i));
+            sum1b = vmlaq_f32 (sum1b, vb, vld1q_f32 (h1 + i + 4));
+        }
+
+        auto sum0 = vaddq_f32 (sum0a, sum0b);
+        auto sum1 = vaddq_f32 (sum1a, sum1b);
+
+        auto pair0 = vadd_f32 (vget_low_f32 (sum0), vget_high_f32 (sum0));
+        auto pair1 = vadd_f32 (vget_low_f32 (sum1), vget_high_f32 (sum1));
+        auto totals = vpadd_f32 (pair0, pair1);
+
+        result0 = vget_lane_f32 (totals, 0);
+        result1 = vget_lane_f32 (totals, 1);
+       #else
+        float sum0[4] = {}, sum1[4] = {};
+
+        for (int i = 0; i < num; i += 4)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                sum0[j] += x[i + j] * h0[i + j];
+                sum1[j] += x[i + j] * h1[i + j];
+            }
+        }
+
+        result0 = (sum0[0] + sum0[1]) + (sum0[2] + sum0[3]);
+        result1 = (sum1[0] + sum1[1]) + (sum1[2] + sum1[3]);
+       #endif
+    }
+}
+
+//==============================================================================
+struct PolyphaseResampler::FilterBank  : public ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<FilterBank>;
+
+    FilterBank (Quality q, int taps, int step)
+        : quality (q), numTaps (taps), cutoffStep (step)
+    {
+        auto settings = PolyphaseResamplerHelpers::getSettings (quality);
+        numPhases = settings.numPhases;
+
+        // one extra phase at the end, so that there's always a next phase to interpolate towards
+        coefficients.malloc ((size_t) ((numPhases + 1) * numTaps));
+
+        auto cutoff = settings.bandwidth * std::pow (2.0, -cutoffStep / (double) PolyphaseResamplerHelpers::cutoffStepsPerOctave);
+        auto halfLength = numTaps / 2;
+        auto windowScale = 1.0 / PolyphaseResamplerHelpers::besselI0 (settings.kaiserBeta);
+
+        for (int phase = 0; phase <= numPhases; ++phase)
+        {
+            auto* h = coefficients + phase * numTaps;
+            auto fraction = phase / (double) numPhases;
+            double sum = 0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                // distance in input samples from the point being calculated
+                auto x = i - halfLength + 1 - fraction;
+                auto relativePos = jlimit (-1.0, 1.0, x / halfLength);
+
+                auto window = windowScale * PolyphaseResamplerHelpers::besselI0 (settings.kaiserBeta * std::sqrt (1.0 - relativePos * relativePos));
+                auto sinc = x == 0 ? 1.0 : std::sin (MathConstants<double>::pi * cutoff * x) / (MathConstants<double>::pi * cutoff * x);
+
+                auto value = cutoff * sinc * window;
+                h[i] = (float) value;
+                sum += value;
+            }
+
+            // normalising every phase keeps the gain at DC exactly the same for all positions
+            for (int i = 0; i < numTaps; ++i)
+                h[i] = (float) (h[i] / sum);
+        }
+    }
+
+    const float* getPhase (int phase) const noexcept     { return coefficients + phase * numTaps; }
+
+    static Ptr get (Quality quality, int numTaps, int cutoffStep)
+    {
+        // The banks are immutable once built, so any number of resamplers can share them
+        static CriticalSection lock;
+        static ReferenceCountedArray<FilterBank> banks;
+
+        const ScopedLock sl (lock);
+
+        for (auto* b : banks)
+            if (b->quality == quality && b->numTaps == numTaps && b->cutoffStep == cutoffStep)
+                return b;
+
+        return banks.add (new FilterBank (quality, numTaps, cutoffStep));
+    }
+
+    const Quality quality;
+    const int numTaps, cutoffStep;
+    int numPhases;
+    HeapBlock<float> coefficients;
+
+    JUCE_DECLARE_NON_COPYABLE (FilterBank)
+};
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler (Quality q, double maximumSpeedRatio)
+    : quality (q),
+      numTaps (calculateNumTaps (q, maximumSpeedRatio)),
+      maxCutoffStep (PolyphaseResamplerHelpers::getCutoffStep (maximumSpeedRatio)),
+      banksByCutoffStep (new std::atomic<FilterBank*>[(size_t) maxCutoffStep + 1]())
+{
+    // the history is stored twice over, so that the last numTaps samples are always contiguous
+    history.calloc ((size_t) numTaps * 2);
+
+    // the top bank is the fallback for any ratio that hasn't been prepared
+    prepareForSpeedRatio (1.0);
+    prepareForSpeedRatio (maximumSpeedRatio);
+}
+
+int PolyphaseResampler::calculateNumTaps (Quality q, double maximumSpeedRatio) noexcept
+{
+    return ((roundToInt (PolyphaseResamplerHelpers::getSettings (q).numTaps * jmax (1.0, maximumSpeedRatio)) + 7) / 8) * 8;
+}
+
+int PolyphaseResampler::getLatencyInSamples (Quality q, double maximumSpeedRatio) noexcept
+{
+    return calculateNumTaps (q, maximumSpeedRatio) / 2;
+}
+
+PolyphaseResampler::~PolyphaseResampler() {}
+
+void PolyphaseResampler::reset() noexcept
+{
+    history.clear ((size_t) numTaps * 2);
+    historyIndex = 0;
+    subSamplePos = 1.0;
+}
+
+void PolyphaseResampler::prepareForSpeedRatio (double speedRatio)
+{
+    auto step = jmin (maxCutoffStep, PolyphaseResamplerHelpers::getCutoffStep (speedRatio));
+
+    const ScopedLock sl (preparedBanks.getLock());
+
+    if (banksByCutoffStep[step].load() == nullptr)
+        banksByCutoffStep[step] = preparedBanks.add (FilterBank::get (quality, numTaps, step));
+}
+
+const PolyphaseResampler::FilterBank& PolyphaseResampler::getFilterBank (double speedRatio) const noexcept
+{
+    // If this ratio hasn't been prepared, a bank with a lower cutoff is the safe choice,
+    // and the one for the maximum ratio is always there.
+    for (auto step = jmin (maxCutoffStep, PolyphaseResamplerHelpers::getCutoffStep (speedRatio));; ++step)
+        if (auto* bank = banksByCutoffStep[step].load())
+            return *bank;
+}
+
+int PolyphaseResampler::getNumInputSamplesNeeded (double speedRatio, int numOutputSamplesToProduce) const noexcept
+{
+    // this has to do exactly the same arithmetic as process()
+    auto pos = subSamplePos;
+    int numUsed = 0;
+
+    for (int i = 0; i < numOutputSamplesToProduce; ++i)
+    {
+        while (pos >= 1.0)
+        {
+            ++numUsed;
+            pos -= 1.0;
+        }
+
+        pos += speedRatio;
+    }
+
+    return numUsed;
+}
+
+float PolyphaseResampler::calculateOutputSample (const FilterBank& bank, const float* window, double position) const noexcept
+{
+    auto phasePos = (float) (position * bank.numPhases);
+    auto phase = jmin ((int) phasePos, bank.numPhases - 1);
+    auto alpha = phasePos - (float) phase;
+
+    float r0, r1;
+    PolyphaseResamplerHelpers::dotProducts (window, bank.getPhase (phase), bank.getPhase (phase + 1), numTaps, r0, r1);
+
+    return r0 + alpha * (r1 - r0);
+}
+
+void PolyphaseResampler::pushSample (float sample) noexcept
+{
+    history[historyIndex] = sample;
+    history[historyIndex + numTaps] = sample;
+
+    if (++historyIndex == numTaps)
+        historyIndex = 0;
+}
+
+void PolyphaseResampler::storeHistory (const float* lastInputSamples) noexcept
+{
+    memcpy (history, lastInputSamples, (size_t) numTaps * sizeof (float));
+    memcpy (history + numTaps, lastInputSamples, (size_t) numTaps * sizeof (float));
+    historyIndex = 0;
+}
+
+int PolyphaseResampler::process (double speedRatio, const float* in, float* out, int numOut) noexcept
+{
+    jassert (speedRatio > 0);
+
+    // Until numTaps samples of the new input have been used, the filters need to see
+    // some of the stored history as well. After that, they can read the input directly.
+    if (speedRatio == 1.0 && subSamplePos == 1.0)
+    {
+        // at a ratio of 1 the output is just the input, delayed by the latency
+        const auto delay = numTaps / 2;
+        auto numFromHistory = jmin (numOut, delay);
+
+        for (int i = 0; i < numFromHistory; ++i)
+        {
+            pushSample (in[i]);
+            out[i] = history[historyIndex + delay - 1];
+        }
+
+        if (numOut > delay)
+            memcpy (out + delay, in, (size_t) (numOut - delay) * sizeof (float));
+
+        if (numOut >= numTaps)
+            storeHistory (in + numOut - numTaps);
+        else
+            for (int i = numFromHistory; i < numOut; ++i)
+                pushSample (in[i]);
+
+        return numOut;
+    }
+
+    auto& bank = getFilterBank (speedRatio);
+    auto pos = subSamplePos;
+    int numUsed = 0;
+
+    for (int i = 0; i < numOut; ++i)
+    {
+        while (pos >= 1.0)
+        {
+            if (numUsed < numTaps)
+                pushSample (in[numUsed]);
+
+            ++numUsed;
+            pos -= 1.0;
+        }
+
+        out[i] = calculateOutputSample (bank, numUsed >= numTaps ? in + numUsed - numTaps
+                                                                 : history + historyIndex, pos);
+        pos += speedRatio;
+    }
+
+    if (numUsed >= numTaps)
+        storeHistory (in + numUsed - numTaps);
+
+    subSamplePos = pos;
+    return numUsed;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct PolyphaseResamplerTests  : public UnitTest
+{
+    PolyphaseResamplerTests()  : UnitTest ("PolyphaseResampler", "Audio") {}
+
+    using Quality = PolyphaseResampler::Quality;
+
+    static HeapBlock<float> createSine (double cyclesPerSample, int numSamples)
+    {
+        HeapBlock<float> data ((size_t) numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = (float) (0.5 * std::sin (MathConstants<double>::twoPi * cyclesPerSample * i));
+
+        return data;
+    }
+
+    void runTest() override
+    {
+        const int numInput = 8192;
+
+        beginTest ("A ratio of 1 passes the signal through with a fixed delay");
+        {
+            PolyphaseResampler resampler;
+            auto input = createSine (0.01, numInput);
+            HeapBlock<float> output ((size_t) numInput);
+
+            expectEquals (resampler.process (1.0, input, output, numInput), numInput);
+
+            auto latency = resampler.getLatencyInSamples();
+
+            for (int i = latency; i < numInput; ++i)
+                expectEquals (output[i], input[i - latency]);
+        }
+
+        beginTest ("Resampled sine waves match the ideal result");
+        {
+            for (auto quality : { Quality::low, Quality::medium, Quality::high, Quality::best })
+            {
+                for (auto ratio : { 48000.0 / 44100.0, 44100.0 / 48000.0, 0.25, 2.0 / 3.0, 1.5 })
+                {
+                    PolyphaseResampler resampler (quality, ratio);
+                    expectEquals (PolyphaseResampler::getLatencyInSamples (quality, ratio), resampler.getLatencyInSamples());
+
+                    const double frequency = 0.02;
+                    auto input = createSine (frequency, numInput);
+
+                    auto numOutput = (int) ((numInput - 2 * resampler.getNumTaps()) / ratio);
+                    HeapBlock<float> output ((size_t) numOutput);
+
+                    auto numNeeded = resampler.getNumInputSamplesNeeded (ratio, numOutput);
+                    expect (numNeeded <= numInput);
+                    expectEquals (resampler.process (ratio, input, output, numOutput), numNeeded);
+
+                    // The first output is centred on the sample that's getLatencyInSamples() before the first
+                    // input, so skip the outputs whose filters would overlap the start of the sine
+                    double maxError = 0;
+
+                    for (int i = (int) std::ceil (resampler.getNumTaps() / ratio); i < numOutput; ++i)
+                    {
+                        auto t = i * ratio - resampler.getLatencyInSamples();
+                        auto expected = 0.5 * std::sin (MathConstants<double>::twoPi * frequency * t);
+                        maxError = jmax (maxError, std::abs (expected - output[i]));
+                    }
+
+                    expectLessThan (maxError, quality == Quality::low ? 2.0e-3 : 2.0e-4);
+                }
+            }
+        }
+
+        beginTest ("Frequencies above the new Nyquist frequency are removed when downsampling");
+        {
+            const double ratio = 2.0;
+            PolyphaseResampler resampler (Quality::high, ratio);
+
+            // 0.45 cycles per input sample would alias to 0.1 cycles per output sample
+            auto input = createSine (0.45, numInput);
+            const int numOutput = numInput / 2 - 1;
+            HeapBlock<float> output ((size_t) numOutput);
+            resampler.process (ratio, input, output, numOutput);
+
+            auto peak = FloatVectorOperations::findMaximum (output + resampler.getNumTaps(), numOutput - resampler.getNumTaps());
+            expectLessThan (peak, Decibels::decibelsToGain (-90.0f));
+        }
+
+        beginTest ("Splitting the input into blocks doesn't change the output");
+        {
+            const double ratio = 0.7;
+            PolyphaseResampler whole (Quality::medium), split (Quality::medium);
+            Random random (8263);
+
+            auto input = createSine (0.05, numInput);
+            const int numOutput = 10000;
+            HeapBlock<float> wholeOutput ((size_t) numOutput), splitOutput ((size_t) numOutput);
+
+            whole.process (ratio, input, wholeOutput, numOutput);
+
+            int inputPos = 0;
+
+            for (int outputPos = 0; outputPos < numOutput;)
+            {
+                auto num = jmin (numOutput - outputPos, random.nextInt (200) + 1);
+                inputPos += split.process (ratio, input + inputPos, splitOutput + outputPos, num);
+                outputPos += num;
+            }
+
+            for (int i = 0; i < numOutput; ++i)
+                expectEquals (splitOutput[i], wholeOutput[i]);
+        }
+    }
+};
+
+static PolyphaseResamplerTests polyphaseResamplerTests;
+
+#endif
+
+} // namespace juce
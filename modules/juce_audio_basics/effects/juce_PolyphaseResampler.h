@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+/**
+    A high-quality resampler for streams of floats, which uses a bank of
+    windowed-sinc filters.
+
+    This works like LagrangeInterpolator, and has the same kind of process()
+    method, but rather than just interpolating between a few neighbouring samples,
+    it uses a proper band-limited filter, so it can be used for sample-rate
+    conversion without adding audible aliasing or imaging. The filter for each
+    fractional position is taken from a precomputed table of sub-sample phases,
+    which is shared between all the resamplers that use the same settings.
+
+    When downsampling (i.e. with a speed ratio greater than 1.0), the filter's
+    cutoff is lowered to remove anything above the new Nyquist frequency. The
+    filter length is fixed when the object is created, so if you'll be downsampling
+    by large ratios, pass a suitable maximumSpeedRatio to the constructor to keep
+    the filters long enough for the lowered cutoff.
+
+    process() is safe to call on the audio thread: it never allocates or locks, so
+    the filters for each downsampling ratio have to be built beforehand. The
+    constructor builds them for a ratio of 1.0 and for maximumSpeedRatio, and you
+    can call prepareForSpeedRatio() to build them for any other ratio that you're
+    about to use.
+
+    The resampler is stateful, so when there's a break in the continuity of the
+    input stream, you should call reset() before feeding it any new data. If you're
+    resampling multiple channels, each one needs its own PolyphaseResampler object.
+
+    @see LagrangeInterpolator, ResamplingAudioSource
+
+    @tags{Audio}
+*/
+class JUCE_API  PolyphaseResampler
+{
+public:
+    /** The available quality settings, trading speed against the accuracy of the filters. */
+    enum class Quality
+    {
+        low,        /**< 16 taps, 64 phases */
+        medium,     /**< 32 taps, 128 phases */
+        high,       /**< 64 taps, 256 phases */
+        best        /**< 128 taps, 512 phases */
+    };
+
+    /** Creates a resampler.
+
+        @param quality              the length and accuracy of the filters to use
+        @param maximumSpeedRatio    the largest speed ratio that you expect to pass to process().
+                                    For ratios above 1.0, the filters are made proportionally
+                                    longer so that the quality isn't reduced when downsampling.
+    */
+    PolyphaseResampler (Quality quality = Quality::high, double maximumSpeedRatio = 1.0);
+
+    /** Destructor. */
+    ~PolyphaseResampler();
+
+    /** Resets the state of the resampler.
+        Call this when there's a break in the continuity of the input data stream.
+    */
+    void reset() noexcept;
+
+    /** Returns the quality that was passed to the constructor. */
+    Quality getQuality() const noexcept                 { return quality; }
+
+    /** Returns the number of taps that the filters use for each output sample. */
+    int getNumTaps() const noexcept                     { return numTaps; }
+
+    /** Returns the delay introduced by the filters, in input samples. */
+    int getLatencyInSamples() const noexcept            { return numTaps / 2; }
+
+    /** Returns the delay that a resampler created with these settings would have, without
+        having to create one.
+    */
+    static int getLatencyInSamples (Quality quality, double maximumSpeedRatio) noexcept;
+
+    /** Makes sure that the filters for a given speed ratio have been built.
+
+        If process() is given a ratio whose filters haven't been built, it falls back to
+        the nearest ones that have a lower cutoff, which avoids aliasing but removes a
+        little more of the top end than necessary. So when you know that a new
+        downsampling ratio is coming up, call this first to get the best quality.
+
+        This may allocate memory, so don't call it on the audio thread, but it's fine
+        to call it while another thread is inside process().
+    */
+    void prepareForSpeedRatio (double speedRatio);
+
+    /** Returns the number of input samples that the next call to process() will use
+        when it's asked for a given number of output samples at a given speed ratio.
+    */
+    int getNumInputSamplesNeeded (double speedRatio, int numOutputSamplesToProduce) const noexcept;
+
+    /** Resamples a stream of samples.
+
+        @param speedRatio       the number of input samples to use for each output sample
+        @param inputSamples     the source data to read from. This must contain at
+                                least getNumInputSamplesNeeded() samples.
+        @param outputSamples    the buffer to write the results into
+        @param numOutputSamplesToProduce    the number of output samples that should be created
+        @returns the actual number of input samples that were used
+    */
+    int process (double speedRatio,
+                 const float* inputSamples,
+                 float* outputSamples,
+                 int numOutputSamplesToProduce) noexcept;
+
+private:
+    //==============================================================================
+    struct FilterBank;
+
+    static int calculateNumTaps (Quality, double maximumSpeedRatio) noexcept;
+    const FilterBank& getFilterBank (double speedRatio) const noexcept;
+    float calculateOutputSample (const FilterBank&, const float* window, double position) const noexcept;
+    void pushSample (float) noexcept;
+    void storeHistory (const float* lastInputSamples) noexcept;
+
+    const Quality quality;
+    const int numTaps, maxCutoffStep;
+
+    // The banks that have been built, indexed by cutoff step. Only prepareForSpeedRatio()
+    // fills these in, and process() just reads them.
+    std::unique_ptr<std::atomic<FilterBank*>[]> banksByCutoffStep;
+    ReferenceCountedArray<FilterBank, CriticalSection> preparedBanks;
+
+    HeapBlock<float> history;
+    int historyIndex = 0;
+    double subSamplePos = 1.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
+
+} // namespace juce
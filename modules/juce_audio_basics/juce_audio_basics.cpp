@@ -37,6 +37,23 @@
 
 #if JUCE_USE_SSE_INTRINSICS
  #include <emmintrin.h>
+
+ #ifndef JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH
+  #if (defined (__x86_64__) || defined (_M_X64)) \
+       && ((JUCE_GCC && __GNUC__ >= 5) || (JUCE_CLANG && __clang_major__ >= 10) || (JUCE_MSVC && _MSC_VER >= 1911))
+   #define JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH 1
+  #endif
+ #endif
+
+ #if JUCE_FLOAT_VECTOR_RUNTIME_DISPATCH
+  #include <immintrin.h>
+
+  #if JUCE_MSVC
+   #include <intrin.h>
+  #else
+   #include <cpuid.h>
+  #endif
+ #endif
 #endif
 
 #ifndef JUCE_USE_VDSP_FRAMEWORK
@@ -60,6 +77,7 @@
 #include "effects/juce_IIRFilter.cpp"
 #include "effects/juce_LagrangeInterpolator.cpp"
 #include "effects/juce_CatmullRomInterpolator.cpp"
+#include "effects/juce_PolyphaseResampler.cpp"
 #include "midi/juce_MidiBuffer.cpp"
 #include "midi/juce_MidiFile.cpp"
 #include "midi/juce_MidiKeyboardState.cpp"
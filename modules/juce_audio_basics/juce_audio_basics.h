@@ -89,6 +89,7 @@
 #include "effects/juce_IIRFilter.h"
 #include "effects/juce_LagrangeInterpolator.h"
 #include "effects/juce_CatmullRomInterpolator.h"
+#include "effects/juce_PolyphaseResampler.h"
 #include "effects/juce_LinearSmoothedValue.h"
 #include "effects/juce_Reverb.h"
 #include "midi/juce_MidiMessage.h"
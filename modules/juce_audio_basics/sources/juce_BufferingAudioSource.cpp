@@ -65,8 +65,7 @@ void BufferingAudioSource::prepareToPlay (int samplesPerBlockExpected, double ne
         buffer.setSize (numberOfChannels, bufferSizeNeeded);
         buffer.clear();
 
-        bufferValidStart = 0;
-        bufferValidEnd = 0;
+        setValidRange (0, 0, true);
 
         backgroundThread.addTimeSliceClient (this);
 
@@ -96,14 +95,55 @@ void BufferingAudioSource::releaseResources()
 
 void BufferingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (bufferStartPosLock);
-
-    auto start = bufferValidStart.load();
-    auto end   = bufferValidEnd.load();
+    auto range = getValidRange();
     auto pos   = nextPlayPos.load();
 
-    auto validStart = (int) (jlimit (start, end, pos) - pos);
-    auto validEnd   = (int) (jlimit (start, end, pos + info.numSamples) - pos);
+    auto validStart = (int) (jlimit (range.start, range.end, pos) - pos);
+    auto validEnd   = (int) (jlimit (range.start, range.end, pos + info.numSamples) - pos);
+
+    if (validStart < validEnd)
+    {
+        for (int chan = jmin (numberOfChannels, info.buffer->getNumChannels()); --chan >= 0;)
+        {
+            jassert (buffer.getNumSamples() > 0);
+            auto startBufferIndex = (int) ((validStart + pos) % buffer.getNumSamples());
+            auto endBufferIndex   = (int) ((validEnd + pos)   % buffer.getNumSamples());
+
+            if (startBufferIndex < endBufferIndex)
+            {
+                info.buffer->copyFrom (chan, info.startSample + validStart,
+                                       buffer,
+                                       chan, startBufferIndex,
+                                       validEnd - validStart);
+            }
+            else
+            {
+                auto initialSize = buffer.getNumSamples() - startBufferIndex;
+
+                info.buffer->copyFrom (chan, info.startSample + validStart,
+                                       buffer,
+                                       chan, startBufferIndex,
+                                       initialSize);
+
+                info.buffer->copyFrom (chan, info.startSample + validStart + initialSize,
+                                       buffer,
+                                       chan, 0,
+                                       (validEnd - validStart) - initialSize);
+            }
+        }
+
+        // The background thread always publishes a new range before it overwrites anything
+        // that was in the old one, so checking it again shows whether any of the samples
+        // were changed while they were being copied. The fence stops the reads of the
+        // samples being moved after the reads of the range.
+        std::atomic_thread_fence (std::memory_order_acquire);
+        auto rangeAfterCopy = getValidRange();
+
+        if (rangeAfterCopy.generation != range.generation)
+            validStart = validEnd;
+        else
+            validStart = (int) (jlimit (pos + validStart, pos + validEnd, rangeAfterCopy.start) - pos);
+    }
 
     if (validStart == validEnd)
     {
@@ -119,39 +159,22 @@ void BufferingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info
             info.buffer->clear (info.startSample + validEnd,
                                 info.numSamples - validEnd);    // partial cache miss at end
 
-        if (validStart < validEnd)
-        {
-            for (int chan = jmin (numberOfChannels, info.buffer->getNumChannels()); --chan >= 0;)
-            {
-                jassert (buffer.getNumSamples() > 0);
-                auto startBufferIndex = (int) ((validStart + nextPlayPos) % buffer.getNumSamples());
-                auto endBufferIndex   = (int) ((validEnd + nextPlayPos)   % buffer.getNumSamples());
-
-                if (startBufferIndex < endBufferIndex)
-                {
-                    info.buffer->copyFrom (chan, info.startSample + validStart,
-                                           buffer,
-                                           chan, startBufferIndex,
-                                           validEnd - validStart);
-                }
-                else
-                {
-                    auto initialSize = buffer.getNumSamples() - startBufferIndex;
+        // (if this fails, the position has been changed by another thread, which takes priority)
+        nextPlayPos.compare_exchange_strong (pos, pos + info.numSamples);
+    }
 
-                    info.buffer->copyFrom (chan, info.startSample + validStart,
-                                           buffer,
-                                           chan, startBufferIndex,
-                                           initialSize);
+    if (isPrepared)
+    {
+        auto neededStart = jmax ((int64) 0, pos);
+        auto neededEnd = source->isLooping() ? pos + info.numSamples
+                                             : jmin (pos + info.numSamples, source->getTotalLength());
+        auto numMissed = (neededEnd - neededStart) - (validEnd - validStart);
 
-                    info.buffer->copyFrom (chan, info.startSample + validStart + initialSize,
-                                           buffer,
-                                           chan, 0,
-                                           (validEnd - validStart) - initialSize);
-                }
-            }
+        if (numMissed > 0)
+        {
+            ++numUnderruns;
+            numSamplesMissed += numMissed;
         }
-
-        nextPlayPos += info.numSamples;
     }
 }
 
@@ -175,14 +198,11 @@ bool BufferingAudioSource::waitForNextAudioBlockReady (const AudioSourceChannelI
     while (elapsed <= timeout)
     {
         {
-            const ScopedLock sl (bufferStartPosLock);
-
-            auto start = bufferValidStart.load();
-            auto end   = bufferValidEnd.load();
+            auto range = getValidRange();
             auto pos   = nextPlayPos.load();
 
-            auto validStart = static_cast<int> (jlimit (start, end, pos) - pos);
-            auto validEnd   = static_cast<int> (jlimit (start, end, pos + info.numSamples) - pos);
+            auto validStart = static_cast<int> (jlimit (range.start, range.end, pos) - pos);
+            auto validEnd   = static_cast<int> (jlimit (range.start, range.end, pos + info.numSamples) - pos);
 
             if (validStart <= 0 && validStart < validEnd && validEnd >= info.numSamples)
                 return true;
@@ -211,59 +231,109 @@ int64 BufferingAudioSource::getNextReadPosition() const
 
 void BufferingAudioSource::setNextReadPosition (int64 newPosition)
 {
-    const ScopedLock sl (bufferStartPosLock);
-
     nextPlayPos = newPosition;
     backgroundThread.moveToFrontOfQueue (this);
 }
 
-bool BufferingAudioSource::readNextBufferChunk()
+int64 BufferingAudioSource::getNumSamplesBuffered() const noexcept
 {
-    int64 newBVS, newBVE, sectionToReadStart, sectionToReadEnd;
+    auto range = getValidRange();
+    auto pos = nextPlayPos.load();
 
+    return (pos >= range.start && pos < range.end) ? range.end - pos : 0;
+}
+
+void BufferingAudioSource::resetUnderrunCounters() noexcept
+{
+    numUnderruns = 0;
+    numSamplesMissed = 0;
+}
+
+//==============================================================================
+BufferingAudioSource::ValidRange BufferingAudioSource::getValidRange() const noexcept
+{
+    // The background thread only holds the version at an odd number for a few
+    // instructions, but if it gets pre-empted while doing that, this gives up
+    // rather than keeping the audio thread waiting
+    for (int attempts = 8; --attempts >= 0;)
     {
-        const ScopedLock sl (bufferStartPosLock);
+        auto version = validRangeVersion.load();
 
-        if (wasSourceLooping != isLooping())
+        if ((version & 1) == 0)
         {
-            wasSourceLooping = isLooping();
-            bufferValidStart = 0;
-            bufferValidEnd = 0;
+            ValidRange range { bufferGeneration.load(), bufferValidStart.load(), bufferValidEnd.load() };
+
+            if (validRangeVersion.load() == version)
+                return range;
         }
+    }
 
-        newBVS = jmax ((int64) 0, nextPlayPos.load());
-        newBVE = newBVS + buffer.getNumSamples() - 4;
-        sectionToReadStart = 0;
-        sectionToReadEnd = 0;
+    return { -1, 0, 0 };
+}
 
-        const int maxChunkSize = 2048;
+void BufferingAudioSource::setValidRange (int64 start, int64 end, bool discardExistingData) noexcept
+{
+    ++validRangeVersion;
 
-        if (newBVS < bufferValidStart || newBVS >= bufferValidEnd)
-        {
-            newBVE = jmin (newBVE, newBVS + maxChunkSize);
+    if (discardExistingData)
+        ++bufferGeneration;
 
-            sectionToReadStart = newBVS;
-            sectionToReadEnd = newBVE;
+    bufferValidStart = start;
+    bufferValidEnd = end;
 
-            bufferValidStart = 0;
-            bufferValidEnd = 0;
-        }
-        else if (std::abs ((int) (newBVS - bufferValidStart)) > 512
-                  || std::abs ((int) (newBVE - bufferValidEnd)) > 512)
-        {
-            newBVE = jmin (newBVE, bufferValidEnd + maxChunkSize);
+    ++validRangeVersion;
+}
+
+bool BufferingAudioSource::readNextBufferChunk()
+{
+    int64 newBVS, newBVE, sectionToReadStart, sectionToReadEnd;
 
-            sectionToReadStart = bufferValidEnd;
-            sectionToReadEnd = newBVE;
+    // (this is the only thread that changes the valid range, so it can read it directly)
+    auto validStart = bufferValidStart.load();
+    auto validEnd = bufferValidEnd.load();
 
-            bufferValidStart = newBVS;
-            bufferValidEnd = jmin (bufferValidEnd.load(), newBVE);
-        }
+    if (wasSourceLooping != isLooping())
+    {
+        wasSourceLooping = isLooping();
+        setValidRange (0, 0, true);
+        validStart = validEnd = 0;
+    }
+
+    newBVS = jmax ((int64) 0, nextPlayPos.load());
+    newBVE = newBVS + buffer.getNumSamples() - 4;
+    sectionToReadStart = 0;
+    sectionToReadEnd = 0;
+
+    const int maxChunkSize = 2048;
+
+    if (newBVS < validStart || newBVS >= validEnd)
+    {
+        newBVE = jmin (newBVE, newBVS + maxChunkSize);
+
+        sectionToReadStart = newBVS;
+        sectionToReadEnd = newBVE;
+
+        setValidRange (0, 0, true);
+    }
+    else if (std::abs ((int) (newBVS - validStart)) > 512
+              || std::abs ((int) (newBVE - validEnd)) > 512)
+    {
+        newBVE = jmin (newBVE, validEnd + maxChunkSize);
+
+        sectionToReadStart = validEnd;
+        sectionToReadEnd = newBVE;
+
+        // the samples before newBVS are about to be overwritten
+        setValidRange (newBVS, jmin (validEnd, newBVE), false);
     }
 
     if (sectionToReadStart == sectionToReadEnd)
         return false;
 
+    // makes sure that the audio thread can see the range that was just published before
+    // it can see any of the samples that are about to be overwritten
+    std::atomic_thread_fence (std::memory_order_release);
+
     jassert (buffer.getNumSamples() > 0);
     auto bufferIndexStart = (int) (sectionToReadStart % buffer.getNumSamples());
     auto bufferIndexEnd   = (int) (sectionToReadEnd   % buffer.getNumSamples());
@@ -287,12 +357,7 @@ bool BufferingAudioSource::readNextBufferChunk()
                            0);
     }
 
-    {
-        const ScopedLock sl2 (bufferStartPosLock);
-
-        bufferValidStart = newBVS;
-        bufferValidEnd = newBVE;
-    }
+    setValidRange (newBVS, newBVE, false);
 
     bufferReadyEvent.signal();
     return true;
@@ -309,7 +374,172 @@ void BufferingAudioSource::readBufferSection (int64 start, int length, int buffe
 
 int BufferingAudioSource::useTimeSlice()
 {
-    return readNextBufferChunk() ? 1 : 100;
+    auto didRead = readNextBufferChunk();
+
+    // Asks to be called again when the buffer will have drained to half-full. As the
+    // thread always calls the client that's due soonest, this means that when there
+    // are lots of sources, the ones that are closest to running out get read first.
+    auto numSamplesAboveHalfFull = getNumSamplesBuffered() - buffer.getNumSamples() / 2;
+
+    if (numSamplesAboveHalfFull <= 0 || sampleRate <= 0)
+        return didRead ? 0 : 100;
+
+    return jlimit (1, 100, (int) (numSamplesAboveHalfFull * 1000 / (int64) sampleRate));
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class BufferingAudioSourceTests  : public UnitTest
+{
+public:
+    BufferingAudioSourceTests() : UnitTest ("BufferingAudioSource", "Audio") {}
+
+    // Each sample holds its position plus one, so that a sample that was copied from the
+    // wrong part of the buffer can be spotted, and silence can't be mistaken for data
+    struct RampSource  : public PositionableAudioSource
+    {
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            for (int ch = 0; ch < info.buffer->getNumChannels(); ++ch)
+                for (int i = 0; i < info.numSamples; ++i)
+                    info.buffer->setSample (ch, info.startSample + i, (float) (position + i + 1));
+
+            position += info.numSamples;
+        }
+
+        void setNextReadPosition (int64 newPosition) override   { position = newPosition; }
+        int64 getNextReadPosition() const override              { return position; }
+        int64 getTotalLength() const override                   { return 1 << 22; }
+        bool isLooping() const override                         { return false; }
+
+        int64 position = 0;
+    };
+
+    // Keeps moving the read position while the test thread is reading blocks
+    struct SeekThread  : public Thread
+    {
+        SeekThread (BufferingAudioSource& s, Random r)
+            : Thread ("BufferingAudioSource seek test"), source (s), random (r)
+        {
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                source.setNextReadPosition (random.nextInt (1 << 21));
+                Thread::sleep (random.nextInt (3));
+            }
+        }
+
+        BufferingAudioSource& source;
+        Random random;
+    };
+
+    // Returns the position that the block was read from, or -1 if it held nothing but
+    // silence, or -2 if the samples that it did hold didn't come from one place
+    static int64 getPositionOfBlock (const AudioBuffer<float>& block)
+    {
+        int64 position = -1;
+
+        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            for (int i = 0; i < block.getNumSamples(); ++i)
+            {
+                auto value = block.getSample (ch, i);
+
+                if (value == 0.0f)
+                    continue;
+
+                auto samplePosition = (int64) value - 1 - i;
+
+                if (position < 0)
+                    position = samplePosition;
+                else if (samplePosition != position)
+                    return -2;
+            }
+        }
+
+        return position;
+    }
+
+    void runTest() override
+    {
+        TimeSliceThread thread ("BufferingAudioSource test");
+        thread.startThread();
+
+        BufferingAudioSource source (new RampSource(), thread, true, 8192, 2);
+        source.prepareToPlay (512, 44100.0);
+
+        AudioBuffer<float> block (2, 512);
+        AudioSourceChannelInfo info (block);
+
+        beginTest ("Blocks are complete and in order when the buffer keeps up");
+        {
+            source.resetUnderrunCounters();
+
+            for (int i = 0; i < 200; ++i)
+            {
+                expect (source.waitForNextAudioBlockReady (info, 1000));
+                source.getNextAudioBlock (info);
+
+                if (getPositionOfBlock (block) != i * (int64) block.getNumSamples())
+                {
+                    expect (false, "block " + String (i));
+                    break;
+                }
+            }
+
+            expectEquals (source.getNumUnderruns(), 0);
+            expectEquals (source.getNumSamplesMissed(), (int64) 0);
+        }
+
+        beginTest ("Blocks never mix up data from different positions");
+        {
+            // big blocks make it more likely that the background thread will overwrite
+            // some of the samples while they're being copied
+            AudioBuffer<float> bigBlock (2, 4096);
+            AudioSourceChannelInfo bigInfo (bigBlock);
+
+            SeekThread seeker (source, getRandom());
+            seeker.startThread();
+
+            int numBlocksWithData = 0;
+
+            for (int i = 0; i < 5000; ++i)
+            {
+                source.getNextAudioBlock (bigInfo);
+                auto position = getPositionOfBlock (bigBlock);
+
+                if (position == -2)
+                {
+                    expect (false, "block " + String (i));
+                    break;
+                }
+
+                if (position >= 0)
+                    ++numBlocksWithData;
+
+                if (i % 4 == 0)
+                    Thread::yield();
+            }
+
+            seeker.stopThread (1000);
+
+            expect (numBlocksWithData > 0);
+            expect (source.getNumUnderruns() > 0);
+        }
+
+        source.releaseResources();
+    }
+};
+
+static BufferingAudioSourceTests bufferingAudioSourceTests;
+
+#endif
+
 } // namespace juce
@@ -31,6 +31,15 @@ namespace juce
     a background thread to smooth out playback. You can either create one of these
     directly, or use it indirectly using an AudioTransportSource.
 
+    The audio thread never has to wait for the background thread: getNextAudioBlock()
+    doesn't take any locks or allocate any memory, and if the data it needs hasn't
+    been read yet, it outputs silence and counts an underrun instead.
+
+    When a lot of these share a TimeSliceThread, each one asks to be serviced again
+    at the time when its buffer will have drained to half-full, so the thread always
+    reads for the source that will run out soonest. If one thread can't keep up, you
+    can give it more with TimeSliceThread::setNumThreads().
+
     @see PositionableAudioSource, AudioTransportSource
 
     @tags{Audio}
@@ -97,18 +106,51 @@ public:
     */
     bool waitForNextAudioBlockReady (const AudioSourceChannelInfo& info, const uint32 timeout);
 
+    //==============================================================================
+    /** Returns the number of samples ahead of the current play position that have
+        already been read into the buffer.
+    */
+    int64 getNumSamplesBuffered() const noexcept;
+
+    /** Returns the number of times that getNextAudioBlock() has been called when some
+        of the samples it needed hadn't been read from the source yet.
+    */
+    int getNumUnderruns() const noexcept                { return numUnderruns; }
+
+    /** Returns the total number of samples that have been replaced by silence because
+        they hadn't been read from the source in time.
+    */
+    int64 getNumSamplesMissed() const noexcept          { return numSamplesMissed; }
+
+    /** Resets the counters returned by getNumUnderruns() and getNumSamplesMissed(). */
+    void resetUnderrunCounters() noexcept;
+
 private:
     //==============================================================================
+    /*  The range of samples in the buffer that can be played. The background thread
+        publishes a new one whenever it changes with a sequence lock, so that the audio
+        thread can take a consistent copy without blocking. The generation changes
+        whenever the whole buffer is thrown away, e.g. after a jump in position.
+    */
+    struct ValidRange
+    {
+        int64 generation, start, end;
+    };
+
     OptionalScopedPointer<PositionableAudioSource> source;
     TimeSliceThread& backgroundThread;
     int numberOfSamplesToBuffer, numberOfChannels;
     AudioBuffer<float> buffer;
-    CriticalSection bufferStartPosLock;
     WaitableEvent bufferReadyEvent;
-    std::atomic<int64> bufferValidStart { 0 }, bufferValidEnd { 0 }, nextPlayPos { 0 };
+    std::atomic<uint32> validRangeVersion { 0 };
+    std::atomic<int64> bufferGeneration { 0 }, bufferValidStart { 0 }, bufferValidEnd { 0 }, nextPlayPos { 0 };
+    std::atomic<int> numUnderruns { 0 };
+    std::atomic<int64> numSamplesMissed { 0 };
     double sampleRate = 0;
     bool wasSourceLooping = false, isPrepared = false, prefillBuffer;
 
+    ValidRange getValidRange() const noexcept;
+    void setValidRange (int64 start, int64 end, bool discardExistingData) noexcept;
     bool readNextBufferChunk();
     void readBufferSection (int64 start, int length, int bufferOffset);
     int useTimeSlice() override;
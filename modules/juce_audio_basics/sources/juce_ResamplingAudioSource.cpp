@@ -44,8 +44,28 @@ void ResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputS
 {
     jassert (samplesInPerOutputSample > 0);
 
-    const SpinLock::ScopedLockType sl (ratioLock);
-    ratio = jmax (0.0, samplesInPerOutputSample);
+    {
+        const SpinLock::ScopedLockType sl (ratioLock);
+        ratio = jmax (0.0, samplesInPerOutputSample);
+    }
+
+    // The audio thread never builds filters, so get them ready for the new ratio here.
+    // Without any polyphase resamplers there's nothing to do, and callers that set the
+    // ratio on the audio thread mustn't have to wait for the lock.
+    if (polyphaseResamplers.isEmpty())
+        return;
+
+    const ScopedLock sl (polyphaseLock);
+
+    for (auto* r : polyphaseResamplers)
+        r->prepareForSpeedRatio (samplesInPerOutputSample);
+}
+
+void ResamplingAudioSource::setUsePolyphaseResampler (bool shouldUsePolyphaseResampler,
+                                                      PolyphaseResampler::Quality quality)
+{
+    usePolyphaseResampler = shouldUsePolyphaseResampler;
+    polyphaseQuality = quality;
 }
 
 void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
@@ -62,6 +82,15 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
     destBuffers.calloc (numChannels);
     createLowPass (ratio);
 
+    {
+        const ScopedLock psl (polyphaseLock);
+        polyphaseResamplers.clear();
+
+        if (usePolyphaseResampler)
+            for (int i = 0; i < numChannels; ++i)
+                polyphaseResamplers.add (new PolyphaseResampler (polyphaseQuality, ratio));
+    }
+
     flushBuffers();
 }
 
@@ -72,6 +101,9 @@ void ResamplingAudioSource::flushBuffers()
     sampsInBuffer = 0;
     subSampleOffset = 0.0;
     resetFilters();
+
+    for (auto* r : polyphaseResamplers)
+        r->reset();
 }
 
 void ResamplingAudioSource::releaseResources()
@@ -89,6 +121,12 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
         localRatio = ratio;
     }
 
+    if (! polyphaseResamplers.isEmpty())
+    {
+        getNextPolyphaseBlock (info, localRatio);
+        return;
+    }
+
     if (lastRatio != localRatio)
     {
         createLowPass (localRatio);
@@ -196,6 +234,48 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
     jassert (sampsInBuffer >= 0);
 }
 
+void ResamplingAudioSource::getNextPolyphaseBlock (const AudioSourceChannelInfo& info, double localRatio)
+{
+    // The resamplers tell us exactly how much input they'll use, so the input can be
+    // read straight into the start of the buffer each time, with nothing left over.
+    // The buffer was sized in prepareToPlay(), so if a block needs more input than it
+    // can hold, the block gets done in several pieces rather than resizing it here.
+    auto& firstResampler = *polyphaseResamplers.getUnchecked (0);
+    auto bufferSize = buffer.getNumSamples();
+    auto channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+
+    for (int done = 0; done < info.numSamples;)
+    {
+        auto numOut = jlimit (1, info.numSamples - done, (int) ((bufferSize - 1) / localRatio));
+        auto numNeeded = firstResampler.getNumInputSamplesNeeded (localRatio, numOut);
+
+        while (numNeeded > bufferSize && numOut > 1)
+            numNeeded = firstResampler.getNumInputSamplesNeeded (localRatio, --numOut);
+
+        // the ratio is too high for the buffer that was allocated in prepareToPlay()
+        jassert (numNeeded <= bufferSize);
+
+        if (numNeeded > bufferSize)
+        {
+            info.buffer->clear (info.startSample + done, info.numSamples - done);
+            return;
+        }
+
+        if (numNeeded > 0)
+        {
+            AudioSourceChannelInfo readInfo (&buffer, 0, numNeeded);
+            input->getNextAudioBlock (readInfo);
+        }
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+            polyphaseResamplers.getUnchecked (channel)->process (localRatio, buffer.getReadPointer (channel),
+                                                                 info.buffer->getWritePointer (channel, info.startSample + done),
+                                                                 numOut);
+
+        done += numOut;
+    }
+}
+
 void ResamplingAudioSource::createLowPass (const double frequencyRatio)
 {
     const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
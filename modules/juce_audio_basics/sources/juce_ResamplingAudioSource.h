@@ -68,6 +68,21 @@ public:
     /** Clears any buffers and filters that the resampler is using. */
     void flushBuffers();
 
+    /** Switches between the default linear interpolation with an IIR anti-aliasing
+        filter, and a windowed-sinc PolyphaseResampler of the given quality.
+
+        The polyphase resampler is far more accurate, but it delays the signal by
+        PolyphaseResampler::getLatencyInSamples() input samples. The resamplers are
+        created in prepareToPlay(), so call this before that. If you'll be downsampling,
+        set the resampling ratio before calling prepareToPlay() too, so that the filters
+        can be made long enough for it.
+
+        When the polyphase resampler is in use, setResamplingRatio() builds any new
+        filters that the ratio needs, so it's best not to call it on the audio thread.
+    */
+    void setUsePolyphaseResampler (bool shouldUsePolyphaseResampler,
+                                   PolyphaseResampler::Quality quality = PolyphaseResampler::Quality::high);
+
     //==============================================================================
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
     void releaseResources() override;
@@ -86,6 +101,13 @@ private:
     HeapBlock<float*> destBuffers;
     HeapBlock<const float*> srcBuffers;
 
+    bool usePolyphaseResampler = false;
+    PolyphaseResampler::Quality polyphaseQuality = PolyphaseResampler::Quality::high;
+    OwnedArray<PolyphaseResampler> polyphaseResamplers;
+    CriticalSection polyphaseLock;
+
+    void getNextPolyphaseBlock (const AudioSourceChannelInfo&, double localRatio);
+
     void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
     void createLowPass (double proportionalRate);
 
@@ -73,7 +73,408 @@ void SynthesiserVoice::renderNextBlock (AudioBuffer<double>& outputBuffer,
 }
 
 //==============================================================================
-Synthesiser::Synthesiser()
+struct Synthesiser::PendingChange
+{
+    void clear()
+    {
+        voice.reset();
+        sound = nullptr;
+        voices.clear();
+        sounds.clear();
+        newVoices.clear();
+        newVoicesWhenOrdered.clear();
+        newVoicesInStartOrder.clear();
+        newSounds.clear();
+    }
+
+    ChangeType type = ChangeType::addVoice;
+    int index = 0;
+    double voiceSampleRate = 0;
+
+    // Before the change is made these hold anything that's being added, and afterwards
+    // they hold whatever got removed, so that it can be deleted off the audio thread.
+    std::unique_ptr<SynthesiserVoice> voice;
+    SynthesiserSound::Ptr sound;
+    OwnedArray<SynthesiserVoice> voices;
+    ReferenceCountedArray<SynthesiserSound> sounds;
+
+    // Storage for the arrays as they'll be after a voice or sound is added or removed. It's
+    // allocated by the posting thread, and gets swapped with the synth's own arrays, so that
+    // the thread that applies the change never allocates or frees anything. Afterwards it
+    // holds the old storage, which gets freed along with the change.
+    OwnedArray<SynthesiserVoice> newVoices;
+    Array<SynthesiserVoice*> newVoicesWhenOrdered, newVoicesInStartOrder;
+    ReferenceCountedArray<SynthesiserSound> newSounds;
+
+    std::atomic<PendingChange*> next { nullptr };
+};
+
+/*  A queue of changes that are posted by any number of threads (one at a time, using
+    postingLock) and applied by whichever thread owns the voices and sounds. The queue
+    always keeps the last change that was applied at its head, so the applying thread
+    only ever has to follow the links from there.
+*/
+struct Synthesiser::PendingChanges
+{
+    PendingChanges()  : oldest (new PendingChange()), newest (oldest), lastApplied (oldest) {}
+
+    ~PendingChanges()
+    {
+        while (oldest != nullptr)
+        {
+            auto* change = oldest;
+            oldest = change->next;
+            delete change;
+        }
+    }
+
+    // must be called with postingLock held
+    void post (PendingChange* change) noexcept
+    {
+        newest->next = change;
+        newest = change;
+    }
+
+    // Deletes the changes that have been applied, along with anything they removed.
+    // Must be called with postingLock held.
+    void deleteAppliedChanges()
+    {
+        auto* applied = lastApplied.load();
+
+        while (oldest != applied)
+        {
+            auto* change = oldest;
+            oldest = change->next;
+            delete change;
+        }
+
+        // the applying thread only reads the link of this one from now on
+        applied->clear();
+    }
+
+    // must be called with postingLock held
+    bool isUpToDate() const noexcept    { return lastApplied.load() == newest; }
+
+    // Keeps track of how many voices and sounds there will be once everything that has been
+    // posted is applied, and allocates the storage that the change will need for them.
+    // Must be called with postingLock held.
+    void updatePostedState (PendingChange& change)
+    {
+        switch (change.type)
+        {
+            case ChangeType::addVoice:
+                if (change.voice != nullptr)
+                    reserveVoices (change, ++numPostedVoices);
+                break;
+
+            case ChangeType::removeVoice:
+                if (isPositiveAndBelow (change.index, numPostedVoices))
+                    reserveVoices (change, --numPostedVoices);
+                break;
+
+            case ChangeType::addSound:
+                change.newSounds.ensureStorageAllocated (++numPostedSounds);
+                break;
+
+            case ChangeType::removeSound:
+                if (isPositiveAndBelow (change.index, numPostedSounds))
+                    change.newSounds.ensureStorageAllocated (--numPostedSounds);
+                break;
+
+            case ChangeType::clearVoices:   numPostedVoices = 0; break;
+            case ChangeType::clearSounds:   numPostedSounds = 0; break;
+            default:                        jassertfalse; break;
+        }
+    }
+
+    static void reserveVoices (PendingChange& change, int numVoices)
+    {
+        change.newVoices.ensureStorageAllocated (numVoices);
+        change.newVoicesWhenOrdered.ensureStorageAllocated (numVoices);
+        change.newVoicesInStartOrder.ensureStorageAllocated (numVoices);
+    }
+
+    PendingChange* oldest;
+    PendingChange* newest;
+    std::atomic<PendingChange*> lastApplied;
+
+    int numPostedVoices = 0, numPostedSounds = 0;
+
+    CriticalSection postingLock;
+    SharedResourcePointer<RetiredObjectCollector> collector;
+
+    JUCE_DECLARE_NON_COPYABLE (PendingChanges)
+};
+
+//==============================================================================
+/*  Deletes the voices and sounds that are removed while a block is being rendered, as soon
+    as the audio thread has applied the change, so that they never get deleted on the audio
+    thread and don't have to wait for the next change to be made.
+*/
+struct Synthesiser::RetiredObjectCollector  : private Thread
+{
+    RetiredObjectCollector()  : Thread ("Synthesiser collector") {}
+
+    ~RetiredObjectCollector()
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread (-1);
+    }
+
+    // must not be called with the queue's postingLock held
+    void collectFrom (PendingChanges& changes)
+    {
+        const ScopedLock sl (listLock);
+        queues.addIfNotAlreadyThere (&changes);
+        startThread();
+        notify();
+    }
+
+    void forget (PendingChanges& changes)
+    {
+        const ScopedLock sl (listLock);
+        queues.removeFirstMatchingValue (&changes);
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            bool isWaitingForChanges;
+
+            {
+                const ScopedLock sl (listLock);
+
+                for (int i = queues.size(); --i >= 0;)
+                {
+                    auto& changes = *queues.getUnchecked (i);
+                    const ScopedLock pl (changes.postingLock);
+                    changes.deleteAppliedChanges();
+
+                    if (changes.isUpToDate())
+                        queues.remove (i);
+                }
+
+                isWaitingForChanges = ! queues.isEmpty();
+            }
+
+            wait (isWaitingForChanges ? 5 : -1);
+        }
+    }
+
+    CriticalSection listLock;
+    Array<PendingChanges*> queues;
+
+    JUCE_DECLARE_NON_COPYABLE (RetiredObjectCollector)
+};
+
+//==============================================================================
+/*  Held by the synth's own methods while they use the voices and sounds. It takes the
+    lock, unless the synth is rendering without locking, and counts how deeply these
+    methods are nested, so that the arrays are never changed while they're being iterated.
+*/
+struct Synthesiser::ScopedRenderLock
+{
+    explicit ScopedRenderLock (const Synthesiser& s) noexcept
+        : synth (s), isLocked (! s.lockFreeRendering.load())
+    {
+        if (isLocked)
+            synth.lock.enter();
+
+        ++synth.busyDepth;
+    }
+
+    ~ScopedRenderLock()
+    {
+        --synth.busyDepth;
+
+        if (isLocked)
+            synth.lock.exit();
+    }
+
+    const Synthesiser& synth;
+    const bool isLocked;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedRenderLock)
+};
+
+//==============================================================================
+struct Synthesiser::RenderThreads
+{
+    RenderThreads (int numThreads, int maxBlockSize, int maxNumChannels)
+        : maximumBlockSize (maxBlockSize), maximumNumChannels (maxNumChannels)
+    {
+        for (int i = 1; i < numThreads; ++i)
+            workers.add (new Worker (*this));
+
+        for (auto* w : workers)
+            w->startThread (Thread::realtimeAudioPriority);
+    }
+
+    int getNumThreads() const noexcept    { return workers.size() + 1; }
+
+    bool canRender (int numChannelsToRender, int numSamples) const noexcept
+    {
+        return numSamples <= maximumBlockSize && numChannelsToRender <= maximumNumChannels;
+    }
+
+    template <typename FloatType>
+    void render (const OwnedArray<SynthesiserVoice>& voicesToRender,
+                 AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+    {
+        voices = &voicesToRender;
+        numChannels = buffer.getNumChannels();
+        numSamplesToRender = numSamples;
+        isDouble = std::is_same<FloatType, double>::value;
+        nextVoice = 0;
+        numWorkersBusy = workers.size();
+        ++jobNumber;
+
+        // Only a worker that has gone to sleep needs waking, so while blocks keep coming
+        // in, this doesn't have to touch anything that might take a lock.
+        for (auto* w : workers)
+            if (w->isAsleep.exchange (false))
+                w->wakeEvent.signal();
+
+        // This thread takes voices from the same list as the workers, and renders
+        // its share directly into the output.
+        for (int i = nextVoice++; i < voices->size(); i = nextVoice++)
+            voices->getUnchecked (i)->renderNextBlock (buffer, startSample, numSamples);
+
+        while (numWorkersBusy.load() > 0)
+            Thread::yield();
+
+        for (auto* w : workers)
+        {
+            if (w->hasOutput)
+            {
+                auto& scratch = w->getScratch ((FloatType*) nullptr);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    buffer.addFrom (ch, startSample, scratch, ch, 0, numSamples);
+            }
+        }
+    }
+
+private:
+    struct Worker  : public Thread
+    {
+        Worker (RenderThreads& o)
+            : Thread ("Synthesiser renderer"), owner (o),
+              floatScratch  (o.maximumNumChannels, o.maximumBlockSize),
+              doubleScratch (o.maximumNumChannels, o.maximumBlockSize)
+        {
+        }
+
+        ~Worker()
+        {
+            signalThreadShouldExit();
+            wakeEvent.signal();
+            stopThread (-1);
+        }
+
+        AudioBuffer<float>&  getScratch (float*) noexcept    { return floatScratch; }
+        AudioBuffer<double>& getScratch (double*) noexcept   { return doubleScratch; }
+
+        void run() override
+        {
+            auto lastJob = owner.jobNumber.load();
+
+            while (waitForNextJob (lastJob))
+            {
+                if (owner.isDouble)
+                    renderShare (doubleScratch);
+                else
+                    renderShare (floatScratch);
+
+                --owner.numWorkersBusy;
+            }
+        }
+
+        // Polls for the next job while blocks are being rendered, and only goes to sleep
+        // on the event once there hasn't been one for a while.
+        bool waitForNextJob (uint32& lastJob)
+        {
+            auto idleStartTime = Time::getMillisecondCounter();
+
+            while (! threadShouldExit())
+            {
+                auto job = owner.jobNumber.load();
+
+                if (job != lastJob)
+                {
+                    lastJob = job;
+                    return true;
+                }
+
+                if (Time::getMillisecondCounter() - idleStartTime < maxPollingTimeMs)
+                {
+                    Thread::yield();
+                    continue;
+                }
+
+                // If render() starts a job after this flag is set, it'll see the flag and
+                // signal the event, so the wake-up can't get lost.
+                isAsleep = true;
+
+                if (owner.jobNumber.load() == lastJob && ! threadShouldExit())
+                    wakeEvent.wait();
+
+                isAsleep = false;
+                idleStartTime = Time::getMillisecondCounter();
+            }
+
+            return false;
+        }
+
+        static constexpr uint32 maxPollingTimeMs = 50;
+
+        template <typename FloatType>
+        void renderShare (AudioBuffer<FloatType>& scratch)
+        {
+            hasOutput = false;
+            auto& voices = *owner.voices;
+            auto numSamples = owner.numSamplesToRender;
+
+            // refers to the scratch space without allocating anything
+            AudioBuffer<FloatType> output (scratch.getArrayOfWritePointers(), owner.numChannels, numSamples);
+
+            for (int i = owner.nextVoice++; i < voices.size(); i = owner.nextVoice++)
+            {
+                if (! hasOutput)
+                {
+                    output.clear();
+                    hasOutput = true;
+                }
+
+                voices.getUnchecked (i)->renderNextBlock (output, 0, numSamples);
+            }
+        }
+
+        RenderThreads& owner;
+        std::atomic<bool> isAsleep { false };
+        WaitableEvent wakeEvent;
+        AudioBuffer<float> floatScratch;
+        AudioBuffer<double> doubleScratch;
+        bool hasOutput = false;
+    };
+
+    const int maximumBlockSize, maximumNumChannels;
+    OwnedArray<Worker> workers;
+
+    const OwnedArray<SynthesiserVoice>* voices = nullptr;
+    int numChannels = 0, numSamplesToRender = 0;
+    bool isDouble = false;
+    std::atomic<int> nextVoice { 0 }, numWorkersBusy { 0 };
+    std::atomic<uint32> jobNumber { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (RenderThreads)
+};
+
+//==============================================================================
+Synthesiser::Synthesiser()  : pendingChanges (new PendingChanges())
 {
     for (int i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
         lastPitchWheelValues[i] = 0x2000;
@@ -81,50 +482,248 @@ Synthesiser::Synthesiser()
 
 Synthesiser::~Synthesiser()
 {
+    renderThreads.reset();
+
+    // Anything that's still pending is deleted along with the queue, and the voices
+    // that it would have removed get deleted with the voices array.
+    pendingChanges->collector->forget (*pendingChanges);
+    pendingChanges.reset();
 }
 
 //==============================================================================
 SynthesiserVoice* Synthesiser::getVoice (const int index) const
 {
-    const ScopedLock sl (lock);
     return voices [index];
 }
 
 void Synthesiser::clearVoices()
 {
-    const ScopedLock sl (lock);
-    voices.clear();
+    postChange (ChangeType::clearVoices, nullptr, nullptr, 0);
 }
 
 SynthesiserVoice* Synthesiser::addVoice (SynthesiserVoice* const newVoice)
 {
-    const ScopedLock sl (lock);
-    newVoice->setCurrentPlaybackSampleRate (sampleRate);
-    return voices.add (newVoice);
+    postChange (ChangeType::addVoice, newVoice, nullptr, 0);
+    return newVoice;
 }
 
 void Synthesiser::removeVoice (const int index)
 {
-    const ScopedLock sl (lock);
-    voices.remove (index);
+    postChange (ChangeType::removeVoice, nullptr, nullptr, index);
 }
 
 void Synthesiser::clearSounds()
 {
-    const ScopedLock sl (lock);
-    sounds.clear();
+    postChange (ChangeType::clearSounds, nullptr, nullptr, 0);
 }
 
 SynthesiserSound* Synthesiser::addSound (const SynthesiserSound::Ptr& newSound)
 {
-    const ScopedLock sl (lock);
-    return sounds.add (newSound);
+    postChange (ChangeType::addSound, nullptr, newSound.get(), 0);
+    return newSound.get();
 }
 
 void Synthesiser::removeSound (const int index)
 {
+    postChange (ChangeType::removeSound, nullptr, nullptr, index);
+}
+
+void Synthesiser::postChange (ChangeType type, SynthesiserVoice* voice, SynthesiserSound* sound, int index)
+{
+    auto& pending = *pendingChanges;
+
+    std::unique_ptr<PendingChange> change (new PendingChange());
+    change->type = type;
+    change->index = index;
+    change->voice.reset (voice);
+    change->sound = sound;
+
+    bool isWaitingForRenderer = false;
+
+    {
+        const ScopedLock sl (pending.postingLock);
+
+        if (voice != nullptr)
+        {
+            // the voice's own setup is done here rather than on the audio thread
+            change->voiceSampleRate = sampleRate;
+            voice->setCurrentPlaybackSampleRate (sampleRate);
+        }
+
+        pending.updatePostedState (*change);
+        pending.post (change.release());
+
+        // If nothing is being rendered, the change can be made straight away. While rendering
+        // without locking, the audio thread owns the arrays, so it always makes the changes.
+        if (! lockFreeRendering.load() && lock.tryEnter())
+        {
+            if (busyDepth == 0)
+            {
+                applyPendingChanges();
+
+                // picks up any changes that a subclass has made to the arrays directly
+                pending.numPostedVoices = voices.size();
+                pending.numPostedSounds = sounds.size();
+            }
+
+            lock.exit();
+        }
+
+        pending.deleteAppliedChanges();
+        isWaitingForRenderer = ! pending.isUpToDate();
+    }
+
+    if (isWaitingForRenderer)
+        pending.collector->collectFrom (pending);
+}
+
+void Synthesiser::applyPendingChanges()
+{
+    auto& pending = *pendingChanges;
+
+    for (auto* change = pending.lastApplied.load()->next.load(); change != nullptr; change = change->next.load())
+    {
+        applyChange (*change);
+        pending.lastApplied = change;
+    }
+}
+
+void Synthesiser::applyChange (PendingChange& change)
+{
+    // Adding or removing a voice or sound builds the new arrays in the storage that came
+    // with the change, and swaps them in, so that nothing gets allocated or freed here.
+    switch (change.type)
+    {
+        case ChangeType::addVoice:
+            if (auto* voice = change.voice.release())
+            {
+                if (change.voiceSampleRate != sampleRate)
+                    voice->setCurrentPlaybackSampleRate (sampleRate);
+
+                updateStartOrder();
+
+                change.newVoices.addArray (voices);
+                change.newVoices.add (voice);
+                change.newVoicesWhenOrdered.addArray (change.newVoices);
+                change.newVoicesInStartOrder.addArray (voicesInStartOrder);
+
+                voices.swapWith (change.newVoices);
+                voicesWhenOrdered.swapWith (change.newVoicesWhenOrdered);
+                voicesInStartOrder.swapWith (change.newVoicesInStartOrder);
+                change.newVoices.clearQuick (false);
+
+                voicesInStartOrder.insert (getStartOrderPosition (*voice), voice);
+            }
+            break;
+
+        case ChangeType::removeVoice:
+            if (auto* voice = voices [change.index])
+            {
+                updateStartOrder();
+
+                for (auto* v : voices)
+                    if (v != voice)
+                        change.newVoices.add (v);
+
+                for (auto* v : voicesInStartOrder)
+                    if (v != voice)
+                        change.newVoicesInStartOrder.add (v);
+
+                change.newVoicesWhenOrdered.addArray (change.newVoices);
+
+                voices.swapWith (change.newVoices);
+                voicesWhenOrdered.swapWith (change.newVoicesWhenOrdered);
+                voicesInStartOrder.swapWith (change.newVoicesInStartOrder);
+                change.newVoices.clearQuick (false);
+                change.voice.reset (voice);
+            }
+            break;
+
+        case ChangeType::clearVoices:
+            voices.swapWith (change.voices);
+            voicesWhenOrdered.clearQuick();
+            voicesInStartOrder.clearQuick();
+            break;
+
+        case ChangeType::addSound:
+            change.newSounds.addArray (sounds);
+            change.newSounds.add (change.sound);
+            sounds.swapWith (change.newSounds);
+            break;
+
+        case ChangeType::removeSound:
+            if (isPositiveAndBelow (change.index, sounds.size()))
+            {
+                for (int i = 0; i < sounds.size(); ++i)
+                    if (i != change.index)
+                        change.newSounds.add (sounds.getObjectPointerUnchecked (i));
+
+                // the old array keeps the removed sound alive until the change is deleted
+                sounds.swapWith (change.newSounds);
+            }
+            break;
+
+        case ChangeType::clearSounds:
+            sounds.swapWith (change.sounds);
+            break;
+
+        default:
+            jassertfalse;
+            break;
+    }
+}
+
+//==============================================================================
+void Synthesiser::updateStartOrder() const
+{
+    // A subclass may have changed the voices array directly, in which case the order needs
+    // rebuilding. Comparing the pointers catches that without touching any of the voices,
+    // as some of them might have been deleted.
+    if (voicesWhenOrdered.size() == voices.size()
+         && std::equal (voices.begin(), voices.end(), voicesWhenOrdered.begin()))
+        return;
+
+    voicesWhenOrdered.clearQuick();
+    voicesWhenOrdered.addArray (voices.begin(), voices.size());
+
+    voicesInStartOrder.clearQuick();
+
+    for (auto* voice : voices)
+        voicesInStartOrder.insert (getStartOrderPosition (*voice), voice);
+}
+
+int Synthesiser::getStartOrderPosition (const SynthesiserVoice& voice) const noexcept
+{
+    // after any voices that were started at the same time, so that the ones that have
+    // never been started stay in the order they were added
+    auto position = voicesInStartOrder.size();
+
+    while (position > 0 && voice.wasStartedBefore (*voicesInStartOrder.getUnchecked (position - 1)))
+        --position;
+
+    return position;
+}
+
+void Synthesiser::setLockFreeRenderingEnabled (bool shouldRenderWithoutLocking)
+{
+    auto& pending = *pendingChanges;
+
     const ScopedLock sl (lock);
-    sounds.remove (index);
+    applyPendingChanges();
+
+    const ScopedLock pl (pending.postingLock);
+    pending.deleteAppliedChanges();
+
+    // picks up any changes that a subclass has made to the arrays directly
+    pending.numPostedVoices = voices.size();
+    pending.numPostedSounds = sounds.size();
+
+    lockFreeRendering = shouldRenderWithoutLocking;
+}
+
+bool Synthesiser::isLockFreeRenderingEnabled() const noexcept
+{
+    return lockFreeRendering.load();
 }
 
 void Synthesiser::setNoteStealingEnabled (const bool shouldSteal)
@@ -139,12 +738,32 @@ void Synthesiser::setMinimumRenderingSubdivisionSize (int numSamples, bool shoul
     subBlockSubdivisionIsStrict = shouldBeStrict;
 }
 
+void Synthesiser::setNumRenderingThreads (int numThreads, int maximumBlockSize, int maximumNumChannels)
+{
+    std::unique_ptr<RenderThreads> newThreads;
+
+    if (numThreads > 1)
+        newThreads.reset (new RenderThreads (numThreads, maximumBlockSize, maximumNumChannels));
+
+    {
+        const ScopedLock sl (lock);
+        std::swap (renderThreads, newThreads);
+    }
+}
+
+int Synthesiser::getNumRenderingThreads() const noexcept
+{
+    const ScopedLock sl (lock);
+    return renderThreads != nullptr ? renderThreads->getNumThreads() : 1;
+}
+
 //==============================================================================
 void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
 {
     if (sampleRate != newRate)
     {
         const ScopedLock sl (lock);
+        applyPendingChanges();
         allNotesOff (0, false);
         sampleRate = newRate;
 
@@ -170,7 +789,8 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
     int midiEventPos;
     MidiMessage m;
 
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
+    applyPendingChanges();
 
     while (numSamples > 0)
     {
@@ -179,7 +799,7 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
             if (targetChannels > 0)
                 renderVoices (outputAudio, startSample, numSamples);
 
-            return;
+            break;
         }
 
         const int samplesToNextMidiMessage = midiEventPos - startSample;
@@ -219,12 +839,24 @@ template void Synthesiser::processNextBlock<double> (AudioBuffer<double>&, const
 
 void Synthesiser::renderVoices (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (renderThreads != nullptr && renderThreads->canRender (buffer.getNumChannels(), numSamples))
+    {
+        renderThreads->render (voices, buffer, startSample, numSamples);
+        return;
+    }
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
 
 void Synthesiser::renderVoices (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (renderThreads != nullptr && renderThreads->canRender (buffer.getNumChannels(), numSamples))
+    {
+        renderThreads->render (voices, buffer, startSample, numSamples);
+        return;
+    }
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
@@ -274,7 +906,7 @@ void Synthesiser::noteOn (const int midiChannel,
                           const int midiNoteNumber,
                           const float velocity)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* sound : sounds)
     {
@@ -313,6 +945,13 @@ void Synthesiser::startVoice (SynthesiserVoice* const voice,
 
         voice->startNote (midiNoteNumber, velocity, sound,
                           lastPitchWheelValues [midiChannel - 1]);
+
+        // it's now the most recently started voice, so it goes to the end of the order
+        updateStartOrder();
+        auto index = voicesInStartOrder.indexOf (voice);
+
+        if (index >= 0)
+            std::rotate (voicesInStartOrder.begin() + index, voicesInStartOrder.begin() + index + 1, voicesInStartOrder.end());
     }
 }
 
@@ -331,7 +970,7 @@ void Synthesiser::noteOff (const int midiChannel,
                            const float velocity,
                            const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
     {
@@ -357,7 +996,7 @@ void Synthesiser::noteOff (const int midiChannel,
 
 void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -368,7 +1007,7 @@ void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 
 void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -387,7 +1026,7 @@ void Synthesiser::handleController (const int midiChannel,
         default:    break;
     }
 
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -396,7 +1035,7 @@ void Synthesiser::handleController (const int midiChannel,
 
 void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
@@ -406,7 +1045,7 @@ void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aft
 
 void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -416,7 +1055,7 @@ void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureVal
 void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     if (isDown)
     {
@@ -446,7 +1085,7 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 void Synthesiser::handleSostenutoPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
 
     for (auto* voice : voices)
     {
@@ -477,9 +1116,10 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
                                               int midiChannel, int midiNoteNumber,
                                               const bool stealIfNoneAvailable) const
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderLock sl (*this);
+    updateStartOrder();
 
-    for (auto* voice : voices)
+    for (auto* voice : voicesInStartOrder)
         if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
             return voice;
 
@@ -503,27 +1143,16 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
     SynthesiserVoice* low = nullptr; // Lowest sounding note, might be sustained, but NOT in release phase
     SynthesiserVoice* top = nullptr; // Highest sounding note, might be sustained, but NOT in release phase
 
-    // this is a list of voices we can steal, sorted by how long they've been running
-    Array<SynthesiserVoice*> usableVoices;
-    usableVoices.ensureStorageAllocated (voices.size());
+    // The voices are kept in the order they were started, so going through them from the
+    // oldest one visits them in the order we'd prefer to steal them.
+    updateStartOrder();
 
-    for (auto* voice : voices)
+    for (auto* voice : voicesInStartOrder)
     {
         if (voice->canPlaySound (soundToPlay))
         {
             jassert (voice->isVoiceActive()); // We wouldn't be here otherwise
 
-            usableVoices.add (voice);
-
-            // NB: Using a functor rather than a lambda here due to scare-stories about
-            // compilers generating code containing heap allocations..
-            struct Sorter
-            {
-                bool operator() (const SynthesiserVoice* a, const SynthesiserVoice* b) const noexcept { return a->wasStartedBefore (*b); }
-            };
-
-            std::sort (usableVoices.begin(), usableVoices.end(), Sorter());
-
             if (! voice->isPlayingButReleased()) // Don't protect released notes
             {
                 auto note = voice->getCurrentlyPlayingNote();
@@ -542,23 +1171,23 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
         top = nullptr;
 
     // The oldest note that's playing with the target pitch is ideal..
-    for (auto* voice : usableVoices)
-        if (voice->getCurrentlyPlayingNote() == midiNoteNumber)
+    for (auto* voice : voicesInStartOrder)
+        if (voice->canPlaySound (soundToPlay) && voice->getCurrentlyPlayingNote() == midiNoteNumber)
             return voice;
 
     // Oldest voice that has been released (no finger on it and not held by sustain pedal)
-    for (auto* voice : usableVoices)
-        if (voice != low && voice != top && voice->isPlayingButReleased())
+    for (auto* voice : voicesInStartOrder)
+        if (voice->canPlaySound (soundToPlay) && voice != low && voice != top && voice->isPlayingButReleased())
             return voice;
 
     // Oldest voice that doesn't have a finger on it:
-    for (auto* voice : usableVoices)
-        if (voice != low && voice != top && ! voice->isKeyDown())
+    for (auto* voice : voicesInStartOrder)
+        if (voice->canPlaySound (soundToPlay) && voice != low && voice != top && ! voice->isKeyDown())
             return voice;
 
     // Oldest voice that isn't protected
-    for (auto* voice : usableVoices)
-        if (voice != low && voice != top)
+    for (auto* voice : voicesInStartOrder)
+        if (voice->canPlaySound (soundToPlay) && voice != low && voice != top)
             return voice;
 
     // We've only got "protected" voices now: lowest note takes priority
@@ -571,4 +1200,356 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
     return low;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct SynthesiserTests  : public UnitTest
+{
+    SynthesiserTests()  : UnitTest ("Synthesiser", "Audio") {}
+
+    struct TestSound  : public SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
+
+    struct TestVoice  : public SynthesiserVoice
+    {
+        TestVoice (int& counter) : numDeleted (counter) {}
+        ~TestVoice()                            { ++numDeleted; }
+
+        bool canPlaySound (SynthesiserSound*) override  { return true; }
+        void pitchWheelMoved (int) override {}
+        void controllerMoved (int, int) override {}
+
+        void startNote (int note, float velocity, SynthesiserSound*, int) override
+        {
+            level = velocity;
+            increment = note / 1000.0;
+        }
+
+        void stopNote (float, bool) override    { clearCurrentNote(); }
+
+        void renderNextBlock (AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            renderVoice (buffer, startSample, numSamples);
+        }
+
+        void renderNextBlock (AudioBuffer<double>& buffer, int startSample, int numSamples) override
+        {
+            renderVoice (buffer, startSample, numSamples);
+        }
+
+        template <typename FloatType>
+        void renderVoice (AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+        {
+            if (! isVoiceActive())
+                return;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto sample = (FloatType) (level * std::sin (phase));
+                phase += increment;
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    buffer.addSample (ch, startSample + i, sample);
+            }
+        }
+
+        int& numDeleted;
+        double phase = 0, increment = 0;
+        float level = 0;
+    };
+
+    struct TestSynth  : public Synthesiser
+    {
+        CriticalSection& getLock() noexcept                         { return lock; }
+        OwnedArray<SynthesiserVoice>& getVoicesArray() noexcept     { return voices; }
+    };
+
+    // Holds the synth's lock on another thread, as if it was in the middle of a block.
+    struct LockHolder  : public Thread
+    {
+        LockHolder (TestSynth& s) : Thread ("Synthesiser test"), synth (s)
+        {
+            startThread();
+            hasLocked.wait();
+        }
+
+        ~LockHolder()
+        {
+            shouldUnlock.signal();
+            stopThread (-1);
+        }
+
+        void run() override
+        {
+            const ScopedLock sl (synth.getLock());
+            hasLocked.signal();
+            shouldUnlock.wait();
+        }
+
+        TestSynth& synth;
+        WaitableEvent hasLocked, shouldUnlock;
+    };
+
+    static void renderSilentBlock (Synthesiser& synth)
+    {
+        AudioBuffer<float> buffer (2, 16);
+        buffer.clear();
+        synth.renderNextBlock (buffer, MidiBuffer(), 0, buffer.getNumSamples());
+    }
+
+    static int findVoicePlaying (Synthesiser& synth, int note)
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->getCurrentlyPlayingNote() == note)
+                return i;
+
+        return -1;
+    }
+
+    // The removed objects are deleted on a background thread, so this gives it a moment.
+    static bool waitForDeletions (const int& numDeleted, int expected)
+    {
+        for (int i = 0; i < 500 && numDeleted != expected; ++i)
+            Thread::sleep (2);
+
+        return numDeleted == expected;
+    }
+
+    static void addVoices (Synthesiser& synth, int numVoices, int& numDeleted)
+    {
+        for (int i = 0; i < numVoices; ++i)
+            synth.addVoice (new TestVoice (numDeleted));
+
+        synth.addSound (new TestSound());
+        synth.setCurrentPlaybackSampleRate (44100.0);
+    }
+
+    void runTest() override
+    {
+        beginTest ("Changes are made straight away when nothing is rendering");
+        {
+            int numDeleted = 0;
+
+            {
+                TestSynth synth;
+                addVoices (synth, 4, numDeleted);
+
+                expectEquals (synth.getNumVoices(), 4);
+                expectEquals (synth.getNumSounds(), 1);
+
+                synth.removeVoice (0);
+                expectEquals (synth.getNumVoices(), 3);
+                expectEquals (numDeleted, 1);
+
+                synth.removeSound (0);
+                expectEquals (synth.getNumSounds(), 0);
+
+                synth.clearVoices();
+                expectEquals (synth.getNumVoices(), 0);
+                expectEquals (numDeleted, 4);
+
+                synth.addVoice (new TestVoice (numDeleted));
+            }
+
+            expectEquals (numDeleted, 5);
+        }
+
+        beginTest ("Changes made during a block are applied at the start of the next one");
+        {
+            int numDeleted = 0;
+            TestSynth synth;
+            addVoices (synth, 2, numDeleted);
+
+            {
+                LockHolder holder (synth);
+
+                synth.addVoice (new TestVoice (numDeleted));
+                synth.removeVoice (0);
+                synth.addSound (new TestSound());
+
+                expectEquals (numDeleted, 0);
+                expectEquals (synth.getNumSounds(), 1);
+            }
+
+            // The next block picks up the changes, and the voice that was removed gets
+            // deleted without anything else having to change.
+            renderSilentBlock (synth);
+            expectEquals (synth.getNumVoices(), 2);
+            expectEquals (synth.getNumSounds(), 2);
+            expect (waitForDeletions (numDeleted, 1));
+        }
+
+        beginTest ("Lock-free rendering doesn't wait for the lock");
+        {
+            int numDeleted = 0;
+            TestSynth synth;
+            addVoices (synth, 2, numDeleted);
+            synth.setLockFreeRenderingEnabled (true);
+            expect (synth.isLockFreeRenderingEnabled());
+
+            auto* addedVoice = new TestVoice (numDeleted);
+
+            {
+                LockHolder holder (synth);
+
+                // Nothing has been rendered yet, so these are all still pending.
+                auto* firstVoice = synth.getVoice (0);
+                synth.addVoice (addedVoice);
+                synth.removeVoice (0);
+                synth.addSound (new TestSound());
+
+                expectEquals (synth.getNumVoices(), 2);
+                expect (synth.getVoice (0) == firstVoice);
+                expectEquals (synth.getNumSounds(), 1);
+                expectEquals (numDeleted, 0);
+
+                // The block doesn't wait for the lock, and picks up the changes.
+                MidiBuffer midi;
+                midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0);
+
+                AudioBuffer<float> buffer (2, 16);
+                buffer.clear();
+                synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+
+                expect (waitForDeletions (numDeleted, 1));
+                expect (buffer.getMagnitude (0, 16) > 0.0f);
+                expect (synth.getVoice (1) == addedVoice);
+                expectEquals (synth.getNumSounds(), 2);
+            }
+
+            synth.setLockFreeRenderingEnabled (false);
+            expectEquals (synth.getNumVoices(), 2);
+            expect (synth.getVoice (1) == addedVoice);
+            expect (findVoicePlaying (synth, 60) >= 0);
+        }
+
+        beginTest ("Voices changed directly by a subclass are picked up");
+        {
+            int numDeleted = 0;
+            TestSynth synth;
+            addVoices (synth, 3, numDeleted);
+
+            synth.noteOn (1, 60, 1.0f);
+            synth.noteOn (1, 62, 1.0f);
+            synth.noteOn (1, 64, 1.0f);
+
+            // replaces the voices without going through the synth, which deletes the old ones
+            for (int i = 0; i < 3; ++i)
+                synth.getVoicesArray().set (i, new TestVoice (numDeleted));
+
+            synth.getVoicesArray().add (new TestVoice (numDeleted));
+            expectEquals (numDeleted, 3);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                synth.noteOn (1, 70 + i, 1.0f);
+                expectEquals (findVoicePlaying (synth, 70 + i), i);
+            }
+        }
+
+        beginTest ("The voice that has been free for longest gets used first");
+        {
+            int numDeleted = 0;
+            TestSynth synth;
+            addVoices (synth, 3, numDeleted);
+
+            synth.noteOn (1, 60, 1.0f);
+            auto first = findVoicePlaying (synth, 60);
+            synth.noteOff (1, 60, 1.0f, false);
+
+            synth.noteOn (1, 62, 1.0f);
+            auto second = findVoicePlaying (synth, 62);
+            synth.noteOff (1, 62, 1.0f, false);
+
+            synth.noteOn (1, 64, 1.0f);
+            auto third = findVoicePlaying (synth, 64);
+
+            expect (first != second && second != third && first != third);
+
+            synth.noteOn (1, 65, 1.0f);
+            expectEquals (findVoicePlaying (synth, 65), first);
+        }
+
+        beginTest ("Voice stealing protects the lowest and highest notes");
+        {
+            int numDeleted = 0;
+            TestSynth synth;
+            addVoices (synth, 3, numDeleted);
+
+            synth.noteOn (1, 60, 1.0f);
+            synth.noteOn (1, 67, 1.0f);
+            synth.noteOn (1, 64, 1.0f);
+            auto middle = findVoicePlaying (synth, 64);
+
+            synth.noteOn (1, 62, 1.0f);
+            expectEquals (findVoicePlaying (synth, 62), middle);
+            expect (findVoicePlaying (synth, 60) >= 0);
+            expect (findVoicePlaying (synth, 67) >= 0);
+
+            // re-triggering a note that's playing stops it, which frees up its voice
+            synth.noteOn (1, 67, 1.0f);
+            expect (findVoicePlaying (synth, 62) >= 0);
+            expect (findVoicePlaying (synth, 60) >= 0);
+        }
+
+        beginTest ("Rendering on several threads gives the same output");
+        {
+            int numDeleted = 0;
+            TestSynth serial, parallel;
+            addVoices (serial, 24, numDeleted);
+            addVoices (parallel, 24, numDeleted);
+            parallel.setNumRenderingThreads (3, 256, 2);
+            expectEquals (parallel.getNumRenderingThreads(), 3);
+
+            MidiBuffer midi;
+
+            for (int i = 0; i < 20; ++i)
+                midi.addEvent (MidiMessage::noteOn (1, 40 + i * 2, 0.1f), i * 10);
+
+            AudioBuffer<float> floatSerial (2, 256), floatParallel (2, 256);
+            AudioBuffer<double> doubleSerial (2, 256), doubleParallel (2, 256);
+
+            for (int block = 0; block < 8; ++block)
+            {
+                // gives the workers time to go to sleep, so they have to be woken up
+                if (block == 4)
+                    Thread::sleep (100);
+
+                floatSerial.clear();
+                floatParallel.clear();
+                serial.renderNextBlock (floatSerial, midi, 0, 256);
+                parallel.renderNextBlock (floatParallel, midi, 0, 256);
+
+                doubleSerial.clear();
+                doubleParallel.clear();
+                serial.renderNextBlock (doubleSerial, MidiBuffer(), 0, 256);
+                parallel.renderNextBlock (doubleParallel, MidiBuffer(), 0, 256);
+
+                midi.clear();
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    for (int i = 0; i < 256; ++i)
+                    {
+                        expectWithinAbsoluteError (floatParallel.getSample (ch, i), floatSerial.getSample (ch, i), 1.0e-5f);
+                        expectWithinAbsoluteError (doubleParallel.getSample (ch, i), doubleSerial.getSample (ch, i), 1.0e-12);
+                    }
+                }
+            }
+
+            expect (floatSerial.getMagnitude (0, 256) > 0.1f);
+
+            parallel.setNumRenderingThreads (1, 0, 0);
+            expectEquals (parallel.getNumRenderingThreads(), 1);
+        }
+    }
+};
+
+static SynthesiserTests synthesiserTests;
+
+#endif
+
 } // namespace juce
@@ -300,6 +300,20 @@ private:
     events that go in will be scanned for note on/off messages, and these are used to
     start and stop the voices playing the appropriate sounds.
 
+    The voices and sounds can be added and removed from any thread while the synth is
+    playing, without making the audio thread wait. If a block is being rendered at the
+    time, the change is queued and gets picked up at the start of the next block, and
+    any objects that get removed are deleted by a background thread as soon as the
+    audio thread has let go of them.
+
+    By default the rendering and the note methods take a lock, so that notes can be
+    triggered from any thread. If the notes only ever come from the midi that's passed
+    to renderNextBlock(), setLockFreeRenderingEnabled() lets the audio thread render
+    without taking any locks at all.
+
+    For instruments with a lot of polyphony, setNumRenderingThreads() lets the voices
+    be shared out between several threads when they're rendered.
+
     While it's playing, you can also cause notes to be triggered by calling the noteOn(),
     noteOff() and other controller methods.
 
@@ -325,7 +339,10 @@ public:
     /** Deletes all voices. */
     void clearVoices();
 
-    /** Returns the number of voices that have been added. */
+    /** Returns the number of voices that have been added.
+        Voices that are added or removed while a block is being rendered only show up here
+        once the change has been picked up at the start of the next block.
+    */
     int getNumVoices() const noexcept                               { return voices.size(); }
 
     /** Returns one of the voices that have been added. */
@@ -338,17 +355,30 @@ public:
         The object passed in will be managed by the synthesiser, which will delete
         it later on when no longer needed. The caller should not retain a pointer to the
         voice.
+
+        If this is called while another thread is in the middle of rendering a block,
+        the voice will be added at the start of the next block rather than straight away.
     */
     SynthesiserVoice* addVoice (SynthesiserVoice* newVoice);
 
-    /** Deletes one of the voices. */
+    /** Deletes one of the voices.
+
+        If this is called while another thread is in the middle of rendering a block,
+        the voice will be removed at the start of the next block, and deleted on a
+        background thread straight afterwards.
+    */
     void removeVoice (int index);
 
     //==============================================================================
-    /** Deletes all sounds. */
+    /** Deletes all sounds.
+        Like the other methods that change the sounds, this won't block the audio thread.
+        @see addSound, removeSound
+    */
     void clearSounds();
 
-    /** Returns the number of sounds that have been added to the synth. */
+    /** Returns the number of sounds that have been added to the synth.
+        @see getNumVoices
+    */
     int getNumSounds() const noexcept                               { return sounds.size(); }
 
     /** Returns one of the sounds. */
@@ -358,10 +388,15 @@ public:
 
         The object passed in is reference counted, so will be deleted when the
         synthesiser and all voices are no longer using it.
+
+        If this is called while another thread is in the middle of rendering a block,
+        the sound will be added at the start of the next block rather than straight away.
     */
     SynthesiserSound* addSound (const SynthesiserSound::Ptr& newSound);
 
-    /** Removes and deletes one of the sounds. */
+    /** Removes and deletes one of the sounds.
+        @see removeVoice
+    */
     void removeSound (int index);
 
     //==============================================================================
@@ -568,9 +603,69 @@ public:
     */
     void setMinimumRenderingSubdivisionSize (int numSamples, bool shouldBeStrict = false) noexcept;
 
+    /** Shares out the rendering of the voices between several threads.
+
+        When this is turned on, the default renderVoices() implementation hands the
+        voices out to a set of worker threads as well as the thread that calls
+        renderNextBlock(), and mixes their results together. This is only worth doing
+        for synths with a large number of expensive voices, and your voices must be safe
+        to render at the same time as each other, i.e. they mustn't share any state that
+        gets modified while rendering, and each one must only write to the buffer that's
+        passed to its renderNextBlock() method.
+
+        Because the voices get mixed in a different order, the output may differ from a
+        single-threaded render by a rounding error.
+
+        So that the audio thread never has to wake them up with a lock, the worker threads
+        keep polling for work while blocks are being rendered, and only go to sleep once
+        nothing has been rendered for a while.
+
+        @param numThreads           the total number of threads to use, including the one
+                                    calling renderNextBlock(). A value of 1 or less turns
+                                    off the multi-threaded rendering.
+        @param maximumBlockSize     the largest number of samples that will be rendered in
+                                    one go. Any larger blocks get rendered on a single thread.
+        @param maximumNumChannels   the largest number of channels that will be rendered.
+                                    Buffers with more channels get rendered on a single thread.
+    */
+    void setNumRenderingThreads (int numThreads, int maximumBlockSize, int maximumNumChannels);
+
+    /** Returns the number of threads that the voices are rendered on.
+        @see setNumRenderingThreads
+    */
+    int getNumRenderingThreads() const noexcept;
+
+    /** Lets the audio thread render without taking any locks.
+
+        Normally renderNextBlock() holds the synth's lock while it renders, as do the note
+        methods, so that notes can be triggered from any thread. When this is turned on,
+        none of them take the lock, and the voices and sounds belong to the audio thread.
+        Voices and sounds can still be added and removed from any thread, but the changes
+        are only made at the start of each block, and anything that gets removed is deleted
+        after that. The audio thread doesn't allocate or free any memory to make them.
+
+        In exchange, the note and controller methods, setCurrentPlaybackSampleRate() and
+        setNumRenderingThreads() must only be called while nothing is being rendered, or
+        from the midi that's passed to renderNextBlock(). Subclasses shouldn't change the
+        voices and sounds arrays directly while it's turned on.
+
+        This must be called while nothing is being rendered, e.g. from your processor's
+        prepareToPlay() and releaseResources() methods. Changes that are made while it's
+        turned on but nothing is being rendered are picked up when it's turned off again.
+    */
+    void setLockFreeRenderingEnabled (bool shouldRenderWithoutLocking);
+
+    /** Returns true if the audio thread is rendering without taking any locks.
+        @see setLockFreeRenderingEnabled
+    */
+    bool isLockFreeRenderingEnabled() const noexcept;
+
 protected:
     //==============================================================================
-    /** This is used to control access to the rendering callback and the note trigger methods. */
+    /** This is used to control access to the rendering callback and the note trigger methods.
+        It isn't taken by the synth's own methods while lock-free rendering is enabled.
+        @see setLockFreeRenderingEnabled
+    */
     CriticalSection lock;
 
     OwnedArray<SynthesiserVoice> voices;
@@ -591,6 +686,10 @@ protected:
     /** Searches through the voices to find one that's not currently playing, and
         which can play the given sound.
 
+        The voices are checked in the order in which they were last started, so the one
+        that has been free for longest gets picked, and in the usual case where the oldest
+        voice has finished, no others need to be looked at.
+
         Returns nullptr if all voices are busy and stealing isn't enabled.
 
         To implement a custom note-stealing algorithm, you can either override this
@@ -632,12 +731,39 @@ protected:
 
 private:
     //==============================================================================
+    struct PendingChange;
+    struct PendingChanges;
+    struct RetiredObjectCollector;
+    struct ScopedRenderLock;
+    struct RenderThreads;
+
     template <typename floatType>
     void processNextBlock (AudioBuffer<floatType>& outputAudio,
                            const MidiBuffer& inputMidi,
                            int startSample,
                            int numSamples);
+
+    enum class ChangeType { addVoice, removeVoice, clearVoices, addSound, removeSound, clearSounds };
+
+    void postChange (ChangeType, SynthesiserVoice*, SynthesiserSound*, int index);
+    void applyPendingChanges();
+    void applyChange (PendingChange&);
+
+    void updateStartOrder() const;
+    int getStartOrderPosition (const SynthesiserVoice&) const noexcept;
+
     //==============================================================================
+    std::unique_ptr<PendingChanges> pendingChanges;
+    std::unique_ptr<RenderThreads> renderThreads;
+
+    // The voices in the order they were last started, oldest first, along with a copy of the
+    // voices array as it was when that order was made, which shows up any changes that a
+    // subclass makes to the array directly.
+    mutable Array<SynthesiserVoice*> voicesInStartOrder, voicesWhenOrdered;
+
+    std::atomic<bool> lockFreeRendering { false };
+    mutable int busyDepth = 0;
+
     double sampleRate = 0;
     uint32 lastNoteOnCounter = 0;
     int minimumSubBlockSize = 32;
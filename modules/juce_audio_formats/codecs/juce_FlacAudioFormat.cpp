@@ -154,6 +154,9 @@ namespace FlacNamespace
  #include "flac/libFLAC/stream_encoder_framing.c"
  #include "flac/libFLAC/window_flac.c"
  #undef VERSION
+
+ // The parallel encoder needs to get at the encoder's internals, so it only works with the bundled code
+ #define JUCE_FLAC_CAN_ENCODE_IN_PARALLEL 1
 #else
  #include <FLAC/all.h>
 #endif
@@ -174,7 +177,8 @@ static const char* const flacFormatName = "FLAC file";
 class FlacReader  : public AudioFormatReader
 {
 public:
-    FlacReader (InputStream* in)  : AudioFormatReader (in, flacFormatName)
+    FlacReader (InputStream* in, AudioFormatSeekIndexCache* cache)
+        : AudioFormatReader (in, flacFormatName), seekIndexCache (cache)
     {
         lengthInSamples = 0;
         decoder = FlacNamespace::FLAC__stream_decoder_new();
@@ -201,6 +205,27 @@ public:
                 FLAC__stream_decoder_process_until_end_of_metadata (decoder);
                 lengthInSamples = tempLength;
             }
+
+            FlacNamespace::FLAC__uint64 firstFramePos = 0;
+
+            if (sampleRate > 0 && FLAC__stream_decoder_get_decode_position (decoder, &firstFramePos))
+            {
+                seekIndex.addPoint (0, (int64) firstFramePos);
+
+                if (seekIndexCache != nullptr)
+                {
+                    auto hashCode = AudioFormatSeekIndexCache::getHashCode (*input);
+
+                    if (! seekIndexCache->loadIndex (hashCode, seekIndex))
+                    {
+                        buildSeekIndex();
+                        seekIndexCache->storeIndex (hashCode, seekIndex);
+
+                        FLAC__stream_decoder_flush (decoder);
+                        input->setPosition ((int64) firstFramePos);
+                    }
+                }
+            }
         }
     }
 
@@ -215,6 +240,7 @@ public:
         bitsPerSample = info.bits_per_sample;
         lengthInSamples = (unsigned int) info.total_samples;
         numChannels = info.channels;
+        maxBlockSize = (int) info.max_blocksize;
 
         reservoir.setSize ((int) numChannels, 2 * (int) info.max_blocksize, false, false, true);
     }
@@ -255,17 +281,40 @@ public:
                 else if (startSampleInFile < reservoirStart
                           || startSampleInFile > reservoirStart + jmax (samplesInReservoir, 511))
                 {
-                    // had some problems with flac crashing if the read pos is aligned more
-                    // accurately than this. Probably fixed in newer versions of the library, though.
-                    reservoirStart = (int) (startSampleInFile & ~511);
-                    samplesInReservoir = 0;
-                    FLAC__stream_decoder_seek_absolute (decoder, (FlacNamespace::FLAC__uint64) reservoirStart);
+                    auto* point = seekIndex.findPointBefore (startSampleInFile, 2 * seekIndexInterval + maxBlockSize);
+
+                    if (point == nullptr)
+                    {
+                        // had some problems with flac crashing if the read pos is aligned more
+                        // accurately than this. Probably fixed in newer versions of the library, though.
+                        reservoirStart = startSampleInFile & ~511;
+                        samplesInReservoir = 0;
+                        FLAC__stream_decoder_seek_absolute (decoder, (FlacNamespace::FLAC__uint64) reservoirStart);
+                    }
+                    else if (startSampleInFile < reservoirStart || point->sample > reservoirStart + samplesInReservoir)
+                    {
+                        // jump straight to the frame, rather than letting the decoder hunt for it
+                        FLAC__stream_decoder_flush (decoder);
+                        input->setPosition (point->bytePosition);
+                        reservoirStart = point->sample;
+                        samplesInReservoir = 0;
+                        decodeNextFrame();
+                    }
+                    else
+                    {
+                        reservoirStart += samplesInReservoir;
+                        samplesInReservoir = 0;
+                        decodeNextFrame();
+                    }
+
+                    addSeekIndexPoint();
                 }
                 else
                 {
                     reservoirStart += samplesInReservoir;
                     samplesInReservoir = 0;
-                    FLAC__stream_decoder_process_single (decoder);
+                    decodeNextFrame();
+                    addSeekIndexPoint();
                 }
 
                 if (samplesInReservoir == 0)
@@ -283,7 +332,7 @@ public:
         return true;
     }
 
-    void useSamples (const FlacNamespace::FLAC__int32* const buffer[], int numSamples)
+    void useSamples (const FlacNamespace::FLAC__int32* const buffer[], int numSamples, int64 firstSample)
     {
         if (scanningForLength)
         {
@@ -291,6 +340,8 @@ public:
         }
         else
         {
+            reservoirStart = firstSample;
+
             if (numSamples > reservoir.getNumSamples())
                 reservoir.setSize ((int) numChannels, numSamples, false, false, true);
 
@@ -326,7 +377,7 @@ public:
 
     static FlacNamespace::FLAC__StreamDecoderSeekStatus seekCallback_ (const FlacNamespace::FLAC__StreamDecoder*, FlacNamespace::FLAC__uint64 absolute_byte_offset, void* client_data)
     {
-        static_cast<const FlacReader*> (client_data)->input->setPosition ((int) absolute_byte_offset);
+        static_cast<const FlacReader*> (client_data)->input->setPosition ((int64) absolute_byte_offset);
         return FlacNamespace::FLAC__STREAM_DECODER_SEEK_STATUS_OK;
     }
 
@@ -352,7 +403,8 @@ public:
                                                                          const FlacNamespace::FLAC__int32* const buffer[],
                                                                          void* client_data)
     {
-        static_cast<FlacReader*> (client_data)->useSamples (buffer, (int) frame->header.blocksize);
+        static_cast<FlacReader*> (client_data)->useSamples (buffer, (int) frame->header.blocksize,
+                                                            (int64) frame->header.number.sample_number);
         return FlacNamespace::FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
     }
 
@@ -370,9 +422,65 @@ public:
 private:
     FlacNamespace::FLAC__StreamDecoder* decoder;
     AudioBuffer<float> reservoir;
-    int reservoirStart = 0, samplesInReservoir = 0;
+    int64 reservoirStart = 0;
+    int samplesInReservoir = 0, maxBlockSize = 0;
     bool ok = false, scanningForLength = false;
 
+    AudioFormatSeekIndexCache* seekIndexCache;
+    AudioFormatSeekIndex seekIndex;
+
+    // the index only needs a point every so often, as decoding a few frames
+    // forward from one is much quicker than searching the stream
+    static constexpr int64 seekIndexInterval = 16384;
+
+    void decodeNextFrame()
+    {
+        if (! FLAC__stream_decoder_process_single (decoder))
+            samplesInReservoir = 0;
+    }
+
+    void addSeekIndexPoint()
+    {
+        auto nextSample = reservoirStart + samplesInReservoir;
+        FlacNamespace::FLAC__uint64 pos = 0;
+
+        if (samplesInReservoir > 0
+             && seekIndex.findPointBefore (nextSample, seekIndexInterval - 1) == nullptr
+             && FLAC__stream_decoder_get_decode_position (decoder, &pos))
+            seekIndex.addPoint (nextSample, (int64) pos);
+    }
+
+    void buildSeekIndex()
+    {
+        // skipping the frames only parses them, which is far quicker than decoding them
+        int64 sample = 0;
+
+        for (;;)
+        {
+            FlacNamespace::FLAC__uint64 pos = 0;
+
+            if (! (FLAC__stream_decoder_get_decode_position (decoder, &pos)
+                    && FLAC__stream_decoder_skip_single_frame (decoder)))
+                break;
+
+            auto state = FLAC__stream_decoder_get_state (decoder);
+
+            if (state == FlacNamespace::FLAC__STREAM_DECODER_END_OF_STREAM)
+            {
+                seekIndex.setComplete (true);
+                break;
+            }
+
+            if (state != FlacNamespace::FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC)
+                break;
+
+            if (seekIndex.findPointBefore (sample, seekIndexInterval - 1) == nullptr)
+                seekIndex.addPoint (sample, (int64) pos);
+
+            sample += (int64) FLAC__stream_decoder_get_blocksize (decoder);
+        }
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlacReader)
 };
 
@@ -381,33 +489,40 @@ private:
 class FlacWriter  : public AudioFormatWriter
 {
 public:
-    FlacWriter (OutputStream* out, double rate, uint32 numChans, uint32 bits, int qualityOptionIndex)
+    FlacWriter (OutputStream* out, double rate, uint32 numChans, uint32 bits, int qualityOptionIndex, int numThreads)
         : AudioFormatWriter (out, flacFormatName, rate, numChans, bits),
-          streamStartPos (output != nullptr ? jmax (output->getPosition(), 0ll) : 0ll)
+          streamStartPos (output != nullptr ? jmax (output->getPosition(), 0ll) : 0ll),
+          qualityIndex (qualityOptionIndex)
     {
         encoder = FlacNamespace::FLAC__stream_encoder_new();
-
-        if (qualityOptionIndex > 0)
-            FLAC__stream_encoder_set_compression_level (encoder, (uint32) jmin (8, qualityOptionIndex));
-
-        FLAC__stream_encoder_set_do_mid_side_stereo (encoder, numChannels == 2);
-        FLAC__stream_encoder_set_loose_mid_side_stereo (encoder, numChannels == 2);
-        FLAC__stream_encoder_set_channels (encoder, numChannels);
-        FLAC__stream_encoder_set_bits_per_sample (encoder, jmin ((unsigned int) 24, bitsPerSample));
-        FLAC__stream_encoder_set_sample_rate (encoder, (unsigned int) sampleRate);
-        FLAC__stream_encoder_set_blocksize (encoder, 0);
-        FLAC__stream_encoder_set_do_escape_coding (encoder, true);
+        setUpEncoder (encoder);
 
         ok = FLAC__stream_encoder_init_stream (encoder,
                                                encodeWriteCallback, encodeSeekCallback,
                                                encodeTellCallback, encodeMetadataCallback,
                                                this) == FlacNamespace::FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+
+       #if JUCE_FLAC_CAN_ENCODE_IN_PARALLEL
+        if (ok && numThreads > 1)
+            parallelEncoder.reset (new ParallelEncoder (*this, numThreads));
+       #else
+        ignoreUnused (numThreads);
+       #endif
     }
 
     ~FlacWriter()
     {
         if (ok)
         {
+           #if JUCE_FLAC_CAN_ENCODE_IN_PARALLEL
+            if (parallelEncoder != nullptr)
+            {
+                parallelEncoder->finish();
+                parallelEncoder.reset();
+            }
+           #endif
+
+            // When encoding in parallel, this just writes the STREAMINFO block
             FlacNamespace::FLAC__stream_encoder_finish (encoder);
             output->flush();
         }
@@ -450,6 +565,11 @@ public:
             samplesToWrite = const_cast<const int**> (channels.get());
         }
 
+       #if JUCE_FLAC_CAN_ENCODE_IN_PARALLEL
+        if (parallelEncoder != nullptr)
+            return parallelEncoder->write (samplesToWrite, numSamples);
+       #endif
+
         return FLAC__stream_encoder_process (encoder, (const FlacNamespace::FLAC__int32**) samplesToWrite, (unsigned) numSamples) != 0;
     }
 
@@ -458,6 +578,20 @@ public:
         return output->write (data, (size_t) size);
     }
 
+    void setUpEncoder (FlacNamespace::FLAC__StreamEncoder* e) const
+    {
+        if (qualityIndex > 0)
+            FLAC__stream_encoder_set_compression_level (e, (uint32) jmin (8, qualityIndex));
+
+        FLAC__stream_encoder_set_do_mid_side_stereo (e, numChannels == 2);
+        FLAC__stream_encoder_set_loose_mid_side_stereo (e, numChannels == 2);
+        FLAC__stream_encoder_set_channels (e, numChannels);
+        FLAC__stream_encoder_set_bits_per_sample (e, jmin ((unsigned int) 24, bitsPerSample));
+        FLAC__stream_encoder_set_sample_rate (e, (unsigned int) sampleRate);
+        FLAC__stream_encoder_set_blocksize (e, 0);
+        FLAC__stream_encoder_set_do_escape_coding (e, true);
+    }
+
     static void packUint32 (FlacNamespace::FLAC__uint32 val, FlacNamespace::FLAC__byte* b, const int bytes)
     {
         b += bytes;
@@ -535,8 +669,190 @@ public:
     bool ok = false;
 
 private:
+   #if JUCE_FLAC_CAN_ENCODE_IN_PARALLEL
+    /*  Splits the stream into segments of whole frames, and gives each one its own encoder
+        on a thread pool. Apart from the mid/side decisions when using loose mid-side stereo,
+        libFLAC doesn't carry anything from one frame into the next, so if the segments start
+        on frames where the mid/side choice is made from scratch, and each encoder starts
+        numbering its frames at the right place, the frames come out exactly as they would
+        from a single encoder. The main encoder keeps track of the MD5 and frame sizes, so that
+        its STREAMINFO block matches too.
+    */
+    struct ParallelEncoder
+    {
+        ParallelEncoder (FlacWriter& w, int numThreads)
+            : writer (w), pool (numThreads)
+        {
+            using namespace FlacNamespace;
+
+            auto blockSize = (int) FLAC__stream_encoder_get_blocksize (writer.encoder);
+            framesPerSegment = jmax (1, 131072 / blockSize);
+
+            if (FLAC__stream_encoder_get_loose_mid_side_stereo (writer.encoder))
+            {
+                auto period = (int) writer.encoder->private_->loose_mid_side_stereo_frames;
+                framesPerSegment = period * ((framesPerSegment + period - 1) / period);
+            }
+
+            segmentSize = framesPerSegment * blockSize;
+            maxSegmentsInProgress = 2 * numThreads;
+        }
+
+        bool write (const int* const* samples, int numSamples)
+        {
+            using namespace FlacNamespace;
+            auto& e = *writer.encoder;
+
+            if (! FLAC__MD5Accumulate (&e.private_->md5context, (const FLAC__int32* const*) samples,
+                                       writer.numChannels, (unsigned) numSamples,
+                                       (e.protected_->bits_per_sample + 7) / 8))
+                failed = true;
+
+            for (int done = 0; done < numSamples;)
+            {
+                if (currentSegment == nullptr)
+                    currentSegment.reset (new Segment (writer, (uint32) (framesPerSegment * numSegmentsStarted++), segmentSize));
+
+                auto num = jmin (numSamples - done, segmentSize - currentSegment->numSamples);
+
+                for (int i = 0; i < (int) writer.numChannels; ++i)
+                    memcpy (currentSegment->getChannel (i) + currentSegment->numSamples,
+                            samples[i] + done, sizeof (int) * (size_t) num);
+
+                currentSegment->numSamples += num;
+                done += num;
+
+                if (currentSegment->numSamples == segmentSize)
+                    startCurrentSegment();
+            }
+
+            return ! failed;
+        }
+
+        bool finish()
+        {
+            if (currentSegment != nullptr)
+                startCurrentSegment();
+
+            while (! segmentsInProgress.isEmpty())
+                writeFirstSegment();
+
+            return ! failed;
+        }
+
+    private:
+        struct Segment  : public ThreadPoolJob
+        {
+            Segment (FlacWriter& w, uint32 firstFrame, int size)
+                : ThreadPoolJob ("FLAC encoder"), writer (w), firstFrameNumber (firstFrame),
+                  segmentSize (size), samples ((size_t) size * w.numChannels)
+            {
+            }
+
+            int* getChannel (int channel) noexcept      { return samples + channel * segmentSize; }
+
+            JobStatus runJob() override
+            {
+                using namespace FlacNamespace;
+                auto* e = FLAC__stream_encoder_new();
+                writer.setUpEncoder (e);
+                FLAC__stream_encoder_set_do_md5 (e, false);
+
+                ok = FLAC__stream_encoder_init_stream (e, writeCallback, nullptr, nullptr, nullptr, this)
+                        == FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+
+                if (ok)
+                {
+                    e->private_->current_frame_number = firstFrameNumber;
+
+                    const FLAC__int32* channels[FLAC__MAX_CHANNELS] = {};
+
+                    for (int i = 0; i < (int) writer.numChannels; ++i)
+                        channels[i] = getChannel (i);
+
+                    ok = FLAC__stream_encoder_process (e, channels, (unsigned) numSamples) != 0;
+                    ok = FLAC__stream_encoder_finish (e) != 0 && ok;
+                }
+
+                FLAC__stream_encoder_delete (e);
+                return jobHasFinished;
+            }
+
+            static FlacNamespace::FLAC__StreamEncoderWriteStatus writeCallback (const FlacNamespace::FLAC__StreamEncoder*,
+                                                                                const FlacNamespace::FLAC__byte buffer[],
+                                                                                size_t bytes, unsigned int samples,
+                                                                                unsigned int, void* client_data)
+            {
+                // the calls with no samples are writing the stream header, which we don't need
+                if (samples > 0)
+                {
+                    auto& segment = *static_cast<Segment*> (client_data);
+                    segment.encodedData.write (buffer, bytes);
+                    segment.frameSizes.add ((uint32) bytes);
+                }
+
+                return FlacNamespace::FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+            }
+
+            FlacWriter& writer;
+            const uint32 firstFrameNumber;
+            const int segmentSize;
+            HeapBlock<int> samples;
+            int numSamples = 0;
+            MemoryOutputStream encodedData;
+            Array<uint32> frameSizes;
+            bool ok = false;
+        };
+
+        void startCurrentSegment()
+        {
+            pool.addJob (currentSegment.get(), false);
+            segmentsInProgress.add (currentSegment.release());
+
+            // write out whatever's finished, and don't let the encoders get too far ahead
+            while (! segmentsInProgress.isEmpty()
+                    && (segmentsInProgress.size() > maxSegmentsInProgress
+                         || ! pool.contains (segmentsInProgress.getFirst())))
+                writeFirstSegment();
+        }
+
+        void writeFirstSegment()
+        {
+            std::unique_ptr<Segment> segment (segmentsInProgress.removeAndReturn (0));
+            pool.waitForJobToFinish (segment.get(), -1);
+
+            if (! segment->ok || ! writer.writeData (segment->encodedData.getData(), (int) segment->encodedData.getDataSize()))
+            {
+                failed = true;
+                return;
+            }
+
+            auto& info = writer.encoder->private_->streaminfo.data.stream_info;
+            info.total_samples += (FlacNamespace::FLAC__uint64) segment->numSamples;
+
+            for (auto size : segment->frameSizes)
+            {
+                info.min_framesize = jmin (info.min_framesize, size);
+                info.max_framesize = jmax (info.max_framesize, size);
+            }
+        }
+
+        FlacWriter& writer;
+        int framesPerSegment = 0, segmentSize = 0, maxSegmentsInProgress = 0, numSegmentsStarted = 0;
+        bool failed = false;
+        std::unique_ptr<Segment> currentSegment;
+        OwnedArray<Segment> segmentsInProgress;
+        ThreadPool pool;
+
+        JUCE_DECLARE_NON_COPYABLE (ParallelEncoder)
+    };
+
+    std::unique_ptr<ParallelEncoder> parallelEncoder;
+   #endif
+
     FlacNamespace::FLAC__StreamEncoder* encoder;
     int64 streamStartPos;
+    int qualityIndex;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlacWriter)
 };
@@ -563,7 +879,7 @@ bool FlacAudioFormat::isCompressed()    { return true; }
 
 AudioFormatReader* FlacAudioFormat::createReaderFor (InputStream* in, const bool deleteStreamIfOpeningFails)
 {
-    std::unique_ptr<FlacReader> r (new FlacReader (in));
+    std::unique_ptr<FlacReader> r (new FlacReader (in, getSeekIndexCache()));
 
     if (r->sampleRate > 0)
         return r.release();
@@ -584,7 +900,8 @@ AudioFormatWriter* FlacAudioFormat::createWriterFor (OutputStream* out,
     if (out != nullptr && getPossibleBitDepths().contains (bitsPerSample))
     {
         std::unique_ptr<FlacWriter> w (new FlacWriter (out, sampleRate, numberOfChannels,
-                                                     (uint32) bitsPerSample, qualityOptionIndex));
+                                                     (uint32) bitsPerSample, qualityOptionIndex,
+                                                     numEncoderThreads));
         if (w->ok)
             return w.release();
     }
@@ -597,6 +914,172 @@ StringArray FlacAudioFormat::getQualityOptions()
     return { "0 (Fastest)", "1", "2", "3", "4", "5 (Default)","6", "7", "8 (Highest quality)" };
 }
 
+void FlacAudioFormat::setNumEncoderThreads (int numThreads) noexcept
+{
+    numEncoderThreads = jmax (1, numThreads);
+}
+
+int FlacAudioFormat::getNumEncoderThreads() const noexcept
+{
+    return numEncoderThreads;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct FlacAudioFormatTests  : public UnitTest
+{
+    FlacAudioFormatTests()  : UnitTest ("FLAC audio format", "Audio") {}
+
+    static AudioBuffer<float> createTestSignal (int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+        Random random (0x1234);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // the channels keep switching between being identical and unrelated, so that
+            // the choice between mid/side and independent stereo changes as it goes along
+            auto t = (double) i;
+            auto shared = 0.4 * std::sin (t * 0.031) + 0.2 * std::sin (t * 0.0071) + 0.05 * (random.nextFloat() - 0.5);
+            auto areIdentical = (i / 15000) % 2 == 0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto value = (ch == 0 || areIdentical) ? shared
+                                                       : 0.4 * std::sin (t * 0.043) + 0.05 * (random.nextFloat() - 0.5);
+                buffer.setSample (ch, i, (float) value);
+            }
+        }
+
+        return buffer;
+    }
+
+    static MemoryBlock encode (const AudioBuffer<float>& buffer, int bitDepth, int quality, int numThreads)
+    {
+        FlacAudioFormat format;
+        format.setNumEncoderThreads (numThreads);
+        MemoryBlock result;
+
+        std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (result, false),
+                                                                           44100.0, (unsigned int) buffer.getNumChannels(),
+                                                                           bitDepth, {}, quality));
+
+        // write it in awkwardly-sized chunks, so that they straddle the segment boundaries
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += 10007)
+            writer->writeFromAudioSampleBuffer (buffer, pos, jmin (10007, buffer.getNumSamples() - pos));
+
+        writer.reset();
+        return result;
+    }
+
+    void checkRandomReads (AudioFormatReader& reader, const AudioBuffer<float>& expected)
+    {
+        auto r = getRandom();
+        AudioBuffer<float> block (expected.getNumChannels(), 5000);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            auto numSamples = 1 + r.nextInt (block.getNumSamples());
+            auto start = r.nextInt (expected.getNumSamples() - numSamples);
+
+            reader.read (&block, 0, numSamples, start, true, true);
+
+            for (int ch = 0; ch < expected.getNumChannels(); ++ch)
+            {
+                block.addFrom (ch, 0, expected, ch, start, numSamples, -1.0f);
+
+                if (block.getMagnitude (ch, 0, numSamples) != 0.0f)
+                {
+                    expect (false, "read of " + String (numSamples) + " samples at " + String (start));
+                    return;
+                }
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        const int numSamples = 400000;
+
+        beginTest ("Seeking with a seek index");
+        {
+            auto encoded = encode (createTestSignal (2, numSamples), 16, 5, 1);
+
+            FlacAudioFormat format;
+            std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (encoded, false), true));
+
+            AudioBuffer<float> expected (2, numSamples);
+            reader->read (&expected, 0, numSamples, 0, true, true);
+            checkRandomReads (*reader, expected);
+
+            AudioFormatSeekIndexCache cache ({});
+            format.setSeekIndexCache (&cache);
+
+            for (int i = 0; i < 2; ++i)
+            {
+                reader.reset (format.createReaderFor (new MemoryInputStream (encoded, false), true));
+                expectEquals ((int) reader->lengthInSamples, numSamples);
+
+                AudioFormatSeekIndex index;
+                MemoryInputStream stream (encoded, false);
+                expect (cache.loadIndex (AudioFormatSeekIndexCache::getHashCode (stream), index));
+                expect (index.isComplete());
+                expect (index.getNumPoints() > numSamples / 32768);
+
+                checkRandomReads (*reader, expected);
+            }
+        }
+
+       #if JUCE_FLAC_CAN_ENCODE_IN_PARALLEL
+        beginTest ("Encoding on several threads produces the same file as encoding on one");
+        {
+            for (auto numChannels : { 1, 2 })
+            {
+                auto signal = createTestSignal (numChannels, numSamples);
+
+                for (auto bitDepth : { 16, 24 })
+                {
+                    for (auto quality : { 0, 1, 4, 8 })
+                    {
+                        auto serial = encode (signal, bitDepth, quality, 1);
+                        auto parallel = encode (signal, bitDepth, quality, 3);
+
+                        expect (serial.getSize() > 1000);
+                        expect (serial == parallel, "channels: " + String (numChannels) + ", bits: " + String (bitDepth)
+                                                      + ", quality: " + String (quality));
+                    }
+                }
+            }
+        }
+
+        beginTest ("A file encoded on several threads decodes correctly");
+        {
+            auto signal = createTestSignal (2, numSamples);
+            auto encoded = encode (signal, 24, 5, 4);
+
+            FlacAudioFormat format;
+            std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (encoded, false), true));
+            expect (reader != nullptr);
+            expectEquals ((int) reader->lengthInSamples, numSamples);
+
+            AudioBuffer<float> decoded (2, numSamples);
+            reader->read (&decoded, 0, numSamples, 0, true, true);
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                decoded.addFrom (ch, 0, signal, ch, 0, numSamples, -1.0f);
+                expectLessThan (decoded.getMagnitude (ch, 0, numSamples), 1.0f / (1 << 22));
+            }
+        }
+       #endif
+    }
+};
+
+static FlacAudioFormatTests flacAudioFormatTests;
+
+#endif
+
 #endif
 
 } // namespace juce
@@ -64,7 +64,27 @@ public:
                                         int bitsPerSample,
                                         const StringPairArray& metadataValues,
                                         int qualityOptionIndex) override;
+
+    //==============================================================================
+    /** Sets the number of threads that writers created by this format will use.
+
+        With more than one thread, a writer compresses blocks of frames on a pool of
+        background threads, and writes them out in order. The file that comes out is
+        identical to the one a single thread would have produced.
+
+        This only has an effect when the bundled copy of libFLAC is being used, and
+        only applies to writers created after it's called.
+    */
+    void setNumEncoderThreads (int numThreads) noexcept;
+
+    /** Returns the number of threads that writers will use.
+        @see setNumEncoderThreads
+    */
+    int getNumEncoderThreads() const noexcept;
+
 private:
+    int numEncoderThreads = 1;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlacAudioFormat)
 };
 
@@ -1569,6 +1569,42 @@ struct MP3Stream
         return true;
     }
 
+    // Reads through the rest of the stream to find where all its frames are.
+    bool scanAllFrames()
+    {
+        for (;;)
+        {
+            int dummy = 0;
+            auto result = decodeNextBlock (nullptr, nullptr, dummy);
+
+            if (result < 0 || stream.isExhausted())
+                return true;
+        }
+    }
+
+    void getSeekIndex (AudioFormatSeekIndex& index) const
+    {
+        index.clear();
+
+        for (int i = 0; i < frameStreamPositions.size(); ++i)
+            index.addPoint ((int64) i * storedStartPosInterval * 1152, frameStreamPositions.getUnchecked (i));
+    }
+
+    void setSeekIndex (const AudioFormatSeekIndex& index)
+    {
+        frameStreamPositions.clearQuick();
+
+        for (int i = 0; i < index.getNumPoints(); ++i)
+        {
+            auto point = index.getPoint (i);
+
+            if (point.sample != (int64) i * storedStartPosInterval * 1152)
+                break;
+
+            frameStreamPositions.add (point.bytePosition);
+        }
+    }
+
     MP3Frame frame;
     VBRTagData vbrTagData;
     BufferedInputStream stream;
@@ -2940,7 +2976,7 @@ static const char* const mp3FormatName = "MP3 file";
 class MP3Reader : public AudioFormatReader
 {
 public:
-    MP3Reader (InputStream* const in)
+    MP3Reader (InputStream* const in, AudioFormatSeekIndexCache* seekIndexCache)
         : AudioFormatReader (in, mp3FormatName),
           stream (*in), currentPosition (0),
           decodedStart (0), decodedEnd (0)
@@ -2955,6 +2991,9 @@ public:
             sampleRate = stream.frame.getFrequency();
             numChannels = (unsigned int) stream.frame.numChannels;
             lengthInSamples = findLength (streamPos);
+
+            if (seekIndexCache != nullptr)
+                useSeekIndexCache (*seekIndexCache);
         }
     }
 
@@ -3034,6 +3073,26 @@ private:
     float decoded0[decodedDataSize], decoded1[decodedDataSize];
     int decodedStart, decodedEnd;
 
+    void useSeekIndexCache (AudioFormatSeekIndexCache& cache)
+    {
+        auto hashCode = AudioFormatSeekIndexCache::getHashCode (stream.stream);
+        AudioFormatSeekIndex index;
+
+        if (cache.loadIndex (hashCode, index))
+        {
+            stream.setSeekIndex (index);
+        }
+        else if (stream.scanAllFrames())
+        {
+            stream.getSeekIndex (index);
+            index.setComplete (true);
+            cache.storeIndex (hashCode, index);
+
+            stream.seek (0);
+            readNextBlock();
+        }
+    }
+
     void createEmptyDecodedData() noexcept
     {
         zeromem (decoded0, sizeof (decoded0));
@@ -3132,7 +3191,7 @@ StringArray MP3AudioFormat::getQualityOptions()     { return {}; }
 
 AudioFormatReader* MP3AudioFormat::createReaderFor (InputStream* sourceStream, const bool deleteStreamIfOpeningFails)
 {
-    std::unique_ptr<MP3Decoder::MP3Reader> r (new MP3Decoder::MP3Reader (sourceStream));
+    std::unique_ptr<MP3Decoder::MP3Reader> r (new MP3Decoder::MP3Reader (sourceStream, getSeekIndexCache()));
 
     if (r->lengthInSamples > 0)
         return r.release();
@@ -3151,6 +3210,75 @@ AudioFormatWriter* MP3AudioFormat::createWriterFor (OutputStream*, double /*samp
     return nullptr;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct MP3AudioFormatTests  : public UnitTest
+{
+    MP3AudioFormatTests()  : UnitTest ("MP3 audio format", "Audio") {}
+
+    // A stream of silent 128kbps, 44.1KHz MPEG-1 layer III frames
+    static MemoryBlock createSilentStream (int numFrames)
+    {
+        MemoryBlock data ((size_t) (numFrames * bytesPerFrame), true);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            auto* frame = static_cast<uint8*> (data.getData()) + i * bytesPerFrame;
+            frame[0] = 0xff; frame[1] = 0xfb; frame[2] = 0x90; frame[3] = 0x64;
+        }
+
+        return data;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Seek index cache");
+
+        const int numFrames = 1000;
+        auto data = createSilentStream (numFrames);
+
+        MP3AudioFormat format;
+        AudioFormatSeekIndexCache cache ({});
+        format.setSeekIndexCache (&cache);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (data, false), true));
+            expect (reader != nullptr);
+            expect (reader->lengthInSamples > 0);
+
+            AudioFormatSeekIndex index;
+            MemoryInputStream stream (data, false);
+            expect (cache.loadIndex (AudioFormatSeekIndexCache::getHashCode (stream), index));
+            expect (index.isComplete());
+            expectEquals (index.getNumPoints(), numFrames / 4);
+
+            for (int p = 0; p < index.getNumPoints(); p += 37)
+            {
+                expectEquals (index.getPoint (p).sample, (int64) p * 4 * 1152);
+                expectEquals (index.getPoint (p).bytePosition, (int64) p * 4 * bytesPerFrame);
+            }
+
+            AudioBuffer<float> buffer (2, 5000);
+
+            for (auto start : { 0, 600000, 3000, 900000 })
+            {
+                buffer.applyGain (0.0f);
+                buffer.setSample (0, 0, 1.0f);
+                reader->read (&buffer, 0, buffer.getNumSamples(), start, true, true);
+                expectEquals (buffer.getMagnitude (0, buffer.getNumSamples()), 0.0f);
+            }
+        }
+    }
+
+    enum { bytesPerFrame = 417 };
+};
+
+static MP3AudioFormatTests mp3AudioFormatTests;
+
+#endif
+
 #endif
 
 } // namespace juce
@@ -114,7 +114,8 @@ const char* const OggVorbisAudioFormat::id3trackNumber = "id3trackNumber";
 class OggReader : public AudioFormatReader
 {
 public:
-    OggReader (InputStream* inp)  : AudioFormatReader (inp, oggFormatName)
+    OggReader (InputStream* inp, AudioFormatSeekIndexCache* cache)
+        : AudioFormatReader (inp, oggFormatName)
     {
         sampleRate = 0;
         usesFloatingPointData = true;
@@ -146,6 +147,23 @@ public:
             sampleRate = info->rate;
 
             reservoir.setSize ((int) numChannels, (int) jmin (lengthInSamples, (int64) 4096));
+
+            if (canUseSeekIndex())
+            {
+                scanPosition = (int64) ovFile.dataoffsets[0];
+                scanGranule = (int64) ovFile.pcmlengths[0];
+
+                if (cache != nullptr)
+                {
+                    auto hashCode = AudioFormatSeekIndexCache::getHashCode (*input);
+
+                    if (! cache->loadIndex (hashCode, seekIndex))
+                    {
+                        extendSeekIndex (lengthInSamples, std::numeric_limits<int>::max());
+                        cache->storeIndex (hashCode, seekIndex);
+                    }
+                }
+            }
         }
     }
 
@@ -196,7 +214,7 @@ public:
                 samplesInReservoir = reservoir.getNumSamples();
 
                 if (reservoirStart != (int) ov_pcm_tell (&ovFile))
-                    ov_pcm_seek (&ovFile, reservoirStart);
+                    seekTo (reservoirStart);
 
                 int bitStream = 0;
                 int offset = 0;
@@ -269,6 +287,117 @@ private:
     AudioBuffer<float> reservoir;
     int reservoirStart = 0, samplesInReservoir = 0;
 
+    AudioFormatSeekIndex seekIndex;
+    int64 scanPosition = 0, scanGranule = 0;
+
+    static constexpr int64 seekIndexInterval = 8192;
+
+    // Without a cache, the index is only extended this many pages at a time, so that
+    // a seek never costs much more than the bisection that ov_pcm_seek does.
+    static constexpr int maxPagesToScanPerSeek = 64;
+
+    bool canUseSeekIndex() const noexcept
+    {
+        return ovFile.seekable && ovFile.links == 1;
+    }
+
+    void seekTo (int64 targetSample)
+    {
+        // the first packet after a page boundary only primes the decoder, so the page
+        // needs to be a couple of blocks before the target
+        auto margin = 2 * (int64) OggVorbisNamespace::vorbis_info_blocksize (ovFile.vi, 1);
+
+        if (canUseSeekIndex())
+            extendSeekIndex (targetSample - margin, maxPagesToScanPerSeek);
+
+        // If the index doesn't reach far enough yet, this falls back to bisecting
+        if (auto* point = seekIndex.findPointBefore (targetSample - margin, 2 * seekIndexInterval))
+        {
+            if (ov_raw_seek (&ovFile, point->bytePosition) == 0)
+            {
+                auto pos = (int64) ov_pcm_tell (&ovFile);
+
+                if (pos <= targetSample && skipSamples (targetSample - pos))
+                    return;
+            }
+        }
+
+        ov_pcm_seek (&ovFile, targetSample);
+    }
+
+    bool skipSamples (int64 numToSkip)
+    {
+        while (numToSkip > 0)
+        {
+            float** dataIn = nullptr;
+            int bitStream = 0;
+            auto samps = ov_read_float (&ovFile, &dataIn, (int) jmin (numToSkip, (int64) 4096), &bitStream);
+
+            if (samps <= 0)
+                return false;
+
+            numToSkip -= samps;
+        }
+
+        return true;
+    }
+
+    // Carries on indexing the pages from where the last call stopped, until it has passed
+    // the target sample or read the given number of pages. This reads the headers of the
+    // pages and skips their contents, so is far quicker than decoding them.
+    void extendSeekIndex (int64 targetSample, int maxNumPages)
+    {
+        if (seekIndex.isComplete() || scanGranule - (int64) ovFile.pcmlengths[0] > targetSample)
+            return;
+
+        auto originalPosition = input->getPosition();
+        auto granuleOffset = (int64) ovFile.pcmlengths[0];
+        auto lastGranule = scanGranule;
+        auto pos = scanPosition;
+
+        for (int numPages = 0; pos < (int64) ovFile.end && numPages < maxNumPages; ++numPages)
+        {
+            uint8 header[27 + 255];
+
+            if (! input->setPosition (pos) || input->read (header, 27) != 27
+                 || memcmp (header, "OggS", 4) != 0)
+                break;
+
+            auto numSegments = (int) header[26];
+
+            if (input->read (header + 27, numSegments) != numSegments)
+                break;
+
+            auto granule = (int64) ByteOrder::littleEndianInt64 (header + 6);
+            auto serialNumber = (long) (int) ByteOrder::littleEndianInt (header + 14);
+            int64 pageSize = 27 + numSegments;
+
+            for (int i = 0; i < numSegments; ++i)
+                pageSize += header[27 + i];
+
+            if (serialNumber == ovFile.serialnos[0])
+            {
+                auto sample = lastGranule - granuleOffset;
+
+                if (seekIndex.findPointBefore (sample, seekIndexInterval - 1) == nullptr)
+                    seekIndex.addPoint (sample, pos);
+
+                if (granule >= 0)
+                    lastGranule = granule;
+            }
+
+            pos += pageSize;
+
+            if (lastGranule - granuleOffset > targetSample)
+                break;
+        }
+
+        scanPosition = pos;
+        scanGranule = lastGranule;
+        seekIndex.setComplete (pos == (int64) ovFile.end);
+        input->setPosition (originalPosition);
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OggReader)
 };
 
@@ -451,7 +580,7 @@ bool OggVorbisAudioFormat::isCompressed()   { return true; }
 
 AudioFormatReader* OggVorbisAudioFormat::createReaderFor (InputStream* in, bool deleteStreamIfOpeningFails)
 {
-    std::unique_ptr<OggReader> r (new OggReader (in));
+    std::unique_ptr<OggReader> r (new OggReader (in, getSeekIndexCache()));
 
     if (r->sampleRate > 0)
         return r.release();
@@ -516,6 +645,98 @@ int OggVorbisAudioFormat::estimateOggFileQuality (const File& source)
     return 0;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct OggVorbisAudioFormatTests  : public UnitTest
+{
+    OggVorbisAudioFormatTests()  : UnitTest ("Ogg-Vorbis audio format", "Audio") {}
+
+    static MemoryBlock createTestFile (int numSamples)
+    {
+        AudioBuffer<float> buffer (2, numSamples);
+        Random random (0x1234);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            buffer.setSample (0, i, 0.4f * std::sin ((float) i * 0.031f) + 0.1f * (random.nextFloat() - 0.5f));
+            buffer.setSample (1, i, 0.4f * std::sin ((float) i * 0.0071f) + 0.1f * (random.nextFloat() - 0.5f));
+        }
+
+        OggVorbisAudioFormat format;
+        MemoryBlock result;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (result, false),
+                                                                               44100.0, 2, 16, {}, 4));
+            writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+        }
+
+        return result;
+    }
+
+    void checkRandomReads (AudioFormatReader& reader, const AudioBuffer<float>& expected)
+    {
+        auto r = getRandom();
+        AudioBuffer<float> block (expected.getNumChannels(), 10000);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            auto numSamples = 1 + r.nextInt (block.getNumSamples());
+            auto start = r.nextInt (expected.getNumSamples() - numSamples);
+
+            reader.read (&block, 0, numSamples, start, true, true);
+
+            for (int ch = 0; ch < expected.getNumChannels(); ++ch)
+            {
+                block.addFrom (ch, 0, expected, ch, start, numSamples, -1.0f);
+
+                if (block.getMagnitude (ch, 0, numSamples) > 1.0e-6f)
+                {
+                    expect (false, "read of " + String (numSamples) + " samples at " + String (start));
+                    return;
+                }
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        beginTest ("Seeking with a seek index");
+
+        const int numSamples = 300000;
+        auto encoded = createTestFile (numSamples);
+
+        OggVorbisAudioFormat format;
+        std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (encoded, false), true));
+        expectEquals ((int) reader->lengthInSamples, numSamples);
+
+        AudioBuffer<float> expected (2, numSamples);
+        reader->read (&expected, 0, numSamples, 0, true, true);
+        checkRandomReads (*reader, expected);
+
+        AudioFormatSeekIndexCache cache ({});
+        format.setSeekIndexCache (&cache);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            reader.reset (format.createReaderFor (new MemoryInputStream (encoded, false), true));
+
+            AudioFormatSeekIndex index;
+            MemoryInputStream stream (encoded, false);
+            expect (cache.loadIndex (AudioFormatSeekIndexCache::getHashCode (stream), index));
+            expect (index.isComplete());
+            expect (index.getNumPoints() > numSamples / 16384);
+
+            checkRandomReads (*reader, expected);
+        }
+    }
+};
+
+static OggVorbisAudioFormatTests oggVorbisAudioFormatTests;
+
+#endif
+
 #endif
 
 } // namespace juce
@@ -194,6 +194,25 @@ public:
                                                 const StringPairArray& metadataValues,
                                                 int qualityOptionIndex);
 
+    //==============================================================================
+    /** Gives this format a cache in which its readers can share their seek indexes.
+
+        Formats like MP3, Ogg-Vorbis and FLAC can't jump straight to a sample, so their
+        readers build an index of where the frames are as they go. If a cache is set,
+        readers will look there for an index of the stream they're opening, and when
+        there isn't one, they'll index the whole stream up-front and store it, so
+        that every seek after that can go straight to the right place.
+
+        The cache isn't owned by the format and must stay alive for as long as any
+        readers created by it. Pass nullptr to stop using a cache.
+
+        @see AudioFormatSeekIndexCache
+    */
+    void setSeekIndexCache (AudioFormatSeekIndexCache* cacheToUse) noexcept     { seekIndexCache = cacheToUse; }
+
+    /** Returns the cache that was set with setSeekIndexCache(), or nullptr. */
+    AudioFormatSeekIndexCache* getSeekIndexCache() const noexcept               { return seekIndexCache; }
+
 protected:
     /** Creates an AudioFormat object.
 
@@ -214,6 +233,7 @@ private:
     //==============================================================================
     String formatName;
     StringArray fileExtensions;
+    AudioFormatSeekIndexCache* seekIndexCache = nullptr;
 };
 
 } // namespace juce
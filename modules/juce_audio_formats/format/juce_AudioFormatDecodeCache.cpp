@@ -0,0 +1,432 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+static MemoryMappedAudioFormatReader* mapWholeFile (MemoryMappedAudioFormatReader* r)
+{
+    std::unique_ptr<MemoryMappedAudioFormatReader> reader (r);
+
+    if (reader != nullptr && reader->mapEntireFile())
+        return reader.release();
+
+    return nullptr;
+}
+
+AudioFormatDecodeCache::AudioFormatDecodeCache (AudioFormatManager& formats, const File& directoryToUse,
+                                                int64 maxSizeInBytes, TimeSliceThread& timeSliceThread)
+    : formatManager (formats), directory (directoryToUse),
+      maxSize (maxSizeInBytes), thread (timeSliceThread)
+{
+    thread.addTimeSliceClient (this);
+}
+
+AudioFormatDecodeCache::~AudioFormatDecodeCache()
+{
+    isBeingDeleted = true;
+    thread.removeTimeSliceClient (this);
+}
+
+//==============================================================================
+MemoryMappedAudioFormatReader* AudioFormatDecodeCache::createReaderFor (const File& audioFile)
+{
+    if (auto* r = createDirectReaderFor (audioFile))
+        return r;
+
+    auto decodedFile = getDecodedFileFor (audioFile);
+
+    if (decodedFile == File())
+        return nullptr;
+
+    {
+        // the lock stops the file being deleted by another thread before it has been mapped
+        const ScopedLock sl (decodeLock);
+
+        if (decodedFile.existsAsFile())
+        {
+            decodedFile.setLastModificationTime (Time::getCurrentTime());
+            return mapDecodedFile (decodedFile);
+        }
+    }
+
+    // This decodes without holding the lock, so that files that have already been
+    // decoded can still be opened by other threads in the meantime
+    auto temp = createTemporaryFileFor (decodedFile);
+
+    if (! decode (audioFile, temp->getFile()))
+        return nullptr;
+
+    const ScopedLock sl (decodeLock);
+
+    if (! keepDecodedFile (*temp))
+        return nullptr;
+
+    return mapDecodedFile (decodedFile);
+}
+
+void AudioFormatDecodeCache::preDecode (const File& audioFile)
+{
+    {
+        const ScopedLock sl (pendingLock);
+        pendingFiles.addIfNotAlreadyThere (audioFile);
+    }
+
+    thread.moveToFrontOfQueue (this);
+}
+
+bool AudioFormatDecodeCache::isDecoded (const File& audioFile) const
+{
+    return getDecodedFileFor (audioFile).existsAsFile();
+}
+
+int AudioFormatDecodeCache::getNumPendingFiles() const
+{
+    const ScopedLock sl (pendingLock);
+    return pendingFiles.size();
+}
+
+void AudioFormatDecodeCache::setMaxSize (int64 maxSizeInBytes)
+{
+    maxSize = maxSizeInBytes;
+
+    const ScopedLock sl (decodeLock);
+    trimToMaxSize ({});
+}
+
+void AudioFormatDecodeCache::clear()
+{
+    {
+        const ScopedLock sl (pendingLock);
+        pendingFiles.clear();
+    }
+
+    const ScopedLock sl (decodeLock);
+
+    for (auto& f : directory.findChildFiles (File::findFiles, false, "*.wav"))
+        f.deleteFile();
+}
+
+//==============================================================================
+int AudioFormatDecodeCache::useTimeSlice()
+{
+    File next;
+
+    {
+        const ScopedLock sl (pendingLock);
+
+        if (pendingFiles.isEmpty())
+            return 500;
+
+        next = pendingFiles.getFirst();
+    }
+
+    std::unique_ptr<MemoryMappedAudioFormatReader> direct (createDirectReaderFor (next));
+
+    if (direct == nullptr)
+    {
+        auto decodedFile = getDecodedFileFor (next);
+
+        if (decodedFile != File() && ! decodedFile.existsAsFile())
+        {
+            auto temp = createTemporaryFileFor (decodedFile);
+
+            if (decode (next, temp->getFile()))
+            {
+                const ScopedLock sl (decodeLock);
+                keepDecodedFile (*temp);
+            }
+        }
+    }
+
+    const ScopedLock sl (pendingLock);
+    pendingFiles.removeFirstMatchingValue (next);
+    return 0;
+}
+
+MemoryMappedAudioFormatReader* AudioFormatDecodeCache::createDirectReaderFor (const File& audioFile) const
+{
+    if (auto* format = formatManager.findFormatForFileExtension (audioFile.getFileExtension()))
+        return mapWholeFile (format->createMemoryMappedReader (audioFile));
+
+    return nullptr;
+}
+
+MemoryMappedAudioFormatReader* AudioFormatDecodeCache::mapDecodedFile (const File& decodedFile) const
+{
+    WavAudioFormat wavFormat;
+    return mapWholeFile (wavFormat.createMemoryMappedReader (decodedFile));
+}
+
+File AudioFormatDecodeCache::getDecodedFileFor (const File& audioFile) const
+{
+    if (! audioFile.existsAsFile())
+        return {};
+
+    // Checking every byte of the file would take as long as decoding much of it, so the
+    // name comes from the things that change whenever the file's contents do
+    auto key = audioFile.getFullPathName()
+                 + "|" + String (audioFile.getSize())
+                 + "|" + String (audioFile.getLastModificationTime().toMilliseconds());
+
+    return directory.getChildFile (String::toHexString (key.hashCode64())).withFileExtension ("wav");
+}
+
+std::unique_ptr<TemporaryFile> AudioFormatDecodeCache::createTemporaryFileFor (const File& decodedFile)
+{
+    // The temporary file doesn't have a .wav extension, so it won't get deleted by
+    // trimToMaxSize() or counted in the total size while it's being written
+    auto name = decodedFile.getFileNameWithoutExtension() + "_" + String::toHexString (Random::getSystemRandom().nextInt());
+
+    return std::make_unique<TemporaryFile> (decodedFile, decodedFile.getSiblingFile (name).withFileExtension ("partial"));
+}
+
+bool AudioFormatDecodeCache::decode (const File& source, const File& destination)
+{
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (source));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || ! directory.createDirectory())
+        return false;
+
+    std::unique_ptr<FileOutputStream> out (destination.createOutputStream());
+
+    if (out == nullptr)
+        return false;
+
+    WavAudioFormat wavFormat;
+    auto bitsPerSample = reader->usesFloatingPointData ? 32 : (int) reader->bitsPerSample;
+
+    if (! wavFormat.getPossibleBitDepths().contains (bitsPerSample))
+        bitsPerSample = 32;
+
+    std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (out.get(), reader->sampleRate,
+                                                                          reader->numChannels, bitsPerSample,
+                                                                          {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    out.release();
+    const int64 blockSize = 65536;
+
+    for (int64 pos = 0; pos < reader->lengthInSamples; pos += blockSize)
+    {
+        if (isBeingDeleted || Thread::currentThreadShouldExit())
+            return false;
+
+        if (! writer->writeFromAudioReader (*reader, pos, jmin (blockSize, reader->lengthInSamples - pos)))
+            return false;
+    }
+
+    return true;
+}
+
+bool AudioFormatDecodeCache::keepDecodedFile (TemporaryFile& temp)
+{
+    auto& decodedFile = temp.getTargetFile();
+
+    // If another thread has decoded the same file in the meantime, its copy may already
+    // be mapped, so that one gets kept and this one is thrown away
+    if (! decodedFile.existsAsFile())
+    {
+        if (! temp.overwriteTargetFileWithTemporary())
+            return false;
+
+        trimToMaxSize (decodedFile);
+    }
+
+    return true;
+}
+
+void AudioFormatDecodeCache::trimToMaxSize (const File& fileToKeep)
+{
+    // the modification time of each file is updated whenever it's used, so the
+    // oldest ones are the ones that were used least recently
+    auto files = directory.findChildFiles (File::findFiles, false, "*.wav");
+
+    std::sort (files.begin(), files.end(), [] (const File& a, const File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    int64 totalSize = 0;
+
+    for (auto& f : files)
+        totalSize += f.getSize();
+
+    for (auto& f : files)
+    {
+        if (totalSize <= maxSize)
+            break;
+
+        auto size = f.getSize();
+
+        if (f != fileToKeep && f.deleteFile())
+            totalSize -= size;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS && JUCE_USE_FLAC
+
+struct AudioFormatDecodeCacheTests  : public UnitTest
+{
+    AudioFormatDecodeCacheTests()  : UnitTest ("AudioFormatDecodeCache", "Audio") {}
+
+    static void writeTestFile (const File& file, AudioFormat& format, double frequency)
+    {
+        const int numSamples = 100000;
+        AudioBuffer<float> buffer (2, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            for (int ch = 0; ch < 2; ++ch)
+                buffer.setSample (ch, i, 0.5f * (float) std::sin ((ch + 1) * frequency * i));
+
+        file.deleteFile();
+        std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (file.createOutputStream(),
+                                                                           44100.0, 2, 16, {}, 0));
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    void expectSameAudio (AudioFormatReader& reader, AudioFormatReader& original)
+    {
+        expectEquals (reader.lengthInSamples, original.lengthInSamples);
+        expectEquals ((int) reader.numChannels, (int) original.numChannels);
+
+        auto numSamples = (int) original.lengthInSamples;
+        AudioBuffer<float> a (2, numSamples), b (2, numSamples);
+        reader.read (&a, 0, numSamples, 0, true, true);
+        original.read (&b, 0, numSamples, 0, true, true);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            a.addFrom (ch, 0, b, ch, 0, numSamples, -1.0f);
+            expectEquals (a.getMagnitude (ch, 0, numSamples), 0.0f);
+        }
+    }
+
+    void runTest() override
+    {
+        TemporaryFile tempDir;
+        auto dir = tempDir.getFile();
+        dir.createDirectory();
+
+        AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        FlacAudioFormat flacFormat;
+        auto file1 = dir.getChildFile ("one.flac");
+        auto file2 = dir.getChildFile ("two.flac");
+        writeTestFile (file1, flacFormat, 0.01);
+        writeTestFile (file2, flacFormat, 0.02);
+
+        TimeSliceThread thread ("decode cache test");
+        thread.startThread();
+
+        AudioFormatDecodeCache cache (formats, dir.getChildFile ("cache"), (int64) 1 << 30, thread);
+
+        beginTest ("Decoding on demand");
+        {
+            expect (! cache.isDecoded (file1));
+
+            for (int i = 0; i < 2; ++i)
+            {
+                std::unique_ptr<MemoryMappedAudioFormatReader> reader (cache.createReaderFor (file1));
+                std::unique_ptr<AudioFormatReader> original (formats.createReaderFor (file1));
+
+                expect (reader != nullptr);
+                expect (cache.isDecoded (file1));
+                expectSameAudio (*reader, *original);
+            }
+        }
+
+        beginTest ("Decoding in the background");
+        {
+            expect (! cache.isDecoded (file2));
+            cache.preDecode (file2);
+
+            for (int i = 0; i < 1000 && cache.getNumPendingFiles() > 0; ++i)
+                Thread::sleep (10);
+
+            expect (cache.isDecoded (file2));
+            expect (cache.getDirectory().findChildFiles (File::findFiles, false, "*.partial").isEmpty());
+        }
+
+        beginTest ("Changed files are decoded again");
+        {
+            auto file3 = dir.getChildFile ("three.flac");
+            writeTestFile (file3, flacFormat, 0.04);
+            expect (std::unique_ptr<MemoryMappedAudioFormatReader> (cache.createReaderFor (file3)) != nullptr);
+            expect (cache.isDecoded (file3));
+
+            writeTestFile (file3, flacFormat, 0.05);
+            file3.setLastModificationTime (Time::getCurrentTime() + RelativeTime::minutes (1));
+            expect (! cache.isDecoded (file3));
+
+            std::unique_ptr<MemoryMappedAudioFormatReader> reader (cache.createReaderFor (file3));
+            std::unique_ptr<AudioFormatReader> original (formats.createReaderFor (file3));
+            expect (reader != nullptr);
+            expectSameAudio (*reader, *original);
+        }
+
+        beginTest ("Size limit");
+        {
+            cache.setMaxSize (0);
+            expect (! cache.isDecoded (file1));
+            expect (! cache.isDecoded (file2));
+
+            std::unique_ptr<MemoryMappedAudioFormatReader> reader (cache.createReaderFor (file1));
+            expect (cache.isDecoded (file1));
+
+            reader.reset();
+            reader.reset (cache.createReaderFor (file2));
+            expect (reader != nullptr);
+            expect (! cache.isDecoded (file1));
+            expect (cache.isDecoded (file2));
+        }
+
+        beginTest ("Uncompressed files are mapped directly");
+        {
+            cache.clear();
+
+            WavAudioFormat wavFormat;
+            auto wavFile = dir.getChildFile ("three.wav");
+            writeTestFile (wavFile, wavFormat, 0.03);
+
+            std::unique_ptr<MemoryMappedAudioFormatReader> reader (cache.createReaderFor (wavFile));
+            expect (reader != nullptr);
+            expect (reader->getFile() == wavFile);
+            expect (! cache.isDecoded (wavFile));
+        }
+
+        dir.deleteRecursively();
+    }
+};
+
+static AudioFormatDecodeCacheTests audioFormatDecodeCacheTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Decodes compressed audio files into uncompressed copies on disk, so that
+    they can be read through a MemoryMappedAudioFormatReader.
+
+    Formats like MP3, Ogg-Vorbis and FLAC have to be decoded every time they're
+    opened and every time a reader seeks. If the same files get used over and over,
+    it can be much quicker to decode each one once, and after that to read the
+    decoded copy by mapping it into memory.
+
+    The copies are kept as WAV files in the directory that you give it. They're
+    named after a hash of the original file's path, size and modification time, so
+    a file gets decoded again if it's changed, moved or renamed. Once the total size
+    of the directory goes over a limit, the copies that were used least recently get
+    deleted.
+
+    Decoding happens without holding any locks, so while one thread is decoding a
+    file, other threads can still open files that have already been decoded. If two
+    threads ask for the same file at once, they may both decode it, but only one copy
+    is kept.
+
+    Files can either be decoded on demand by createReaderFor(), or queued with
+    preDecode() so that a background thread can decode them before they're needed.
+
+    @see AudioFormatManager, MemoryMappedAudioFormatReader
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioFormatDecodeCache  : private TimeSliceClient
+{
+public:
+    //==============================================================================
+    /** Creates a cache.
+
+        @param formatManager    the formats to use when opening the original files. This
+                                must stay alive for as long as the cache exists
+        @param directoryToUse   the directory in which to keep the decoded files. It'll be
+                                created if it doesn't exist
+        @param maxSizeInBytes   the total size that the decoded files are allowed to take up
+        @param timeSliceThread  the thread that should be used to decode files that are
+                                queued with preDecode(). Make sure that the thread you supply
+                                is running, and won't be deleted while the cache still exists.
+    */
+    AudioFormatDecodeCache (AudioFormatManager& formatManager,
+                            const File& directoryToUse,
+                            int64 maxSizeInBytes,
+                            TimeSliceThread& timeSliceThread);
+
+    /** Destructor. */
+    ~AudioFormatDecodeCache();
+
+    //==============================================================================
+    /** Returns a memory-mapped reader for a file, decoding it first if needed.
+
+        If the file's format can already be memory-mapped (e.g. WAV or AIFF), the file
+        itself is mapped. Otherwise, if there's no decoded copy of it in the cache yet,
+        this will decode the whole file before returning, which could take a while.
+
+        The reader that is returned has already had its whole file mapped, and it's the
+        caller's responsibility to delete it. Returns nullptr if the file can't be read.
+    */
+    MemoryMappedAudioFormatReader* createReaderFor (const File& audioFile);
+
+    /** Adds a file to the queue of files that the background thread will decode.
+        Files that have already been decoded are ignored.
+    */
+    void preDecode (const File& audioFile);
+
+    /** Returns true if there's a decoded copy of this file in the cache. */
+    bool isDecoded (const File& audioFile) const;
+
+    /** Returns the number of files that the background thread is decoding or has still to decode. */
+    int getNumPendingFiles() const;
+
+    //==============================================================================
+    /** Changes the total size that the decoded files can take up.
+        If they're already bigger than this, the oldest ones will be deleted.
+    */
+    void setMaxSize (int64 maxSizeInBytes);
+
+    /** Returns the total size that the decoded files can take up. */
+    int64 getMaxSize() const noexcept                   { return maxSize; }
+
+    /** Returns the directory that the decoded files are kept in. */
+    const File& getDirectory() const noexcept           { return directory; }
+
+    /** Deletes all the decoded files and empties the background queue. */
+    void clear();
+
+private:
+    //==============================================================================
+    AudioFormatManager& formatManager;
+    const File directory;
+    std::atomic<int64> maxSize;
+    std::atomic<bool> isBeingDeleted { false };
+    TimeSliceThread& thread;
+    Array<File> pendingFiles;
+    CriticalSection pendingLock, decodeLock;
+
+    int useTimeSlice() override;
+    MemoryMappedAudioFormatReader* createDirectReaderFor (const File&) const;
+    MemoryMappedAudioFormatReader* mapDecodedFile (const File&) const;
+    File getDecodedFileFor (const File&) const;
+    static std::unique_ptr<TemporaryFile> createTemporaryFileFor (const File& decodedFile);
+    bool decode (const File& source, const File& destination);
+    bool keepDecodedFile (TemporaryFile&);
+    void trimToMaxSize (const File& fileToKeep);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatDecodeCache)
+};
+
+} // namespace juce
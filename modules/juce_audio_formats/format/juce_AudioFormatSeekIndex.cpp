@@ -0,0 +1,479 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace SeekIndexHelpers
+{
+    static void writeVarInt (OutputStream& out, uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.writeByte ((char) (0x80 | (value & 0x7f)));
+            value >>= 7;
+        }
+
+        out.writeByte ((char) value);
+    }
+
+    static bool readVarInt (InputStream& in, uint64& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (in.isExhausted())
+                return false;
+
+            auto byte = (uint8) in.readByte();
+            value |= ((uint64) (byte & 0x7f)) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    static const int magicNumber = (int) ByteOrder::littleEndianInt ("jsix");
+    static const int currentVersion = 1;
+}
+
+//==============================================================================
+AudioFormatSeekIndex::AudioFormatSeekIndex() {}
+AudioFormatSeekIndex::~AudioFormatSeekIndex() {}
+
+AudioFormatSeekIndex::AudioFormatSeekIndex (const AudioFormatSeekIndex& other)
+    : points (other.points), complete (other.complete)
+{
+}
+
+AudioFormatSeekIndex& AudioFormatSeekIndex::operator= (const AudioFormatSeekIndex& other)
+{
+    points = other.points;
+    complete = other.complete;
+    return *this;
+}
+
+void AudioFormatSeekIndex::clear() noexcept
+{
+    points.clearQuick();
+    complete = false;
+}
+
+void AudioFormatSeekIndex::addPoint (int64 sample, int64 bytePosition)
+{
+    // Points nearly always arrive in order, so check for that first
+    if (points.isEmpty() || sample > points.getReference (points.size() - 1).sample)
+    {
+        points.add ({ sample, bytePosition });
+        return;
+    }
+
+    auto* end = points.end();
+    auto* next = std::upper_bound (points.begin(), end, sample,
+                                   [] (int64 s, const Point& p) { return s < p.sample; });
+
+    if (next != points.begin() && (next - 1)->sample == sample)
+        return;
+
+    points.insert ((int) (next - points.begin()), { sample, bytePosition });
+}
+
+const AudioFormatSeekIndex::Point* AudioFormatSeekIndex::findPointBefore (int64 sample, int64 maxDistance) const noexcept
+{
+    auto* next = std::upper_bound (points.begin(), points.end(), sample,
+                                   [] (int64 s, const Point& p) { return s < p.sample; });
+
+    if (next == points.begin())
+        return nullptr;
+
+    auto* point = next - 1;
+    return sample - point->sample <= maxDistance ? point : nullptr;
+}
+
+bool AudioFormatSeekIndex::writeToStream (OutputStream& out) const
+{
+    using namespace SeekIndexHelpers;
+
+    out.writeInt (magicNumber);
+    out.writeInt (currentVersion);
+    out.writeBool (complete);
+    writeVarInt (out, (uint64) points.size());
+
+    // Both positions always increase, so only the differences need storing
+    Point last { 0, 0 };
+
+    for (auto& p : points)
+    {
+        if (p.bytePosition < last.bytePosition)
+            return false;
+
+        writeVarInt (out, (uint64) (p.sample - last.sample));
+        writeVarInt (out, (uint64) (p.bytePosition - last.bytePosition));
+        last = p;
+    }
+
+    return true;
+}
+
+bool AudioFormatSeekIndex::readFromStream (InputStream& in)
+{
+    using namespace SeekIndexHelpers;
+    clear();
+
+    if (in.readInt() != magicNumber || in.readInt() != currentVersion)
+        return false;
+
+    auto isComplete = in.readBool();
+    uint64 numPoints = 0;
+
+    if (! readVarInt (in, numPoints) || numPoints > (uint64) std::numeric_limits<int>::max())
+        return false;
+
+    // Each point takes at least two bytes, so a corrupt count that's more than the rest of the
+    // stream could hold is rejected before any space gets allocated for it.
+    const int64 minBytesPerPoint = 2;
+    auto totalLength = in.getTotalLength();
+
+    if (totalLength >= 0)
+    {
+        if (numPoints > (uint64) jmax ((int64) 0, totalLength - in.getPosition()) / (uint64) minBytesPerPoint)
+            return false;
+
+        points.ensureStorageAllocated ((int) numPoints);
+    }
+    Point last { 0, 0 };
+
+    for (uint64 i = 0; i < numPoints; ++i)
+    {
+        uint64 sampleDelta = 0, byteDelta = 0;
+
+        if (! (readVarInt (in, sampleDelta) && readVarInt (in, byteDelta)))
+        {
+            clear();
+            return false;
+        }
+
+        last.sample += (int64) sampleDelta;
+        last.bytePosition += (int64) byteDelta;
+        points.add (last);
+    }
+
+    complete = isComplete;
+    return true;
+}
+
+//==============================================================================
+struct AudioFormatSeekIndexCache::Entry
+{
+    int64 hashCode;
+    AudioFormatSeekIndex index;
+};
+
+AudioFormatSeekIndexCache::AudioFormatSeekIndexCache (const File& directoryToUse, int maxNumInMemory_)
+    : directory (directoryToUse), maxNumInMemory (jmax (1, maxNumInMemory_))
+{
+}
+
+AudioFormatSeekIndexCache::~AudioFormatSeekIndexCache() {}
+
+int64 AudioFormatSeekIndexCache::getHashCode (InputStream& in)
+{
+    const int64 endChunkSize = 65536, sampleChunkSize = 4096;
+    const int numSampleChunks = 32;
+    auto originalPosition = in.getPosition();
+    auto totalLength = in.getTotalLength();
+
+    // A 64-bit FNV-1a hash of the length, the data at each end, and a set of chunks
+    // spread out between them, so that an edit anywhere in a file is likely to change it
+    uint64 hash = 14695981039346656037ull;
+
+    auto addToHash = [&hash] (const void* data, size_t numBytes)
+    {
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ static_cast<const uint8*> (data)[i]) * 1099511628211ull;
+    };
+
+    addToHash (&totalLength, sizeof (totalLength));
+
+    if (auto* fileStream = dynamic_cast<FileInputStream*> (&in))
+    {
+        auto modificationTime = fileStream->getFile().getLastModificationTime().toMilliseconds();
+        addToHash (&modificationTime, sizeof (modificationTime));
+    }
+
+    HeapBlock<char> buffer ((size_t) endChunkSize);
+
+    auto addChunk = [&] (int64 start, int64 numBytes)
+    {
+        if (in.setPosition (start))
+        {
+            auto numRead = in.read (buffer, (int) numBytes);
+
+            if (numRead > 0)
+                addToHash (buffer, (size_t) numRead);
+        }
+    };
+
+    addChunk (0, endChunkSize);
+
+    auto middleLength = totalLength - 2 * endChunkSize - sampleChunkSize;
+
+    if (middleLength > 0)
+        for (int i = 0; i < numSampleChunks; ++i)
+            addChunk (endChunkSize + middleLength * i / (numSampleChunks - 1), sampleChunkSize);
+
+    addChunk (jmax ((int64) 0, totalLength - endChunkSize), endChunkSize);
+
+    in.setPosition (originalPosition);
+    return (int64) hash;
+}
+
+File AudioFormatSeekIndexCache::getFileFor (int64 hashCode) const
+{
+    return directory.getChildFile (String::toHexString (hashCode)).withFileExtension ("seekindex");
+}
+
+bool AudioFormatSeekIndexCache::loadIndex (int64 hashCode, AudioFormatSeekIndex& result)
+{
+    const ScopedLock sl (lock);
+
+    for (int i = entries.size(); --i >= 0;)
+    {
+        if (entries.getUnchecked (i)->hashCode == hashCode)
+        {
+            entries.move (i, -1);
+            result = entries.getLast()->index;
+            return true;
+        }
+    }
+
+    if (directory != File())
+    {
+        FileInputStream in (getFileFor (hashCode));
+
+        if (in.openedOk() && result.readFromStream (in) && result.isComplete())
+        {
+            entries.add (new Entry { hashCode, result });
+
+            if (entries.size() > maxNumInMemory)
+                entries.remove (0);
+
+            return true;
+        }
+
+        result.clear();
+    }
+
+    return false;
+}
+
+void AudioFormatSeekIndexCache::storeIndex (int64 hashCode, const AudioFormatSeekIndex& index)
+{
+    if (! index.isComplete())
+        return;
+
+    const ScopedLock sl (lock);
+
+    for (int i = entries.size(); --i >= 0;)
+        if (entries.getUnchecked (i)->hashCode == hashCode)
+            entries.remove (i);
+
+    entries.add (new Entry { hashCode, index });
+
+    if (entries.size() > maxNumInMemory)
+        entries.remove (0);
+
+    if (directory != File() && directory.createDirectory())
+    {
+        TemporaryFile temp (getFileFor (hashCode));
+
+        {
+            FileOutputStream out (temp.getFile());
+
+            if (! (out.openedOk() && index.writeToStream (out)))
+                return;
+        }
+
+        temp.overwriteTargetFileWithTemporary();
+    }
+}
+
+void AudioFormatSeekIndexCache::clear()
+{
+    const ScopedLock sl (lock);
+    entries.clear();
+
+    if (directory.isDirectory())
+        for (auto& f : directory.findChildFiles (File::findFiles, false, "*.seekindex"))
+            f.deleteFile();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioFormatSeekIndexTests  : public UnitTest
+{
+    AudioFormatSeekIndexTests() : UnitTest ("AudioFormatSeekIndex", "Audio") {}
+
+    static AudioFormatSeekIndex createIndex (Random& r)
+    {
+        AudioFormatSeekIndex index;
+        int64 sample = r.nextInt (100), pos = r.nextInt (10000);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            index.addPoint (sample, pos);
+            sample += 1 + r.nextInt (5000);
+            pos += 1 + r.nextInt (100000);
+        }
+
+        index.addPoint (sample + ((int64) 1 << 40), pos + ((int64) 1 << 35));
+        index.setComplete (true);
+        return index;
+    }
+
+    static bool areSame (const AudioFormatSeekIndex& a, const AudioFormatSeekIndex& b)
+    {
+        if (a.getNumPoints() != b.getNumPoints() || a.isComplete() != b.isComplete())
+            return false;
+
+        for (int i = 0; i < a.getNumPoints(); ++i)
+            if (a.getPoint (i).sample != b.getPoint (i).sample
+                 || a.getPoint (i).bytePosition != b.getPoint (i).bytePosition)
+                return false;
+
+        return true;
+    }
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Points");
+        {
+            AudioFormatSeekIndex index;
+            index.addPoint (1000, 100);
+            index.addPoint (3000, 300);
+            index.addPoint (2000, 200);
+            index.addPoint (2000, 999);
+
+            expectEquals (index.getNumPoints(), 3);
+            expectEquals (index.getPoint (1).bytePosition, (int64) 200);
+
+            expect (index.findPointBefore (999, 10000) == nullptr);
+            expectEquals (index.findPointBefore (1000, 0)->bytePosition, (int64) 100);
+            expectEquals (index.findPointBefore (2999, 10000)->bytePosition, (int64) 200);
+            expect (index.findPointBefore (2999, 500) == nullptr);
+            expectEquals (index.findPointBefore (5000, 10000)->bytePosition, (int64) 300);
+        }
+
+        beginTest ("Serialisation");
+        {
+            auto index = createIndex (r);
+
+            MemoryOutputStream out;
+            expect (index.writeToStream (out));
+
+            AudioFormatSeekIndex loaded;
+            MemoryInputStream in (out.getData(), out.getDataSize(), false);
+            expect (loaded.readFromStream (in));
+            expect (areSame (index, loaded));
+
+            MemoryInputStream truncated (out.getData(), out.getDataSize() / 2, false);
+            expect (! loaded.readFromStream (truncated));
+            expectEquals (loaded.getNumPoints(), 0);
+
+            MemoryOutputStream corrupt;
+            corrupt.writeInt (SeekIndexHelpers::magicNumber);
+            corrupt.writeInt (SeekIndexHelpers::currentVersion);
+            corrupt.writeBool (true);
+            SeekIndexHelpers::writeVarInt (corrupt, (uint64) std::numeric_limits<int>::max());
+            corrupt.writeInt64 (0);
+
+            MemoryInputStream corruptIn (corrupt.getData(), corrupt.getDataSize(), false);
+            expect (! loaded.readFromStream (corruptIn));
+            expectEquals (loaded.getNumPoints(), 0);
+        }
+
+        beginTest ("Cache");
+        {
+            TemporaryFile dir;
+            auto index = createIndex (r);
+
+            MemoryBlock data;
+            for (int i = 0; i < 200000; ++i)
+                data.append (&i, 1);
+
+            MemoryInputStream stream (data, false);
+            stream.setPosition (1234);
+            auto hash = AudioFormatSeekIndexCache::getHashCode (stream);
+            expectEquals (stream.getPosition(), (int64) 1234);
+
+            {
+                MemoryBlock edited (data);
+                edited[100000] = (char) (edited[100000] + 1);
+                MemoryInputStream editedStream (edited, false);
+                expect (AudioFormatSeekIndexCache::getHashCode (editedStream) != hash);
+            }
+
+            {
+                AudioFormatSeekIndexCache cache (dir.getFile());
+                AudioFormatSeekIndex loaded;
+                expect (! cache.loadIndex (hash, loaded));
+
+                AudioFormatSeekIndex incomplete (index);
+                incomplete.setComplete (false);
+                cache.storeIndex (hash, incomplete);
+                expect (! cache.loadIndex (hash, loaded));
+
+                cache.storeIndex (hash, index);
+                expect (cache.loadIndex (hash, loaded));
+                expect (areSame (index, loaded));
+            }
+
+            {
+                AudioFormatSeekIndexCache cache (dir.getFile());
+                AudioFormatSeekIndex loaded;
+                expect (cache.loadIndex (hash, loaded));
+                expect (areSame (index, loaded));
+
+                cache.clear();
+                expect (! cache.loadIndex (hash, loaded));
+            }
+
+            dir.getFile().deleteRecursively();
+        }
+    }
+};
+
+static AudioFormatSeekIndexTests audioFormatSeekIndexTests;
+
+#endif
+
+} // namespace juce
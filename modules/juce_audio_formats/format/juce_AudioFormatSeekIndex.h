@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A list of places in a compressed audio stream where decoding can begin.
+
+    Each point holds the index of a sample, and the byte position in the stream of
+    the frame or page that has to be decoded to get to that sample. The readers for
+    formats that can't work out where a sample is without searching for it, such as
+    MP3, Ogg-Vorbis and FLAC, use one of these so that once they've found a position,
+    they can jump straight back to it later.
+
+    An index doesn't have to cover the whole stream - a reader can fill in the
+    points as it finds them, and will only use a point if it's close to the sample
+    that's needed. Once every part of the stream has been covered, the index can be
+    marked as complete and shared between readers using an AudioFormatSeekIndexCache.
+
+    @see AudioFormatSeekIndexCache
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioFormatSeekIndex
+{
+public:
+    //==============================================================================
+    /** Creates an empty index. */
+    AudioFormatSeekIndex();
+
+    /** Destructor. */
+    ~AudioFormatSeekIndex();
+
+    AudioFormatSeekIndex (const AudioFormatSeekIndex&);
+    AudioFormatSeekIndex& operator= (const AudioFormatSeekIndex&);
+
+    //==============================================================================
+    /** A position in the stream where decoding can start. */
+    struct Point
+    {
+        int64 sample;           /**< The first sample that decoding from this point will produce. */
+        int64 bytePosition;     /**< The position in the stream to start decoding from. */
+    };
+
+    /** Removes all the points. */
+    void clear() noexcept;
+
+    /** Adds a point to the index.
+        Points can be added in any order, but if there's already one for the same sample,
+        this will be ignored.
+    */
+    void addPoint (int64 sample, int64 bytePosition);
+
+    /** Returns the number of points in the index. */
+    int getNumPoints() const noexcept                       { return points.size(); }
+
+    /** Returns one of the points, which are kept sorted by their sample positions. */
+    Point getPoint (int index) const noexcept               { return points[index]; }
+
+    /** Finds the last point that comes at or before a sample.
+        Returns nullptr if there isn't one, or if the nearest one is more than
+        maxDistance samples away.
+    */
+    const Point* findPointBefore (int64 sample, int64 maxDistance) const noexcept;
+
+    //==============================================================================
+    /** Marks the index as covering the whole of the stream. */
+    void setComplete (bool isComplete) noexcept             { complete = isComplete; }
+
+    /** Returns true if the index has been marked as covering the whole of the stream. */
+    bool isComplete() const noexcept                        { return complete; }
+
+    //==============================================================================
+    /** Writes the index to a stream in a compact binary form. */
+    bool writeToStream (OutputStream&) const;
+
+    /** Replaces the contents of this index with one that was written by writeToStream().
+        Returns false if the data isn't valid, in which case the index will be left empty.
+    */
+    bool readFromStream (InputStream&);
+
+private:
+    //==============================================================================
+    Array<Point> points;
+    bool complete = false;
+
+    JUCE_LEAK_DETECTOR (AudioFormatSeekIndex)
+};
+
+//==============================================================================
+/**
+    Keeps the seek indexes that audio format readers build, so that the next reader
+    to open the same data doesn't have to build its index again.
+
+    The indexes are identified by a hash of the data in the stream, so they'll be
+    found again if a file gets moved or renamed, as long as its modification time
+    is kept. A cache keeps a number of recent indexes in memory, and if it's given a
+    directory, it also saves them there so that they're still available the next time
+    the app runs.
+
+    To use one, pass it to AudioFormat::setSeekIndexCache().
+
+    @see AudioFormatSeekIndex, AudioFormat::setSeekIndexCache
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioFormatSeekIndexCache
+{
+public:
+    //==============================================================================
+    /** Creates a cache.
+
+        @param directoryToUse       a directory in which to save the indexes, or File()
+                                    to only keep them in memory. The directory will be
+                                    created if it doesn't exist.
+        @param maxNumInMemory       the number of indexes to keep in memory
+    */
+    explicit AudioFormatSeekIndexCache (const File& directoryToUse, int maxNumInMemory = 64);
+
+    /** Destructor. */
+    ~AudioFormatSeekIndexCache();
+
+    //==============================================================================
+    /** Calculates a hash code that identifies the data in a stream.
+        This looks at the stream's length, the data at its start and end and a set of
+        small chunks spread out between them, plus the file's modification time if it's
+        a FileInputStream. It leaves the stream's position where it was.
+    */
+    static int64 getHashCode (InputStream&);
+
+    /** Looks for an index that was stored with the given hash code.
+        Returns true and fills in the index if one was found.
+    */
+    bool loadIndex (int64 hashCode, AudioFormatSeekIndex& result);
+
+    /** Stores an index for the data with the given hash code.
+        Only indexes that have been marked as complete are stored.
+    */
+    void storeIndex (int64 hashCode, const AudioFormatSeekIndex& index);
+
+    /** Removes all the indexes from memory and from the directory. */
+    void clear();
+
+    /** Returns the directory that the indexes are saved in. */
+    const File& getDirectory() const noexcept               { return directory; }
+
+private:
+    //==============================================================================
+    struct Entry;
+    File directory;
+    const int maxNumInMemory;
+    OwnedArray<Entry> entries;
+    CriticalSection lock;
+
+    File getFileFor (int64 hashCode) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatSeekIndexCache)
+};
+
+} // namespace juce
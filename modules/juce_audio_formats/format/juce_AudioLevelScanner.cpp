@@ -0,0 +1,384 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+namespace juce
+{
+
+Range<float> AudioLevelScanner::Levels::getOverallRange (int channel) const noexcept
+{
+    Range<float> result;
+
+    for (int i = 0; i < getNumBlocks(); ++i)
+        result = (i == 0 ? getRange (i, channel) : result.getUnionWith (getRange (i, channel)));
+
+    return result;
+}
+
+float AudioLevelScanner::Levels::getOverallRMS (int channel) const noexcept
+{
+    auto numBlocks = getNumBlocks();
+
+    if (numBlocks == 0 || samples.isEmpty())
+        return 0.0f;
+
+    double sum = 0;
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        auto blockLength = (i < numBlocks - 1) ? (int64) samplesPerBlock
+                                               : samples.getLength() - (int64) samplesPerBlock * i;
+        auto rms = (double) getRMS (i, channel);
+        sum += rms * rms * (double) blockLength;
+    }
+
+    return (float) std::sqrt (sum / (double) samples.getLength());
+}
+
+//==============================================================================
+struct AudioLevelScanner::ScanState
+{
+    ReaderFactory createReader;
+    int numChannels, samplesPerBlock, numChunks;
+    int64 startSample, numSamples, chunkSize;
+    Range<float>* ranges;
+    float* rmsLevels;
+
+    std::atomic<int> nextChunk { 0 }, numChunksDone { 0 };
+    std::atomic<bool> failed { false };
+    WaitableEvent finished;
+
+    // Keeps taking chunks until there are none left. A job that the pool doesn't get
+    // round to starting until the scan is over will find nothing to do, so nothing
+    // in here apart from the counters can be touched once all the chunks are done.
+    void run (AudioFormatReader* reader)
+    {
+        std::unique_ptr<AudioFormatReader> ownedReader;
+
+        for (;;)
+        {
+            auto chunk = nextChunk++;
+
+            if (chunk >= numChunks)
+                return;
+
+            if (reader == nullptr && ! failed)
+            {
+                ownedReader.reset (createReader());
+                reader = ownedReader.get();
+            }
+
+            auto chunkStart = chunkSize * chunk;
+            auto firstResult = (chunkStart / samplesPerBlock) * numChannels;
+
+            if (reader == nullptr
+                 || ! scanBlocks (*reader, numChannels, startSample + chunkStart,
+                                  jmin (chunkSize, numSamples - chunkStart), samplesPerBlock,
+                                  ranges + firstResult, rmsLevels + firstResult))
+                failed = true;
+
+            if (++numChunksDone == numChunks)
+                finished.signal();
+        }
+    }
+};
+
+//==============================================================================
+AudioLevelScanner::AudioLevelScanner (ThreadPool& threadPool)  : pool (threadPool)
+{
+}
+
+AudioLevelScanner::~AudioLevelScanner()
+{
+}
+
+void AudioLevelScanner::setMinimumChunkSize (int64 numSamples) noexcept
+{
+    jassert (numSamples > 0);
+    minimumChunkSize = jmax ((int64) 1, numSamples);
+}
+
+bool AudioLevelScanner::scan (const ReaderFactory& createReader,
+                              int64 startSample, int64 numSamples,
+                              int samplesPerBlock, Levels& result)
+{
+    std::unique_ptr<AudioFormatReader> reader (createReader());
+
+    if (reader == nullptr)
+    {
+        result = {};
+        return false;
+    }
+
+    return scan (*reader, createReader, startSample, numSamples, samplesPerBlock, result);
+}
+
+bool AudioLevelScanner::scan (AudioFormatManager& formatManager, const File& file,
+                              int samplesPerBlock, Levels& result)
+{
+    ReaderFactory createReader = [&formatManager, file]() -> AudioFormatReader*
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader (format->createMemoryMappedReader (file));
+
+            if (mappedReader != nullptr && mappedReader->mapEntireFile())
+                return mappedReader.release();
+        }
+
+        return formatManager.createReaderFor (file);
+    };
+
+    std::unique_ptr<AudioFormatReader> reader (createReader());
+
+    if (reader == nullptr)
+    {
+        result = {};
+        return false;
+    }
+
+    return scan (*reader, createReader, 0, reader->lengthInSamples, samplesPerBlock, result);
+}
+
+bool AudioLevelScanner::scan (AudioFormatReader& firstReader, const ReaderFactory& createReader,
+                              int64 startSample, int64 numSamples, int samplesPerBlock, Levels& result)
+{
+    jassert (samplesPerBlock > 0);
+    samplesPerBlock = jmax (1, samplesPerBlock);
+    numSamples = jmax ((int64) 0, numSamples);
+
+    auto numBlocks = (int) ((numSamples + samplesPerBlock - 1) / samplesPerBlock);
+
+    result.numChannels = (int) firstReader.numChannels;
+    result.samplesPerBlock = samplesPerBlock;
+    result.samples = Range<int64> (startSample, startSample + numSamples);
+    result.ranges.clearQuick();
+    result.ranges.insertMultiple (0, {}, numBlocks * result.numChannels);
+    result.rmsLevels.clearQuick();
+    result.rmsLevels.insertMultiple (0, 0.0f, numBlocks * result.numChannels);
+
+    if (numBlocks == 0 || result.numChannels == 0)
+        return true;
+
+    // Gives each thread a few chunks, so that the ones that finish early can help the others out
+    auto numThreads = pool.getNumThreads() + 1;
+    auto minBlocksPerChunk = (int) ((minimumChunkSize + samplesPerBlock - 1) / samplesPerBlock);
+    auto blocksPerChunk = jmax (1, minBlocksPerChunk, (numBlocks + numThreads * 4 - 1) / (numThreads * 4));
+
+    auto state = std::make_shared<ScanState>();
+    state->createReader     = createReader;
+    state->numChannels      = result.numChannels;
+    state->samplesPerBlock  = samplesPerBlock;
+    state->numChunks        = (numBlocks + blocksPerChunk - 1) / blocksPerChunk;
+    state->startSample      = startSample;
+    state->numSamples       = numSamples;
+    state->chunkSize        = (int64) blocksPerChunk * samplesPerBlock;
+    state->ranges           = result.ranges.getRawDataPointer();
+    state->rmsLevels        = result.rmsLevels.getRawDataPointer();
+
+    for (int i = jmin (state->numChunks - 1, pool.getNumThreads()); --i >= 0;)
+        pool.addJob ([state] { state->run (nullptr); });
+
+    state->run (&firstReader);
+    state->finished.wait();
+
+    return ! state->failed;
+}
+
+//==============================================================================
+bool AudioLevelScanner::scanBlocks (AudioFormatReader& reader, int numChannels,
+                                    int64 startSample, int64 numSamples, int samplesPerBlock,
+                                    Range<float>* ranges, float* rmsLevels)
+{
+    jassert (numChannels > 0 && numChannels <= (int) reader.numChannels && samplesPerBlock > 0);
+
+    if (numSamples <= 0)
+        return true;
+
+    auto bufferSize = (int) jmin ((int64) samplesPerBlock, numSamples, (int64) 4096);
+    AudioBuffer<float> buffer (numChannels, bufferSize);
+    auto floatData = buffer.getArrayOfWritePointers();
+    auto intData = reinterpret_cast<int* const*> (floatData);
+    HeapBlock<double> sumsOfSquares (numChannels);
+
+    for (int64 blockStart = 0; blockStart < numSamples; blockStart += samplesPerBlock)
+    {
+        auto blockLength = jmin ((int64) samplesPerBlock, numSamples - blockStart);
+
+        for (int i = 0; i < numChannels; ++i)
+            sumsOfSquares[i] = 0;
+
+        for (int64 pos = 0; pos < blockLength; pos += bufferSize)
+        {
+            auto numToDo = (int) jmin ((int64) bufferSize, blockLength - pos);
+
+            if (! reader.read (intData, numChannels, startSample + blockStart + pos, numToDo, false))
+                return false;
+
+            for (int i = 0; i < numChannels; ++i)
+            {
+                auto* data = floatData[i];
+
+                if (! reader.usesFloatingPointData)
+                    FloatVectorOperations::convertFixedToFloat (data, intData[i], 1.0f / (float) std::numeric_limits<int>::max(), numToDo);
+
+                auto r = FloatVectorOperations::findMinAndMax (data, numToDo);
+                ranges[i] = (pos == 0 ? r : ranges[i].getUnionWith (r));
+
+                double sum = 0;
+
+                for (int j = 0; j < numToDo; ++j)
+                    sum += (double) data[j] * (double) data[j];
+
+                sumsOfSquares[i] += sum;
+            }
+        }
+
+        for (int i = 0; i < numChannels; ++i)
+            rmsLevels[i] = (float) std::sqrt (sumsOfSquares[i] / (double) blockLength);
+
+        ranges += numChannels;
+        rmsLevels += numChannels;
+    }
+
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioLevelScannerTests  : public UnitTest
+{
+    AudioLevelScannerTests()  : UnitTest ("AudioLevelScanner", "Audio") {}
+
+    static void writeTestData (OutputStream* stream, int numSamples)
+    {
+        AudioBuffer<float> buffer (2, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto envelope = (float) (i % 5000) / 5000.0f;
+            buffer.setSample (0, i, envelope * (float) std::sin (i * 0.01));
+            buffer.setSample (1, i, -0.5f * envelope);
+        }
+
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (stream, 44100.0, 2, 16, {}, 0));
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    void expectMatchesSingleThreadedScan (AudioFormatReader& reader, const AudioLevelScanner::Levels& levels)
+    {
+        auto numBlocks = levels.getNumBlocks();
+        HeapBlock<Range<float>> ranges (numBlocks * 2);
+        HeapBlock<float> rmsLevels (numBlocks * 2);
+
+        expect (AudioLevelScanner::scanBlocks (reader, 2, levels.samples.getStart(), levels.samples.getLength(),
+                                               levels.samplesPerBlock, ranges, rmsLevels));
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                expect (levels.getRange (i, ch) == ranges[i * 2 + ch]);
+                expectEquals (levels.getRMS (i, ch), rmsLevels[i * 2 + ch]);
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        const int numSamples = 123456;
+        MemoryBlock wavData;
+        writeTestData (new MemoryOutputStream (wavData, false), numSamples);
+
+        ThreadPool pool (3);
+        AudioLevelScanner scanner (pool);
+        scanner.setMinimumChunkSize (1000);
+
+        auto createReader = [&wavData]() -> AudioFormatReader*
+        {
+            return WavAudioFormat().createReaderFor (new MemoryInputStream (wavData, false), true);
+        };
+
+        std::unique_ptr<AudioFormatReader> reader (createReader());
+
+        beginTest ("Levels match a single-threaded scan");
+        {
+            AudioLevelScanner::Levels levels;
+            expect (scanner.scan (createReader, 0, numSamples, 1000, levels));
+            expectEquals (levels.getNumBlocks(), 124);
+            expectEquals (levels.numChannels, 2);
+            expectMatchesSingleThreadedScan (*reader, levels);
+        }
+
+        beginTest ("Levels match readMaxLevels");
+        {
+            AudioLevelScanner::Levels levels;
+            expect (scanner.scan (createReader, 777, 50000, 2500, levels));
+
+            for (int i = 0; i < levels.getNumBlocks(); ++i)
+            {
+                Range<float> expected[2];
+                reader->readMaxLevels (777 + i * 2500, 2500, expected, 2);
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    expectWithinAbsoluteError (levels.getRange (i, ch).getStart(), expected[ch].getStart(), 1.0e-6f);
+                    expectWithinAbsoluteError (levels.getRange (i, ch).getEnd(),   expected[ch].getEnd(),   1.0e-6f);
+                }
+            }
+
+            expectWithinAbsoluteError (levels.getOverallRange (1).getStart(), -0.5f, 0.001f);
+            expectWithinAbsoluteError (levels.getOverallRMS (1), 0.5f / std::sqrt (3.0f), 0.01f);
+        }
+
+        beginTest ("Files are scanned through memory-mapped readers");
+        {
+            TemporaryFile tempFile (".wav");
+            writeTestData (tempFile.getFile().createOutputStream(), numSamples);
+
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            AudioLevelScanner::Levels levels;
+            expect (scanner.scan (formatManager, tempFile.getFile(), 4096, levels));
+            expectEquals (levels.samples.getLength(), (int64) numSamples);
+            expectMatchesSingleThreadedScan (*reader, levels);
+        }
+
+        beginTest ("Failing to create a reader");
+        {
+            AudioLevelScanner::Levels levels;
+            expect (! scanner.scan ([] { return static_cast<AudioFormatReader*> (nullptr); }, 0, 1000, 100, levels));
+            expectEquals (levels.getNumBlocks(), 0);
+        }
+    }
+};
+
+static AudioLevelScannerTests audioLevelScannerTests;
+
+#endif
+
+} // namespace juce
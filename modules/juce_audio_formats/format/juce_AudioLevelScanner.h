@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures the levels in an audio stream by splitting it into chunks and reading
+    them on several threads at once.
+
+    This produces the same kind of information as AudioFormatReader::readMaxLevels(),
+    plus the RMS level, for each block of a given number of samples along the stream.
+    It's intended for things like generating waveform overviews for a large number of
+    files, where reading each file on a single thread would be too slow.
+
+    Readers can only be used by one thread at a time, so each thread that takes part
+    in a scan needs its own reader. The scanner gets these by calling a function that
+    you give it, or it can open them itself from a file using an AudioFormatManager,
+    in which case it'll use memory-mapped readers for formats that support them.
+
+    @see AudioFormatReader::readMaxLevels
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioLevelScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner that will share its work out between the threads in a pool.
+        The pool must not be deleted while the scanner is still in use.
+    */
+    explicit AudioLevelScanner (ThreadPool& threadPool);
+
+    /** Destructor. */
+    ~AudioLevelScanner();
+
+    //==============================================================================
+    /** The results of a scan. */
+    struct Levels
+    {
+        /** The number of channels that were scanned. */
+        int numChannels = 0;
+
+        /** The number of samples that each block covers. The last block may be shorter. */
+        int samplesPerBlock = 0;
+
+        /** The range of the stream that was scanned. */
+        Range<int64> samples;
+
+        /** Returns the number of blocks that the levels were measured for. */
+        int getNumBlocks() const noexcept                       { return numChannels > 0 ? ranges.size() / numChannels : 0; }
+
+        /** Returns the lowest and highest sample values in one of the blocks. */
+        Range<float> getRange (int block, int channel) const noexcept   { return ranges[block * numChannels + channel]; }
+
+        /** Returns the RMS level of one of the blocks. */
+        float getRMS (int block, int channel) const noexcept            { return rmsLevels[block * numChannels + channel]; }
+
+        /** Returns the lowest and highest sample values in the whole of the scanned range. */
+        Range<float> getOverallRange (int channel) const noexcept;
+
+        /** Returns the RMS level of the whole of the scanned range. */
+        float getOverallRMS (int channel) const noexcept;
+
+        /** The ranges for each block, with the channels for each block next to each other. */
+        Array<Range<float>> ranges;
+
+        /** The RMS levels for each block, in the same order as the ranges. */
+        Array<float> rmsLevels;
+    };
+
+    //==============================================================================
+    /** A function that the scanner calls to create a reader for each thread that takes
+        part in a scan. It may be called on any of the pool's threads, and can return
+        nullptr if it fails.
+    */
+    using ReaderFactory = std::function<AudioFormatReader*()>;
+
+    /** Scans part of a stream.
+
+        The calling thread reads some of the chunks itself, and blocks until all of them
+        have been read.
+
+        @param createReader     a function that creates a new reader for the stream
+        @param startSample      the first sample to scan
+        @param numSamples       the number of samples to scan
+        @param samplesPerBlock  the number of samples that each set of levels should cover
+        @param result           on return, this holds the levels
+        @returns false if a reader couldn't be created or failed to read some of the data,
+                 in which case the result won't be complete
+    */
+    bool scan (const ReaderFactory& createReader,
+               int64 startSample, int64 numSamples,
+               int samplesPerBlock, Levels& result);
+
+    /** Scans the whole of a file.
+
+        If the file's format can create a MemoryMappedAudioFormatReader, all the threads
+        will read it through memory-mapped readers, otherwise each one will open the
+        file with a normal reader.
+
+        @returns false if the file couldn't be opened or read
+    */
+    bool scan (AudioFormatManager& formatManager, const File& file,
+               int samplesPerBlock, Levels& result);
+
+    //==============================================================================
+    /** Sets the smallest number of samples that will be given to a thread in one go.
+
+        Each thread has to open its own reader and seek to the start of its chunk, so
+        chunks that are too small will waste time doing that. The default is 262144.
+    */
+    void setMinimumChunkSize (int64 numSamples) noexcept;
+
+    /** Returns the value that was set with setMinimumChunkSize(). */
+    int64 getMinimumChunkSize() const noexcept                  { return minimumChunkSize; }
+
+    //==============================================================================
+    /** Measures the levels of some blocks of samples on the calling thread, using a
+        reader that has already been opened. This is what each thread does with the
+        chunks that it's given.
+
+        The ranges and rmsLevels arrays must have enough space for the blocks, with
+        numChannels items for each one. Returns false if the reader fails.
+    */
+    static bool scanBlocks (AudioFormatReader& reader, int numChannels,
+                            int64 startSample, int64 numSamples, int samplesPerBlock,
+                            Range<float>* ranges, float* rmsLevels);
+
+private:
+    //==============================================================================
+    struct ScanState;
+    ThreadPool& pool;
+    int64 minimumChunkSize = 262144;
+
+    bool scan (AudioFormatReader& firstReader, const ReaderFactory& createReader,
+               int64 startSample, int64 numSamples, int samplesPerBlock, Levels& result);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioLevelScanner)
+};
+
+} // namespace juce
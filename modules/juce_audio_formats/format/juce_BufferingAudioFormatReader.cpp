@@ -41,6 +41,9 @@ BufferingAudioReader::BufferingAudioReader (AudioFormatReader* sourceReader,
     bitsPerSample         = 32;
     usesFloatingPointData = true;
 
+    for (int i = 0; i < numBlocks; ++i)
+        blocks.add (new BufferedBlock ((int) numChannels, samplesPerBlock));
+
     for (int i = 3; --i >= 0;)
         readNextBufferChunk();
 
@@ -64,32 +67,18 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
     clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
                                        startSampleInFile, numSamples, lengthInSamples);
 
-    const ScopedLock sl (lock);
     nextReadPosition = startSampleInFile;
 
     while (numSamples > 0)
     {
-        if (auto block = getBlockContaining (startSampleInFile))
-        {
-            auto offset = (int) (startSampleInFile - block->range.getStart());
-            auto numToDo = jmin (numSamples, (int) (block->range.getEnd() - startSampleInFile));
-
-            for (int j = 0; j < numDestChannels; ++j)
-            {
-                if (auto dest = (float*) destSamples[j])
-                {
-                    dest += startOffsetInDestBuffer;
-
-                    if (j < (int) numChannels)
-                        FloatVectorOperations::copy (dest, block->buffer.getReadPointer (j, offset), numToDo);
-                    else
-                        FloatVectorOperations::clear (dest, numToDo);
-                }
-            }
+        auto numDone = copyFromBlocks (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                       startSampleInFile, numSamples);
 
-            startOffsetInDestBuffer += numToDo;
-            startSampleInFile += numToDo;
-            numSamples -= numToDo;
+        if (numDone > 0)
+        {
+            startOffsetInDestBuffer += numDone;
+            startSampleInFile += numDone;
+            numSamples -= numDone;
         }
         else
         {
@@ -103,7 +92,6 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
             }
             else
             {
-                ScopedUnlock ul (lock);
                 Thread::yield();
             }
         }
@@ -112,20 +100,63 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
     return true;
 }
 
-BufferingAudioReader::BufferedBlock::BufferedBlock (AudioFormatReader& reader, int64 pos, int numSamples)
-    : range (pos, pos + numSamples),
-      buffer ((int) reader.numChannels, numSamples)
+BufferingAudioReader::BufferedBlock::BufferedBlock (int numChannelsToUse, int numSamples)
+    : buffer (numChannelsToUse, numSamples)
 {
-    reader.read (&buffer, 0, numSamples, pos, true, true);
 }
 
-BufferingAudioReader::BufferedBlock* BufferingAudioReader::getBlockContaining (int64 pos) const noexcept
+int BufferingAudioReader::copyFromBlocks (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                          int64 startSampleInFile, int numSamples) const noexcept
 {
-    for (auto* b : blocks)
-        if (b->range.contains (pos))
-            return b;
+    // If the background thread reuses the block while its samples are being copied, the
+    // search is tried again, but it gives up rather than keeping the caller waiting
+    for (int attempts = 8; --attempts >= 0;)
+    {
+        bool wasOverwritten = false;
+
+        for (auto* block : blocks)
+        {
+            auto version = block->version.load();
+
+            if ((version & 1) != 0)
+                continue;
 
-    return nullptr;
+            Range<int64> range (block->start.load(), block->end.load());
+
+            if (! range.contains (startSampleInFile))
+                continue;
+
+            auto offset = (int) (startSampleInFile - range.getStart());
+            auto numToDo = jmin (numSamples, (int) (range.getEnd() - startSampleInFile));
+
+            for (int j = 0; j < numDestChannels; ++j)
+            {
+                if (auto dest = (float*) destSamples[j])
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    if (j < (int) numChannels)
+                        FloatVectorOperations::copy (dest, block->buffer.getReadPointer (j, offset), numToDo);
+                    else
+                        FloatVectorOperations::clear (dest, numToDo);
+                }
+            }
+
+            // The fence stops the reads of the samples being moved after the version check
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if (block->version.load() == version)
+                return numToDo;
+
+            wasOverwritten = true;
+            break;
+        }
+
+        if (! wasOverwritten)
+            break;
+    }
+
+    return 0;
 }
 
 int BufferingAudioReader::useTimeSlice()
@@ -138,37 +169,168 @@ bool BufferingAudioReader::readNextBufferChunk()
     auto pos = nextReadPosition.load();
     auto startPos = ((pos - 1024) / samplesPerBlock) * samplesPerBlock;
     auto endPos = startPos + numBlocks * samplesPerBlock;
+    Range<int64> rangeNeeded (startPos, endPos);
 
-    OwnedArray<BufferedBlock> newBlocks;
+    // (this is the only thread that changes the blocks, so it can read their ranges directly)
+    for (auto p = startPos; p < endPos; p += samplesPerBlock)
+    {
+        auto isAlreadyRead = std::any_of (blocks.begin(), blocks.end(),
+                                          [p] (const BufferedBlock* b) { return b->start.load() == p && b->end.load() > p; });
 
-    for (int i = blocks.size(); --i >= 0;)
-        if (blocks.getUnchecked(i)->range.intersects (Range<int64> (startPos, endPos)))
-            newBlocks.add (blocks.getUnchecked(i));
+        if (isAlreadyRead)
+            continue;
 
-    if (newBlocks.size() == numBlocks)
-    {
-        newBlocks.clear (false);
-        return false;
+        // There's one block for each position in the range that's needed, so if one of the
+        // positions is missing, there's always a block outside the range that can be reused
+        for (auto* block : blocks)
+        {
+            if (! Range<int64> (block->start.load(), block->end.load()).intersects (rangeNeeded))
+            {
+                readBlock (*block, p);
+                return true; // just do one block
+            }
+        }
+
+        jassertfalse;
+        break;
     }
 
-    for (auto p = startPos; p < endPos; p += samplesPerBlock)
+    return false;
+}
+
+void BufferingAudioReader::readBlock (BufferedBlock& block, int64 pos)
+{
+    // An odd version tells readSamples() that the block is being rewritten, and makes any
+    // copy that's already in progress fail its check
+    ++block.version;
+    std::atomic_thread_fence (std::memory_order_release);
+
+    source->read (&block.buffer, 0, samplesPerBlock, pos, true, true);
+
+    block.start = pos;
+    block.end = pos + samplesPerBlock;
+    ++block.version;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct BufferingAudioReaderTests  : public UnitTest
+{
+    BufferingAudioReaderTests() : UnitTest ("BufferingAudioReader", "Audio") {}
+
+    // Each sample holds its position plus one, so that a sample that was copied from the
+    // wrong block can be spotted, and silence can't be mistaken for data
+    struct RampReader  : public AudioFormatReader
     {
-        if (getBlockContaining (p) == nullptr)
+        RampReader() : AudioFormatReader (nullptr, "Ramp")
+        {
+            sampleRate = 44100.0;
+            lengthInSamples = 1 << 22;
+            numChannels = 2;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
         {
-            newBlocks.add (new BufferedBlock (*source, p, samplesPerBlock));
-            break; // just do one block
+            for (int i = 0; i < numSamples; ++i)
+            {
+                for (int ch = 0; ch < numDestChannels; ++ch)
+                    if (auto dest = (float*) destSamples[ch])
+                        dest[startOffsetInDestBuffer + i] = (float) (startSampleInFile + i + 1);
+
+                // takes its time, so that the blocks spend longer being overwritten
+                if (i % 1024 == 0)
+                    Thread::yield();
+            }
+
+            return true;
+        }
+    };
+
+    // Returns the number of samples that held the right data, or -1 if any of them came
+    // from the wrong position
+    static int countCorrectSamples (const AudioBuffer<float>& buffer, int64 position)
+    {
+        int numCorrect = 0;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                auto value = buffer.getSample (ch, i);
+
+                if (value == (float) (position + i + 1))
+                    ++numCorrect;
+                else if (value != 0.0f)
+                    return -1;
+            }
         }
+
+        return numCorrect;
     }
 
+    void runTest() override
     {
-        const ScopedLock sl (lock);
-        newBlocks.swapWith (blocks);
+        TimeSliceThread thread ("BufferingAudioReader test");
+        thread.startThread();
+
+        BufferingAudioReader reader (new RampReader(), thread, 65536);
+        AudioBuffer<float> buffer (2, 4096);
+
+        beginTest ("Reads wait for the data when there's no timeout");
+        {
+            reader.setReadTimeout (-1);
+
+            for (int i = 0; i < 100; ++i)
+            {
+                auto position = i * (int64) 3000;
+                reader.read (&buffer, 0, buffer.getNumSamples(), position, true, true);
+
+                if (countCorrectSamples (buffer, position) != buffer.getNumSamples() * 2)
+                {
+                    expect (false, "read " + String (i));
+                    break;
+                }
+            }
+        }
+
+        beginTest ("Reads never mix up data from different positions");
+        {
+            reader.setReadTimeout (0);
+            auto random = getRandom();
+            int numReadsWithData = 0;
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                // jumping around a small area keeps the background thread reusing the
+                // blocks that are being read from
+                auto position = (int64) random.nextInt (1 << 18);
+                reader.read (&buffer, 0, buffer.getNumSamples(), position, true, true);
+                auto numCorrect = countCorrectSamples (buffer, position);
+
+                if (numCorrect < 0)
+                {
+                    expect (false, "read " + String (i));
+                    break;
+                }
+
+                if (numCorrect > 0)
+                    ++numReadsWithData;
+
+                if (i % 4 == 0)
+                    Thread::yield();
+            }
+
+            expect (numReadsWithData > 0);
+        }
     }
+};
 
-    for (int i = blocks.size(); --i >= 0;)
-        newBlocks.removeObject (blocks.getUnchecked(i), false);
+static BufferingAudioReaderTests bufferingAudioReaderTests;
 
-    return true;
-}
+#endif
 
 } // namespace juce
@@ -32,6 +32,9 @@ namespace juce
     An AudioFormatReader that uses a background thread to pre-read data from
     another reader.
 
+    Its readSamples() method doesn't take any locks or allocate any memory, so it can
+    be called from the audio thread.
+
     @see AudioFormatReader
 
     @tags{Audio}
@@ -75,20 +78,27 @@ private:
 
     enum { samplesPerBlock = 32768 };
 
+    /*  The blocks are all allocated up-front, and the background thread reuses the ones
+        that are no longer needed. Each block's range is published with a sequence lock, so
+        that readSamples() can copy from a block without locking, and can tell whether it
+        got reused while the samples were being copied.
+    */
     struct BufferedBlock
     {
-        BufferedBlock (AudioFormatReader& reader, int64 pos, int numSamples);
+        BufferedBlock (int numChannelsToUse, int numSamples);
 
-        Range<int64> range;
+        std::atomic<uint32> version { 0 };
+        std::atomic<int64> start { 0 }, end { 0 };
         AudioBuffer<float> buffer;
     };
 
-    CriticalSection lock;
     OwnedArray<BufferedBlock> blocks;
 
-    BufferedBlock* getBlockContaining (int64 pos) const noexcept;
+    int copyFromBlocks (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                        int64 startSampleInFile, int numSamples) const noexcept;
     int useTimeSlice() override;
     bool readNextBufferChunk();
+    void readBlock (BufferedBlock&, int64 pos);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferingAudioReader)
 };
@@ -54,10 +54,13 @@
 
 //==============================================================================
 #include "format/juce_AudioFormat.cpp"
+#include "format/juce_AudioFormatDecodeCache.cpp"
 #include "format/juce_AudioFormatManager.cpp"
 #include "format/juce_AudioFormatReader.cpp"
 #include "format/juce_AudioFormatReaderSource.cpp"
+#include "format/juce_AudioFormatSeekIndex.cpp"
 #include "format/juce_AudioFormatWriter.cpp"
+#include "format/juce_AudioLevelScanner.cpp"
 #include "format/juce_AudioSubsectionReader.cpp"
 #include "format/juce_BufferingAudioFormatReader.cpp"
 #include "sampler/juce_Sampler.cpp"
@@ -112,9 +112,12 @@
 //==============================================================================
 #include "format/juce_AudioFormatReader.h"
 #include "format/juce_AudioFormatWriter.h"
+#include "format/juce_AudioFormatSeekIndex.h"
 #include "format/juce_MemoryMappedAudioFormatReader.h"
 #include "format/juce_AudioFormat.h"
 #include "format/juce_AudioFormatManager.h"
+#include "format/juce_AudioFormatDecodeCache.h"
+#include "format/juce_AudioLevelScanner.h"
 #include "format/juce_AudioFormatReaderSource.h"
 #include "format/juce_AudioSubsectionReader.h"
 #include "format/juce_BufferingAudioFormatReader.h"
@@ -53,6 +53,37 @@ SamplerSound::SamplerSound (const String& soundName,
     }
 }
 
+SamplerSound::SamplerSound (const String& soundName,
+                            ReaderFactory createReaderToStream,
+                            const BigInteger& notes,
+                            int midiNoteForNormalPitch,
+                            double attackTimeSecs,
+                            double releaseTimeSecs,
+                            double preloadTimeSecs)
+    : name (soundName),
+      sourceSampleRate (0),
+      midiNotes (notes),
+      midiRootNote (midiNoteForNormalPitch)
+{
+    std::unique_ptr<AudioFormatReader> reader (createReaderToStream != nullptr ? createReaderToStream() : nullptr);
+
+    if (reader != nullptr && reader->sampleRate > 0 && reader->lengthInSamples > 0)
+    {
+        sourceSampleRate = reader->sampleRate;
+        length = (int) jmin ((int64) std::numeric_limits<int>::max() - 4, reader->lengthInSamples);
+
+        auto preloadLength = jlimit (0, length, (int) (preloadTimeSecs * sourceSampleRate));
+        data.reset (new AudioBuffer<float> (jmin (2, (int) reader->numChannels), preloadLength + 4));
+
+        reader->read (data.get(), 0, preloadLength + 4, 0, true, true);
+
+        attackSamples  = roundToInt (attackTimeSecs  * sourceSampleRate);
+        releaseSamples = roundToInt (releaseTimeSecs * sourceSampleRate);
+
+        createStreamReader = std::move (createReaderToStream);
+    }
+}
+
 SamplerSound::~SamplerSound()
 {
 }
@@ -67,13 +98,174 @@ bool SamplerSound::appliesToChannel (int /*midiChannel*/)
     return true;
 }
 
+//==============================================================================
+/*  Reads a streamed sound into a ring buffer ahead of the voice that's playing it.
+
+    The voice plays the preloaded part of the sound while the first part of the ring
+    gets filled. Each time a note starts, the generation number changes, and the voice
+    only trusts the data in the ring once the background thread has caught up with the
+    new generation. The voice publishes how far it has got through the sound, and the
+    background thread never writes over the part of the ring that's after that point.
+
+    The audio thread passes note starts and stops to the background thread through a
+    queue, so it never has to wait for a lock. Each request holds a reference to its
+    sound, and it's the background thread that releases it, so a sound never gets
+    deleted on the audio thread. The background thread keeps its own reader for the
+    sound it's streaming, and keeps it after the note stops, so repeated notes don't
+    need to open the source again.
+*/
+struct SamplerVoice::DiskStream  : public TimeSliceClient
+{
+    DiskStream (TimeSliceThread& t)  : thread (t), ring (2, ringSize)
+    {
+        ring.clear();
+        thread.addTimeSliceClient (this);
+    }
+
+    ~DiskStream()
+    {
+        thread.removeTimeSliceClient (this);
+    }
+
+    enum { ringSize = 32768, margin = 8, maxPendingRequests = 32 };
+
+    //==============================================================================
+    // These are called by the voice on the audio thread
+    void start (SamplerSound* soundToStream, int64 firstSampleToStream) noexcept
+    {
+        playPosition = firstSampleToStream;
+        currentGeneration = ++generation;
+
+        // If the queue is full, the background thread never catches up with this
+        // generation, and the note plays as silence once its preloaded part has run out.
+        // The voice still holds a reference to the sound, so dropping the request here
+        // doesn't delete it.
+        if (! requests.push ({ soundToStream, firstSampleToStream, currentGeneration }))
+            jassertfalse;
+    }
+
+    void stop() noexcept
+    {
+        currentGeneration = ++generation;
+        requests.push ({ nullptr, 0, currentGeneration });
+    }
+
+    /** Returns the end of the range of samples in the ring that can be played. */
+    int64 getValidEnd() const noexcept
+    {
+        auto gen1 = filledGeneration.load();
+        auto end = filledEnd.load();
+        auto gen2 = filledGeneration.load();
+
+        return (gen1 == currentGeneration && gen2 == currentGeneration) ? end : 0;
+    }
+
+    void setPlayPosition (int64 position) noexcept
+    {
+        playPosition = jmax (playPosition.load(), position);
+    }
+
+    //==============================================================================
+    int useTimeSlice() override
+    {
+        handlePendingRequests();
+
+        if (! isFilling)
+            return 10;
+
+        auto limit = jmin (jmax (playPosition.load(), streamStart) + ringSize - margin,
+                           (int64) static_cast<SamplerSound*> (sound.get())->length + 4);
+
+        if (fillPosition >= limit)
+            return 5;
+
+        auto numToRead = (int) jmin (limit - fillPosition, (int64) 4096);
+        auto ringIndex = (int) (fillPosition & (ringSize - 1));
+        auto numBeforeWrap = jmin (numToRead, ringSize - ringIndex);
+
+        reader->read (&ring, ringIndex, numBeforeWrap, fillPosition, true, true);
+
+        if (numBeforeWrap < numToRead)
+            reader->read (&ring, 0, numToRead - numBeforeWrap, fillPosition + numBeforeWrap, true, true);
+
+        fillPosition += numToRead;
+        filledEnd = fillPosition;
+
+        return fillPosition < limit ? 0 : 1;
+    }
+
+    void handlePendingRequests()
+    {
+        Request request;
+        bool gotRequest = false;
+
+        // Only the most recent request matters, but the older ones still need to be
+        // taken out of the queue so that their sounds get released on this thread.
+        while (requests.pop (request))
+            gotRequest = true;
+
+        if (! gotRequest)
+            return;
+
+        if (request.sound == nullptr)
+        {
+            isFilling = false;
+            return;
+        }
+
+        if (request.sound != sound)
+        {
+            reader.reset();
+            sound = std::move (request.sound);
+            reader.reset (static_cast<SamplerSound*> (sound.get())->createStreamReader());
+        }
+
+        isFilling = (reader != nullptr);
+        streamStart = request.start;
+        fillPosition = request.start;
+        filledEnd = request.start;
+        filledGeneration = request.generation;
+    }
+
+    //==============================================================================
+    struct Request
+    {
+        SynthesiserSound::Ptr sound;
+        int64 start = 0, generation = 0;
+    };
+
+    TimeSliceThread& thread;
+    AudioBuffer<float> ring;
+    SPSCQueue<Request> requests { maxPendingRequests };
+
+    int64 generation = 0, currentGeneration = 0;                        // (only used by the audio thread)
+
+    SynthesiserSound::Ptr sound;                                        // (only used by the background thread)
+    std::unique_ptr<AudioFormatReader> reader;
+    int64 streamStart = 0, fillPosition = 0;
+    bool isFilling = false;
+
+    std::atomic<int64> filledGeneration { -1 }, filledEnd { 0 }, playPosition { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (DiskStream)
+};
+
 //==============================================================================
 SamplerVoice::SamplerVoice() {}
+
+SamplerVoice::SamplerVoice (TimeSliceThread& streamingThread)
+    : stream (new DiskStream (streamingThread))
+{
+}
+
 SamplerVoice::~SamplerVoice() {}
 
 bool SamplerVoice::canPlaySound (SynthesiserSound* sound)
 {
-    return dynamic_cast<const SamplerSound*> (sound) != nullptr;
+    if (auto* s = dynamic_cast<const SamplerSound*> (sound))
+        return stream != nullptr || ! s->isStreaming();
+
+    return false;
 }
 
 void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSound* s, int /*currentPitchWheelPosition*/)
@@ -85,6 +277,12 @@ void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSou
 
         sourceSamplePosition = 0.0;
         lgain = velocity;
+
+        if (sound->isStreaming())
+        {
+            jassert (stream != nullptr); // this voice needs a thread to play streamed sounds!
+            stream->start (const_cast<SamplerSound*> (sound), sound->data->getNumSamples() - 4);
+        }
         rgain = velocity;
 
         isInAttack = (sound->attackSamples > 0);
@@ -122,6 +320,9 @@ void SamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
     else
     {
         clearCurrentNote();
+
+        if (stream != nullptr)
+            stream->stop();
     }
 }
 
@@ -137,6 +338,27 @@ void SamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startS
         const float* const inL = data.getReadPointer (0);
         const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer (1) : nullptr;
 
+        // For a streamed sound, the samples after the preloaded ones come from the stream's
+        // ring buffer. If they haven't been read in time, they're played as silence.
+        auto numPreloaded = data.getNumSamples();
+        const float* streamL = nullptr;
+        const float* streamR = nullptr;
+        int64 streamEnd = 0;
+
+        if (playingSound->isStreaming())
+        {
+            streamL = stream->ring.getReadPointer (0);
+            streamR = inR != nullptr ? stream->ring.getReadPointer (1) : nullptr;
+            streamEnd = stream->getValidEnd();
+        }
+
+        auto getSample = [=] (const float* preloaded, const float* streamed, int index) noexcept
+        {
+            if (index < numPreloaded)   return preloaded[index];
+            if (index < streamEnd)      return streamed[index & (DiskStream::ringSize - 1)];
+            return 0.0f;
+        };
+
         float* outL = outputBuffer.getWritePointer (0, startSample);
         float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
 
@@ -147,9 +369,20 @@ void SamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startS
             auto invAlpha = 1.0f - alpha;
 
             // just using a very simple linear interpolation here..
-            float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha)
-                                       : l;
+            float l, r;
+
+            if (pos + 1 < numPreloaded)
+            {
+                l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
+                r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha)
+                                     : l;
+            }
+            else
+            {
+                l = (getSample (inL, streamL, pos) * invAlpha + getSample (inL, streamL, pos + 1) * alpha);
+                r = (inR != nullptr) ? (getSample (inR, streamR, pos) * invAlpha + getSample (inR, streamR, pos + 1) * alpha)
+                                     : l;
+            }
 
             l *= lgain;
             r *= rgain;
@@ -199,7 +432,159 @@ void SamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startS
                 break;
             }
         }
+
+        if (stream != nullptr && isVoiceActive())
+            stream->setPlayPosition ((int64) sourceSamplePosition);
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct SamplerTests  : public UnitTest
+{
+    SamplerTests()  : UnitTest ("SamplerSound", "Audio") {}
+
+    enum { blockSize = 512 };
+
+    // Renders some MIDI through a single voice. Instead of starting the thread, this runs
+    // the voice's stream before each block until it's read as far ahead as it can.
+    static AudioBuffer<float> render (SynthesiserSound* sound, TimeSliceThread& thread,
+                                      const MidiBuffer& midi, int numSamples)
+    {
+        Synthesiser synth;
+        auto* voice = new SamplerVoice (thread);
+        synth.addVoice (voice);
+        synth.addSound (sound);
+        synth.setCurrentPlaybackSampleRate (44100.0);
+
+        AudioBuffer<float> output (2, numSamples);
+        output.clear();
+
+        for (int pos = 0; pos < numSamples; pos += blockSize)
+        {
+            auto num = jmin ((int) blockSize, numSamples - pos);
+
+            while (voice->stream->useTimeSlice() == 0)
+            {}
+
+            MidiBuffer blockMidi;
+            blockMidi.addEvents (midi, pos, num, 0);
+            synth.renderNextBlock (output, blockMidi, pos, num);
+        }
+
+        return output;
+    }
+
+    static float getMaxDifference (const AudioBuffer<float>& a, const AudioBuffer<float>& b)
+    {
+        float maxDifference = 0;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxDifference = jmax (maxDifference, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+
+        return maxDifference;
+    }
+
+    void runTest() override
+    {
+        const int numSamples = 100000;
+        MemoryBlock wavData;
+
+        {
+            AudioBuffer<float> buffer (2, numSamples);
+            auto r = getRandom();
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample (ch, i, r.nextFloat() * 2.0f - 1.0f);
+
+            WavAudioFormat wav;
+            std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (wavData, false),
+                                                                             44100.0, 2, 16, {}, 0));
+            writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+        }
+
+        auto createReader = [&wavData]() -> AudioFormatReader*
+        {
+            return WavAudioFormat().createReaderFor (new MemoryInputStream (wavData, false), true);
+        };
+
+        BigInteger notes;
+        notes.setRange (0, 128, true);
+
+        std::unique_ptr<AudioFormatReader> reader (createReader());
+        SynthesiserSound::Ptr inMemory (new SamplerSound ("memory", *reader, notes, 60, 0.01, 0.1, 10.0));
+        SynthesiserSound::Ptr streamed (new SamplerSound ("streamed", createReader, notes, 60, 0.01, 0.1, 0.05));
+
+        TimeSliceThread thread ("Sampler test");
+
+        beginTest ("Streamed sounds match sounds held in memory");
+        {
+            expect (static_cast<SamplerSound*> (streamed.get())->isStreaming());
+            expectEquals (static_cast<SamplerSound*> (streamed.get())->getAudioData()->getNumSamples(), 2205 + 4);
+
+            for (auto note : { 60, 67, 48 })
+            {
+                MidiBuffer midi;
+                midi.addEvent (MidiMessage::noteOn (1, note, 0.8f), 0);
+                midi.addEvent (MidiMessage::noteOff (1, note), 70000);
+
+                auto expected = render (inMemory.get(), thread, midi, 110000);
+                auto actual   = render (streamed.get(), thread, midi, 110000);
+
+                expectGreaterThan (expected.getMagnitude (0, 60000, 1000), 0.1f);
+                expectEquals (getMaxDifference (expected, actual), 0.0f);
+            }
+        }
+
+        beginTest ("Notes that restart while streaming");
+        {
+            MidiBuffer midi;
+
+            for (int i = 0; i < 6; ++i)
+                midi.addEvent (MidiMessage::noteOn (1, 55 + i * 3, 1.0f), i * 15003);
+
+            auto expected = render (inMemory.get(), thread, midi, 120000);
+            auto actual   = render (streamed.get(), thread, midi, 120000);
+
+            expectEquals (getMaxDifference (expected, actual), 0.0f);
+        }
+
+        beginTest ("Sounds are released by the streaming thread");
+        {
+            SynthesiserSound::Ptr other (new SamplerSound ("other", createReader, notes, 60, 0.0, 0.0, 0.05));
+
+            Synthesiser synth;
+            auto* voice = new SamplerVoice (thread);
+            synth.addVoice (voice);
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            AudioBuffer<float> output (2, blockSize);
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0);
+
+            synth.addSound (streamed);
+            synth.renderNextBlock (output, midi, 0, blockSize);
+            voice->stream->useTimeSlice();
+
+            synth.allNotesOff (0, false);
+            synth.clearSounds();
+            expectGreaterThan (streamed->getReferenceCount(), 1);
+
+            synth.addSound (other);
+            synth.renderNextBlock (output, midi, 0, blockSize);
+            expectGreaterThan (streamed->getReferenceCount(), 1);
+
+            voice->stream->useTimeSlice();
+            expectEquals (streamed->getReferenceCount(), 1);
+        }
+    }
+};
+
+static SamplerTests samplerTests;
+
+#endif
+
 } // namespace juce
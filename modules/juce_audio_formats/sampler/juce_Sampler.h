@@ -31,11 +31,13 @@ namespace juce
 /**
     A subclass of SynthesiserSound that represents a sampled audio clip.
 
-    This is a pretty basic sampler, and just attempts to load the whole audio stream
-    into memory.
+    This is a pretty basic sampler, which can either load the whole audio stream
+    into memory, or just load the start of it and stream the rest from the source
+    while it plays.
 
     To use it, create a Synthesiser, add some SamplerVoice objects to it, then
-    give it some SampledSound objects to play.
+    give it some SampledSound objects to play. To play sounds that are streamed,
+    the voices must be created with a TimeSliceThread to do the reading.
 
     @see SamplerVoice, Synthesiser, SynthesiserSound
 
@@ -71,6 +73,48 @@ public:
                   double releaseTimeSecs,
                   double maxSampleLengthSeconds);
 
+    /** A function that creates a new reader for a streamed sound's audio. It can
+        return nullptr if it fails.
+    */
+    using ReaderFactory = std::function<AudioFormatReader*()>;
+
+    /** Creates a sampled sound that streams its audio from a reader while it plays.
+
+        Only the first part of the audio is loaded into memory, so that the voices can
+        start playing it straight away, and the rest is read by the voice's background
+        thread as it's needed. This makes large sample sets much quicker to load, and
+        they use a lot less memory.
+
+        The factory is called once here to read the preloaded part, and then once by
+        each voice that streams the sound, on that voice's thread, so voices never have
+        to wait for each other to finish reading. A voice keeps its reader, and a
+        reference to the sound, until it streams a different sound or is deleted.
+        Readers that open their files with an AsyncFileInputStream or that are
+        memory-mapped work best when a lot of voices are streaming at once.
+
+        @param name         a name for the sample
+        @param createReaderToStream     a function that creates a reader for the audio to play.
+                                        It may be called on any thread
+        @param midiNotes    the set of midi keys that this sound should be played on. This
+                            is used by the SynthesiserSound::appliesToNote() method
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate. All other notes will be pitched
+                                        up or down relative to this one
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+        @param preloadTimeSecs  the length of audio to load into memory, in seconds. This
+                                needs to be long enough to cover the time it takes for the
+                                voice's thread to start reading, at the highest pitch that
+                                the sound will be played at
+    */
+    SamplerSound (const String& name,
+                  ReaderFactory createReaderToStream,
+                  const BigInteger& midiNotes,
+                  int midiNoteForNormalPitch,
+                  double attackTimeSecs,
+                  double releaseTimeSecs,
+                  double preloadTimeSecs);
+
     /** Destructor. */
     ~SamplerSound();
 
@@ -79,10 +123,14 @@ public:
     const String& getName() const noexcept                  { return name; }
 
     /** Returns the audio sample data.
+        For a streamed sound, this only contains the part of the audio that was preloaded.
         This could return nullptr if there was a problem loading the data.
     */
     AudioBuffer<float>* getAudioData() const noexcept       { return data.get(); }
 
+    /** Returns true if this sound streams its audio from a reader as it plays. */
+    bool isStreaming() const noexcept                       { return createStreamReader != nullptr; }
+
 
     //==============================================================================
     bool appliesToNote (int midiNoteNumber) override;
@@ -95,6 +143,7 @@ private:
 
     String name;
     std::unique_ptr<AudioBuffer<float>> data;
+    ReaderFactory createStreamReader;
     double sourceSampleRate;
     BigInteger midiNotes;
     int length = 0, attackSamples = 0, releaseSamples = 0;
@@ -119,9 +168,17 @@ class JUCE_API  SamplerVoice    : public SynthesiserVoice
 {
 public:
     //==============================================================================
-    /** Creates a SamplerVoice. */
+    /** Creates a SamplerVoice.
+        A voice created like this can only play sounds that are held in memory.
+    */
     SamplerVoice();
 
+    /** Creates a SamplerVoice that can also play sounds which are streamed.
+        The thread will be used to read ahead of the voice while it's playing one of
+        them. It must stay alive for as long as the voice does.
+    */
+    explicit SamplerVoice (TimeSliceThread& streamingThread);
+
     /** Destructor. */
     ~SamplerVoice();
 
@@ -139,6 +196,10 @@ public:
 
 private:
     //==============================================================================
+    struct DiskStream;
+    friend struct SamplerTests;
+    std::unique_ptr<DiskStream> stream;
+
     double pitchRatio = 0;
     double sourceSamplePosition = 0;
     float lgain = 0, rgain = 0, attackReleaseLevel = 0, attackDelta = 0, releaseDelta = 0;
@@ -27,8 +27,111 @@
 namespace juce
 {
 
+//==============================================================================
+/*  A set of real-time worker threads which help the audio thread to render the
+    nodes of a graph in parallel.
+
+    For each block, the audio thread opens a job, works on it alongside any workers
+    that pick it up, and then closes it again, which waits for the workers that are
+    still inside the job to leave it. Workers that wake up too late to join in
+    simply go back to sleep.
+*/
+struct GraphRenderThreadPool
+{
+    struct Job
+    {
+        virtual ~Job() {}
+        virtual void runOnWorkerThread() = 0;
+    };
+
+    GraphRenderThreadPool (int numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+            workers.add (new Worker (*this, i));
+
+        for (auto* w : workers)
+            w->startThread (Thread::realtimeAudioPriority);
+    }
+
+    ~GraphRenderThreadPool()
+    {
+        for (auto* w : workers)
+        {
+            w->signalThreadShouldExit();
+            w->notify();
+        }
+
+        for (auto* w : workers)
+            w->stopThread (2000);
+    }
+
+    int getNumThreads() const noexcept      { return workers.size(); }
+
+    void openJob (Job& job) noexcept
+    {
+        currentJob = &job;
+        isAcceptingWorkers = 1;
+
+        for (auto* w : workers)
+            w->notify();
+    }
+
+    void closeJob() noexcept
+    {
+        isAcceptingWorkers = 0;
+
+        while (numWorkersInJob.get() > 0)
+            Thread::yield();
+
+        currentJob = nullptr;
+    }
+
+private:
+    //==============================================================================
+    struct Worker  : public Thread
+    {
+        Worker (GraphRenderThreadPool& p, int index)
+            : Thread ("Graph render thread " + String (index + 1)), pool (p)
+        {
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wait (-1);
+
+                if (! threadShouldExit())
+                    pool.runCurrentJob();
+            }
+        }
+
+        GraphRenderThreadPool& pool;
+
+        JUCE_DECLARE_NON_COPYABLE (Worker)
+    };
+
+    void runCurrentJob()
+    {
+        ++numWorkersInJob;
+
+        if (isAcceptingWorkers.get() != 0)
+            if (auto* job = currentJob.get())
+                job->runOnWorkerThread();
+
+        --numWorkersInJob;
+    }
+
+    OwnedArray<Worker> workers;
+    Atomic<Job*> currentJob { nullptr };
+    Atomic<int> isAcceptingWorkers { 0 }, numWorkersInJob { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (GraphRenderThreadPool)
+};
+
+//==============================================================================
 template <typename FloatType>
-struct GraphRenderSequence
+struct GraphRenderSequence  : private GraphRenderThreadPool::Job
 {
     GraphRenderSequence() {}
 
@@ -63,7 +166,7 @@ struct GraphRenderSequence
         }
 
         currentAudioInputBuffer = &buffer;
-        currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
+        currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples, false, false, true);
         currentAudioOutputBuffer.clear();
         currentMidiInputBuffer = &midiMessages;
         currentMidiOutputBuffer.clear();
@@ -71,8 +174,11 @@ struct GraphRenderSequence
         {
             const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples };
 
-            for (auto* op : renderOps)
-                op->perform (context);
+            if (isRenderingInParallel())
+                performOpsInParallel (context);
+            else
+                for (auto* op : renderOps)
+                    op->perform (context);
         }
 
         for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -85,70 +191,112 @@ struct GraphRenderSequence
 
     void addClearChannelOp (int index)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); });
+        createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); },
+                  {}, { audioResource (index) });
     }
 
     void addCopyChannelOp (int srcIndex, int dstIndex)
     {
         createOp ([=] (const Context& c)    { FloatVectorOperations::copy (c.audioBuffers[dstIndex],
                                                                            c.audioBuffers[srcIndex],
-                                                                           c.numSamples); });
+                                                                           c.numSamples); },
+                  { audioResource (srcIndex) }, { audioResource (dstIndex) });
     }
 
     void addAddChannelOp (int srcIndex, int dstIndex)
     {
         createOp ([=] (const Context& c)    { FloatVectorOperations::add (c.audioBuffers[dstIndex],
                                                                           c.audioBuffers[srcIndex],
-                                                                          c.numSamples); });
+                                                                          c.numSamples); },
+                  { audioResource (srcIndex), audioResource (dstIndex) }, { audioResource (dstIndex) });
     }
 
     void addClearMidiBufferOp (int index)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); });
+        createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); },
+                  {}, { midiResource (index) });
     }
 
     void addCopyMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
+        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; },
+                  { midiResource (srcIndex) }, { midiResource (dstIndex) });
     }
 
     void addAddMidiBufferOp (int srcIndex, int dstIndex)
     {
         createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
-                                                                                 0, c.numSamples, 0); });
+                                                                                 0, c.numSamples, 0); },
+                  { midiResource (srcIndex), midiResource (dstIndex) }, { midiResource (dstIndex) });
     }
 
     void addDelayChannelOp (int chan, int delaySize)
     {
-        renderOps.add (new DelayChannelOp (chan, delaySize));
+        addOp (new DelayChannelOp (chan, delaySize),
+               { audioResource (chan) }, { audioResource (chan) });
     }
 
     void addProcessOp (const AudioProcessorGraph::Node::Ptr& node,
                        const Array<int>& audioChannelsUsed, int totalNumChans, int midiBuffer)
     {
-        renderOps.add (new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer));
+        Array<int> resourcesUsed { midiResource (midiBuffer) };
+
+        for (auto index : audioChannelsUsed)
+            resourcesUsed.addIfNotAlreadyThere (audioResource (index));
+
+        auto resourcesWritten = resourcesUsed;
+
+        if (auto* ioProc = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()))
+        {
+            if (ioProc->getType() == AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode)
+                resourcesWritten.add (graphAudioOutputResource);
+
+            if (ioProc->getType() == AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode)
+                resourcesWritten.add (graphMidiOutputResource);
+        }
+
+        addOp (new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer),
+               resourcesUsed, resourcesWritten);
     }
 
-    void prepareBuffers (int blockSize)
+    bool isRenderingInParallel() const noexcept     { return threadPool != nullptr; }
+
+    // If a previous sequence is supplied, its buffers are taken over so that editing
+    // the graph doesn't need to reallocate them unless more are needed
+    void prepareBuffers (int blockSize, GraphRenderSequence* previous)
     {
-        renderingBuffer.setSize (numBuffersNeeded + 1, blockSize);
+        if (previous != nullptr)
+        {
+            renderingBuffer = std::move (previous->renderingBuffer);
+            currentAudioOutputBuffer = std::move (previous->currentAudioOutputBuffer);
+            midiBuffers.swapWith (previous->midiBuffers);
+            tempMIDI.swapWith (previous->tempMIDI);
+        }
+
+        renderingBuffer.setSize (numBuffersNeeded + 1, blockSize, false, false, true);
         renderingBuffer.clear();
-        currentAudioOutputBuffer.setSize (numBuffersNeeded + 1, blockSize);
+        currentAudioOutputBuffer.setSize (numBuffersNeeded + 1, blockSize, false, false, true);
         currentAudioOutputBuffer.clear();
 
         currentAudioInputBuffer = nullptr;
         currentMidiInputBuffer = nullptr;
         currentMidiOutputBuffer.clear();
 
-        midiBuffers.clearQuick();
         midiBuffers.resize (numMidiBuffersNeeded);
 
         const int defaultMIDIBufferSize = 512;
 
+        tempMIDI.clear();
         tempMIDI.ensureSize (defaultMIDIBufferSize);
 
         for (auto&& m : midiBuffers)
+        {
+            m.clear();
             m.ensureSize (defaultMIDIBufferSize);
+        }
+
+        resourceUsage.clear();
+        readyOps.resize (renderOps.size());
     }
 
     void releaseBuffers()
@@ -172,6 +320,9 @@ struct GraphRenderSequence
     Array<MidiBuffer> midiBuffers;
     MidiBuffer tempMIDI;
 
+    // If this is set, the ops are performed in parallel using these threads
+    GraphRenderThreadPool* threadPool = nullptr;
+
 private:
     //==============================================================================
     struct RenderingOp
@@ -180,14 +331,101 @@ private:
         virtual ~RenderingOp() {}
         virtual void perform (const Context&) = 0;
 
+        // The ops which can't start until this one has finished
+        Array<int> dependentOps;
+        int numDependencies = 0;
+        Atomic<int> numDependenciesRemaining;
+
         JUCE_LEAK_DETECTOR (RenderingOp)
     };
 
     OwnedArray<RenderingOp> renderOps;
 
     //==============================================================================
+    // Each op declares which buffers it reads and writes, so that the ordering which
+    // matters can be kept when the ops are spread across several threads.
+    enum { graphAudioOutputResource, graphMidiOutputResource, numGraphResources };
+
+    static int audioResource (int bufferIndex) noexcept     { return numGraphResources + 2 * bufferIndex; }
+    static int midiResource  (int bufferIndex) noexcept     { return numGraphResources + 2 * bufferIndex + 1; }
+
+    static bool isReadOnlyResource (int resource) noexcept
+    {
+        // Buffer 0 of each kind is the shared empty buffer. The builder never hands it to
+        // an op that could write to it, so nothing needs to wait for anything else to read it.
+        return resource == audioResource (0) || resource == midiResource (0);
+    }
+
+    struct ResourceUsage
+    {
+        int lastWriter = -1;
+        Array<int> readersSinceLastWrite;
+    };
+
+    Array<ResourceUsage> resourceUsage;
+
+    ResourceUsage& getResourceUsage (int resource)
+    {
+        if (resource >= resourceUsage.size())
+            resourceUsage.resize (resource + 1);
+
+        return resourceUsage.getReference (resource);
+    }
+
+    void addOp (RenderingOp* op, const Array<int>& resourcesRead, const Array<int>& resourcesWritten)
+    {
+        auto opIndex = renderOps.size();
+        renderOps.add (op);
+
+        Array<int> dependencies;
+
+        for (auto r : resourcesRead)
+        {
+            if (isReadOnlyResource (r))
+                continue;
+
+            auto& usage = getResourceUsage (r);
+
+            if (usage.lastWriter >= 0)
+                dependencies.addIfNotAlreadyThere (usage.lastWriter);
+        }
+
+        for (auto r : resourcesWritten)
+        {
+            if (isReadOnlyResource (r))
+                continue;
+
+            auto& usage = getResourceUsage (r);
+
+            if (usage.lastWriter >= 0)
+                dependencies.addIfNotAlreadyThere (usage.lastWriter);
+
+            for (auto reader : usage.readersSinceLastWrite)
+                dependencies.addIfNotAlreadyThere (reader);
+        }
+
+        for (auto r : resourcesRead)
+            if (! isReadOnlyResource (r))
+                getResourceUsage (r).readersSinceLastWrite.addIfNotAlreadyThere (opIndex);
+
+        for (auto r : resourcesWritten)
+        {
+            if (! isReadOnlyResource (r))
+            {
+                auto& usage = getResourceUsage (r);
+                usage.lastWriter = opIndex;
+                usage.readersSinceLastWrite.clearQuick();
+            }
+        }
+
+        for (auto d : dependencies)
+            renderOps.getUnchecked (d)->dependentOps.add (opIndex);
+
+        op->numDependencies = dependencies.size();
+    }
+
     template <typename LambdaType>
-    void createOp (LambdaType&& fn)
+    void createOp (LambdaType&& fn, const Array<int>& resourcesRead, const Array<int>& resourcesWritten)
     {
         struct LambdaOp  : public RenderingOp
         {
@@ -197,7 +435,103 @@ private:
             LambdaType function;
         };
 
-        renderOps.add (new LambdaOp (static_cast<LambdaType&&> (fn)));
+        addOp (new LambdaOp (static_cast<LambdaType&&> (fn)), resourcesRead, resourcesWritten);
+    }
+
+    //==============================================================================
+    Array<Atomic<int>> readyOps;
+    Atomic<int> readyOpsStart { 0 }, readyOpsEnd { 0 }, numOpsRemaining { 0 };
+    const Context* currentContext = nullptr;
+
+    void performOpsInParallel (const Context& context)
+    {
+        if (renderOps.isEmpty())
+            return;
+
+        jassert (readyOps.size() == renderOps.size());
+
+        for (auto& index : readyOps)
+            index = -1;
+
+        readyOpsStart = 0;
+        readyOpsEnd = 0;
+        numOpsRemaining = renderOps.size();
+        currentContext = &context;
+
+        for (int i = 0; i < renderOps.size(); ++i)
+        {
+            auto* op = renderOps.getUnchecked (i);
+            op->numDependenciesRemaining = op->numDependencies;
+
+            if (op->numDependencies == 0)
+                pushReadyOp (i);
+        }
+
+        threadPool->openJob (*this);
+        performReadyOps();
+        threadPool->closeJob();
+
+        currentContext = nullptr;
+    }
+
+    void runOnWorkerThread() override
+    {
+        performReadyOps();
+    }
+
+    void performReadyOps()
+    {
+        while (numOpsRemaining.get() > 0)
+        {
+            auto opIndex = popReadyOp();
+
+            if (opIndex < 0)
+            {
+                Thread::yield();
+                continue;
+            }
+
+            auto* op = renderOps.getUnchecked (opIndex);
+            op->perform (*currentContext);
+
+            for (auto dependent : op->dependentOps)
+                if (--(renderOps.getUnchecked (dependent)->numDependenciesRemaining) == 0)
+                    pushReadyOp (dependent);
+
+            --numOpsRemaining;
+        }
+    }
+
+    // Each op is pushed exactly once per block, so the queue never needs to wrap around
+    void pushReadyOp (int opIndex) noexcept
+    {
+        auto slot = (readyOpsEnd += 1) - 1;
+        readyOps.getReference (slot) = opIndex;
+    }
+
+    int popReadyOp() noexcept
+    {
+        for (;;)
+        {
+            auto slot = readyOpsStart.get();
+
+            if (slot >= readyOpsEnd.get())
+                return -1;
+
+            if (readyOpsStart.compareAndSetBool (slot + 1, slot))
+            {
+                auto& index = readyOps.getReference (slot);
+
+                for (;;)
+                {
+                    // the slot has been claimed by a pusher, but may not have been filled in yet
+                    auto opIndex = index.get();
+
+                    if (opIndex >= 0)
+                        return opIndex;
+                }
+            }
+        }
     }
 
     //==============================================================================
@@ -329,6 +663,7 @@ struct RenderSequenceBuilder
     RenderSequenceBuilder (AudioProcessorGraph& g, RenderSequence& s)
         : graph (g), sequence (s)
     {
+        createConnectionLists();
         createOrderedNodeList();
 
         audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
@@ -337,8 +672,14 @@ struct RenderSequenceBuilder
         for (int i = 0; i < orderedNodes.size(); ++i)
         {
             createRenderingOpsForNode (*orderedNodes.getUnchecked(i), i);
-            markAnyUnusedBuffersAsFree (audioBuffers, i);
-            markAnyUnusedBuffersAsFree (midiBuffers, i);
+
+            // When rendering in parallel, buffers aren't recycled, because sharing them would make
+            // otherwise independent branches of the graph wait for each other
+            if (! s.isRenderingInParallel())
+            {
+                markAnyUnusedBuffersAsFree (audioBuffers, i);
+                markAnyUnusedBuffersAsFree (midiBuffers, i);
+            }
         }
 
         graph.setLatencySamples (totalLatency);
@@ -354,6 +695,12 @@ struct RenderSequenceBuilder
     RenderSequence& sequence;
 
     Array<AudioProcessorGraph::Node*> orderedNodes;
+    HashMap<uint32, int> renderingIndices;
+    HashMap<int64, int> lastRenderingIndexUsingOutput;
+
+    // The graph's connections, sorted by source and by destination, so that the
+    // builder can look them up without searching the whole graph each time
+    std::vector<AudioProcessorGraph::Connection> connectionsBySource, connectionsByDestination;
 
     struct AssignedBuffer
     {
@@ -397,26 +744,160 @@ struct RenderSequenceBuilder
     {
         int maxLatency = 0;
 
-        for (auto&& c : graph.getConnections())
-            if (c.destination.nodeID == nodeID)
-                maxLatency = jmax (maxLatency, getNodeDelay (c.source.nodeID));
+        for (auto& c : getConnectionsToNode (nodeID))
+            maxLatency = jmax (maxLatency, getNodeDelay (c.source.nodeID));
 
         return maxLatency;
     }
 
+    //==============================================================================
+    struct ConnectionRange
+    {
+        using Iterator = std::vector<AudioProcessorGraph::Connection>::const_iterator;
+
+        Iterator begin() const noexcept     { return range.first; }
+        Iterator end() const noexcept       { return range.second; }
+
+        std::pair<Iterator, Iterator> range;
+    };
+
+    static bool isEarlierDestination (const AudioProcessorGraph::Connection& a, const AudioProcessorGraph::Connection& b) noexcept
+    {
+        if (a.destination.nodeID != b.destination.nodeID)
+            return a.destination.nodeID < b.destination.nodeID;
+
+        return a.destination.channelIndex < b.destination.channelIndex;
+    }
+
+    void createConnectionLists()
+    {
+        connectionsBySource = graph.getConnections();
+        connectionsByDestination = connectionsBySource;
+
+        // a stable sort keeps each destination's sources in the order the graph lists them
+        std::stable_sort (connectionsByDestination.begin(), connectionsByDestination.end(), isEarlierDestination);
+    }
+
+    ConnectionRange getConnectionsFromNode (NodeID nodeID) const
+    {
+        return { std::equal_range (connectionsBySource.cbegin(), connectionsBySource.cend(),
+                                   AudioProcessorGraph::Connection ({ nodeID, 0 }, {}),
+                                   [] (const AudioProcessorGraph::Connection& a, const AudioProcessorGraph::Connection& b)
+                                   {
+                                       return a.source.nodeID < b.source.nodeID;
+                                   }) };
+    }
+
+    ConnectionRange getConnectionsToNode (NodeID nodeID) const
+    {
+        return { std::equal_range (connectionsByDestination.cbegin(), connectionsByDestination.cend(),
+                                   AudioProcessorGraph::Connection ({}, { nodeID, 0 }),
+                                   [] (const AudioProcessorGraph::Connection& a, const AudioProcessorGraph::Connection& b)
+                                   {
+                                       return a.destination.nodeID < b.destination.nodeID;
+                                   }) };
+    }
+
+    ConnectionRange getConnectionsToChannel (AudioProcessorGraph::NodeAndChannel destination) const
+    {
+        return { std::equal_range (connectionsByDestination.cbegin(), connectionsByDestination.cend(),
+                                   AudioProcessorGraph::Connection ({}, destination),
+                                   isEarlierDestination) };
+    }
+
     //==============================================================================
     void createOrderedNodeList()
     {
-        for (auto* node : graph.getNodes())
+        auto& nodes = graph.getNodes();
+
+        HashMap<uint32, int> nodeIndices;
+
+        for (int i = 0; i < nodes.size(); ++i)
+            nodeIndices.set (nodes.getUnchecked (i)->nodeID.uid, i);
+
+        // This is a topological sort (Kahn's algorithm), so it takes O (nodes + connections).
+        // A node is ready to go into the list once all the nodes that feed into it are there.
+        std::vector<Array<int>> destinations ((size_t) nodes.size());
+        std::vector<int> numSourcesNotInList ((size_t) nodes.size(), 0);
+
+        for (auto& c : connectionsBySource)
         {
-            int j = 0;
+            auto source = nodeIndices[c.source.nodeID.uid];
+            auto dest = nodeIndices[c.destination.nodeID.uid];
+            auto& sourceDestinations = destinations[(size_t) source];
 
-            for (; j < orderedNodes.size(); ++j)
-                if (graph.isAnInputTo (*node, *orderedNodes.getUnchecked(j)))
-                  break;
+            // the connections are sorted by source and then destination, so repeats are adjacent
+            if (sourceDestinations.isEmpty() || sourceDestinations.getLast() != dest)
+            {
+                sourceDestinations.add (dest);
+                ++numSourcesNotInList[(size_t) dest];
+            }
+        }
+
+        std::vector<bool> isInList ((size_t) nodes.size(), false);
+        Array<int> orderedIndices;
+        orderedIndices.ensureStorageAllocated (nodes.size());
+
+        auto addToList = [&] (int index)
+        {
+            isInList[(size_t) index] = true;
+            orderedIndices.add (index);
+        };
+
+        for (int i = 0; i < nodes.size(); ++i)
+            if (numSourcesNotInList[(size_t) i] == 0)
+                addToList (i);
+
+        // The list doubles as the queue of nodes whose destinations still need visiting
+        int nextToVisit = 0, firstNodeNotInList = 0;
 
-            orderedNodes.insert (j, node);
+        while (orderedIndices.size() < nodes.size())
+        {
+            if (nextToVisit == orderedIndices.size())
+            {
+                // All the nodes that are left are in or after a feedback loop, so the loop
+                // gets broken at the first of them in the graph's own order
+                while (isInList[(size_t) firstNodeNotInList])
+                    ++firstNodeNotInList;
+
+                addToList (firstNodeNotInList);
+            }
+
+            for (auto dest : destinations[(size_t) orderedIndices.getUnchecked (nextToVisit++)])
+                if (--numSourcesNotInList[(size_t) dest] == 0 && ! isInList[(size_t) dest])
+                    addToList (dest);
         }
+
+        for (auto i : orderedIndices)
+            orderedNodes.add (nodes.getObjectPointerUnchecked (i));
+
+        for (int i = 0; i < orderedNodes.size(); ++i)
+            renderingIndices.set (orderedNodes.getUnchecked (i)->nodeID.uid, i);
+
+        for (auto& c : connectionsBySource)
+        {
+            auto destIndex = renderingIndices[c.destination.nodeID.uid];
+
+            if (isUsedByDestination (c, destIndex))
+            {
+                auto key = getOutputKey (c.source);
+
+                if (! lastRenderingIndexUsingOutput.contains (key) || lastRenderingIndexUsingOutput[key] < destIndex)
+                    lastRenderingIndexUsingOutput.set (key, destIndex);
+            }
+        }
+    }
+
+    static int64 getOutputKey (AudioProcessorGraph::NodeAndChannel output) noexcept
+    {
+        return (int64) ((((uint64) output.nodeID.uid) << 32) | (uint32) output.channelIndex);
+    }
+
+    bool isUsedByDestination (const AudioProcessorGraph::Connection& c, int destIndex) const
+    {
+        return c.source.isMIDI() ? c.destination.isMIDI()
+                                 : isPositiveAndBelow (c.destination.channelIndex,
+                                                       orderedNodes.getUnchecked (destIndex)->getProcessor()->getTotalNumInputChannels());
     }
 
     int findBufferForInputAudioChannel (AudioProcessorGraph::Node& node, const int inputChan,
@@ -658,6 +1139,9 @@ struct RenderSequenceBuilder
             auto index = findBufferForInputAudioChannel (node, inputChan, ourRenderingIndex, maxLatency);
             jassert (index >= 0);
 
+            if (index == readOnlyEmptyBufferIndex)
+                index = getClearedScratchBuffer();
+
             audioChannelsToUse.add (index);
 
             if (inputChan < numOuts)
@@ -673,10 +1157,20 @@ struct RenderSequenceBuilder
             audioBuffers.getReference (index).channel = { node.nodeID, outputChan };
         }
 
+        // a processor with no channels still gets given one
+        if (audioChannelsToUse.isEmpty())
+            audioChannelsToUse.add (getClearedScratchBuffer());
+
         auto midiBufferToUse = findBufferForInputMidiChannel (node, ourRenderingIndex);
 
+        // A processor that doesn't produce MIDI can still write to its buffer, so that buffer can't
+        // be passed on to another node until this one has finished with it. When the graph is
+        // rendered in parallel, this also gives each node its own buffer, so that nodes which
+        // don't use MIDI don't have to wait for each other.
         if (processor.producesMidi())
             midiBuffers.getReference (midiBufferToUse).channel = { node.nodeID, AudioProcessorGraph::midiChannelIndex };
+        else
+            midiBuffers.getReference (midiBufferToUse).setAssignedToNonExistentNode();
 
         delays.set (node.nodeID.uid, maxLatency + processor.getLatencySamples());
 
@@ -690,15 +1184,23 @@ struct RenderSequenceBuilder
     Array<AudioProcessorGraph::NodeAndChannel> getSourcesForChannel (AudioProcessorGraph::Node& node, int inputChannelIndex)
     {
         Array<AudioProcessorGraph::NodeAndChannel> results;
-        AudioProcessorGraph::NodeAndChannel nc { node.nodeID, inputChannelIndex };
 
-        for (auto&& c : graph.getConnections())
-            if (c.destination == nc)
-                results.add (c.source);
+        for (auto& c : getConnectionsToChannel ({ node.nodeID, inputChannelIndex }))
+            results.add (c.source);
 
         return results;
     }
 
+    // Processors are free to write to all of their channels, including input-only ones, so
+    // instead of the shared empty buffer, they get a buffer of their own that's been cleared
+    int getClearedScratchBuffer()
+    {
+        auto index = getFreeBuffer (audioBuffers);
+        audioBuffers.getReference (index).setAssignedToNonExistentNode();
+        sequence.addClearChannelOp (index);
+        return index;
+    }
+
     static int getFreeBuffer (Array<AssignedBuffer>& buffers)
     {
         for (int i = 1; i < buffers.size(); ++i)
@@ -727,34 +1229,34 @@ struct RenderSequenceBuilder
     void markAnyUnusedBuffersAsFree (Array<AssignedBuffer>& buffers, const int stepIndex)
     {
         for (auto& b : buffers)
-            if (b.isAssigned() && ! isBufferNeededLater (stepIndex, -1, b.channel))
-                b.setFree();
+        {
+            if (b.isAssigned())
+            {
+                auto key = getOutputKey (b.channel);
+
+                if (! lastRenderingIndexUsingOutput.contains (key) || lastRenderingIndexUsingOutput[key] < stepIndex)
+                    b.setFree();
+            }
+        }
     }
 
     bool isBufferNeededLater (int stepIndexToSearchFrom,
                               int inputChannelOfIndexToIgnore,
                               AudioProcessorGraph::NodeAndChannel output) const
     {
-        while (stepIndexToSearchFrom < orderedNodes.size())
+        for (auto& c : getConnectionsFromNode (output.nodeID))
         {
-            auto* node = orderedNodes.getUnchecked (stepIndexToSearchFrom);
+            if (c.source.channelIndex != output.channelIndex)
+                continue;
 
-            if (output.isMIDI())
-            {
-                if (inputChannelOfIndexToIgnore != AudioProcessorGraph::midiChannelIndex
-                     && graph.isConnected ({ { output.nodeID, AudioProcessorGraph::midiChannelIndex },
-                                             { node->nodeID,  AudioProcessorGraph::midiChannelIndex } }))
-                    return true;
-            }
-            else
-            {
-                for (int i = 0; i < node->getProcessor()->getTotalNumInputChannels(); ++i)
-                    if (i != inputChannelOfIndexToIgnore && graph.isConnected ({ output, { node->nodeID, i } }))
-                        return true;
-            }
+            auto destIndex = renderingIndices[c.destination.nodeID.uid];
 
-            inputChannelOfIndexToIgnore = -1;
-            ++stepIndexToSearchFrom;
+            if (destIndex < stepIndexToSearchFrom
+                 || (destIndex == stepIndexToSearchFrom && c.destination.channelIndex == inputChannelOfIndexToIgnore))
+                continue;
+
+            if (isUsedByDestination (c, destIndex))
+                return true;
         }
 
         return false;
@@ -866,6 +1368,11 @@ void AudioProcessorGraph::Node::setBypassed (bool shouldBeBypassed) noexcept
 struct AudioProcessorGraph::RenderSequenceFloat   : public GraphRenderSequence<float> {};
 struct AudioProcessorGraph::RenderSequenceDouble  : public GraphRenderSequence<double> {};
 
+struct AudioProcessorGraph::RenderThreadPool  : public GraphRenderThreadPool
+{
+    RenderThreadPool (int numThreads) : GraphRenderThreadPool (numThreads) {}
+};
+
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
 {
@@ -1203,6 +1710,9 @@ void AudioProcessorGraph::buildRenderingSequence()
     std::unique_ptr<RenderSequenceFloat>  newSequenceF (new RenderSequenceFloat());
     std::unique_ptr<RenderSequenceDouble> newSequenceD (new RenderSequenceDouble());
 
+    newSequenceF->threadPool = renderThreadPool.get();
+    newSequenceD->threadPool = renderThreadPool.get();
+
     {
         MessageManagerLock mml;
 
@@ -1210,18 +1720,15 @@ void AudioProcessorGraph::buildRenderingSequence()
         RenderSequenceBuilder<RenderSequenceDouble> builderD (*this, *newSequenceD);
     }
 
-    {
-        const ScopedLock sl (getCallbackLock());
-        newSequenceF->prepareBuffers (getBlockSize());
-        newSequenceD->prepareBuffers (getBlockSize());
-    }
+    std::unique_ptr<RenderSequenceFloat>  oldSequenceF;
+    std::unique_ptr<RenderSequenceDouble> oldSequenceD;
 
     if (anyNodesNeedPreparing())
     {
         {
             const ScopedLock sl (getCallbackLock());
-            renderSequenceFloat.reset();
-            renderSequenceDouble.reset();
+            std::swap (renderSequenceFloat, oldSequenceF);
+            std::swap (renderSequenceDouble, oldSequenceD);
         }
 
         for (auto* node : nodes)
@@ -1230,10 +1737,40 @@ void AudioProcessorGraph::buildRenderingSequence()
 
     const ScopedLock sl (getCallbackLock());
 
+    newSequenceF->prepareBuffers (getBlockSize(), renderSequenceFloat != nullptr ? renderSequenceFloat.get() : oldSequenceF.get());
+    newSequenceD->prepareBuffers (getBlockSize(), renderSequenceDouble != nullptr ? renderSequenceDouble.get() : oldSequenceD.get());
+
     std::swap (renderSequenceFloat, newSequenceF);
     std::swap (renderSequenceDouble, newSequenceD);
 }
 
+void AudioProcessorGraph::rebuild()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    handleUpdateNowIfNeeded();
+}
+
+void AudioProcessorGraph::setNumRenderThreads (int numThreads)
+{
+    numThreads = jmax (0, numThreads);
+
+    if (numThreads == numRenderThreads)
+        return;
+
+    auto wasPrepared = (isPrepared.get() != 0);
+    isPrepared = 0;
+
+    // the old sequences must be gone before the threads they use are deleted
+    clearRenderingSequence();
+
+    renderThreadPool.reset (numThreads > 0 ? new RenderThreadPool (numThreads) : nullptr);
+    numRenderThreads = numThreads;
+
+    if (wasPrepared)
+        triggerAsyncUpdate();
+}
+
 void AudioProcessorGraph::handleAsyncUpdate()
 {
     buildRenderingSequence();
@@ -1498,4 +2035,410 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphTests() : UnitTest ("AudioProcessorGraph", "Audio") {}
+
+    void runTest() override
+    {
+        ScopedJuceInitialiser_GUI libraryInitialiser;
+
+        beginTest ("Parallel rendering matches serial rendering");
+        {
+            auto seed = getRandom().nextInt64();
+
+            for (auto numThreads : { 1, 3, 8 })
+            {
+                AudioProcessorGraph serial, parallel;
+                parallel.setNumRenderThreads (numThreads);
+                expectEquals (parallel.getNumRenderThreads(), numThreads);
+
+                Random serialRandom (seed), parallelRandom (seed);
+                buildTestGraph (serial, serialRandom);
+                buildTestGraph (parallel, parallelRandom);
+
+                expectEquals (parallel.getLatencySamples(), serial.getLatencySamples());
+
+                Random inputRandom (seed);
+
+                for (int block = 0; block < 20; ++block)
+                {
+                    AudioBuffer<float> serialBuffer (2, blockSize), parallelBuffer (2, blockSize);
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < blockSize; ++i)
+                            serialBuffer.setSample (ch, i, inputRandom.nextFloat() * 2.0f - 1.0f);
+
+                    parallelBuffer.makeCopyOf (serialBuffer);
+
+                    MidiBuffer serialMidi, parallelMidi;
+                    serial.processBlock (serialBuffer, serialMidi);
+                    parallel.processBlock (parallelBuffer, parallelMidi);
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        expect (std::memcmp (serialBuffer.getReadPointer (ch), parallelBuffer.getReadPointer (ch),
+                                             sizeof (float) * (size_t) blockSize) == 0);
+                }
+
+                serial.releaseResources();
+                parallel.releaseResources();
+            }
+        }
+
+        beginTest ("Editing a prepared graph gives the same output as building it from scratch");
+        {
+            for (auto numThreads : { 0, 2 })
+            {
+                auto seed = getRandom().nextInt64();
+                AudioProcessorGraph edited, fresh;
+                edited.setNumRenderThreads (numThreads);
+                fresh.setNumRenderThreads (numThreads);
+
+                Random editedRandom (seed), freshRandom (seed), inputRandom (seed);
+                buildTestGraph (edited, editedRandom);
+                buildTestGraph (fresh, freshRandom);
+
+                auto processNoise = [&inputRandom] (AudioProcessorGraph& graph, AudioBuffer<float>& buffer)
+                {
+                    buffer.setSize (2, blockSize);
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < blockSize; ++i)
+                            buffer.setSample (ch, i, inputRandom.nextFloat() * 2.0f - 1.0f);
+
+                    MidiBuffer midi;
+                    graph.processBlock (buffer, midi);
+                };
+
+                AudioBuffer<float> editedBuffer, freshBuffer;
+
+                for (int block = 0; block < 4; ++block)
+                    processNoise (edited, editedBuffer);
+
+                // add a whole extra branch, so that the graph needs more buffers, then take it away again
+                auto& nodes = edited.getNodes();
+                Array<AudioProcessorGraph::NodeID> extraNodes;
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    auto source = nodes[i % 5]->nodeID;
+                    auto node = edited.addNode (new TestProcessor (1.0f, i))->nodeID;
+                    edited.addConnection ({ { source, 0 }, { node, 1 } });
+                    edited.addConnection ({ { node, 0 }, { nodes[1]->nodeID, 0 } });
+                    extraNodes.add (node);
+                }
+
+                edited.rebuild();
+
+                for (int block = 0; block < 4; ++block)
+                    processNoise (edited, editedBuffer);
+
+                for (auto node : extraNodes)
+                    edited.removeNode (node);
+
+                edited.rebuild();
+                edited.reset();
+
+                auto state = inputRandom.nextInt64();
+                inputRandom.setSeed (state);
+                processNoise (edited, editedBuffer);
+                inputRandom.setSeed (state);
+                processNoise (fresh, freshBuffer);
+
+                expectEquals (edited.getLatencySamples(), fresh.getLatencySamples());
+
+                for (int ch = 0; ch < 2; ++ch)
+                    expect (std::memcmp (editedBuffer.getReadPointer (ch), freshBuffer.getReadPointer (ch),
+                                         sizeof (float) * (size_t) blockSize) == 0);
+
+                edited.releaseResources();
+                fresh.releaseResources();
+            }
+        }
+
+        beginTest ("Nodes are rendered after the nodes that feed them");
+        {
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            // a chain whose nodes are added to the graph in a random order
+            const int chainLength = 200;
+            Array<int> renderOrder, positions;
+            Array<AudioProcessorGraph::NodeID> chain;
+            chain.resize (chainLength);
+
+            for (int i = 0; i < chainLength; ++i)
+                positions.add (i);
+
+            auto random = getRandom();
+
+            for (int i = chainLength; --i > 0;)
+                positions.swap (i, random.nextInt (i + 1));
+
+            for (auto position : positions)
+                chain.set (position, graph.addNode (new TestProcessor (2, [&renderOrder, position] (AudioBuffer<float>&)
+                                                                      {
+                                                                          renderOrder.add (position);
+                                                                      }))->nodeID);
+
+            for (int i = 1; i < chainLength; ++i)
+                graph.addConnection ({ { chain[i - 1], i % 2 }, { chain[i], 0 } });
+
+            graph.prepareToPlay (44100.0, blockSize);
+
+            auto renderBlock = [&]
+            {
+                renderOrder.clearQuick();
+                AudioBuffer<float> buffer (2, blockSize);
+                buffer.clear();
+                MidiBuffer midi;
+                graph.processBlock (buffer, midi);
+            };
+
+            renderBlock();
+            expectEquals (renderOrder.size(), chainLength);
+
+            for (int i = 0; i < renderOrder.size(); ++i)
+                expectEquals (renderOrder[i], i);
+
+            // closing the chain into a loop means one of the connections has to become feedback
+            graph.addConnection ({ { chain.getLast(), 0 }, { chain.getFirst(), 1 } });
+            graph.rebuild();
+            renderBlock();
+
+            expectEquals (renderOrder.size(), chainLength);
+            renderOrder.sort();
+
+            for (int i = 0; i < renderOrder.size(); ++i)
+                expectEquals (renderOrder[i], i);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Independent nodes are rendered at the same time");
+        {
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+            AudioProcessorGraph graph;
+            graph.setNumRenderThreads (2);
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            std::atomic<int> numActive { 0 }, maxActive { 0 };
+
+            auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeID;
+            auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeID;
+
+            for (int i = 0; i < 2; ++i)
+            {
+                auto node = graph.addNode (new TestProcessor (2, [&] (AudioBuffer<float>&)
+                {
+                    auto n = ++numActive;
+
+                    for (auto max = maxActive.load(); n > max;)
+                        if (maxActive.compare_exchange_weak (max, n))
+                            break;
+
+                    Thread::sleep (20);
+                    --numActive;
+                }))->nodeID;
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    graph.addConnection ({ { input, ch }, { node, ch } });
+                    graph.addConnection ({ { node, ch }, { output, ch } });
+                }
+            }
+
+            graph.prepareToPlay (44100.0, blockSize);
+
+            for (int block = 0; block < 10 && maxActive.load() < 2; ++block)
+            {
+                AudioBuffer<float> buffer (2, blockSize);
+                buffer.clear();
+                MidiBuffer midi;
+                graph.processBlock (buffer, midi);
+            }
+
+            expectEquals (maxActive.load(), 2);
+            graph.releaseResources();
+        }
+
+        beginTest ("Writing to input-only channels doesn't affect other nodes");
+        {
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+            for (auto numThreads : { 0, 2 })
+            {
+                AudioProcessorGraph graph;
+                graph.setNumRenderThreads (numThreads);
+                graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+                auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeID;
+
+                // Each node has an unconnected third input, which one of them scribbles on
+                // and the other passes on to its outputs, which should stay silent
+                auto writer = graph.addNode (new TestProcessor (3, [] (AudioBuffer<float>& buffer)
+                {
+                    buffer.clear();
+                    FloatVectorOperations::fill (buffer.getWritePointer (2), 1.0f, buffer.getNumSamples());
+                }))->nodeID;
+
+                auto reader = graph.addNode (new TestProcessor (3, [] (AudioBuffer<float>& buffer)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                        buffer.copyFrom (ch, 0, buffer, 2, 0, buffer.getNumSamples());
+                }))->nodeID;
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    graph.addConnection ({ { writer, ch }, { output, ch } });
+                    graph.addConnection ({ { reader, ch }, { output, ch } });
+                }
+
+                graph.prepareToPlay (44100.0, blockSize);
+
+                for (int block = 0; block < 4; ++block)
+                {
+                    AudioBuffer<float> buffer (2, blockSize);
+                    buffer.clear();
+                    MidiBuffer midi;
+                    graph.processBlock (buffer, midi);
+
+                    expectEquals (buffer.getMagnitude (0, blockSize), 0.0f);
+                }
+
+                graph.releaseResources();
+            }
+        }
+
+        beginTest ("Render threads can be changed while prepared");
+        {
+            AudioProcessorGraph graph;
+            Random random (getRandom().nextInt64());
+            buildTestGraph (graph, random);
+
+            for (auto numThreads : { 2, 0, 4 })
+            {
+                graph.setNumRenderThreads (numThreads);
+
+                AudioBuffer<float> buffer (2, blockSize);
+                buffer.clear();
+                MidiBuffer midi;
+                graph.processBlock (buffer, midi);
+
+                expectEquals (graph.getNumRenderThreads(), numThreads);
+            }
+
+            graph.releaseResources();
+        }
+    }
+
+private:
+    enum { blockSize = 256 };
+
+    // A stateful processor with some latency, so that the order in which things happen matters.
+    // It can also be given a function to run instead of its usual processing.
+    struct TestProcessor  : public AudioProcessor
+    {
+        TestProcessor (float g, int latency)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                               .withOutput ("Output", AudioChannelSet::stereo())),
+              gain (g)
+        {
+            setLatencySamples (latency);
+        }
+
+        TestProcessor (int numInputs, std::function<void (AudioBuffer<float>&)> f)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::discreteChannels (numInputs))
+                                               .withOutput ("Output", AudioChannelSet::stereo())),
+              gain (1.0f), function (std::move (f))
+        {
+        }
+
+        const String getName() const override                  { return "Test"; }
+        void prepareToPlay (double, int) override              { reset(); }
+        void reset() override                                  { state[0] = state[1] = 0; }
+        void releaseResources() override                       {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            if (function != nullptr)
+            {
+                function (buffer);
+                return;
+            }
+
+            for (int ch = 0; ch < jmin (2, buffer.getNumChannels()); ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    data[i] = state[ch] = state[ch] * 0.5f + std::tanh (data[i] * gain);
+            }
+        }
+
+        double getTailLengthSeconds() const override           { return 0; }
+        bool acceptsMidi() const override                      { return false; }
+        bool producesMidi() const override                     { return false; }
+        AudioProcessorEditor* createEditor() override          { return nullptr; }
+        bool hasEditor() const override                        { return false; }
+        int getNumPrograms() override                          { return 1; }
+        int getCurrentProgram() override                       { return 0; }
+        void setCurrentProgram (int) override                  {}
+        const String getProgramName (int) override             { return {}; }
+        void changeProgramName (int, const String&) override   {}
+        void getStateInformation (MemoryBlock&) override       {}
+        void setStateInformation (const void*, int) override   {}
+
+        float gain, state[2] = {};
+        std::function<void (AudioBuffer<float>&)> function;
+    };
+
+    static void buildTestGraph (AudioProcessorGraph& graph, Random& random)
+    {
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+        auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeID;
+        auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeID;
+
+        Array<AudioProcessorGraph::NodeID> chainEnds;
+
+        for (int chain = 0; chain < 16; ++chain)
+        {
+            auto previous = input;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                auto node = graph.addNode (new TestProcessor (0.5f + random.nextFloat(), random.nextInt (40)))->nodeID;
+
+                for (int ch = 0; ch < 2; ++ch)
+                    graph.addConnection ({ { previous, ch }, { node, ch } });
+
+                // some cross-links, so that chains have to wait for each other
+                if (i == 1 && ! chainEnds.isEmpty() && random.nextBool())
+                    graph.addConnection ({ { chainEnds[random.nextInt (chainEnds.size())], random.nextInt (2) }, { node, 0 } });
+
+                previous = node;
+            }
+
+            chainEnds.add (previous);
+
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection ({ { previous, ch }, { output, ch } });
+        }
+
+        graph.prepareToPlay (44100.0, blockSize);
+    }
+};
+
+static AudioProcessorGraphTests audioProcessorGraphTests;
+
+#endif
+
 } // namespace juce
@@ -272,6 +272,38 @@ public:
     */
     bool removeIllegalConnections();
 
+    /** Applies any changes that have been made to the graph's nodes or connections.
+
+        Edits to the graph are normally collected together and the rendering sequence
+        is rebuilt asynchronously on the message thread. Calling this rebuilds it straight
+        away if there are edits that haven't been applied yet, which is handy if you've
+        just made a batch of changes and want them to take effect before the next block.
+
+        This must be called on the message thread.
+    */
+    void rebuild();
+
+    //==============================================================================
+    /** Sets the number of extra threads that the graph uses to render its nodes.
+
+        By default this is 0, and the whole graph is rendered on the thread which calls
+        processBlock(). If you give it some threads, it'll create that many real-time
+        worker threads, and independent branches of the graph will be processed on them
+        in parallel, with the calling thread joining in. Everything is joined up again
+        before processBlock() returns.
+
+        Each buffer sees exactly the same operations in the same order as it would when
+        rendering on a single thread, so the output is identical, but be aware that
+        processors in different branches may have their processBlock() methods called
+        concurrently.
+
+        Changing this causes the graph to rebuild its rendering sequence.
+    */
+    void setNumRenderThreads (int numThreads);
+
+    /** Returns the number of threads set by setNumRenderThreads(). */
+    int getNumRenderThreads() const noexcept                        { return numRenderThreads; }
+
     //==============================================================================
     /** A special type of AudioProcessor that can live inside an AudioProcessorGraph
         in order to use the audio that comes into and out of the graph itself.
@@ -388,6 +420,10 @@ private:
     ReferenceCountedArray<Node> nodes;
     NodeID lastNodeID = {};
 
+    struct RenderThreadPool;
+    std::unique_ptr<RenderThreadPool> renderThreadPool;
+    int numRenderThreads = 0;
+
     struct RenderSequenceFloat;
     struct RenderSequenceDouble;
     std::unique_ptr<RenderSequenceFloat> renderSequenceFloat;
@@ -271,6 +271,11 @@ private:
 };
 
 //==============================================================================
+/*  As well as the min/max values for each thumbnail sample, this keeps a pyramid of
+    coarser levels, where each value covers two values from the level below. A range
+    of any length can then be measured by combining a couple of values from each level,
+    so drawing a zoomed-out view doesn't need to look at every thumbnail sample.
+*/
 class AudioThumbnail::ThumbData
 {
 public:
@@ -299,14 +304,18 @@ public:
             int8 mx = -128;
             int8 mn = 127;
 
-            while (startSample <= endSample)
+            for (int level = 0; startSample <= endSample; ++level)
             {
-                auto& v = data.getReference (startSample);
+                auto& values = getLevel (level);
+
+                if ((startSample & 1) != 0)
+                    include (values.getReference (startSample++), mn, mx);
 
-                if (v.getMinValue() < mn)  mn = v.getMinValue();
-                if (v.getMaxValue() > mx)  mx = v.getMaxValue();
+                if ((endSample & 1) == 0 && startSample <= endSample)
+                    include (values.getReference (endSample--), mn, mx);
 
-                ++startSample;
+                startSample >>= 1;
+                endSample >>= 1;
             }
 
             if (mn <= mx)
@@ -321,48 +330,99 @@ public:
 
     void write (const MinMaxValue* values, int startIndex, int numValues)
     {
-        resetPeak();
+        auto firstChanged = startIndex;
 
         if (startIndex + numValues > data.size())
-            ensureSize (startIndex + numValues);
+        {
+            // any padding between the old end and startIndex needs its levels updating too
+            firstChanged = jmin (firstChanged, jmax (0, data.size() - 1));
+            data.insertMultiple (-1, MinMaxValue(), startIndex + numValues - data.size());
+        }
 
         auto* dest = getData (startIndex);
 
         for (int i = 0; i < numValues; ++i)
             dest[i] = values[i];
+
+        updateLevels (firstChanged, startIndex + numValues - 1);
     }
 
-    void resetPeak() noexcept
+    // Must be called after changing any of the values returned by getData()
+    void updateAllLevels()
     {
-        peakLevel = -1;
+        updateLevels (0, data.size() - 1);
     }
 
-    int getPeak() noexcept
+    int getPeak() const noexcept
     {
-        if (peakLevel < 0)
+        if (data.isEmpty())
+            return 0;
+
+        return getLevel (coarserLevels.size()).getReference (0).getPeak();
+    }
+
+private:
+    Array<MinMaxValue> data;
+    Array<Array<MinMaxValue>> coarserLevels;
+
+    const Array<MinMaxValue>& getLevel (int level) const noexcept
+    {
+        return level == 0 ? data : coarserLevels.getReference (level - 1);
+    }
+
+    static void include (const MinMaxValue& v, int8& mn, int8& mx) noexcept
+    {
+        if (v.getMinValue() < mn)  mn = v.getMinValue();
+        if (v.getMaxValue() > mx)  mx = v.getMaxValue();
+    }
+
+    // Recalculates the values in the coarser levels that cover a range of thumbnail samples
+    void updateLevels (int start, int end)
+    {
+        int numLevels = 0;
+
+        for (auto size = data.size(); size > 1; size = (size + 1) / 2)
+            ++numLevels;
+
+        coarserLevels.resize (numLevels);
+
+        for (int level = 1; level <= numLevels && start <= end; ++level)
         {
-            for (auto& s : data)
+            auto& below = getLevel (level - 1);
+            auto& values = coarserLevels.getReference (level - 1);
+            auto size = (below.size() + 1) / 2;
+
+            if (values.size() < size)
+                values.insertMultiple (-1, MinMaxValue(), size - values.size());
+
+            start >>= 1;
+            end = jmin (end >> 1, size - 1);
+
+            for (int i = start; i <= end; ++i)
             {
-                auto peak = s.getPeak();
+                int8 mx = -128;
+                int8 mn = 127;
 
-                if (peak > peakLevel)
-                    peakLevel = peak;
+                include (below.getReference (i * 2), mn, mx);
+
+                if (i * 2 + 1 < below.size())
+                    include (below.getReference (i * 2 + 1), mn, mx);
+
+                values.getReference (i).set (mn, mx);
             }
         }
-
-        return peakLevel;
     }
 
-private:
-    Array<MinMaxValue> data;
-    int peakLevel = -1;
-
     void ensureSize (int thumbSamples)
     {
-        auto extraNeeded = thumbSamples - data.size();
+        auto oldSize = data.size();
+        auto extraNeeded = thumbSamples - oldSize;
 
         if (extraNeeded > 0)
+        {
             data.insertMultiple (-1, MinMaxValue(), extraNeeded);
+            updateLevels (jmax (0, oldSize - 1), data.size() - 1);
+        }
     }
 };
 
@@ -615,6 +675,9 @@ bool AudioThumbnail::loadFrom (InputStream& rawInput)
         for (int chan = 0; chan < numChannels; ++chan)
             channels.getUnchecked(chan)->getData(i)->read (input);
 
+    for (auto* c : channels)
+        c->updateAllLevels();
+
     return true;
 }
 
@@ -823,4 +886,104 @@ void AudioThumbnail::drawChannels (Graphics& g, const Rectangle<int>& area, doub
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioThumbnailTests  : public UnitTest
+{
+    AudioThumbnailTests()  : UnitTest ("AudioThumbnail", "Audio") {}
+
+    // not a Range, because an empty result has its minimum above its maximum
+    using MinAndMax = std::pair<float, float>;
+
+    // With these values, the times that are passed to getApproximateMinMax() map exactly
+    // onto thumbnail samples
+    static constexpr int samplesPerThumbSample = 64;
+    static constexpr double sampleRate = 65536.0;
+
+    static MinAndMax getMinMax (const AudioThumbnail& thumb, int firstThumbSample, int lastThumbSample)
+    {
+        float mn, mx;
+        thumb.getApproximateMinMax (firstThumbSample * samplesPerThumbSample / sampleRate,
+                                    lastThumbSample  * samplesPerThumbSample / sampleRate, 0, mn, mx);
+        return { mn, mx };
+    }
+
+    // Asking for a single thumbnail sample reads it straight from the finest level, so
+    // combining these gives the result that the coarser levels should produce
+    static MinAndMax getMinMaxOneAtATime (const AudioThumbnail& thumb, int firstThumbSample, int lastThumbSample)
+    {
+        auto mn = 1.0f, mx = -1.0f;
+
+        for (int i = firstThumbSample; i <= lastThumbSample; ++i)
+        {
+            auto r = getMinMax (thumb, i, i);
+
+            if (r.first <= r.second)
+            {
+                mn = jmin (mn, r.first);
+                mx = jmax (mx, r.second);
+            }
+        }
+
+        // this is what getApproximateMinMax() gives for a range with no data in it
+        if (mn > mx)
+            return { 1.0f / 128.0f, 0.0f };
+
+        return { mn, mx };
+    }
+
+    void runTest() override
+    {
+        beginTest ("Ranges match a brute-force scan of the thumbnail samples");
+
+        AudioFormatManager formatManager;
+        AudioThumbnailCache cache (1);
+        AudioThumbnail thumb (samplesPerThumbSample, formatManager, cache);
+
+        auto r = getRandom();
+        AudioBuffer<float> buffer (1, 5000);
+        int numThumbSamples = 0;
+
+        // The thumbnail starts off empty. Half of the blocks are added at its end, sometimes
+        // leaving a gap, so that it grows, and the rest overwrite blocks written before.
+        thumb.reset (1, sampleRate, 0);
+
+        for (int block = 0; block < 100; ++block)
+        {
+            auto numSamples = 1 + r.nextInt (buffer.getNumSamples());
+            auto startThumbSample = r.nextBool() ? numThumbSamples + r.nextInt (3)
+                                                 : r.nextInt (numThumbSamples + 1);
+            auto startSample = startThumbSample * (int64) samplesPerThumbSample;
+            // an offset stops the blocks all including zero, which is what the gaps hold
+            auto offset = r.nextFloat() * 1.6f - 0.8f;
+
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (0, i, offset + 0.2f * (r.nextFloat() * 2.0f - 1.0f));
+
+            thumb.addBlock (startSample, buffer, 0, numSamples);
+            numThumbSamples = jmax (numThumbSamples, startThumbSample + (numSamples + samplesPerThumbSample - 1) / samplesPerThumbSample);
+
+            for (int i = 0; i < 20; ++i)
+            {
+                auto first = r.nextInt (numThumbSamples + 10);
+                auto last = first + r.nextInt (numThumbSamples + 10 - first);
+
+                auto expected = getMinMaxOneAtATime (thumb, first, last);
+                auto actual = getMinMax (thumb, first, last);
+
+                if (actual != expected)
+                {
+                    expect (false, "Range " + String (first) + " to " + String (last));
+                    return;
+                }
+            }
+        }
+    }
+};
+
+static AudioThumbnailTests audioThumbnailTests;
+
+#endif
+
 } // namespace juce
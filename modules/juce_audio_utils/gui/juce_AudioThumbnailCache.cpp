@@ -59,6 +59,308 @@ private:
     JUCE_LEAK_DETECTOR (ThumbnailCacheEntry)
 };
 
+//==============================================================================
+/*  Keeps thumbnails in a file that's made up of a short header followed by a list of
+    records, each of which holds a hash code, the time it was last used, and the data.
+    New records are always appended after the last one, and a record with no data marks
+    a thumbnail as removed. When the file is opened, it's mapped into memory and scanned
+    to find the latest record for each hash code, and after that, the records can be
+    read straight out of the mapped memory. Once the file gets too big, it's rewritten
+    with only the most recently-used thumbnails in it.
+
+    The file is kept bigger than the records in it, and new records are written straight
+    into the mapped memory. When there's no room left, the file's size is doubled and it
+    gets mapped again, so that storing a lot of thumbnails doesn't mean remapping the
+    whole file for each one. The unused space is filled with zeros, which reads as a
+    record with no hash, time or data, and marks the end of the list.
+*/
+class AudioThumbnailCache::ThumbnailStore
+{
+public:
+    ThumbnailStore (const File& fileToUse, int64 maxSize)
+        : file (fileToUse), maxSizeInBytes (jmax ((int64) 65536, maxSize))
+    {
+        open();
+    }
+
+    bool load (int64 hash, MemoryBlock& dest)
+    {
+        if (map == nullptr || ! index.contains (hash))
+            return false;
+
+        auto& entry = index.getReference (hash);
+        auto* record = static_cast<char*> (map->getData()) + entry.position;
+
+        entry.lastUsed = Time::currentTimeMillis();
+        auto lastUsed = ByteOrder::swapIfBigEndian ((uint64) entry.lastUsed);
+        memcpy (record + lastUsedOffset, &lastUsed, sizeof (lastUsed));
+
+        dest.replaceWith (record + recordHeaderSize, (size_t) entry.size);
+        return true;
+    }
+
+    void store (int64 hash, const MemoryBlock& data)
+    {
+        if (data.getSize() == 0 || data.getSize() > (size_t) std::numeric_limits<int32>::max())
+            return;
+
+        if (append (hash, Time::currentTimeMillis(), data.getData(), (int) data.getSize()))
+            if (fileSize > maxSizeInBytes)
+                removeLeastRecentlyUsed();
+    }
+
+    void remove (int64 hash)
+    {
+        if (index.contains (hash))
+            append (hash, Time::currentTimeMillis(), nullptr, 0);
+    }
+
+    void clear()
+    {
+        map.reset();
+        index.clear();
+        file.deleteFile();
+        open();
+    }
+
+    const File file;
+
+private:
+    struct Entry
+    {
+        int64 position = 0, lastUsed = 0;
+        int size = 0;
+    };
+
+    enum
+    {
+        fileHeaderSize = 8,
+        lastUsedOffset = 8,
+        sizeOffset = 16,
+        recordHeaderSize = 20
+    };
+
+    static int getMagicHeader() noexcept    { return (int) ByteOrder::littleEndianInt ("jtdb"); }
+    static int getVersion() noexcept        { return 2; }
+
+    const int64 maxSizeInBytes;
+    std::unique_ptr<MemoryMappedFile> map;
+    HashMap<int64, Entry> index;
+    int64 fileSize = 0;
+
+    void open()
+    {
+        map.reset();
+        index.clear();
+        fileSize = 0;
+
+        if (! hasValidHeader() && ! createEmptyFile())
+            return;
+
+        fileSize = scanRecords();
+
+        // This wipes anything after the last valid record, which is either unused space or
+        // a record that didn't get completely written
+        clearUnusedSpace();
+    }
+
+    bool hasValidHeader() const
+    {
+        FileInputStream in (file);
+
+        return in.openedOk()
+                && in.readInt() == getMagicHeader()
+                && in.readInt() == getVersion();
+    }
+
+    bool createEmptyFile() const
+    {
+        file.deleteFile();
+        FileOutputStream out (file);
+
+        return out.openedOk()
+                && out.writeInt (getMagicHeader())
+                && out.writeInt (getVersion());
+    }
+
+    bool remap()
+    {
+        map.reset (new MemoryMappedFile (file, MemoryMappedFile::readWrite));
+
+        if (map->getData() == nullptr)
+        {
+            map.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    void clearUnusedSpace()
+    {
+        if (map != nullptr && (int64) map->getSize() > fileSize)
+            zeromem (static_cast<char*> (map->getData()) + fileSize, (size_t) ((int64) map->getSize() - fileSize));
+    }
+
+    bool ensureSpaceFor (int64 numBytes)
+    {
+        auto sizeNeeded = fileSize + numBytes;
+
+        if (map != nullptr && (int64) map->getSize() >= sizeNeeded)
+            return true;
+
+        auto newSize = jmax (sizeNeeded, jmin (jmax ((int64) 65536, fileSize * 2), maxSizeInBytes));
+        map.reset();
+
+        {
+            FileOutputStream out (file);
+
+            if (! (out.openedOk() && out.setPosition (newSize) && out.truncate().wasOk()))
+            {
+                open();
+                return false;
+            }
+        }
+
+        if (! remap())
+            return false;
+
+        clearUnusedSpace();
+        return true;
+    }
+
+    // Builds the index from the mapped file, and returns the length of the valid part of it
+    int64 scanRecords()
+    {
+        if (! remap())
+            return 0;
+
+        auto* data = static_cast<const char*> (map->getData());
+        auto length = (int64) map->getSize();
+        auto position = (int64) fileHeaderSize;
+
+        while (position + recordHeaderSize <= length)
+        {
+            auto hash = (int64) ByteOrder::littleEndianInt64 (data + position);
+            auto lastUsed = (int64) ByteOrder::littleEndianInt64 (data + position + lastUsedOffset);
+            auto size = (int) ByteOrder::littleEndianInt (data + position + sizeOffset);
+
+            if (size < 0 || position + recordHeaderSize + size > length || (size == 0 && lastUsed == 0))
+                break;
+
+            if (size == 0)
+            {
+                index.remove (hash);
+            }
+            else
+            {
+                Entry entry;
+                entry.position = position;
+                entry.lastUsed = lastUsed;
+                entry.size = size;
+                index.set (hash, entry);
+            }
+
+            position += recordHeaderSize + size;
+        }
+
+        return position;
+    }
+
+    bool append (int64 hash, int64 lastUsed, const void* data, int size)
+    {
+        if (! ensureSpaceFor (recordHeaderSize + size))
+            return false;
+
+        auto* record = static_cast<char*> (map->getData()) + fileSize;
+        auto littleEndianHash = ByteOrder::swapIfBigEndian ((uint64) hash);
+        auto littleEndianLastUsed = ByteOrder::swapIfBigEndian ((uint64) lastUsed);
+        auto littleEndianSize = ByteOrder::swapIfBigEndian ((uint32) size);
+
+        if (size > 0)
+            memcpy (record + recordHeaderSize, data, (size_t) size);
+
+        memcpy (record, &littleEndianHash, sizeof (littleEndianHash));
+        memcpy (record + lastUsedOffset, &littleEndianLastUsed, sizeof (littleEndianLastUsed));
+        memcpy (record + sizeOffset, &littleEndianSize, sizeof (littleEndianSize));
+
+        if (size == 0)
+        {
+            index.remove (hash);
+        }
+        else
+        {
+            Entry entry;
+            entry.position = fileSize;
+            entry.lastUsed = lastUsed;
+            entry.size = size;
+            index.set (hash, entry);
+        }
+
+        fileSize += recordHeaderSize + size;
+        return true;
+    }
+
+    // Rewrites the file with the most recently-used thumbnails that fit into three
+    // quarters of the maximum size, leaving some room before this has to happen again
+    void removeLeastRecentlyUsed()
+    {
+        struct LiveEntry
+        {
+            int64 hash;
+            Entry entry;
+        };
+
+        Array<LiveEntry> entries;
+
+        for (HashMap<int64, Entry>::Iterator i (index); i.next();)
+            entries.add ({ i.getKey(), i.getValue() });
+
+        std::sort (entries.begin(), entries.end(),
+                   [] (const LiveEntry& a, const LiveEntry& b) { return a.entry.lastUsed > b.entry.lastUsed; });
+
+        if (map == nullptr)
+            return;
+
+        TemporaryFile tempFile (file);
+
+        {
+            FileOutputStream out (tempFile.getFile());
+
+            if (! (out.openedOk() && out.writeInt (getMagicHeader()) && out.writeInt (getVersion())))
+                return;
+
+            auto* data = static_cast<const char*> (map->getData());
+            auto size = (int64) fileHeaderSize;
+
+            for (auto& e : entries)
+            {
+                size += recordHeaderSize + e.entry.size;
+
+                if (size > maxSizeInBytes * 3 / 4)
+                    break;
+
+                if (! out.write (data + e.entry.position, (size_t) (recordHeaderSize + e.entry.size)))
+                    return;
+            }
+
+            out.flush();
+
+            if (out.getStatus().failed())
+                return;
+        }
+
+        map.reset();
+
+        if (tempFile.overwriteTargetFileWithTemporary())
+            open();
+        else
+            remap();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThumbnailStore)
+};
+
 //==============================================================================
 AudioThumbnailCache::AudioThumbnailCache (const int maxNumThumbs)
     : thread ("thumb cache"),
@@ -68,6 +370,13 @@ AudioThumbnailCache::AudioThumbnailCache (const int maxNumThumbs)
     thread.startThread (2);
 }
 
+AudioThumbnailCache::AudioThumbnailCache (const int maxNumThumbs, const File& storeFile,
+                                          const int64 maxStoreSizeInBytes)
+    : AudioThumbnailCache (maxNumThumbs)
+{
+    store.reset (new ThumbnailStore (storeFile, maxStoreSizeInBytes));
+}
+
 AudioThumbnailCache::~AudioThumbnailCache()
 {
 }
@@ -113,6 +422,19 @@ bool AudioThumbnailCache::loadThumb (AudioThumbnailBase& thumb, const int64 hash
         return true;
     }
 
+    if (store != nullptr)
+    {
+        MemoryBlock data;
+
+        if (store->load (hashCode, data))
+        {
+            MemoryInputStream in (data, false);
+
+            if (thumb.loadFrom (in))
+                return true;
+        }
+    }
+
     return loadNewThumb (thumb, hashCode);
 }
 
@@ -137,6 +459,9 @@ void AudioThumbnailCache::storeThumb (const AudioThumbnailBase& thumb,
         thumb.saveTo (out);
     }
 
+    if (store != nullptr)
+        store->store (hashCode, te->data);
+
     saveNewlyFinishedThumbnail (thumb, hashCode);
 }
 
@@ -146,6 +471,19 @@ void AudioThumbnailCache::clear()
     thumbs.clear();
 }
 
+void AudioThumbnailCache::clearStoreFile()
+{
+    const ScopedLock sl (lock);
+
+    if (store != nullptr)
+        store->clear();
+}
+
+File AudioThumbnailCache::getStoreFile() const
+{
+    return store != nullptr ? store->file : File();
+}
+
 void AudioThumbnailCache::removeThumb (const int64 hashCode)
 {
     const ScopedLock sl (lock);
@@ -153,6 +491,9 @@ void AudioThumbnailCache::removeThumb (const int64 hashCode)
     for (int i = thumbs.size(); --i >= 0;)
         if (thumbs.getUnchecked(i)->hash == hashCode)
             thumbs.remove (i);
+
+    if (store != nullptr)
+        store->remove (hashCode);
 }
 
 static inline int getThumbnailCacheFileMagicHeader() noexcept
@@ -195,4 +536,209 @@ bool AudioThumbnailCache::loadNewThumb (AudioThumbnailBase&, int64)
     return false;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioThumbnailCacheTests  : public UnitTest
+{
+    AudioThumbnailCacheTests()  : UnitTest ("AudioThumbnailCache", "Audio") {}
+
+    static MemoryBlock getData (const AudioThumbnail& thumb)
+    {
+        MemoryOutputStream out;
+        thumb.saveTo (out);
+        return out.getMemoryBlock();
+    }
+
+    void fillRandomly (AudioThumbnail& thumbToFill)
+    {
+        const int numSamples = 100000;
+        AudioBuffer<float> buffer (2, numSamples);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        thumbToFill.reset (buffer.getNumChannels(), 44100.0, numSamples);
+        thumbToFill.addBlock (0, buffer, 0, numSamples);
+    }
+
+    // Stores a set of random thumbnails under the hash codes 0 to numThumbs - 1
+    void storeThumbs (const File& storeFile, int numThumbs, Array<MemoryBlock>& data)
+    {
+        AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+
+        for (int i = 0; i < numThumbs; ++i)
+        {
+            fillRandomly (*thumb);
+            data.add (getData (*thumb));
+            cache.storeThumb (*thumb, i);
+        }
+    }
+
+    bool isStored (AudioThumbnailCache& cache, int64 hash, const MemoryBlock& expectedData)
+    {
+        if (! cache.loadThumb (*loadedThumb, hash))
+            return false;
+
+        expect (getData (*loadedThumb) == expectedData);
+        return true;
+    }
+
+    bool isStored (const File& storeFile, int64 hash, const MemoryBlock& expectedData)
+    {
+        AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+        return isStored (cache, hash, expectedData);
+    }
+
+    static void overwrite (const File& file, int64 position, const void* data, size_t numBytes)
+    {
+        FileOutputStream out (file);
+        out.setPosition (position);
+        out.write (data, numBytes);
+    }
+
+    void runTest() override
+    {
+        AudioFormatManager formatManager;
+        AudioThumbnailCache thumbCache (1);
+        AudioThumbnail newThumb (64, formatManager, thumbCache), newLoadedThumb (64, formatManager, thumbCache);
+        thumb = &newThumb;
+        loadedThumb = &newLoadedThumb;
+        random = getRandom();
+
+        TemporaryFile temp;
+        auto storeFile = temp.getFile();
+        Array<MemoryBlock> data;
+
+        beginTest ("Thumbnails are kept in the file");
+        {
+            storeThumbs (storeFile, 3, data);
+
+            for (int i = 0; i < 3; ++i)
+                expect (isStored (storeFile, i, data[i]));
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+                cache.removeThumb (1);
+            }
+
+            expect (isStored (storeFile, 0, data[0]));
+            expect (! isStored (storeFile, 1, data[1]));
+            expect (isStored (storeFile, 2, data[2]));
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+                cache.clearStoreFile();
+            }
+
+            expect (! isStored (storeFile, 0, data[0]));
+        }
+
+        const int64 fileHeaderSize = 8, recordHeaderSize = 20;
+
+        beginTest ("A truncated file keeps the complete records");
+        {
+            storeFile.deleteFile();
+            data.clear();
+            storeThumbs (storeFile, 3, data);
+
+            auto recordSize = recordHeaderSize + (int64) data[0].getSize();
+
+            {
+                FileOutputStream out (storeFile);
+                out.setPosition (fileHeaderSize + 2 * recordSize + 10);
+                out.truncate();
+            }
+
+            expect (isStored (storeFile, 0, data[0]));
+            expect (isStored (storeFile, 1, data[1]));
+            expect (! isStored (storeFile, 2, data[2]));
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+                cache.storeThumb (*thumb, 3);
+            }
+
+            expect (isStored (storeFile, 1, data[1]));
+            expect (isStored (storeFile, 3, getData (*thumb)));
+        }
+
+        beginTest ("A corrupt record is dropped along with the ones after it");
+        {
+            storeFile.deleteFile();
+            data.clear();
+            storeThumbs (storeFile, 3, data);
+
+            auto recordSize = recordHeaderSize + (int64) data[0].getSize();
+            const uint32 badSize = 0x7fffffff;
+            overwrite (storeFile, fileHeaderSize + recordSize + 16, &badSize, sizeof (badSize));
+
+            expect (isStored (storeFile, 0, data[0]));
+            expect (! isStored (storeFile, 1, data[1]));
+            expect (! isStored (storeFile, 2, data[2]));
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+                cache.storeThumb (*thumb, 3);
+            }
+
+            expect (isStored (storeFile, 0, data[0]));
+            expect (isStored (storeFile, 3, getData (*thumb)));
+        }
+
+        beginTest ("A file with a bad header is replaced");
+        {
+            overwrite (storeFile, 0, "xxxx", 4);
+
+            expect (! isStored (storeFile, 0, data[0]));
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+                cache.storeThumb (*thumb, 3);
+            }
+
+            expect (isStored (storeFile, 3, getData (*thumb)));
+        }
+
+        beginTest ("The least recently used thumbnails are removed");
+        {
+            storeFile.deleteFile();
+            data.clear();
+
+            {
+                AudioThumbnailCache cache (1, storeFile, maxStoreSize);
+
+                for (int i = 0; i < 30; ++i)
+                {
+                    fillRandomly (*thumb);
+                    data.add (getData (*thumb));
+                    cache.storeThumb (*thumb, i);
+
+                    // using the first thumbnail keeps it in the file
+                    expect (isStored (cache, 0, data[0]));
+                    Thread::sleep (2);
+                }
+            }
+
+            auto recordSize = recordHeaderSize + (int64) data[0].getSize();
+            expect (30 * recordSize > maxStoreSize);
+            expect (storeFile.getSize() <= maxStoreSize + recordSize);
+
+            expect (isStored (storeFile, 0, data[0]));
+            expect (! isStored (storeFile, 1, data[1]));
+            expect (isStored (storeFile, 29, data[29]));
+        }
+    }
+
+    static constexpr int64 maxStoreSize = 65536;
+    AudioThumbnail* thumb = nullptr;
+    AudioThumbnail* loadedThumb = nullptr;
+    Random random;
+};
+
+static AudioThumbnailCacheTests audioThumbnailCacheTests;
+
+#endif
+
 } // namespace juce
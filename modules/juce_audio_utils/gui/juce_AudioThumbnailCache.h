@@ -35,6 +35,9 @@ namespace juce
     that need it, and it maintains a set of low-res previews in memory, to avoid
     having to re-scan audio files too often.
 
+    It can also be given a file in which to keep a copy of every thumbnail that
+    finishes loading, so that they're still available the next time the app runs.
+
     @see AudioThumbnail
 
     @tags{Audio}
@@ -50,13 +53,44 @@ public:
     */
     explicit AudioThumbnailCache (int maxNumThumbsToStore);
 
+    /** Creates a cache object that also keeps the thumbnails in a file on disk.
+
+        Whenever a thumbnail finishes loading, its data is added to the file, and
+        the next time a thumbnail is needed for the same source, it'll be read from
+        there rather than by scanning the audio again. The file is memory-mapped,
+        so looking up a thumbnail is quick even when it holds a very large number
+        of them.
+
+        Once the file grows beyond maxStoreSizeInBytes, the thumbnails that were
+        used least recently are removed from it.
+
+        The thumbnails are identified by the hash codes of their sources. If you're
+        using a FileInputSource, create it with useFileTimeInHashGeneration set to
+        true, so that a file which has been modified gets a new thumbnail.
+
+        @param maxNumThumbsToStore  how many previews should be kept in memory at once
+        @param storeFile            the file to keep the thumbnails in. It'll be created
+                                    if it doesn't exist
+        @param maxStoreSizeInBytes  the size that the file is allowed to grow to
+    */
+    AudioThumbnailCache (int maxNumThumbsToStore, const File& storeFile, int64 maxStoreSizeInBytes);
+
     /** Destructor. */
     virtual ~AudioThumbnailCache();
 
     //==============================================================================
-    /** Clears out any stored thumbnails. */
+    /** Clears out any thumbnails that are stored in memory.
+        This doesn't affect the file that was passed to the constructor - to empty
+        that as well, use clearStoreFile().
+    */
     void clear();
 
+    /** Removes all the thumbnails from the file that was passed to the constructor. */
+    void clearStoreFile();
+
+    /** Returns the file that the thumbnails are being kept in, or File() if there isn't one. */
+    File getStoreFile() const;
+
     /** Reloads the specified thumb if this cache contains the appropriate stored
         data.
 
@@ -106,7 +140,9 @@ private:
     TimeSliceThread thread;
 
     class ThumbnailCacheEntry;
+    class ThumbnailStore;
     OwnedArray<ThumbnailCacheEntry> thumbs;
+    std::unique_ptr<ThumbnailStore> store;
     CriticalSection lock;
     int maxNumThumbsToStore;
 
@@ -0,0 +1,652 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#ifndef DOXYGEN
+/** The open-addressing table that FlatHashMap and FlatHashSet are built on.
+    Each entry type must have a member called "key".
+
+    Alongside the entries, the table keeps one control byte for each slot, which is either
+    empty, deleted, or holds 7 bits of the entry's hash. The slots are arranged in groups
+    of eight, and a lookup reads a group's control bytes as one 64-bit word and compares
+    them all at once, so it rarely has to look at an entry that doesn't match.
+*/
+template <typename EntryType, class HashFunctionType>
+class FlatHashTable
+{
+public:
+    explicit FlatHashTable (HashFunctionType hashFunction)  : hashFunctionToUse (hashFunction) {}
+
+    FlatHashTable (FlatHashTable&& other) noexcept
+        : hashFunctionToUse (other.hashFunctionToUse)
+    {
+        swapWith (other);
+    }
+
+    FlatHashTable& operator= (FlatHashTable&& other) noexcept
+    {
+        clear();
+        swapWith (other);
+        return *this;
+    }
+
+    ~FlatHashTable()
+    {
+        clear();
+    }
+
+    //==============================================================================
+    void clear() noexcept
+    {
+        for (int i = 0; i < capacity; ++i)
+        {
+            if (isFull (control[i]))
+                getEntry (i).~EntryType();
+
+            control[i] = emptyControl;
+        }
+
+        numItems = 0;
+        numDeleted = 0;
+    }
+
+    void reserve (int numItemsNeeded)
+    {
+        auto newCapacity = getCapacityNeededFor (numItemsNeeded);
+
+        if (newCapacity > capacity)
+            rehash (newCapacity);
+    }
+
+    void swapWith (FlatHashTable& other) noexcept
+    {
+        control.swapWith (other.control);
+        slots.swapWith (other.slots);
+        std::swap (capacity, other.capacity);
+        std::swap (numItems, other.numItems);
+        std::swap (numDeleted, other.numDeleted);
+        std::swap (shift, other.shift);
+        std::swap (hashFunctionToUse, other.hashFunctionToUse);
+    }
+
+    //==============================================================================
+    template <typename KeyLike>
+    uint64 getHash (const KeyLike& key) const
+    {
+        // The hash functions are only expected to spread their keys out across the range
+        // they're given, so the result gets scrambled before it's used.
+        return (uint64) (uint32) hashFunctionToUse.generateHash (key, std::numeric_limits<int>::max())
+                 * (uint64) 0x9e3779b97f4a7c15ull;
+    }
+
+    template <typename KeyLike>
+    int findIndex (const KeyLike& key, uint64 hash) const
+    {
+        if (numItems == 0)
+            return -1;
+
+        auto tag = getTag (hash);
+        auto groupMask = (capacity / groupSize) - 1;
+        auto group = getFirstGroup (hash);
+
+        for (int step = 1;; ++step)
+        {
+            auto controlWord = getControlWord (group);
+
+            for (auto matches = findMatchingBytes (controlWord, tag); matches != 0; matches &= matches - 1)
+            {
+                auto index = group * groupSize + getLowestByteIndex (matches);
+
+                if (getEntry (index).key == key)
+                    return index;
+            }
+
+            if (findEmptyBytes (controlWord) != 0)
+                return -1;
+
+            group = (group + step) & groupMask;
+        }
+    }
+
+    template <typename KeyLike>
+    int findIndex (const KeyLike& key) const
+    {
+        return numItems > 0 ? findIndex (key, getHash (key)) : -1;
+    }
+
+    // Adds an entry whose key isn't already in the table, and returns the index it ends up at.
+    int insert (uint64 hash, EntryType&& newEntry)
+    {
+        if ((numItems + numDeleted + 1) * 8 > capacity * 7)
+            rehash (numItems * 2 < capacity ? capacity
+                                            : getCapacityNeededFor (numItems + 1));
+
+        auto index = findFreeSlot (hash);
+
+        if (control[index] == deletedControl)
+            --numDeleted;
+
+        new (&(slots[index])) EntryType (std::move (newEntry));
+        control[index] = getTag (hash);
+        ++numItems;
+        return index;
+    }
+
+    void removeIndex (int index) noexcept
+    {
+        getEntry (index).~EntryType();
+        --numItems;
+
+        // If this slot's group still has an empty slot, then no lookup can have gone past
+        // it, so the slot can be made empty again. Otherwise it has to be marked as deleted,
+        // so that lookups for entries that overflowed from this group keep going.
+        if (findEmptyBytes (getControlWord (index / groupSize)) != 0)
+        {
+            control[index] = emptyControl;
+        }
+        else
+        {
+            control[index] = deletedControl;
+            ++numDeleted;
+        }
+    }
+
+    //==============================================================================
+    int getNextIndex (int index) const noexcept
+    {
+        while (++index < capacity)
+            if (isFull (control[index]))
+                return index;
+
+        return capacity;
+    }
+
+    EntryType& getEntry (int index) const noexcept      { return *reinterpret_cast<EntryType*> (&(slots[index])); }
+
+    static int getCapacityNeededFor (int numItemsNeeded) noexcept
+    {
+        int newCapacity = groupSize;
+
+        while (numItemsNeeded * 8 > newCapacity * 7)
+            newCapacity *= 2;
+
+        return newCapacity;
+    }
+
+    //==============================================================================
+    using Slot = typename std::aligned_storage<sizeof (EntryType), alignof (EntryType)>::type;
+
+    HashFunctionType hashFunctionToUse;
+    HeapBlock<uint8> control;
+    HeapBlock<Slot> slots;
+    int capacity = 0, numItems = 0, numDeleted = 0, shift = 64;
+
+private:
+    enum : uint8
+    {
+        emptyControl   = 0x80,
+        deletedControl = 0xfe
+    };
+
+    enum { groupSize = 8 };
+
+    static constexpr uint64 lowBits  = 0x0101010101010101ull;
+    static constexpr uint64 highBits = 0x8080808080808080ull;
+
+    static bool isFull (uint8 c) noexcept                   { return (c & 0x80) == 0; }
+    static uint8 getTag (uint64 hash) noexcept              { return (uint8) ((hash >> 32) & 0x7f); }
+    int getFirstGroup (uint64 hash) const noexcept          { return (int) ((hash >> 32) >> (shift - 32)); }
+
+    uint64 getControlWord (int group) const noexcept        { return ByteOrder::littleEndianInt64 (control + group * groupSize); }
+
+    // These set the top bit of each byte in the word that's a match. The first one can also
+    // give a false positive for a byte that follows a real match, but that just means
+    // checking one more key.
+    static uint64 findMatchingBytes (uint64 word, uint8 tag) noexcept
+    {
+        auto x = word ^ (lowBits * tag);
+        return (x - lowBits) & ~x & highBits;
+    }
+
+    static uint64 findEmptyBytes (uint64 word) noexcept                 { return word & (~word << 6) & highBits; }
+    static uint64 findEmptyOrDeletedBytes (uint64 word) noexcept        { return word & ~(word << 7) & highBits; }
+
+    static int getLowestByteIndex (uint64 matches) noexcept
+    {
+       #if JUCE_GCC || JUCE_CLANG
+        return __builtin_ctzll (matches) >> 3;
+       #else
+        return countNumberOfBits ((matches & (~matches + 1)) - 1) >> 3;
+       #endif
+    }
+
+    int findFreeSlot (uint64 hash) const noexcept
+    {
+        auto groupMask = (capacity / groupSize) - 1;
+        auto group = getFirstGroup (hash);
+
+        for (int step = 1;; ++step)
+        {
+            if (auto freeBytes = findEmptyOrDeletedBytes (getControlWord (group)))
+                return group * groupSize + getLowestByteIndex (freeBytes);
+
+            group = (group + step) & groupMask;
+        }
+    }
+
+    void rehash (int newCapacity)
+    {
+        jassert (isPowerOfTwo (newCapacity) && newCapacity >= getCapacityNeededFor (numItems));
+
+        HeapBlock<uint8> oldControl (newCapacity);
+        HeapBlock<Slot> oldSlots (newCapacity);
+        oldControl.swapWith (control);
+        oldSlots.swapWith (slots);
+        memset (control, emptyControl, (size_t) newCapacity);
+
+        auto oldCapacity = capacity;
+        capacity = newCapacity;
+        shift = 64 - (countNumberOfBits ((uint32) (newCapacity / groupSize) - 1));
+        numItems = 0;
+        numDeleted = 0;
+
+        for (int i = 0; i < oldCapacity; ++i)
+        {
+            if (isFull (oldControl[i]))
+            {
+                auto& e = *reinterpret_cast<EntryType*> (&(oldSlots[i]));
+                auto hash = getHash (e.key);
+                auto index = findFreeSlot (hash);
+
+                new (&(slots[index])) EntryType (std::move (e));
+                control[index] = getTag (hash);
+                ++numItems;
+                e.~EntryType();
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (FlatHashTable)
+};
+#endif
+
+//==============================================================================
+/**
+    A hash map that keeps all of its keys and values in a single flat array.
+
+    This works like HashMap, and uses the same kind of hash function class, but rather
+    than allocating a node for each item and chaining them together in slots, it stores
+    the items directly in the table, along with a byte of each item's hash which lets a
+    lookup check eight slots at once. That means adding an item doesn't allocate anything
+    unless the table needs to grow, and a lookup usually only touches a couple of cache
+    lines, which makes it much faster for large tables.
+
+    The values can be move-only types. The hash function is called with an upperLimit of
+    std::numeric_limits<int>::max(), and the result is scrambled before use, so a hash
+    function that just returns the key modulo upperLimit works fine.
+
+    The lookup methods can be given any type of key that the hash function and the
+    key type's operator== understand, as long as it produces the same hash as the
+    equivalent key. With the DefaultHashFunctions, this means that a map with String keys
+    can be searched using a StringRef or a string literal without creating a String.
+
+    Unlike HashMap, this isn't thread-safe, and adding or removing items will invalidate
+    any pointers or references to values in the map.
+
+    @code
+    FlatHashMap<String, int> map;
+    map.set ("one", 1);
+    map.set ("two", 2);
+
+    if (auto* value = map.find ("two"))
+        DBG (*value); // prints "2"
+
+    for (auto i = map.begin(); i != map.end(); ++i)
+        DBG (i.getKey() << " -> " << i.getValue());
+    @endcode
+
+    @see HashMap, FlatHashSet, DefaultHashFunctions
+
+    @tags{Core}
+*/
+template <typename KeyType,
+          typename ValueType,
+          class HashFunctionType = DefaultHashFunctions>
+class FlatHashMap
+{
+public:
+    //==============================================================================
+    /** Creates an empty map.
+        This doesn't allocate any memory until the first item is added.
+    */
+    explicit FlatHashMap (HashFunctionType hashFunction = HashFunctionType())
+        : table (hashFunction)
+    {
+    }
+
+    /** Move constructor. */
+    FlatHashMap (FlatHashMap&&) noexcept = default;
+
+    /** Move assignment operator. */
+    FlatHashMap& operator= (FlatHashMap&&) noexcept = default;
+
+    //==============================================================================
+    /** Removes all the items from the map, but keeps the memory that was allocated for them. */
+    void clear() noexcept                               { table.clear(); }
+
+    /** Returns the number of items in the map. */
+    int size() const noexcept                           { return table.numItems; }
+
+    /** Returns true if the map is empty. */
+    bool isEmpty() const noexcept                       { return table.numItems == 0; }
+
+    /** Makes sure that the map can hold at least this many items without
+        needing to reallocate its table.
+    */
+    void reserve (int numItemsNeeded)                   { table.reserve (numItemsNeeded); }
+
+    /** Returns the number of slots in the table. */
+    int getCapacity() const noexcept                    { return table.capacity; }
+
+    /** Efficiently swaps the contents of two maps. */
+    void swapWith (FlatHashMap& other) noexcept         { table.swapWith (other.table); }
+
+    //==============================================================================
+    /** Returns a pointer to the value for a key, or nullptr if the key isn't in the map. */
+    template <typename KeyLike>
+    ValueType* find (const KeyLike& keyToLookFor) noexcept
+    {
+        auto index = table.findIndex (getLookupKey (keyToLookFor));
+        return index >= 0 ? &(table.getEntry (index).value) : nullptr;
+    }
+
+    /** Returns a pointer to the value for a key, or nullptr if the key isn't in the map. */
+    template <typename KeyLike>
+    const ValueType* find (const KeyLike& keyToLookFor) const noexcept
+    {
+        return const_cast<FlatHashMap&> (*this).find (keyToLookFor);
+    }
+
+    /** Returns true if the map contains an item with the given key. */
+    template <typename KeyLike>
+    bool contains (const KeyLike& keyToLookFor) const noexcept
+    {
+        return find (keyToLookFor) != nullptr;
+    }
+
+    /** Returns a copy of the value for a key.
+        If the key isn't in the map, a default-constructed value is returned.
+    */
+    template <typename KeyLike>
+    ValueType operator[] (const KeyLike& keyToLookFor) const
+    {
+        if (auto* v = find (keyToLookFor))
+            return *v;
+
+        return ValueType();
+    }
+
+    /** Returns a reference to the value for a key.
+        If the key isn't in the map, a default-constructed value is added for it.
+    */
+    ValueType& getReference (const KeyType& key)
+    {
+        return getOrAdd (KeyType (key));
+    }
+
+    /** Returns a reference to the value for a key.
+        If the key isn't in the map, a default-constructed value is added for it.
+    */
+    ValueType& getReference (KeyType&& key)
+    {
+        return getOrAdd (std::move (key));
+    }
+
+    /** Adds or replaces the value for a key. */
+    void set (const KeyType& key, const ValueType& newValue)    { getReference (key) = newValue; }
+
+    /** Adds or replaces the value for a key. */
+    void set (const KeyType& key, ValueType&& newValue)         { getReference (key) = std::move (newValue); }
+
+    /** Adds or replaces the value for a key. */
+    void set (KeyType&& key, ValueType&& newValue)              { getReference (std::move (key)) = std::move (newValue); }
+
+    /** Removes the item with the given key, returning true if there was one. */
+    template <typename KeyLike>
+    bool remove (const KeyLike& keyToRemove)
+    {
+        auto index = table.findIndex (getLookupKey (keyToRemove));
+
+        if (index < 0)
+            return false;
+
+        table.removeIndex (index);
+        return true;
+    }
+
+    //==============================================================================
+    /** Iterates the items in a FlatHashMap.
+        Dereferencing the iterator gives you the value, and getKey() returns the key.
+        The order of the items is unpredictable, and adding or removing items will
+        invalidate any iterators.
+    */
+    template <typename MapType, typename ValueReferenceType>
+    struct IteratorBase
+    {
+        IteratorBase (MapType& m, int i) noexcept  : map (m), index (i) {}
+
+        const KeyType& getKey() const noexcept                  { return map.table.getEntry (index).key; }
+        ValueReferenceType getValue() const noexcept            { return map.table.getEntry (index).value; }
+
+        ValueReferenceType operator*() const noexcept           { return getValue(); }
+        IteratorBase& operator++() noexcept                     { index = map.table.getNextIndex (index); return *this; }
+        bool operator== (const IteratorBase& other) const noexcept  { return index == other.index; }
+        bool operator!= (const IteratorBase& other) const noexcept  { return index != other.index; }
+
+    private:
+        MapType& map;
+        int index;
+    };
+
+    using Iterator      = IteratorBase<FlatHashMap, ValueType&>;
+    using ConstIterator = IteratorBase<const FlatHashMap, const ValueType&>;
+
+    /** Returns an iterator for the first item in the map. */
+    Iterator begin() noexcept                       { return { *this, table.getNextIndex (-1) }; }
+    /** Returns an iterator for the end of the map. */
+    Iterator end() noexcept                         { return { *this, table.capacity }; }
+    /** Returns an iterator for the first item in the map. */
+    ConstIterator begin() const noexcept            { return { *this, table.getNextIndex (-1) }; }
+    /** Returns an iterator for the end of the map. */
+    ConstIterator end() const noexcept              { return { *this, table.capacity }; }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        KeyType key;
+        ValueType value;
+    };
+
+    FlatHashTable<Entry, HashFunctionType> table;
+
+    template <typename KeyLike>
+    using LookupType = typename std::conditional<std::is_same<KeyType, String>::value
+                                                   && std::is_convertible<const KeyLike&, const char*>::value,
+                                                 StringRef, const KeyLike&>::type;
+
+    // Makes sure that a String-keyed map hashes a string literal by its text rather than its address.
+    template <typename KeyLike>
+    static LookupType<KeyLike> getLookupKey (const KeyLike& key) noexcept    { return key; }
+
+    ValueType& getOrAdd (KeyType&& key)
+    {
+        auto hash = table.getHash (key);
+        auto index = table.findIndex (key, hash);
+
+        if (index < 0)
+            index = table.insert (hash, { std::move (key), ValueType() });
+
+        return table.getEntry (index).value;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlatHashMap)
+};
+
+//==============================================================================
+/**
+    A set of unique keys, stored in a single flat array.
+
+    This is the set equivalent of FlatHashMap, and has the same performance
+    characteristics and restrictions - see FlatHashMap for details.
+
+    @see FlatHashMap, SortedSet
+
+    @tags{Core}
+*/
+template <typename KeyType,
+          class HashFunctionType = DefaultHashFunctions>
+class FlatHashSet
+{
+public:
+    //==============================================================================
+    /** Creates an empty set.
+        This doesn't allocate any memory until the first item is added.
+    */
+    explicit FlatHashSet (HashFunctionType hashFunction = HashFunctionType())
+        : table (hashFunction)
+    {
+    }
+
+    /** Move constructor. */
+    FlatHashSet (FlatHashSet&&) noexcept = default;
+
+    /** Move assignment operator. */
+    FlatHashSet& operator= (FlatHashSet&&) noexcept = default;
+
+    //==============================================================================
+    /** Removes all the items from the set, but keeps the memory that was allocated for them. */
+    void clear() noexcept                               { table.clear(); }
+
+    /** Returns the number of items in the set. */
+    int size() const noexcept                           { return table.numItems; }
+
+    /** Returns true if the set is empty. */
+    bool isEmpty() const noexcept                       { return table.numItems == 0; }
+
+    /** Makes sure that the set can hold at least this many items without
+        needing to reallocate its table.
+    */
+    void reserve (int numItemsNeeded)                   { table.reserve (numItemsNeeded); }
+
+    /** Returns the number of slots in the table. */
+    int getCapacity() const noexcept                    { return table.capacity; }
+
+    /** Efficiently swaps the contents of two sets. */
+    void swapWith (FlatHashSet& other) noexcept         { table.swapWith (other.table); }
+
+    //==============================================================================
+    /** Returns true if the set contains the given key. */
+    template <typename KeyLike>
+    bool contains (const KeyLike& keyToLookFor) const noexcept
+    {
+        return table.findIndex (getLookupKey (keyToLookFor)) >= 0;
+    }
+
+    /** Adds a key to the set.
+        Returns true if it was added, or false if the set already contained it.
+    */
+    bool add (const KeyType& newKey)                    { return addIfNotPresent (KeyType (newKey)); }
+
+    /** Adds a key to the set.
+        Returns true if it was added, or false if the set already contained it.
+    */
+    bool add (KeyType&& newKey)                         { return addIfNotPresent (std::move (newKey)); }
+
+    /** Removes a key from the set, returning true if it was there. */
+    template <typename KeyLike>
+    bool remove (const KeyLike& keyToRemove)
+    {
+        auto index = table.findIndex (getLookupKey (keyToRemove));
+
+        if (index < 0)
+            return false;
+
+        table.removeIndex (index);
+        return true;
+    }
+
+    //==============================================================================
+    /** Iterates the keys in a FlatHashSet, in an unpredictable order. */
+    struct Iterator
+    {
+        Iterator (const FlatHashSet& s, int i) noexcept  : set (s), index (i) {}
+
+        const KeyType& operator*() const noexcept               { return set.table.getEntry (index).key; }
+        Iterator& operator++() noexcept                         { index = set.table.getNextIndex (index); return *this; }
+        bool operator== (const Iterator& other) const noexcept  { return index == other.index; }
+        bool operator!= (const Iterator& other) const noexcept  { return index != other.index; }
+
+    private:
+        const FlatHashSet& set;
+        int index;
+    };
+
+    /** Returns an iterator for the first key in the set. */
+    Iterator begin() const noexcept                 { return { *this, table.getNextIndex (-1) }; }
+    /** Returns an iterator for the end of the set. */
+    Iterator end() const noexcept                   { return { *this, table.capacity }; }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        KeyType key;
+    };
+
+    FlatHashTable<Entry, HashFunctionType> table;
+
+    template <typename KeyLike>
+    using LookupType = typename std::conditional<std::is_same<KeyType, String>::value
+                                                   && std::is_convertible<const KeyLike&, const char*>::value,
+                                                 StringRef, const KeyLike&>::type;
+
+    template <typename KeyLike>
+    static LookupType<KeyLike> getLookupKey (const KeyLike& key) noexcept    { return key; }
+
+    bool addIfNotPresent (KeyType&& key)
+    {
+        auto hash = table.getHash (key);
+
+        if (table.findIndex (key, hash) >= 0)
+            return false;
+
+        table.insert (hash, { std::move (key) });
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlatHashSet)
+};
+
+} // namespace juce
@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct FlatHashMapTests  : public UnitTest
+{
+    FlatHashMapTests() : UnitTest ("FlatHashMap", "Containers") {}
+
+    struct Counted
+    {
+        Counted() noexcept                              { ++numLive; }
+        Counted (int v) noexcept  : value (v)           { ++numLive; }
+        Counted (const Counted& o) noexcept  : value (o.value)  { ++numLive; }
+        Counted& operator= (const Counted& o) noexcept  { value = o.value; return *this; }
+        ~Counted() noexcept                             { --numLive; }
+
+        int value = 0;
+        static int numLive;
+    };
+
+    static Array<String> createKeys (Random& r, int num)
+    {
+        Array<String> keys;
+
+        for (int i = 0; i < num; ++i)
+            keys.add ("key_" + String::toHexString (r.nextInt64()));
+
+        return keys;
+    }
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Matches HashMap");
+        {
+            FlatHashMap<int, int> flat;
+            HashMap<int, int> reference;
+
+            for (int i = 0; i < 50000; ++i)
+            {
+                auto key = r.nextInt (2000) * 1024;   // keys that all collide in the low bits
+
+                if (r.nextInt (3) == 0)
+                {
+                    expectEquals ((int) flat.remove (key), (int) reference.contains (key));
+                    reference.remove (key);
+                }
+                else
+                {
+                    flat.set (key, i);
+                    reference.set (key, i);
+                }
+            }
+
+            expectEquals (flat.size(), reference.size());
+
+            int numVisited = 0;
+
+            for (auto i = flat.begin(); i != flat.end(); ++i)
+            {
+                expectEquals (i.getValue(), reference[i.getKey()]);
+                ++numVisited;
+            }
+
+            expectEquals (numVisited, reference.size());
+
+            for (HashMap<int, int>::Iterator i (reference); i.next();)
+            {
+                expect (flat.contains (i.getKey()));
+                expectEquals (flat[i.getKey()], i.getValue());
+            }
+
+            expect (! flat.contains (1));
+            expectEquals (flat[1], 0);
+            expect (flat.find (1) == nullptr);
+        }
+
+        beginTest ("String keys and heterogeneous lookup");
+        {
+            FlatHashMap<String, int> map;
+            auto keys = createKeys (r, 1000);
+
+            for (int i = 0; i < keys.size(); ++i)
+                map.set (keys[i], i);
+
+            for (int i = 0; i < keys.size(); ++i)
+            {
+                expectEquals (map[keys[i]], i);
+                expectEquals (*map.find (StringRef (keys[i])), i);
+                expectEquals (*map.find (keys[i].toRawUTF8()), i);
+            }
+
+            map.set ("literal", 123);
+            expectEquals (map["literal"], 123);
+            expect (map.contains (StringRef ("literal")));
+            expect (map.remove ("literal"));
+            expect (! map.contains ("literal"));
+            expectEquals (map.size(), keys.size());
+        }
+
+        beginTest ("Move-only values");
+        {
+            FlatHashMap<int, std::unique_ptr<String>> map;
+
+            for (int i = 0; i < 100; ++i)
+                map.set (i, std::unique_ptr<String> (new String (i)));
+
+            for (int i = 0; i < 100; i += 2)
+                expect (map.remove (i));
+
+            for (int i = 1; i < 100; i += 2)
+                expectEquals (*map.find (i)->get(), String (i));
+
+            FlatHashMap<int, std::unique_ptr<String>> other (std::move (map));
+            expectEquals (other.size(), 50);
+            expect (map.isEmpty());
+        }
+
+        beginTest ("Object lifetimes");
+        {
+            {
+                FlatHashMap<int, Counted> map;
+
+                for (int i = 0; i < 1000; ++i)
+                    map.set (i, Counted (i));
+
+                expectEquals (Counted::numLive, 1000);
+
+                for (int i = 0; i < 500; ++i)
+                    map.remove (i);
+
+                expectEquals (Counted::numLive, 500);
+                expectEquals (map[700].value, 700);
+            }
+
+            expectEquals (Counted::numLive, 0);
+        }
+
+        beginTest ("Reserve");
+        {
+            FlatHashMap<int, int> map;
+            expectEquals (map.getCapacity(), 0);
+
+            map.reserve (1000);
+            auto capacity = map.getCapacity();
+            expect (capacity >= 1000);
+
+            for (int i = 0; i < 1000; ++i)
+                map.getReference (i) = i;
+
+            expectEquals (map.getCapacity(), capacity);
+
+            map.clear();
+            expect (map.isEmpty());
+            expectEquals (map.getCapacity(), capacity);
+        }
+
+        beginTest ("FlatHashSet");
+        {
+            FlatHashSet<String> set;
+            expect (set.add ("a"));
+            expect (set.add ("b"));
+            expect (! set.add ("a"));
+            expectEquals (set.size(), 2);
+            expect (set.contains ("a"));
+            expect (set.contains (StringRef ("b")));
+            expect (! set.contains ("c"));
+
+            StringArray seen;
+
+            for (auto& s : set)
+                seen.add (s);
+
+            seen.sort (false);
+            expectEquals (seen.joinIntoString (","), String ("a,b"));
+
+            expect (set.remove ("a"));
+            expect (! set.remove ("a"));
+            expectEquals (set.size(), 1);
+        }
+    }
+};
+
+int FlatHashMapTests::Counted::numLive = 0;
+
+static FlatHashMapTests flatHashMapTests;
+
+//==============================================================================
+struct FlatHashMapBenchmark  : public UnitTestBenchmark
+{
+    FlatHashMapBenchmark()  : UnitTestBenchmark ("FlatHashMap") {}
+
+    template <typename MapType, typename KeyType, typename AddFunction, typename ContainsFunction>
+    void timeMap (const String& label, const Array<KeyType>& keys, AddFunction add, ContainsFunction contains)
+    {
+        // look the keys up in a different order, so that the chained maps don't get the
+        // benefit of finding their nodes in the order that they were allocated
+        auto keysToFind = keys;
+        Random r (1234);
+
+        for (int i = keysToFind.size(); --i > 0;)
+            keysToFind.swap (i, r.nextInt (i + 1));
+
+        timeCalls (label + ", adding " + String (keys.size()) + " keys", [&]
+        {
+            MapType map;
+
+            for (int i = 0; i < keys.size(); ++i)
+                add (map, keys.getReference (i), i);
+
+            return map.size();
+        });
+
+        MapType map;
+
+        for (int i = 0; i < keys.size(); ++i)
+            add (map, keys.getReference (i), i);
+
+        timeCalls (label + ", finding " + String (keys.size()) + " keys", [&]
+        {
+            int numFound = 0;
+
+            for (auto& k : keysToFind)
+                if (contains (map, k))
+                    ++numFound;
+
+            return numFound;
+        });
+    }
+
+    void runTest() override
+    {
+        const int numItems = 100000;
+        auto r = getRandom();
+        Array<int> intKeys;
+
+        for (int i = 0; i < numItems; ++i)
+            intKeys.add (r.nextInt());
+
+        auto stringKeys = FlatHashMapTests::createKeys (r, numItems);
+
+        beginTest ("Int keys");
+
+        timeMap<FlatHashMap<int, int>> ("FlatHashMap<int, int>", intKeys,
+                                        [] (FlatHashMap<int, int>& m, int k, int v)   { m.set (k, v); },
+                                        [] (FlatHashMap<int, int>& m, int k)          { return m.contains (k); });
+
+        timeMap<HashMap<int, int>> ("HashMap<int, int>", intKeys,
+                                    [] (HashMap<int, int>& m, int k, int v)   { m.set (k, v); },
+                                    [] (HashMap<int, int>& m, int k)          { return m.contains (k); });
+
+        timeMap<std::unordered_map<int, int>> ("std::unordered_map<int, int>", intKeys,
+                                               [] (std::unordered_map<int, int>& m, int k, int v)   { m[k] = v; },
+                                               [] (std::unordered_map<int, int>& m, int k)          { return m.find (k) != m.end(); });
+
+        beginTest ("String keys");
+
+        timeMap<FlatHashMap<String, int>> ("FlatHashMap<String, int>", stringKeys,
+                                           [] (FlatHashMap<String, int>& m, const String& k, int v)   { m.set (k, v); },
+                                           [] (FlatHashMap<String, int>& m, const String& k)          { return m.contains (k); });
+
+        timeMap<HashMap<String, int>> ("HashMap<String, int>", stringKeys,
+                                       [] (HashMap<String, int>& m, const String& k, int v)   { m.set (k, v); },
+                                       [] (HashMap<String, int>& m, const String& k)          { return m.contains (k); });
+
+        timeMap<std::unordered_map<String, int>> ("std::unordered_map<String, int>", stringKeys,
+                                                  [] (std::unordered_map<String, int>& m, const String& k, int v)   { m[k] = v; },
+                                                  [] (std::unordered_map<String, int>& m, const String& k)          { return m.find (k) != m.end(); });
+    }
+};
+
+static FlatHashMapBenchmark flatHashMapBenchmark;
+
+} // namespace juce
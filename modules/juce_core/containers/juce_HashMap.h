@@ -43,6 +43,10 @@ struct DefaultHashFunctions
     static int generateHash (int64 key, int upperLimit) noexcept            { return generateHash ((uint64) key, upperLimit); }
     /** Generates a simple hash from a string. */
     static int generateHash (const String& key, int upperLimit) noexcept    { return generateHash ((uint32) key.hashCode(), upperLimit); }
+    /** Generates a simple hash from a string, which matches the hash of a String containing the same text. */
+    static int generateHash (StringRef key, int upperLimit) noexcept        { return generateHash ((uint32) key.hashCode(), upperLimit); }
+    /** Generates a simple hash from an Identifier, using the hash code that it stores. */
+    static int generateHash (const Identifier& key, int upperLimit) noexcept { return generateHash ((uint32) key.hashCode(), upperLimit); }
     /** Generates a simple hash from a variant. */
     static int generateHash (const var& key, int upperLimit) noexcept       { return generateHash (key.toString(), upperLimit); }
     /** Generates a simple hash from a void ptr. */
@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A typed, bounded FIFO for passing objects from one thread to another without
+    taking any locks.
+
+    Unlike AbstractFifo, this holds the objects itself. All of its storage is
+    allocated when it's created, so pushing and popping never allocate memory
+    (although the objects' own copy or move constructors might).
+
+    Only one thread may call push() or emplace(), and only one thread may call pop()
+    at any one time. If more than one thread needs to add objects, use an MPMCQueue
+    or an MPSCQueue instead.
+
+    e.g.
+    @code
+    SPSCQueue<MidiMessage> queue (256);
+
+    // on the MIDI thread..
+    if (! queue.push (message))
+        jassertfalse; // the queue is full
+
+    // on the audio thread..
+    MidiMessage m;
+
+    while (queue.pop (m))
+        handleMessage (m);
+    @endcode
+
+    @see MPMCQueue, MPSCQueue, AbstractFifo
+
+    @tags{Core}
+*/
+template <typename ElementType>
+class SPSCQueue
+{
+public:
+    //==============================================================================
+    /** Creates a queue that can hold at least the given number of objects.
+        The actual capacity is rounded up, and can be found with getCapacity().
+    */
+    explicit SPSCQueue (int minimumCapacity)
+        : mask ((size_t) nextPowerOfTwo (jmax (2, minimumCapacity + 1)) - 1),
+          storage (mask + 1)
+    {
+    }
+
+    /** Destructor. Any objects that are still in the queue are deleted. */
+    ~SPSCQueue()
+    {
+        for (auto i = readIndex.load(); i != writeIndex.load(); i = (i + 1) & mask)
+            getSlot (i)->~ElementType();
+    }
+
+    //==============================================================================
+    /** Adds a copy of an object to the queue.
+        Returns false, leaving the queue unchanged, if there's no room.
+    */
+    bool push (const ElementType& newElement)       { return emplace (newElement); }
+
+    /** Moves an object into the queue.
+        Returns false, leaving the object untouched, if there's no room.
+    */
+    bool push (ElementType&& newElement)            { return emplace (std::move (newElement)); }
+
+    /** Constructs an object in-place at the end of the queue.
+        Returns false if there's no room.
+    */
+    template <typename... Args>
+    bool emplace (Args&&... args)
+    {
+        auto index = writeIndex.load (std::memory_order_relaxed);
+        auto next = (index + 1) & mask;
+
+        if (next == cachedReadIndex)
+        {
+            cachedReadIndex = readIndex.load (std::memory_order_acquire);
+
+            if (next == cachedReadIndex)
+                return false;
+        }
+
+        new (getSlot (index)) ElementType (std::forward<Args> (args)...);
+        writeIndex.store (next, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes the object at the front of the queue and moves it into the result.
+        Returns false if the queue is empty.
+    */
+    bool pop (ElementType& result)
+    {
+        auto index = readIndex.load (std::memory_order_relaxed);
+
+        if (index == cachedWriteIndex)
+        {
+            cachedWriteIndex = writeIndex.load (std::memory_order_acquire);
+
+            if (index == cachedWriteIndex)
+                return false;
+        }
+
+        auto* slot = getSlot (index);
+        result = std::move (*slot);
+        slot->~ElementType();
+        readIndex.store ((index + 1) & mask, std::memory_order_release);
+        return true;
+    }
+
+    //==============================================================================
+    /** Returns the number of objects in the queue.
+        If other threads are using the queue, this will be out of date by the time you use it.
+    */
+    int getNumReady() const noexcept
+    {
+        return (int) ((writeIndex.load (std::memory_order_acquire)
+                        - readIndex.load (std::memory_order_acquire)) & mask);
+    }
+
+    /** Returns true if the queue is empty. */
+    bool isEmpty() const noexcept                   { return getNumReady() == 0; }
+
+    /** Returns the largest number of objects that the queue can hold. */
+    int getCapacity() const noexcept                { return (int) mask; }
+
+private:
+    //==============================================================================
+    using Slot = typename std::aligned_storage<sizeof (ElementType), alignof (ElementType)>::type;
+
+    const size_t mask;
+    HeapBlock<Slot> storage;
+
+    // The producer's and consumer's indexes are kept on separate cache lines, each
+    // with a private copy of the other side's index that's only refreshed when the
+    // queue looks full or empty.
+    char padding1[64];
+    std::atomic<size_t> writeIndex { 0 };
+    size_t cachedReadIndex = 0;
+    char padding2[64];
+    std::atomic<size_t> readIndex { 0 };
+    size_t cachedWriteIndex = 0;
+    char padding3[64];
+
+    ElementType* getSlot (size_t index) const noexcept     { return reinterpret_cast<ElementType*> (storage + index); }
+
+    JUCE_DECLARE_NON_COPYABLE (SPSCQueue)
+};
+
+//==============================================================================
+/**
+    A typed, bounded FIFO that any number of threads can push objects into and pop
+    objects from without taking any locks.
+
+    All of the storage is allocated when the queue is created, so pushing and popping
+    never allocate memory. Each slot has its own sequence number, so that producers
+    and consumers only contend for the head and tail counters, and never for the
+    slots themselves.
+
+    This works just as well with a single consumer, so it's also the one to use when
+    several threads need to send objects to a realtime thread. If a producer gets
+    suspended half-way through writing an object, consumers will see the queue as
+    empty at that point until the producer finishes.
+
+    @see SPSCQueue, MPSCQueue, AbstractFifo
+
+    @tags{Core}
+*/
+template <typename ElementType>
+class MPMCQueue
+{
+public:
+    //==============================================================================
+    /** Creates a queue that can hold at least the given number of objects.
+        The actual capacity is rounded up to a power of two, and can be found with
+        getCapacity().
+    */
+    explicit MPMCQueue (int minimumCapacity)
+        : mask ((size_t) nextPowerOfTwo (jmax (2, minimumCapacity)) - 1),
+          cells (mask + 1)
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            new (&cells[i].sequence) std::atomic<size_t> (i);
+    }
+
+    /** Destructor. Any objects that are still in the queue are deleted. */
+    ~MPMCQueue()
+    {
+        for (auto i = dequeuePos.load(); i != enqueuePos.load(); ++i)
+            reinterpret_cast<ElementType*> (&cells[i & mask].storage)->~ElementType();
+    }
+
+    //==============================================================================
+    /** Adds a copy of an object to the queue.
+        Returns false, leaving the queue unchanged, if there's no room.
+    */
+    bool push (const ElementType& newElement)       { return emplace (newElement); }
+
+    /** Moves an object into the queue.
+        Returns false, leaving the object untouched, if there's no room.
+    */
+    bool push (ElementType&& newElement)            { return emplace (std::move (newElement)); }
+
+    /** Constructs an object in-place at the end of the queue.
+        Returns false if there's no room.
+    */
+    template <typename... Args>
+    bool emplace (Args&&... args)
+    {
+        auto pos = enqueuePos.load (std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;)
+        {
+            cell = cells + (pos & mask);
+            auto diff = (pointer_sized_int) cell->sequence.load (std::memory_order_acquire) - (pointer_sized_int) pos;
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load (std::memory_order_relaxed);
+            }
+        }
+
+        new (&cell->storage) ElementType (std::forward<Args> (args)...);
+        cell->sequence.store (pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes the object at the front of the queue and moves it into the result.
+        Returns false if the queue is empty.
+    */
+    bool pop (ElementType& result)
+    {
+        auto pos = dequeuePos.load (std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;)
+        {
+            cell = cells + (pos & mask);
+            auto diff = (pointer_sized_int) cell->sequence.load (std::memory_order_acquire) - (pointer_sized_int) (pos + 1);
+
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load (std::memory_order_relaxed);
+            }
+        }
+
+        auto* element = reinterpret_cast<ElementType*> (&cell->storage);
+        result = std::move (*element);
+        element->~ElementType();
+        cell->sequence.store (pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    //==============================================================================
+    /** Returns the approximate number of objects in the queue.
+        If other threads are using the queue, this will be out of date by the time you use it.
+    */
+    int getNumReady() const noexcept
+    {
+        auto head = dequeuePos.load (std::memory_order_acquire);
+        auto tail = enqueuePos.load (std::memory_order_acquire);
+        return tail > head ? (int) jmin (tail - head, mask + 1) : 0;
+    }
+
+    /** Returns true if the queue looks empty. */
+    bool isEmpty() const noexcept                   { return getNumReady() == 0; }
+
+    /** Returns the largest number of objects that the queue can hold. */
+    int getCapacity() const noexcept                { return (int) (mask + 1); }
+
+private:
+    //==============================================================================
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof (ElementType), alignof (ElementType)>::type storage;
+    };
+
+    const size_t mask;
+    HeapBlock<Cell> cells;
+
+    char padding1[64];
+    std::atomic<size_t> enqueuePos { 0 };
+    char padding2[64];
+    std::atomic<size_t> dequeuePos { 0 };
+    char padding3[64];
+
+    JUCE_DECLARE_NON_COPYABLE (MPMCQueue)
+};
+
+//==============================================================================
+/**
+    An unbounded FIFO that any number of threads can push objects into, and a single
+    thread can pop them from, without taking any locks.
+
+    Important note: every push() allocates a small node with operator new, and every pop()
+    deletes one, so neither of them is safe to call from a realtime thread such as the
+    audio callback. If a realtime thread needs to push or pop, use an MPMCQueue instead.
+
+    Unlike a bounded queue this can never fill up, which makes it suitable for things
+    like message posting, where a push must always succeed. Apart from the allocation,
+    pushing is wait-free: it's a single atomic exchange.
+
+    If a producer gets suspended half-way through pushing, the consumer will see the
+    queue as ending at that point until the producer finishes.
+
+    @see MPMCQueue, SPSCQueue
+
+    @tags{Core}
+*/
+template <typename ElementType>
+class MPSCQueue
+{
+public:
+    //==============================================================================
+    /** Creates an empty queue. */
+    MPSCQueue()
+        : head (&stub), tail (&stub)
+    {
+    }
+
+    /** Destructor. Any objects that are still in the queue are deleted. */
+    ~MPSCQueue()
+    {
+        while (auto* next = tail->next.load())
+            removeFront (next);
+
+        if (tail != &stub)
+            delete tail;
+    }
+
+    //==============================================================================
+    /** Adds a copy of an object to the queue.
+        This allocates memory, so don't call it from a realtime thread.
+    */
+    void push (const ElementType& newElement)       { emplace (newElement); }
+
+    /** Moves an object into the queue.
+        This allocates memory, so don't call it from a realtime thread.
+    */
+    void push (ElementType&& newElement)            { emplace (std::move (newElement)); }
+
+    /** Constructs an object at the end of the queue.
+        This allocates memory, so don't call it from a realtime thread.
+    */
+    template <typename... Args>
+    void emplace (Args&&... args)
+    {
+        auto* node = new Node();
+        new (&node->storage) ElementType (std::forward<Args> (args)...);
+
+        auto* previous = head.exchange (node, std::memory_order_acq_rel);
+        previous->next.store (node, std::memory_order_release);
+    }
+
+    /** Removes the object at the front of the queue and moves it into the result.
+        Returns false if the queue is empty.
+
+        This must only be called by one thread at a time. It deletes the node that held
+        the object, so don't call it from a realtime thread.
+    */
+    bool pop (ElementType& result)
+    {
+        auto* next = tail->next.load (std::memory_order_acquire);
+
+        if (next == nullptr)
+            return false;
+
+        result = std::move (*next->getElement());
+        removeFront (next);
+        return true;
+    }
+
+    /** Returns true if the queue is empty.
+        This must only be called by the consumer thread.
+    */
+    bool isEmpty() const noexcept                   { return tail->next.load (std::memory_order_acquire) == nullptr; }
+
+private:
+    //==============================================================================
+    struct Node
+    {
+        std::atomic<Node*> next { nullptr };
+        typename std::aligned_storage<sizeof (ElementType), alignof (ElementType)>::type storage;
+
+        ElementType* getElement() noexcept          { return reinterpret_cast<ElementType*> (&storage); }
+    };
+
+    // The tail always points to a node whose element has already been taken, and the
+    // stub is used for this until the first element has been popped.
+    Node stub;
+    std::atomic<Node*> head;
+    char padding[64];
+    Node* tail;
+
+    void removeFront (Node* next)
+    {
+        next->getElement()->~ElementType();
+
+        if (tail != &stub)
+            delete tail;
+
+        tail = next;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (MPSCQueue)
+};
+
+} // namespace juce
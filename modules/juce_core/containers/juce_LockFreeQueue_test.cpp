@@ -0,0 +1,351 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct LockFreeQueueTests  : public UnitTest
+{
+    LockFreeQueueTests() : UnitTest ("Lock-free queues", "Containers") {}
+
+    //==============================================================================
+    struct TestThread  : public Thread
+    {
+        TestThread (std::function<void()> f)  : Thread ("queue test"), function (std::move (f))   { startThread(); }
+        ~TestThread()                                                                           { stopThread (-1); }
+
+        void run() override     { function(); }
+
+        std::function<void()> function;
+    };
+
+    struct Counted
+    {
+        Counted() noexcept                          { ++numLive; }
+        Counted (int v) noexcept  : value (v)       { ++numLive; }
+        Counted (const Counted& o) noexcept  : value (o.value)  { ++numLive; }
+        Counted& operator= (const Counted& o) noexcept          { value = o.value; return *this; }
+        ~Counted() noexcept                         { --numLive; }
+
+        int value = 0;
+        static int numLive;
+    };
+
+    template <typename QueueType>
+    void testBoundedBasics (QueueType& queue, int expectedCapacity)
+    {
+        expectEquals (queue.getCapacity(), expectedCapacity);
+        expect (queue.isEmpty());
+
+        String s;
+        expect (! queue.pop (s));
+
+        for (int i = 0; i < expectedCapacity; ++i)
+            expect (queue.push (String (i)));
+
+        expect (! queue.push ("extra"));
+        expectEquals (queue.getNumReady(), expectedCapacity);
+
+        for (int i = 0; i < expectedCapacity / 2; ++i)
+        {
+            expect (queue.pop (s));
+            expectEquals (s, String (i));
+        }
+
+        for (int i = 0; i < expectedCapacity / 2; ++i)
+            expect (queue.emplace (String (expectedCapacity + i)));
+
+        for (int i = expectedCapacity / 2; i < expectedCapacity + expectedCapacity / 2; ++i)
+        {
+            expect (queue.pop (s));
+            expectEquals (s, String (i));
+        }
+
+        expect (queue.isEmpty());
+        expect (! queue.pop (s));
+    }
+
+    template <typename QueueType>
+    void testLifetimes (QueueType& queue)
+    {
+        for (int i = 0; i < 5; ++i)
+            queue.push (Counted (i));
+
+        expectEquals (Counted::numLive, 5);
+
+        Counted c;
+        expect (queue.pop (c));
+        expectEquals (c.value, 0);
+        expectEquals (Counted::numLive, 5);
+    }
+
+    template <typename QueueType, typename PushFunction>
+    void testManyProducers (QueueType& queue, PushFunction pushFunction, int numProducers, int numConsumers, int numPerProducer)
+    {
+        std::atomic<int> numPopped { 0 };
+        std::atomic<int64> total { 0 };
+        std::atomic<bool> orderingFailed { false };
+        const int numTotal = numProducers * numPerProducer;
+
+        {
+            OwnedArray<TestThread> threads;
+
+            for (int c = 0; c < numConsumers; ++c)
+            {
+                threads.add (new TestThread ([&]
+                {
+                    HeapBlock<int> lastSeen (numProducers);
+
+                    for (int i = 0; i < numProducers; ++i)
+                        lastSeen[i] = -1;
+
+                    while (numPopped.load() < numTotal)
+                    {
+                        int v;
+
+                        if (queue.pop (v))
+                        {
+                            auto producer = v / numPerProducer;
+                            auto index = v % numPerProducer;
+
+                            if (index <= lastSeen[producer])
+                                orderingFailed = true;
+
+                            lastSeen[producer] = index;
+                            total += v;
+                            ++numPopped;
+                        }
+                        else
+                        {
+                            Thread::yield();
+                        }
+                    }
+                }));
+            }
+
+            for (int p = 0; p < numProducers; ++p)
+            {
+                threads.add (new TestThread ([&, p]
+                {
+                    for (int i = 0; i < numPerProducer; ++i)
+                        pushFunction (p * numPerProducer + i);
+                }));
+            }
+        }
+
+        expectEquals (numPopped.load(), numTotal);
+        expectEquals (total.load(), (int64) numTotal * (numTotal - 1) / 2);
+        expect (! orderingFailed.load());
+        expect (queue.isEmpty());
+    }
+
+    void runTest() override
+    {
+        beginTest ("SPSCQueue");
+        {
+            SPSCQueue<String> queue (100);
+            testBoundedBasics (queue, 127);
+
+            {
+                SPSCQueue<Counted> counted (8);
+                testLifetimes (counted);
+            }
+
+            expectEquals (Counted::numLive, 0);
+        }
+
+        beginTest ("MPMCQueue");
+        {
+            MPMCQueue<String> queue (100);
+            testBoundedBasics (queue, 128);
+
+            {
+                MPMCQueue<Counted> counted (8);
+                testLifetimes (counted);
+            }
+
+            expectEquals (Counted::numLive, 0);
+        }
+
+        beginTest ("MPSCQueue");
+        {
+            MPSCQueue<String> queue;
+            String s;
+            expect (queue.isEmpty());
+            expect (! queue.pop (s));
+
+            for (int i = 0; i < 1000; ++i)
+                queue.push (String (i));
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                expect (queue.pop (s));
+                expectEquals (s, String (i));
+            }
+
+            expect (! queue.pop (s));
+
+            {
+                MPSCQueue<Counted> counted;
+                testLifetimes (counted);
+            }
+
+            expectEquals (Counted::numLive, 0);
+        }
+
+        beginTest ("SPSCQueue stress");
+        {
+            SPSCQueue<int> queue (64);
+            testManyProducers (queue, [&] (int v) { while (! queue.push (v)) Thread::yield(); }, 1, 1, 200000);
+        }
+
+        beginTest ("MPMCQueue stress");
+        {
+            MPMCQueue<int> queue (64);
+            testManyProducers (queue, [&] (int v) { while (! queue.push (v)) Thread::yield(); }, 4, 4, 50000);
+        }
+
+        beginTest ("MPSCQueue stress");
+        {
+            MPSCQueue<int> queue;
+            testManyProducers (queue, [&] (int v) { queue.push (v); }, 4, 1, 50000);
+        }
+    }
+};
+
+int LockFreeQueueTests::Counted::numLive = 0;
+
+static LockFreeQueueTests lockFreeQueueTests;
+
+//==============================================================================
+struct LockFreeQueueBenchmark  : public UnitTestBenchmark
+{
+    LockFreeQueueBenchmark()  : UnitTestBenchmark ("Lock-free queues") {}
+
+    // Only the transfer itself is timed: the clock starts once all the threads are
+    // running, and stops when the consumer has received the last item.
+    template <typename PushFunction, typename PopFunction>
+    void timeTransfer (const String& label, int numProducers, PushFunction push, PopFunction pop)
+    {
+        const int numPerProducer = (1 << 21) / numProducers;
+        const int numItems = numPerProducer * numProducers;
+        std::atomic<int> numThreadsReady { 0 };
+        std::atomic<bool> started { false };
+        double seconds = 0;
+
+        auto waitForStart = [&]
+        {
+            ++numThreadsReady;
+
+            while (! started.load())
+                Thread::yield();
+        };
+
+        {
+            OwnedArray<LockFreeQueueTests::TestThread> threads;
+
+            threads.add (new LockFreeQueueTests::TestThread ([&]
+            {
+                waitForStart();
+                auto startTicks = Time::getHighResolutionTicks();
+
+                for (int numPopped = 0; numPopped < numItems;)
+                {
+                    int v;
+
+                    if (pop (v))
+                        ++numPopped;
+                    else
+                        Thread::yield();
+                }
+
+                seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+            }));
+
+            for (int p = 0; p < numProducers; ++p)
+            {
+                threads.add (new LockFreeQueueTests::TestThread ([&]
+                {
+                    waitForStart();
+
+                    for (int i = 0; i < numPerProducer; ++i)
+                        while (! push (i))
+                            Thread::yield();
+                }));
+            }
+
+            while (numThreadsReady.load() < numProducers + 1)
+                Thread::yield();
+
+            started = true;
+        }
+
+        logResult (label, numItems / seconds / 1.0e6, "million items per second");
+    }
+
+    void runTest() override
+    {
+        // the locked version is the usual pattern of a CriticalSection-protected Array
+        // that the consumer swaps out and then works through on its own
+        CriticalSection lock;
+        Array<int> array, pending;
+        int pendingIndex = 0;
+
+        auto lockedPush = [&] (int v)   { const ScopedLock sl (lock); array.add (v); return true; };
+
+        auto lockedPop = [&] (int& v)
+        {
+            if (pendingIndex >= pending.size())
+            {
+                pending.clearQuick();
+                pendingIndex = 0;
+
+                const ScopedLock sl (lock);
+                pending.swapWith (array);
+
+                if (pending.isEmpty())
+                    return false;
+            }
+
+            v = pending.getUnchecked (pendingIndex++);
+            return true;
+        };
+
+        SPSCQueue<int> spsc (1024);
+        MPMCQueue<int> mpmc (1024);
+        MPSCQueue<int> mpsc;
+
+        beginTest ("One producer");
+        timeTransfer ("Locked Array", 1, lockedPush, lockedPop);
+        timeTransfer ("SPSCQueue",    1, [&] (int v) { return spsc.push (v); }, [&] (int& v) { return spsc.pop (v); });
+        timeTransfer ("MPMCQueue",    1, [&] (int v) { return mpmc.push (v); }, [&] (int& v) { return mpmc.pop (v); });
+
+        beginTest ("Four producers");
+        timeTransfer ("Locked Array", 4, lockedPush, lockedPop);
+        timeTransfer ("MPMCQueue",    4, [&] (int v) { return mpmc.push (v); }, [&] (int& v) { return mpmc.pop (v); });
+        timeTransfer ("MPSCQueue",    4, [&] (int v) { mpsc.push (v); return true; }, [&] (int& v) { return mpsc.pop (v); });
+    }
+};
+
+static LockFreeQueueBenchmark lockFreeQueueBenchmark;
+
+} // namespace juce
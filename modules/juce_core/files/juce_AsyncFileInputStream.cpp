@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct AsyncFileInputStream::Block
+{
+    Block (int size)  : storage ((size_t) size + alignment)
+    {
+        // the data starts on a page boundary so that it can be read straight from the disk
+        data = reinterpret_cast<char*> ((reinterpret_cast<pointer_sized_uint> (storage.get()) + alignment - 1)
+                                          & ~(pointer_sized_uint) (alignment - 1));
+    }
+
+    enum { alignment = 4096 };
+
+    HeapBlock<char> storage;
+    char* data;
+    int64 start = -1;
+    AsyncFileReadQueue::Request request;
+};
+
+//==============================================================================
+AsyncFileInputStream::AsyncFileInputStream (const File& f, AsyncFileReadQueue* queueToUse,
+                                            int blockSizeToUse, int numBlocksToReadAhead)
+    : queue (queueToUse != nullptr ? *queueToUse : sharedQueue.getObject()),
+      file (f),
+      blockSize (blockSizeToUse)
+{
+    jassert (blockSize > 0 && numBlocksToReadAhead > 0);
+
+    for (int i = 0; i < numBlocksToReadAhead; ++i)
+        blocks.add (new Block (blockSize));
+}
+
+AsyncFileInputStream::~AsyncFileInputStream()
+{
+    for (auto* b : blocks)
+        b->request.waitUntilDone (-1);
+}
+
+//==============================================================================
+int64 AsyncFileInputStream::getTotalLength()
+{
+    return file.getSize();
+}
+
+int64 AsyncFileInputStream::getPosition()
+{
+    return currentPosition;
+}
+
+bool AsyncFileInputStream::setPosition (int64 pos)
+{
+    currentPosition = jlimit ((int64) 0, file.getSize(), pos);
+    return true;
+}
+
+bool AsyncFileInputStream::isExhausted()
+{
+    return currentPosition >= file.getSize();
+}
+
+int AsyncFileInputStream::read (void* destBuffer, int maxBytesToRead)
+{
+    // The caller shouldn't call this with a negative size or a null buffer!
+    jassert (destBuffer != nullptr && maxBytesToRead >= 0);
+
+    auto* dest = static_cast<char*> (destBuffer);
+    int numRead = 0;
+
+    while (maxBytesToRead > 0 && currentPosition < file.getSize())
+    {
+        auto* block = getBlockFor (currentPosition);
+
+        if (block == nullptr)
+            break;
+
+        auto offset = (int) (currentPosition - block->start);
+        auto numAvailable = block->request.getNumBytesRead() - offset;
+
+        if (numAvailable <= 0)
+            break;
+
+        auto num = jmin (maxBytesToRead, numAvailable);
+        memcpy (dest, block->data + offset, (size_t) num);
+
+        dest += num;
+        numRead += num;
+        maxBytesToRead -= num;
+        currentPosition += num;
+    }
+
+    return numRead;
+}
+
+//==============================================================================
+AsyncFileInputStream::Block* AsyncFileInputStream::findBlock (int64 start) const noexcept
+{
+    for (auto* b : blocks)
+        if (b->start == start)
+            return b;
+
+    return nullptr;
+}
+
+AsyncFileInputStream::Block* AsyncFileInputStream::getBlockFor (int64 position)
+{
+    auto start = position - position % blockSize;
+    readAhead (start);
+
+    if (auto* block = findBlock (start))
+    {
+        block->request.waitUntilDone (-1);
+
+        if (block->request.getNumBytesRead() > 0)
+            return block;
+
+        // if the read failed, the block will be tried again next time
+        block->start = -1;
+    }
+
+    return nullptr;
+}
+
+void AsyncFileInputStream::readAhead (int64 firstBlockStart)
+{
+    auto windowEnd = firstBlockStart + blocks.size() * (int64) blockSize;
+    Array<AsyncFileReadQueue::Request*> requests;
+
+    for (auto start = firstBlockStart; start < jmin (windowEnd, file.getSize()); start += blockSize)
+    {
+        if (findBlock (start) != nullptr)
+            continue;
+
+        for (auto* b : blocks)
+        {
+            if (b->start < firstBlockStart || b->start >= windowEnd)
+            {
+                // (after a jump in position, the old block might still be being read)
+                b->request.waitUntilDone (-1);
+
+                b->start = start;
+                b->request.setRead (file, start, b->data, (int) jmin ((int64) blockSize, file.getSize() - start));
+                requests.add (&b->request);
+                break;
+            }
+        }
+    }
+
+    if (! requests.isEmpty())
+        queue.submit (requests.getRawDataPointer(), requests.size());
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AsyncFileInputStreamTests  : public UnitTest
+{
+public:
+    AsyncFileInputStreamTests()  : UnitTest ("AsyncFileInputStream", "Files") {}
+
+    void runTest() override
+    {
+        TemporaryFile tempFile;
+        MemoryBlock data;
+        data.setSize (100000);
+
+        auto r = getRandom();
+
+        for (size_t i = 0; i < data.getSize(); ++i)
+            data[(int) i] = (char) r.nextInt (256);
+
+        tempFile.getFile().replaceWithData (data.getData(), data.getSize());
+
+        AsyncFileReadQueue queue (8, 2);
+
+        beginTest ("Sequential reads");
+        {
+            AsyncFileInputStream stream (tempFile.getFile(), &queue, 4096, 3);
+            expect (stream.openedOk());
+            expectEquals (stream.getTotalLength(), (int64) data.getSize());
+
+            MemoryBlock result;
+            char buffer[1000];
+
+            while (! stream.isExhausted())
+            {
+                auto num = stream.read (buffer, r.nextInt (1000));
+                result.append (buffer, (size_t) num);
+            }
+
+            expect (result == data);
+            expectEquals (stream.read (buffer, 100), 0);
+        }
+
+        beginTest ("Random access");
+        {
+            AsyncFileInputStream stream (tempFile.getFile(), &queue, 1000, 4);
+            HeapBlock<char> buffer (5000);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                auto pos = (int64) r.nextInt ((int) data.getSize() + 100);
+                auto num = r.nextInt (5000);
+                expect (stream.setPosition (pos));
+
+                auto expectedNum = (int) jlimit ((int64) 0, (int64) num, (int64) data.getSize() - pos);
+                expectEquals (stream.read (buffer, num), expectedNum);
+                expect (memcmp (buffer, data.begin() + jmin (pos, (int64) data.getSize()), (size_t) expectedNum) == 0);
+            }
+        }
+
+        beginTest ("Shared queue");
+        {
+            AsyncFileInputStream stream (tempFile.getFile());
+            MemoryBlock result;
+            stream.readIntoMemoryBlock (result);
+            expect (result == data);
+        }
+    }
+};
+
+static AsyncFileInputStreamTests asyncFileInputStreamTests;
+
+#endif
+
+} // namespace juce
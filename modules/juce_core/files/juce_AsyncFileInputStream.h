@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An input stream that reads a file ahead of its current position using an
+    AsyncFileReadQueue.
+
+    The file is read in blocks which start at multiples of the block size, and a number
+    of the blocks after the current position are kept in flight at once. This works well
+    for streaming lots of files at the same time, e.g. when an AudioFormatReader is
+    created on one of these, as the reads for all the files get passed to the disk in
+    batches instead of one at a time.
+
+    @see AsyncFileReadQueue, FileInputStream
+
+    @tags{Core}
+*/
+class JUCE_API  AsyncFileInputStream  : public InputStream
+{
+public:
+    //==============================================================================
+    /** Creates a stream to read from a file.
+
+        @param fileToRead           the file to read
+        @param queueToUse           the queue to perform the reads on. If this is nullptr,
+                                    a queue that's shared between all the streams will be used
+        @param blockSize            the number of bytes to read in each block
+        @param numBlocksToReadAhead the number of blocks to keep in memory
+    */
+    AsyncFileInputStream (const File& fileToRead,
+                          AsyncFileReadQueue* queueToUse = nullptr,
+                          int blockSize = 65536,
+                          int numBlocksToReadAhead = 4);
+
+    /** Destructor. */
+    ~AsyncFileInputStream();
+
+    //==============================================================================
+    /** Returns the file that this stream is reading from. */
+    const File& getFile() const noexcept                { return file.getFile(); }
+
+    /** Returns true if the stream opened without problems. */
+    bool openedOk() const noexcept                      { return file.openedOk(); }
+
+    /** Returns true if the stream couldn't be opened for some reason. */
+    bool failedToOpen() const noexcept                  { return ! file.openedOk(); }
+
+    //==============================================================================
+    int64 getTotalLength() override;
+    int read (void*, int) override;
+    bool isExhausted() override;
+    int64 getPosition() override;
+    bool setPosition (int64) override;
+
+private:
+    //==============================================================================
+    struct Block;
+
+    SharedResourcePointer<AsyncFileReadQueue> sharedQueue;
+    AsyncFileReadQueue& queue;
+    AsyncFileReadQueue::ReadableFile file;
+    OwnedArray<Block> blocks;
+    const int blockSize;
+    int64 currentPosition = 0;
+
+    Block* findBlock (int64 start) const noexcept;
+    Block* getBlockFor (int64 position);
+    void readAhead (int64 firstBlockStart);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncFileInputStream)
+};
+
+} // namespace juce
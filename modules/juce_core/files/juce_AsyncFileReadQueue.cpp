@@ -0,0 +1,312 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if ! JUCE_IO_URING_AVAILABLE
+struct AsyncFileReadQueue::KernelQueue
+{
+    static KernelQueue* create (int)                        { return nullptr; }
+    void submit (Request* const*, int)                      {}
+};
+#endif
+
+//==============================================================================
+struct AsyncFileReadQueue::ReadThread  : public Thread
+{
+    ReadThread (AsyncFileReadQueue& q)  : Thread ("File reader"), owner (q) {}
+
+    ~ReadThread()
+    {
+        stopThread (4000);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (auto* request = owner.getNextWaitingRequest())
+                performRead (*request);
+            else
+                wait (-1);
+        }
+    }
+
+    AsyncFileReadQueue& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadThread)
+};
+
+//==============================================================================
+AsyncFileReadQueue::ReadableFile::ReadableFile (const File& f)  : file (f)
+{
+    openHandle();
+
+    if (handle != nullptr)
+        size = file.getSize();
+}
+
+AsyncFileReadQueue::ReadableFile::~ReadableFile()
+{
+    closeHandle();
+}
+
+//==============================================================================
+AsyncFileReadQueue::Request::Request() {}
+
+AsyncFileReadQueue::Request::~Request()
+{
+    if (state.load() != idleState)
+        waitUntilDone (-1);
+}
+
+void AsyncFileReadQueue::Request::setRead (ReadableFile& f, int64 pos, void* dest, int num) noexcept
+{
+    // you can't change a request while it's still in flight!
+    jassert (! isPending());
+    jassert (pos >= 0 && num >= 0);
+
+    file = &f;
+    position = pos;
+    destination = static_cast<char*> (dest);
+    numBytes = num;
+}
+
+bool AsyncFileReadQueue::Request::waitUntilDone (int timeoutMilliseconds)
+{
+    if (state.load() == idleState)
+        return true;
+
+    if (! finishedEvent.wait (timeoutMilliseconds))
+        return false;
+
+    // the event is signalled just before the state changes, so this won't wait for long
+    while (! isDone())
+        Thread::yield();
+
+    return true;
+}
+
+//==============================================================================
+AsyncFileReadQueue::AsyncFileReadQueue (int maxNumRequestsInFlight, int numThreads, bool allowKernelQueue)
+{
+    jassert (maxNumRequestsInFlight > 0 && numThreads > 0);
+
+    if (allowKernelQueue)
+        kernelQueue.reset (KernelQueue::create (maxNumRequestsInFlight));
+
+    if (kernelQueue == nullptr)
+    {
+        for (int i = 0; i < numThreads; ++i)
+        {
+            auto* t = threads.add (new ReadThread (*this));
+            t->startThread();
+        }
+    }
+}
+
+AsyncFileReadQueue::~AsyncFileReadQueue()
+{
+    // All the requests must have finished before the queue is deleted!
+    jassert (waitingRequests.isEmpty());
+
+    kernelQueue.reset();
+    threads.clear();
+}
+
+void AsyncFileReadQueue::submit (Request& request)
+{
+    auto* r = &request;
+    submit (&r, 1);
+}
+
+void AsyncFileReadQueue::submit (Request* const* requests, int numRequests)
+{
+    for (int i = 0; i < numRequests; ++i)
+    {
+        auto& r = *requests[i];
+
+        // you need to call setRead() before submitting a request, and can't
+        // submit it again until it has finished
+        jassert (r.file != nullptr && ! r.isPending());
+
+        r.numBytesDone = 0;
+        r.numBytesRead = 0;
+        r.finishedEvent.reset();
+        r.state = Request::pendingState;
+    }
+
+    if (kernelQueue != nullptr)
+    {
+        kernelQueue->submit (requests, numRequests);
+        return;
+    }
+
+    {
+        const ScopedLock sl (lock);
+        waitingRequests.addArray (requests, numRequests);
+    }
+
+    for (auto* t : threads)
+        t->notify();
+}
+
+AsyncFileReadQueue::Request* AsyncFileReadQueue::getNextWaitingRequest()
+{
+    const ScopedLock sl (lock);
+    return waitingRequests.isEmpty() ? nullptr : waitingRequests.removeAndReturn (0);
+}
+
+void AsyncFileReadQueue::performRead (Request& r)
+{
+    auto num = r.file->readAt (r.position, r.destination, r.numBytes);
+
+    if (num >= 0)
+        r.numBytesDone = num;
+
+    requestFinished (r, num >= 0);
+}
+
+void AsyncFileReadQueue::requestFinished (Request& r, bool succeeded)
+{
+    r.numBytesRead = succeeded ? r.numBytesDone : -1;
+
+    if (r.onFinished != nullptr)
+        r.onFinished (r);
+
+    r.finishedEvent.signal();
+    r.state = Request::doneState;
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AsyncFileReadQueueTests  : public UnitTest
+{
+public:
+    AsyncFileReadQueueTests()  : UnitTest ("AsyncFileReadQueue", "Files") {}
+
+    void runTest() override
+    {
+        TemporaryFile tempFile;
+        MemoryBlock data;
+        createTestFile (tempFile.getFile(), data);
+
+        for (int useKernel = 2; --useKernel >= 0;)
+        {
+            AsyncFileReadQueue queue (16, 3, useKernel != 0);
+
+            if (useKernel != 0)
+                logMessage (queue.isUsingKernelQueue() ? "Using the kernel queue" : "Kernel queue not available");
+
+            beginTest ("Single reads");
+            {
+                AsyncFileReadQueue::ReadableFile file (tempFile.getFile());
+                expect (file.openedOk());
+                expectEquals (file.getSize(), (int64) data.getSize());
+
+                HeapBlock<char> buffer (1000);
+                AsyncFileReadQueue::Request request;
+                request.setRead (file, 12345, buffer, 1000);
+                queue.submit (request);
+
+                expect (request.waitUntilDone (5000));
+                expect (request.isDone());
+                expectEquals (request.getNumBytesRead(), 1000);
+                expect (memcmp (buffer, addBytesToPointer (data.getData(), 12345), 1000) == 0);
+
+                request.setRead (file, (int64) data.getSize() - 10, buffer, 1000);
+                queue.submit (request);
+                expect (request.waitUntilDone (5000));
+                expectEquals (request.getNumBytesRead(), 10);
+
+                request.setRead (file, (int64) data.getSize() + 10, buffer, 1000);
+                queue.submit (request);
+                expect (request.waitUntilDone (5000));
+                expectEquals (request.getNumBytesRead(), 0);
+            }
+
+            beginTest ("Batched reads");
+            {
+                AsyncFileReadQueue::ReadableFile file (tempFile.getFile());
+                auto r = getRandom();
+
+                const int numRequests = 100, maxSize = 20000;
+                OwnedArray<AsyncFileReadQueue::Request> requests;
+                HeapBlock<char> buffers (numRequests * maxSize);
+                Array<int> sizes;
+                std::atomic<int> numCallbacks { 0 };
+
+                for (int i = 0; i < numRequests; ++i)
+                {
+                    auto* request = requests.add (new AsyncFileReadQueue::Request());
+                    sizes.add (r.nextInt (maxSize));
+                    request->setRead (file, r.nextInt ((int) data.getSize()), buffers + i * maxSize, sizes.getLast());
+                    request->onFinished = [&numCallbacks] (AsyncFileReadQueue::Request&) { ++numCallbacks; };
+                }
+
+                queue.submit (requests.getRawDataPointer(), numRequests);
+
+                for (int i = 0; i < numRequests; ++i)
+                {
+                    auto& request = *requests.getUnchecked (i);
+                    expect (request.waitUntilDone (5000));
+
+                    auto expectedSize = (int) jmin ((int64) sizes[i], (int64) data.getSize() - request.getPosition());
+                    expectEquals (request.getNumBytesRead(), expectedSize);
+                    expect (memcmp (buffers + i * maxSize,
+                                    addBytesToPointer (data.getData(), request.getPosition()),
+                                    (size_t) expectedSize) == 0);
+                }
+
+                expectEquals (numCallbacks.load(), numRequests);
+            }
+        }
+
+        beginTest ("Missing files");
+        {
+            AsyncFileReadQueue::ReadableFile file (tempFile.getFile().getSiblingFile ("doesnt_exist"));
+            expect (! file.openedOk());
+            expectEquals (file.getSize(), (int64) 0);
+        }
+    }
+
+    static void createTestFile (const File& file, MemoryBlock& data)
+    {
+        data.setSize (300000);
+        auto* d = static_cast<uint8*> (data.getData());
+
+        for (size_t i = 0; i < data.getSize(); ++i)
+            d[i] = (uint8) ((i * 7) ^ (i >> 8));
+
+        file.replaceWithData (data.getData(), data.getSize());
+    }
+};
+
+static AsyncFileReadQueueTests asyncFileReadQueueTests;
+
+#endif
+
+} // namespace juce
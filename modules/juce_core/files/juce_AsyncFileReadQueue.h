@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Performs reads from files in the background, so that lots of small reads from
+    lots of different files can be kept in flight at the same time.
+
+    On Linux, the queue hands the reads to the kernel in batches using io_uring when
+    it's available (see the JUCE_USE_IO_URING flag). Everywhere else, or if the kernel
+    doesn't support it, a small pool of threads performs the reads with positional
+    read calls, so that many reads of the same file can happen at once.
+
+    To use it, open a ReadableFile, fill in some Request objects, and pass them to
+    submit(). Each request can then be polled or waited for, or can call a function
+    when it's finished.
+
+    @code
+    AsyncFileReadQueue queue;
+    AsyncFileReadQueue::ReadableFile file (myFile);
+
+    HeapBlock<char> data (8192);
+    AsyncFileReadQueue::Request request;
+    request.setRead (file, 0, data, 8192);
+    queue.submit (request);
+
+    // ...do something else...
+
+    if (request.waitUntilDone (-1) && request.getNumBytesRead() > 0)
+        ...
+    @endcode
+
+    @see AsyncFileInputStream
+
+    @tags{Core}
+*/
+class JUCE_API  AsyncFileReadQueue
+{
+public:
+    //==============================================================================
+    /** Creates a queue.
+
+        @param maxNumRequestsInFlight   the number of reads that can be waiting in the kernel
+                                        at once - any more than this are held by the queue
+                                        until some of the others have finished
+        @param numThreads               the number of threads to use if the kernel can't
+                                        do the reads itself
+        @param allowKernelQueue         if false, the queue will always use its own threads
+    */
+    AsyncFileReadQueue (int maxNumRequestsInFlight = 128,
+                        int numThreads = 4,
+                        bool allowKernelQueue = true);
+
+    /** Destructor.
+        Any requests that were submitted must have finished before the queue is deleted.
+    */
+    ~AsyncFileReadQueue();
+
+    //==============================================================================
+    /** A file that has been opened so that reads from it can be submitted to a queue.
+
+        A ReadableFile must not be deleted while there are still requests in flight
+        that read from it.
+    */
+    class JUCE_API  ReadableFile
+    {
+    public:
+        /** Opens a file for reading. */
+        explicit ReadableFile (const File& fileToRead);
+
+        /** Destructor. */
+        ~ReadableFile();
+
+        /** Returns true if the file was opened successfully. */
+        bool openedOk() const noexcept              { return handle != nullptr; }
+
+        /** Returns the size of the file when it was opened. */
+        int64 getSize() const noexcept              { return size; }
+
+        /** Returns the file that this object is reading. */
+        const File& getFile() const noexcept        { return file; }
+
+        /** Reads a block of data straight away on the calling thread, without changing
+            any file position. Returns the number of bytes read, or -1 if there was an error.
+        */
+        int readAt (int64 position, void* destBuffer, int numBytes);
+
+    private:
+        File file;
+        void* handle = nullptr;
+        int64 size = 0;
+
+        void openHandle();
+        void closeHandle();
+
+        friend class AsyncFileReadQueue;
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadableFile)
+    };
+
+    //==============================================================================
+    /** A read that can be submitted to a queue.
+
+        A request can be re-used for a new read as soon as it has finished. If a request
+        is deleted while it's still in flight, its destructor will wait for the read
+        to finish.
+    */
+    class JUCE_API  Request
+    {
+    public:
+        /** Creates an empty request. */
+        Request();
+
+        /** Destructor. */
+        ~Request();
+
+        /** Sets the block of data that this request should read.
+            The file and the destination buffer must stay valid until the read has finished.
+        */
+        void setRead (ReadableFile& file, int64 position, void* destBuffer, int numBytes) noexcept;
+
+        /** Returns true if the request has been submitted and hasn't finished yet. */
+        bool isPending() const noexcept             { return state.load() == pendingState; }
+
+        /** Returns true if the request has been submitted and has finished. */
+        bool isDone() const noexcept                { return state.load() == doneState; }
+
+        /** Waits for a submitted request to finish.
+            Returns false if the timeout expired first.
+        */
+        bool waitUntilDone (int timeoutMilliseconds);
+
+        /** Returns the number of bytes that were read, or -1 if there was an error.
+            This will be less than the number requested if the read went past the end
+            of the file. It's only valid once the request has finished.
+        */
+        int getNumBytesRead() const noexcept        { return numBytesRead; }
+
+        /** Returns the position in the file that this request reads from. */
+        int64 getPosition() const noexcept          { return position; }
+
+        /** If this is set, it'll be called on one of the queue's threads when the read
+            finishes. It mustn't submit this request again, or block for long.
+        */
+        std::function<void (Request&)> onFinished;
+
+    private:
+        enum { idleState, pendingState, doneState };
+
+        // this is laid out in the same way as a POSIX iovec
+        struct IOVector
+        {
+            void* base;
+            size_t size;
+        };
+
+        ReadableFile* file = nullptr;
+        int64 position = 0;
+        char* destination = nullptr;
+        int numBytes = 0, numBytesDone = 0, numBytesRead = 0;
+        std::atomic<int> state { idleState };
+        WaitableEvent finishedEvent { true };
+        IOVector ioVector;
+
+        friend class AsyncFileReadQueue;
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Request)
+    };
+
+    //==============================================================================
+    /** Starts performing a read in the background. */
+    void submit (Request& request);
+
+    /** Starts performing a set of reads in the background.
+        Submitting several reads in one call lets the queue pass them to the kernel
+        in a single batch.
+    */
+    void submit (Request* const* requests, int numRequests);
+
+    /** Returns true if the reads are being performed by the kernel rather than by
+        the queue's own threads.
+    */
+    bool isUsingKernelQueue() const noexcept        { return kernelQueue != nullptr; }
+
+private:
+    //==============================================================================
+    struct KernelQueue;
+    struct ReadThread;
+
+    std::unique_ptr<KernelQueue> kernelQueue;
+    OwnedArray<ReadThread> threads;
+    Array<Request*> waitingRequests;
+    CriticalSection lock;
+
+    Request* getNextWaitingRequest();
+    static void performRead (Request&);
+    static void requestFinished (Request&, bool succeeded);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncFileReadQueue)
+};
+
+} // namespace juce
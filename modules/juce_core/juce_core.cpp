@@ -39,6 +39,7 @@
 #include <locale>
 #include <cctype>
 #include <cstdarg>
+#include <unordered_map>
 
 #if ! JUCE_ANDROID
  #include <sys/timeb.h>
@@ -83,6 +84,19 @@
   #if JUCE_USE_CURL
    #include <curl/curl.h>
   #endif
+
+  #if JUCE_USE_IO_URING
+   #include <sys/syscall.h>
+   #include <sys/uio.h>
+   #include <sys/mman.h>
+
+   #if defined (__NR_io_uring_setup) && defined (__has_include)
+    #if __has_include (<linux/io_uring.h>)
+     #include <linux/io_uring.h>
+     #define JUCE_IO_URING_AVAILABLE 1
+    #endif
+   #endif
+  #endif
  #endif
 
  #include <pwd.h>
@@ -218,6 +232,7 @@
 #endif
 #include "native/juce_linux_SystemStats.cpp"
 #include "native/juce_linux_Threads.cpp"
+#include "native/juce_linux_AsyncFileReadQueue.cpp"
 
 //==============================================================================
 #elif JUCE_ANDROID
@@ -231,6 +246,8 @@
 
 #endif
 
+#include "files/juce_AsyncFileReadQueue.cpp"
+#include "files/juce_AsyncFileInputStream.cpp"
 #include "threads/juce_ChildProcess.cpp"
 #include "threads/juce_HighResolutionTimer.cpp"
 #include "network/juce_URL.cpp"
@@ -240,6 +257,8 @@
 //==============================================================================
 #if JUCE_UNIT_TESTS
 #include "containers/juce_HashMap_test.cpp"
+#include "containers/juce_FlatHashMap_test.cpp"
+#include "containers/juce_LockFreeQueue_test.cpp"
 #endif
 
 //==============================================================================
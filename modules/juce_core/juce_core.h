@@ -144,6 +144,19 @@
  #endif
 #endif
 
+/** Config: JUCE_USE_IO_URING
+    Lets AsyncFileReadQueue pass its reads to the kernel using io_uring (Linux only).
+    If the kernel that the app is running on doesn't support it, the queue will still
+    fall back to using threads.
+*/
+#ifndef JUCE_USE_IO_URING
+ #if JUCE_LINUX
+  #define JUCE_USE_IO_URING 1
+ #else
+  #define JUCE_USE_IO_URING 0
+ #endif
+#endif
+
 /** Config: JUCE_LOAD_CURL_SYMBOLS_LAZILY
     If enabled, JUCE will load libcurl lazily when required (for example, when WebInputStream
     is used). Enabling this flag may also help with library dependency erros as linking
@@ -265,6 +278,7 @@ namespace juce
 #include "containers/juce_SortedSet.h"
 #include "containers/juce_SparseSet.h"
 #include "containers/juce_AbstractFifo.h"
+#include "containers/juce_LockFreeQueue.h"
 #include "text/juce_NewLine.h"
 #include "text/juce_StringPool.h"
 #include "text/juce_Identifier.h"
@@ -280,6 +294,7 @@ namespace juce
 #include "containers/juce_NamedValueSet.h"
 #include "containers/juce_DynamicObject.h"
 #include "containers/juce_HashMap.h"
+#include "containers/juce_FlatHashMap.h"
 #include "system/juce_SystemStats.h"
 #include "memory/juce_HeavyweightLeakedObjectDetector.h"
 #include "time/juce_RelativeTime.h"
@@ -339,6 +354,8 @@ namespace juce
 #include "zip/juce_ZipFile.h"
 #include "containers/juce_PropertySet.h"
 #include "memory/juce_SharedResourcePointer.h"
+#include "files/juce_AsyncFileReadQueue.h"
+#include "files/juce_AsyncFileInputStream.h"
 
 #if JUCE_CORE_INCLUDE_OBJC_HELPERS && (JUCE_MAC || JUCE_IOS)
  #include "native/juce_osx_ObjCHelpers.h"
@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_IO_URING_AVAILABLE
+
+/*  Submits reads to the kernel using an io_uring submission queue, and uses a thread
+    to wait for them to finish. This talks to the kernel directly rather than needing
+    liburing to be installed.
+*/
+struct AsyncFileReadQueue::KernelQueue  : private Thread
+{
+    static KernelQueue* create (int maxNumRequestsInFlight)
+    {
+        std::unique_ptr<KernelQueue> q (new KernelQueue (maxNumRequestsInFlight));
+
+        if (q->ringFD < 0)
+            return nullptr;
+
+        q->startThread (8);
+        return q.release();
+    }
+
+    ~KernelQueue()
+    {
+        if (isThreadRunning())
+        {
+            signalThreadShouldExit();
+
+            {
+                const ScopedLock sl (lock);
+
+                // All the requests must have finished before the queue is deleted!
+                jassert (numInFlight == 0 && waitingRequests.isEmpty());
+
+                // a no-op with no request attached wakes the thread up so it can exit
+                auto& sqe = getNextSubmissionEntry();
+                sqe.opcode = IORING_OP_NOP;
+                submitEntries();
+            }
+
+            waitForThreadToExit (-1);
+        }
+
+        if (submissionEntries != nullptr)   munmap (submissionEntries, submissionEntriesSize);
+        if (completionRing != nullptr && completionRing != submissionRing)  munmap (completionRing, completionRingSize);
+        if (submissionRing != nullptr)      munmap (submissionRing, submissionRingSize);
+
+        if (ringFD >= 0)
+            close (ringFD);
+    }
+
+    void submit (Request* const* requests, int numRequests)
+    {
+        const ScopedLock sl (lock);
+        waitingRequests.addArray (requests, numRequests);
+        submitWaitingRequests();
+    }
+
+private:
+    //==============================================================================
+    CriticalSection lock;
+    Array<Request*> waitingRequests;
+    int ringFD = -1, maxNumInFlight = 0, numInFlight = 0;
+    uint32 numUnpublished = 0, numUnsubmitted = 0;
+
+    void* submissionRing = nullptr;
+    void* completionRing = nullptr;
+    io_uring_sqe* submissionEntries = nullptr;
+    size_t submissionRingSize = 0, completionRingSize = 0, submissionEntriesSize = 0;
+
+    uint32* sqHead = nullptr;
+    uint32* sqTail = nullptr;
+    uint32* sqMask = nullptr;
+    uint32* sqArray = nullptr;
+    uint32* cqHead = nullptr;
+    uint32* cqTail = nullptr;
+    uint32* cqMask = nullptr;
+    io_uring_cqe* completionEntries = nullptr;
+
+    static_assert (sizeof (Request::IOVector) == sizeof (iovec), "Request::IOVector must match iovec");
+
+    //==============================================================================
+    explicit KernelQueue (int maxNumRequestsInFlight)  : Thread ("File reader")
+    {
+        io_uring_params params;
+        zerostruct (params);
+
+        ringFD = (int) syscall (__NR_io_uring_setup, (unsigned) maxNumRequestsInFlight, &params);
+
+        if (ringFD >= 0 && ! mapRings (params))
+        {
+            close (ringFD);
+            ringFD = -1;
+        }
+
+        // the completion queue is bigger than this, so it can never overflow
+        maxNumInFlight = (int) params.sq_entries;
+    }
+
+    bool mapRings (const io_uring_params& params)
+    {
+        submissionRingSize = params.sq_off.array + params.sq_entries * sizeof (uint32);
+        completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+        submissionEntriesSize = params.sq_entries * sizeof (io_uring_sqe);
+
+       #ifdef IORING_FEAT_SINGLE_MMAP
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+       #else
+        const bool singleMap = false;
+       #endif
+
+        if (singleMap)
+            submissionRingSize = completionRingSize = jmax (submissionRingSize, completionRingSize);
+
+        submissionRing = mapRegion (submissionRingSize, IORING_OFF_SQ_RING);
+
+        if (submissionRing == nullptr)
+            return false;
+
+        completionRing = singleMap ? submissionRing : mapRegion (completionRingSize, IORING_OFF_CQ_RING);
+        submissionEntries = static_cast<io_uring_sqe*> (mapRegion (submissionEntriesSize, IORING_OFF_SQES));
+
+        if (completionRing == nullptr || submissionEntries == nullptr)
+            return false;
+
+        sqHead  = addBytesToPointer (static_cast<uint32*> (submissionRing), params.sq_off.head);
+        sqTail  = addBytesToPointer (static_cast<uint32*> (submissionRing), params.sq_off.tail);
+        sqMask  = addBytesToPointer (static_cast<uint32*> (submissionRing), params.sq_off.ring_mask);
+        sqArray = addBytesToPointer (static_cast<uint32*> (submissionRing), params.sq_off.array);
+        cqHead  = addBytesToPointer (static_cast<uint32*> (completionRing), params.cq_off.head);
+        cqTail  = addBytesToPointer (static_cast<uint32*> (completionRing), params.cq_off.tail);
+        cqMask  = addBytesToPointer (static_cast<uint32*> (completionRing), params.cq_off.ring_mask);
+        completionEntries = addBytesToPointer (static_cast<io_uring_cqe*> (completionRing), params.cq_off.cqes);
+
+        return true;
+    }
+
+    void* mapRegion (size_t size, int64 offset)
+    {
+        auto* address = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFD, (off_t) offset);
+        return address != MAP_FAILED ? address : nullptr;
+    }
+
+    int enter (uint32 numToSubmit, uint32 minToComplete, uint32 flags) noexcept
+    {
+        return (int) syscall (__NR_io_uring_enter, ringFD, numToSubmit, minToComplete, flags, nullptr, 0);
+    }
+
+    //==============================================================================
+    // (these must be called with the lock held)
+    io_uring_sqe& getNextSubmissionEntry() noexcept
+    {
+        auto tail = *sqTail + numUnpublished++;
+
+        // the queue never holds more than its size, as each batch is submitted straight away
+        jassert (tail - __atomic_load_n (sqHead, __ATOMIC_ACQUIRE) < *sqMask + 1);
+
+        auto index = tail & *sqMask;
+        auto& sqe = submissionEntries[index];
+        zerostruct (sqe);
+
+        sqArray[index] = index;
+        ++numUnsubmitted;
+        return sqe;
+    }
+
+    void submitWaitingRequests()
+    {
+        while (numInFlight < maxNumInFlight && ! waitingRequests.isEmpty())
+        {
+            auto& r = *waitingRequests.removeAndReturn (0);
+            auto& sqe = getNextSubmissionEntry();
+
+            r.ioVector.base = r.destination + r.numBytesDone;
+            r.ioVector.size = (size_t) (r.numBytes - r.numBytesDone);
+
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = getFD (r.file->handle);
+            sqe.off = (uint64) (r.position + r.numBytesDone);
+            sqe.addr = (uint64) (pointer_sized_uint) &r.ioVector;
+            sqe.len = 1;
+            sqe.user_data = (uint64) (pointer_sized_uint) &r;
+
+            ++numInFlight;
+        }
+
+        submitEntries();
+    }
+
+    void submitEntries()
+    {
+        if (numUnpublished > 0)
+        {
+            __atomic_store_n (sqTail, *sqTail + numUnpublished, __ATOMIC_RELEASE);
+            numUnpublished = 0;
+        }
+
+        while (numUnsubmitted > 0)
+        {
+            auto result = enter (numUnsubmitted, 0, 0);
+
+            if (result > 0)
+                numUnsubmitted -= (uint32) result;
+            else if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                break;  // leave the entries in the queue, so they'll go with the next batch
+            else if (result == 0)
+                break;
+        }
+    }
+
+    //==============================================================================
+    void run() override
+    {
+        bool stopEntryFinished = false;
+
+        for (;;)
+        {
+            enter (0, 1, IORING_ENTER_GETEVENTS);
+
+            Array<Request*> unfinished;
+            int numFinished = 0;
+
+            auto head = *cqHead;
+            auto tail = __atomic_load_n (cqTail, __ATOMIC_ACQUIRE);
+
+            for (; head != tail; ++head)
+            {
+                auto& cqe = completionEntries[head & *cqMask];
+                auto* r = reinterpret_cast<Request*> ((pointer_sized_uint) cqe.user_data);
+                auto result = cqe.res;
+
+                if (r == nullptr)
+                {
+                    stopEntryFinished = true;
+                    continue;
+                }
+
+                ++numFinished;
+
+                if (result == -EAGAIN || result == -EINTR)
+                {
+                    unfinished.add (r);
+                }
+                else if (result < 0)
+                {
+                    requestFinished (*r, false);
+                }
+                else
+                {
+                    r->numBytesDone += result;
+
+                    // a short read that didn't reach the end of the file gets carried on
+                    if (result > 0 && r->numBytesDone < r->numBytes)
+                        unfinished.add (r);
+                    else
+                        requestFinished (*r, true);
+                }
+            }
+
+            __atomic_store_n (cqHead, head, __ATOMIC_RELEASE);
+
+            const ScopedLock sl (lock);
+            numInFlight -= numFinished;
+            waitingRequests.insertArray (0, unfinished.getRawDataPointer(), unfinished.size());
+            submitWaitingRequests();
+
+            if (stopEntryFinished && threadShouldExit() && numInFlight == 0)
+                break;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (KernelQueue)
+};
+
+#endif
+
+} // namespace juce
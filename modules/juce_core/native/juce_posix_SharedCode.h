@@ -509,6 +509,50 @@ size_t FileInputStream::readInternal (void* buffer, size_t numBytes)
     return (size_t) result;
 }
 
+//==============================================================================
+void AsyncFileReadQueue::ReadableFile::openHandle()
+{
+    auto f = open (file.getFullPathName().toUTF8(), O_RDONLY, 00644);
+
+    if (f != -1)
+        handle = fdToVoidPointer (f);
+}
+
+void AsyncFileReadQueue::ReadableFile::closeHandle()
+{
+    if (handle != nullptr)
+        close (getFD (handle));
+}
+
+int AsyncFileReadQueue::ReadableFile::readAt (int64 position, void* destBuffer, int numBytes)
+{
+    if (handle == nullptr)
+        return -1;
+
+    int numRead = 0;
+
+    while (numRead < numBytes)
+    {
+        auto result = pread (getFD (handle), static_cast<char*> (destBuffer) + numRead,
+                             (size_t) (numBytes - numRead), (off_t) (position + numRead));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        if (result == 0)
+            break;
+
+        numRead += (int) result;
+    }
+
+    return numRead;
+}
+
 //==============================================================================
 void FileOutputStream::openHandle()
 {
@@ -316,6 +316,54 @@ size_t FileInputStream::readInternal (void* buffer, size_t numBytes)
     return 0;
 }
 
+//==============================================================================
+void AsyncFileReadQueue::ReadableFile::openHandle()
+{
+    auto h = CreateFile (file.getFullPathName().toWideCharPointer(),
+                         GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, 0);
+
+    if (h != INVALID_HANDLE_VALUE)
+        handle = (void*) h;
+}
+
+void AsyncFileReadQueue::ReadableFile::closeHandle()
+{
+    if (handle != nullptr)
+        CloseHandle ((HANDLE) handle);
+}
+
+int AsyncFileReadQueue::ReadableFile::readAt (int64 position, void* destBuffer, int numBytes)
+{
+    if (handle == nullptr)
+        return -1;
+
+    int numRead = 0;
+
+    while (numRead < numBytes)
+    {
+        // with a synchronous handle, the offset in an OVERLAPPED structure just
+        // says where to read from, so several threads can read the file at once
+        OVERLAPPED overlapped = {};
+        auto pos = position + numRead;
+        overlapped.Offset     = (DWORD) (pos & 0xffffffff);
+        overlapped.OffsetHigh = (DWORD) (pos >> 32);
+
+        DWORD actualNum = 0;
+
+        if (! ReadFile ((HANDLE) handle, static_cast<char*> (destBuffer) + numRead,
+                        (DWORD) (numBytes - numRead), &actualNum, &overlapped))
+            return GetLastError() == ERROR_HANDLE_EOF ? numRead : -1;
+
+        if (actualNum == 0)
+            break;
+
+        numRead += (int) actualNum;
+    }
+
+    return numRead;
+}
+
 //==============================================================================
 void FileOutputStream::openHandle()
 {
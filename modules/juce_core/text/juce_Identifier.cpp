@@ -26,38 +26,40 @@ namespace juce
 Identifier::Identifier() noexcept {}
 Identifier::~Identifier() noexcept {}
 
-Identifier::Identifier (const Identifier& other) noexcept  : name (other.name) {}
+Identifier::Identifier (const Identifier& other) noexcept  : hash (other.hash), name (other.name) {}
 
-Identifier::Identifier (Identifier&& other) noexcept : name (static_cast<String&&> (other.name)) {}
+Identifier::Identifier (Identifier&& other) noexcept : hash (other.hash), name (static_cast<String&&> (other.name)) {}
 
 Identifier& Identifier::operator= (Identifier&& other) noexcept
 {
     name = static_cast<String&&> (other.name);
+    hash = other.hash;
     return *this;
 }
 
 Identifier& Identifier::operator= (const Identifier& other) noexcept
 {
     name = other.name;
+    hash = other.hash;
     return *this;
 }
 
 Identifier::Identifier (const String& nm)
-    : name (StringPool::getGlobalPool().getPooledString (nm))
+    : name (StringPool::getGlobalPool().getPooledString (nm, hash))
 {
     // An Identifier cannot be created from an empty string!
     jassert (nm.isNotEmpty());
 }
 
 Identifier::Identifier (const char* nm)
-    : name (StringPool::getGlobalPool().getPooledString (nm))
+    : name (nm != nullptr ? StringPool::getGlobalPool().getPooledString (StringRef (nm), hash) : String())
 {
     // An Identifier cannot be created from an empty string!
     jassert (nm != nullptr && nm[0] != 0);
 }
 
 Identifier::Identifier (String::CharPointerType start, String::CharPointerType end)
-    : name (StringPool::getGlobalPool().getPooledString (start, end))
+    : name (StringPool::getGlobalPool().getPooledString (start, end, hash))
 {
     // An Identifier cannot be created from an empty string!
     jassert (start < end);
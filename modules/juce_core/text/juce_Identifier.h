@@ -116,6 +116,12 @@ public:
     /** Returns true if this Identifier is null */
     bool isNull() const noexcept                                        { return name.isEmpty(); }
 
+    /** Returns a hash code for this identifier.
+        This is the same value as toString().hashCode(), but it's worked out when the
+        Identifier is created, so it doesn't cost anything to call.
+    */
+    int hashCode() const noexcept                                       { return hash; }
+
     /** A null identifier. */
     static Identifier null;
 
@@ -126,6 +132,7 @@ public:
     static bool isValidIdentifier (const String& possibleIdentifier) noexcept;
 
 private:
+    int hash = 0;   // this must be initialised before the name, which sets it
     String name;
 };
 
@@ -199,6 +199,19 @@ public:
         return newText;
     }
 
+    // Used when appending: if a string that isn't shared needs to grow, it's probably being
+    // built up by a series of appends, so it gets some extra space to stop each one from
+    // reallocating. Shared and empty strings still get exactly what they need.
+    static CharPointerType makeUniqueWithSpaceToAppend (const CharPointerType text, size_t numBytes)
+    {
+        auto* b = bufferFromText (text);
+
+        if (b != (StringHolder*) &emptyString && b->refCount.get() <= 0 && b->allocatedNumBytes < numBytes)
+            numBytes = jmax (numBytes, b->allocatedNumBytes + b->allocatedNumBytes / 2);
+
+        return makeUniqueWithByteSize (text, numBytes);
+    }
+
     static size_t getAllocatedNumBytes (const CharPointerType text) noexcept
     {
         return bufferFromText (text)->allocatedNumBytes;
@@ -293,6 +306,11 @@ void String::preallocateBytes (const size_t numBytesNeeded)
     text = StringHolder::makeUniqueWithByteSize (text, numBytesNeeded + sizeof (CharPointerType::CharType));
 }
 
+void String::preallocateBytesToAppend (const size_t numBytesNeeded)
+{
+    text = StringHolder::makeUniqueWithSpaceToAppend (text, numBytesNeeded + sizeof (CharPointerType::CharType));
+}
+
 int String::getReferenceCount() const noexcept
 {
     return StringHolder::getReferenceCount (text);
@@ -611,6 +629,7 @@ struct HashGenerator
 int String::hashCode() const noexcept       { return (int) HashGenerator<uint32>    ::calculate (text); }
 int64 String::hashCode64() const noexcept   { return (int64) HashGenerator<uint64>  ::calculate (text); }
 size_t String::hash() const noexcept        { return HashGenerator<size_t>          ::calculate (text); }
+int StringRef::hashCode() const noexcept    { return (int) HashGenerator<uint32>    ::calculate (text); }
 
 //==============================================================================
 JUCE_API bool JUCE_CALLTYPE operator== (const String& s1, const String& s2) noexcept            { return s1.compare (s2) == 0; }
@@ -788,7 +807,7 @@ void String::appendCharPointer (const CharPointerType startOfTextToAppend,
     if (extraBytesNeeded > 0)
     {
         auto byteOffsetOfNull = getByteOffsetOfEnd();
-        preallocateBytes (byteOffsetOfNull + (size_t) extraBytesNeeded);
+        preallocateBytesToAppend (byteOffsetOfNull + (size_t) extraBytesNeeded);
 
         auto* newStringStart = addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull);
         memcpy (newStringStart, startOfTextToAppend.getAddress(), (size_t) extraBytesNeeded);
@@ -870,7 +889,7 @@ String& String::operator+= (const int64 number)        { return StringHelpers::o
 String& String::operator+= (const uint64 number)       { return StringHelpers::operationAddAssign<uint64>       (*this, number); }
 
 //==============================================================================
-JUCE_API String JUCE_CALLTYPE operator+ (const char* s1, const String& s2)    { String s (s1); return s += s2; }
+JUCE_API String JUCE_CALLTYPE operator+ (const char* s1, const String& s2)    { return s1 != nullptr ? String::concatenate ({ s1, s2 }) : s2; }
 JUCE_API String JUCE_CALLTYPE operator+ (const wchar_t* s1, const String& s2) { String s (s1); return s += s2; }
 
 JUCE_API String JUCE_CALLTYPE operator+ (char s1, const String& s2)           { return String::charToString ((juce_wchar) (uint8) s1) + s2; }
@@ -1219,6 +1238,30 @@ String String::repeatedString (StringRef stringToRepeat, int numberOfTimesToRepe
     return result;
 }
 
+String String::concatenate (std::initializer_list<StringRef> strings)
+{
+    size_t totalBytes = 0;
+
+    for (auto& s : strings)
+        totalBytes += findByteOffsetOfEnd (s.text);
+
+    if (totalBytes == 0)
+        return {};
+
+    String result { PreallocationBytes (totalBytes) };
+    auto* dest = reinterpret_cast<char*> (result.text.getAddress());
+
+    for (auto& s : strings)
+    {
+        auto numBytes = findByteOffsetOfEnd (s.text);
+        memcpy (dest, s.text.getAddress(), numBytes);
+        dest += numBytes;
+    }
+
+    CharPointerType (reinterpret_cast<CharPointerType::CharType*> (dest)).writeNull();
+    return result;
+}
+
 String String::paddedLeft (const juce_wchar padCharacter, int minimumLength) const
 {
     jassert (padCharacter != 0);
@@ -2763,11 +2806,93 @@ public:
 
             expectEquals (String::toDecimalStringWithSignificantFigures (-0.0000000000019, 1), String ("-0.000000000002"));
         }
+
+        {
+            beginTest ("Concatenation");
+
+            String a ("abc"), b (CharPointer_UTF8 ("d\xc3\xa9" "f")), empty;
+
+            expectEquals (String::concatenate ({ a, "-", b, empty, "!" }), String (CharPointer_UTF8 ("abc-d\xc3\xa9" "f!")));
+            expectEquals (String::concatenate ({ a }), a);
+            expect (String::concatenate ({ empty, "" }).isEmpty());
+            expect (String::concatenate ({}).isEmpty());
+
+            expectEquals ("xyz" + a, String ("xyzabc"));
+            expectEquals ((const char*) nullptr + a, a);
+
+            String built, copy;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                built << i << ',';
+
+                if (i == 500)
+                    copy = built;
+            }
+
+            expectEquals (built.upToFirstOccurrenceOf (",", false, false), String ("0"));
+            expectEquals (built.fromLastOccurrenceOf (",", false, false), String());
+            expect (built.startsWith (copy));
+            expect (copy.endsWith ("500,"));
+            expectEquals (copy.getReferenceCount(), 1);
+        }
     }
 };
 
 static StringTests stringUnitTests;
 
+//==============================================================================
+class StringBenchmark  : public UnitTestBenchmark
+{
+public:
+    StringBenchmark() : UnitTestBenchmark ("String class") {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+        StringArray words;
+
+        for (int i = 0; i < 256; ++i)
+            words.add (StringTests::createRandomWideCharString (r).substring (0, 16));
+
+        beginTest ("Construction");
+
+        timeCalls ("String (int)", [&]          { return String (r.nextInt()).length(); });
+        timeCalls ("String (double, 3)", [&]    { return String (r.nextDouble() * 1000.0, 3).length(); });
+        timeCalls ("String::formatted", [&]     { return String::formatted ("%d: %s", r.nextInt(), "abc").length(); });
+
+        beginTest ("Concatenation");
+
+        timeCalls ("operator+ (4 strings)", [&]
+        {
+            return (words[r.nextInt (256)] + " = " + words[r.nextInt (256)] + ";").length();
+        });
+
+        timeCalls ("String::concatenate (4 strings)", [&]
+        {
+            return String::concatenate ({ words[r.nextInt (256)], " = ", words[r.nextInt (256)], ";" }).length();
+        });
+
+        timeCalls ("operator<< (50 ints)", [&]
+        {
+            String s;
+
+            for (int i = 0; i < 50; ++i)
+                s << i << ' ';
+
+            return s.length();
+        });
+
+        beginTest ("Comparison");
+
+        timeCalls ("operator==", [&]            { return words[r.nextInt (256)] == words[r.nextInt (256)] ? 1 : 0; });
+        timeCalls ("compareIgnoreCase", [&]     { return words[r.nextInt (256)].compareIgnoreCase (words[r.nextInt (256)]); });
+        timeCalls ("hashCode", [&]              { return words[r.nextInt (256)].hashCode(); });
+    }
+};
+
+static StringBenchmark stringBenchmark;
+
 #endif
 
 } // namespace juce
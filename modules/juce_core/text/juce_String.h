@@ -244,7 +244,7 @@ public:
         {
             auto byteOffsetOfNull = getByteOffsetOfEnd();
 
-            preallocateBytes (byteOffsetOfNull + extraBytesNeeded);
+            preallocateBytesToAppend (byteOffsetOfNull + extraBytesNeeded);
             CharPointerType (addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull))
                 .writeWithCharLimit (startOfTextToAppend, (int) numChars);
         }
@@ -272,7 +272,7 @@ public:
             {
                 auto byteOffsetOfNull = getByteOffsetOfEnd();
 
-                preallocateBytes (byteOffsetOfNull + extraBytesNeeded);
+                preallocateBytesToAppend (byteOffsetOfNull + extraBytesNeeded);
                 CharPointerType (addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull))
                     .writeWithCharLimit (textToAppend, (int) numChars);
             }
@@ -871,6 +871,17 @@ public:
     static String repeatedString (StringRef stringToRepeat,
                                   int numberOfTimesToRepeat);
 
+    /** Creates a string by joining together a list of other strings.
+
+        Because this works out the total length before copying anything, the result is
+        created with a single allocation, which makes it quicker than a chain of operator+
+        calls, each of which has to create a temporary string. E.g.
+        @code
+        auto s = String::concatenate ({ name, " = ", value, ";" });
+        @endcode
+    */
+    static String concatenate (std::initializer_list<StringRef> strings);
+
     /** Returns a copy of this string with the specified character repeatedly added to its
         beginning until the total length is at least the minimum length specified.
     */
@@ -1389,6 +1400,7 @@ private:
 
     explicit String (const PreallocationBytes&); // This constructor preallocates a certain amount of memory
     size_t getByteOffsetOfEnd() const noexcept;
+    void preallocateBytesToAppend (size_t numBytesNeeded);
     JUCE_DEPRECATED (String (const String&, size_t));
 
     // This private cast operator should prevent strings being accidentally cast
@@ -27,14 +27,15 @@ static const int minNumberOfStringsForGarbageCollection = 300;
 static const uint32 garbageCollectionInterval = 30000;
 
 
-StringPool::StringPool() noexcept  : lastGarbageCollectionTime (0) {}
-StringPool::~StringPool() {}
-
 struct StartEndString
 {
     StartEndString (String::CharPointerType s, String::CharPointerType e) noexcept : start (s), end (e) {}
     operator String() const   { return String (start, end); }
 
+    // these let the HashGenerator iterate the characters
+    bool isEmpty() const noexcept           { return start >= end || start.isEmpty(); }
+    juce_wchar getAndAdvance() noexcept     { return start.getAndAdvance(); }
+
     String::CharPointerType start, end;
 };
 
@@ -58,89 +59,287 @@ static int compareStrings (const StartEndString& string1, const String& string2)
     return 0;
 }
 
-template <typename NewStringType>
-static String addPooledString (Array<String>& strings, const NewStringType& newString)
+//==============================================================================
+struct StringPool::Entry
+{
+    Entry (const String& s, uint32 h)  : string (s), hash (h) {}
+
+    const String string;
+    const uint32 hash;
+
+    // set while a garbage collection is deciding whether to remove this entry
+    std::atomic<bool> isBeingRemoved { false };
+};
+
+// Readers search this without taking the lock. Once a table has been published, the only
+// change that's ever made to it is to fill an empty slot, so when it needs to grow or have
+// entries removed, a new table is built and swapped in to replace it.
+struct StringPool::Table
 {
-    int start = 0;
-    int end = strings.size();
+    explicit Table (int numSlots)
+        : mask (numSlots - 1),
+          shift (32 - findHighestSetBit ((uint32) numSlots)),
+          slots (new std::atomic<Entry*>[(size_t) numSlots])
+    {
+        jassert (isPowerOfTwo (numSlots));
 
-    while (start < end)
+        for (int i = 0; i < numSlots; ++i)
+            slots[i].store (nullptr, std::memory_order_relaxed);
+    }
+
+    template <typename NewStringType>
+    Entry* find (const NewStringType& s, uint32 hash) const noexcept
     {
-        const String& startString = strings.getReference (start);
-        const int startComp = compareStrings (newString, startString);
+        for (auto i = getFirstSlot (hash);; i = (i + 1) & mask)
+        {
+            auto* e = slots[i].load (std::memory_order_acquire);
 
-        if (startComp == 0)
-            return startString;
+            if (e == nullptr)
+                return nullptr;
 
-        const int halfway = (start + end) / 2;
+            if (e->hash == hash && compareStrings (s, e->string) == 0)
+                return e;
+        }
+    }
+
+    // This must only be called while holding the pool's lock.
+    void add (Entry* e) noexcept
+    {
+        auto i = getFirstSlot (e->hash);
+
+        while (slots[i].load (std::memory_order_relaxed) != nullptr)
+            i = (i + 1) & mask;
+
+        slots[i].store (e, std::memory_order_release);
+    }
+
+    int getNumSlots() const noexcept    { return mask + 1; }
+
+    static int getNumSlotsNeededFor (int numEntries) noexcept
+    {
+        // keep the table less than half full, so that searches stay short
+        return jmax (64, nextPowerOfTwo (numEntries * 2 + 1));
+    }
 
-        if (halfway == start)
+private:
+    const int mask, shift;
+    std::unique_ptr<std::atomic<Entry*>[]> slots;
+
+    int getFirstSlot (uint32 hash) const noexcept   { return (int) ((hash * 2654435769u) >> shift); }
+
+    JUCE_DECLARE_NON_COPYABLE (Table)
+};
+
+//==============================================================================
+/*  Counts the calling thread as a reader for as long as it exists. The count that it uses
+    belongs to the epoch that was current when it started, and once the epoch has moved on,
+    no new readers join the old one, so the number left in it can only go down.
+*/
+struct StringPool::ScopedReader
+{
+    explicit ScopedReader (StringPool& pool) noexcept
+        : count (pool.readerCounts[getReaderCountIndex()])
+    {
+        for (;;)
         {
-            if (startComp > 0)
-                ++start;
+            auto e = pool.epoch.load();
+            parity = (int) (e & 1);
+            ++count.numReaders[parity];
+
+            // If the epoch changed before this reader was counted, the thread that changed
+            // it might already have seen the old count, so it needs to join the new one.
+            if (pool.epoch.load() == e)
+                break;
 
-            break;
+            --count.numReaders[parity];
         }
+    }
+
+    ~ScopedReader()
+    {
+        --count.numReaders[parity];
+    }
+
+    static int getReaderCountIndex() noexcept
+    {
+        auto id = (uint64) (pointer_sized_uint) Thread::getCurrentThreadId();
+        return (int) ((id * 0x9e3779b97f4a7c15ULL) >> 32) & (numReaderCounts - 1);
+    }
 
-        const String& halfwayString = strings.getReference (halfway);
-        const int halfwayComp = compareStrings (newString, halfwayString);
+    ReaderCount& count;
+    int parity = 0;
 
-        if (halfwayComp == 0)
-            return halfwayString;
+    JUCE_DECLARE_NON_COPYABLE (ScopedReader)
+};
 
-        if (halfwayComp > 0)
-            start = halfway;
-        else
-            end = halfway;
+//==============================================================================
+StringPool::StringPool() noexcept  : lastGarbageCollectionTime (0)
+{
+    for (auto& c : readerCounts)
+    {
+        c.numReaders[0] = 0;
+        c.numReaders[1] = 0;
     }
+}
 
-    strings.insert (start, newString);
-    return strings.getReference (start);
+StringPool::~StringPool()
+{
+    delete table.load();
 }
 
-String StringPool::getPooledString (const char* const newString)
+static uint32 getStringHash (const String& s) noexcept              { return (uint32) s.hashCode(); }
+static uint32 getStringHash (CharPointer_UTF8 s) noexcept           { return HashGenerator<uint32>::calculate (s); }
+static uint32 getStringHash (const StartEndString& s) noexcept      { return HashGenerator<uint32>::calculate (s); }
+
+template <typename NewStringType>
+String StringPool::getPooled (const NewStringType& newString, uint32 hash)
 {
-    if (newString == nullptr || *newString == 0)
-        return {};
+    {
+        const ScopedReader reader (*this);
+
+        if (auto* t = table.load())
+        {
+            if (auto* e = t->find (newString, hash))
+            {
+                String result (e->string);
+
+                // If a garbage collection is in the middle of removing this entry, it may not
+                // have seen the reference that was just taken, so fall back on the locked path.
+                if (! e->isBeingRemoved.load())
+                    return result;
+            }
+        }
+    }
 
     const ScopedLock sl (lock);
     garbageCollectIfNeeded();
-    return addPooledString (strings, CharPointer_UTF8 (newString));
+
+    auto* t = table.load();
+
+    if (t != nullptr)
+        if (auto* e = t->find (newString, hash))
+            return e->string;
+
+    auto* e = entries.add (new Entry (newString, hash));
+
+    if (t == nullptr || entries.size() * 2 > t->getNumSlots())
+        rebuildTable();
+    else
+        t->add (e);
+
+    deleteRetiredObjectsIfUnused();
+    return e->string;
 }
 
-String StringPool::getPooledString (String::CharPointerType start, String::CharPointerType end)
+StringPool::Table* StringPool::rebuildTable()
 {
-    if (start.isEmpty() || start == end)
+    auto* newTable = new Table (Table::getNumSlotsNeededFor (entries.size()));
+
+    for (auto* e : entries)
+        newTable->add (e);
+
+    if (auto* oldTable = table.exchange (newTable))
+        retiredTables.add (oldTable);
+
+    return newTable;
+}
+
+// This must only be called while holding the pool's lock.
+void StringPool::deleteRetiredObjectsIfUnused()
+{
+    // Objects that were retired before the epoch last changed can be deleted once the readers
+    // from the previous epoch have finished, as any reader that started later can only have
+    // seen the current table. This doesn't need all the readers to stop at once, so the
+    // retired objects don't pile up while other threads keep using the pool.
+    if ((! expiringTables.isEmpty() || ! expiringEntries.isEmpty()) && ! hasReadersInPreviousEpoch())
+    {
+        expiringTables.clear();
+        expiringEntries.clear();
+    }
+
+    if (expiringTables.isEmpty() && expiringEntries.isEmpty()
+         && (! retiredTables.isEmpty() || ! retiredEntries.isEmpty()))
+    {
+        expiringTables.swapWith (retiredTables);
+        expiringEntries.swapWith (retiredEntries);
+        ++epoch;
+
+        if (! hasReadersInPreviousEpoch())
+        {
+            expiringTables.clear();
+            expiringEntries.clear();
+        }
+    }
+}
+
+bool StringPool::hasReadersInPreviousEpoch() const noexcept
+{
+    auto parity = (int) ((epoch.load() + 1) & 1);
+
+    for (auto& c : readerCounts)
+        if (c.numReaders[parity].load() != 0)
+            return true;
+
+    return false;
+}
+
+String StringPool::getPooledString (const char* const newString)
+{
+    if (newString == nullptr || *newString == 0)
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, StartEndString (start, end));
+    CharPointer_UTF8 text (newString);
+    return getPooled (text, getStringHash (text));
+}
+
+String StringPool::getPooledString (String::CharPointerType start, String::CharPointerType end)
+{
+    int hash;
+    return getPooledString (start, end, hash);
 }
 
 String StringPool::getPooledString (StringRef newString)
+{
+    int hash;
+    return getPooledString (newString, hash);
+}
+
+String StringPool::getPooledString (const String& newString)
 {
     if (newString.isEmpty())
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString.text);
+    return getPooled (newString, getStringHash (newString));
 }
 
-String StringPool::getPooledString (const String& newString)
+String StringPool::getPooledString (String::CharPointerType start, String::CharPointerType end, int& hashCode)
+{
+    hashCode = 0;
+
+    if (start.isEmpty() || start == end)
+        return {};
+
+    StartEndString text (start, end);
+    auto hash = getStringHash (text);
+    hashCode = (int) hash;
+    return getPooled (text, hash);
+}
+
+String StringPool::getPooledString (StringRef newString, int& hashCode)
 {
+    hashCode = 0;
+
     if (newString.isEmpty())
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString);
+    auto hash = getStringHash (newString.text);
+    hashCode = (int) hash;
+    return getPooled (newString.text, hash);
 }
 
 void StringPool::garbageCollectIfNeeded()
 {
-    if (strings.size() > minNumberOfStringsForGarbageCollection
+    if (entries.size() > minNumberOfStringsForGarbageCollection
          && Time::getApproximateMillisecondCounter() > lastGarbageCollectionTime + garbageCollectionInterval)
         garbageCollect();
 }
@@ -148,11 +347,35 @@ void StringPool::garbageCollectIfNeeded()
 void StringPool::garbageCollect()
 {
     const ScopedLock sl (lock);
+    bool anyRemoved = false;
+
+    for (int i = entries.size(); --i >= 0;)
+    {
+        auto* e = entries.getUnchecked (i);
+
+        if (e->string.getReferenceCount() == 1)
+        {
+            // A reader could be taking a copy of this string right now, so after flagging
+            // the entry, its reference count needs checking again. A reader that got in
+            // first will be seen here, and one that comes later will see the flag.
+            e->isBeingRemoved = true;
+
+            if (e->string.getReferenceCount() == 1)
+            {
+                retiredEntries.add (entries.removeAndReturn (i));
+                anyRemoved = true;
+            }
+            else
+            {
+                e->isBeingRemoved = false;
+            }
+        }
+    }
 
-    for (int i = strings.size(); --i >= 0;)
-        if (strings.getReference(i).getReferenceCount() == 1)
-            strings.remove (i);
+    if (anyRemoved)
+        rebuildTable();
 
+    deleteRetiredObjectsIfUnused();
     lastGarbageCollectionTime = Time::getApproximateMillisecondCounter();
 }
 
@@ -162,4 +385,197 @@ StringPool& StringPool::getGlobalPool() noexcept
     return pool;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StringPoolTests  : public UnitTest
+{
+public:
+    StringPoolTests() : UnitTest ("StringPool", "Text") {}
+
+    void runTest() override
+    {
+        beginTest ("Pooled strings are shared");
+        {
+            StringPool pool;
+
+            auto s1 = pool.getPooledString ("abcdef");
+            auto s2 = pool.getPooledString (String ("abc") + "def");
+            auto s3 = pool.getPooledString (StringRef ("abcdef"));
+
+            expect (s1 == "abcdef");
+            expect (s1.getCharPointer() == s2.getCharPointer());
+            expect (s1.getCharPointer() == s3.getCharPointer());
+
+            String source ("xxabcdefxx");
+            auto start = source.getCharPointer() + 2;
+            auto s4 = pool.getPooledString (start, start + 6);
+            expect (s1.getCharPointer() == s4.getCharPointer());
+
+            expect (pool.getPooledString ("abcdeg").getCharPointer() != s1.getCharPointer());
+            expect (pool.getPooledString (String()).isEmpty());
+            expect (pool.getPooledString (nullptr).isEmpty());
+        }
+
+        beginTest ("Hash codes");
+        {
+            StringPool pool;
+            int hash = 0;
+
+            auto s = pool.getPooledString (StringRef ("hello world"), hash);
+            expectEquals (hash, String ("hello world").hashCode());
+            expectEquals (hash, s.hashCode());
+
+            String source ("hello world!!");
+            auto start = source.getCharPointer();
+            pool.getPooledString (start, start + 11, hash);
+            expectEquals (hash, String ("hello world").hashCode());
+
+            pool.getPooledString (StringRef (""), hash);
+            expectEquals (hash, 0);
+
+            Identifier id ("hello world");
+            expectEquals (id.hashCode(), String ("hello world").hashCode());
+            expectEquals (Identifier (id).hashCode(), id.hashCode());
+            expectEquals (Identifier().hashCode(), 0);
+        }
+
+        beginTest ("Many strings");
+        {
+            StringPool pool;
+            StringArray originals;
+
+            for (int i = 0; i < 5000; ++i)
+                originals.add (pool.getPooledString ("string " + String (i)));
+
+            for (int i = 0; i < originals.size(); ++i)
+                expect (pool.getPooledString ("string " + String (i)).getCharPointer()
+                          == originals[i].getCharPointer());
+        }
+
+        beginTest ("Garbage collection");
+        {
+            StringPool pool;
+            auto kept = pool.getPooledString ("kept");
+            auto keptPointer = kept.getCharPointer().getAddress();
+
+            for (int i = 0; i < 1000; ++i)
+                pool.getPooledString ("temporary " + String (i));
+
+            pool.garbageCollect();
+
+            expect (pool.getPooledString ("kept").getCharPointer().getAddress() == keptPointer);
+
+            auto recreated = pool.getPooledString ("temporary 0");
+            expect (recreated == "temporary 0");
+            expectEquals (recreated.getReferenceCount(), 2);
+        }
+
+        beginTest ("Multiple threads");
+        {
+            StringPool pool;
+            const int numStrings = 2000, numThreads = 4;
+
+            struct InternThread  : public Thread
+            {
+                InternThread (StringPool& p, int n)  : Thread ("StringPool test"), pool (p), num (n) {}
+
+                void run() override
+                {
+                    Random r;
+
+                    for (int i = 0; i < num; ++i)
+                        results.add (pool.getPooledString ("thread test " + String (i)));
+
+                    for (int i = 0; i < 20 && ! threadShouldExit(); ++i)
+                    {
+                        pool.getPooledString ("dropped " + String (r.nextInt (num)));
+
+                        if (i % 5 == 0)
+                            pool.garbageCollect();
+                    }
+                }
+
+                StringPool& pool;
+                const int num;
+                StringArray results;
+            };
+
+            OwnedArray<InternThread> threads;
+
+            for (int i = 0; i < numThreads; ++i)
+                threads.add (new InternThread (pool, numStrings))->startThread();
+
+            for (auto* t : threads)
+                t->stopThread (-1);
+
+            for (int i = 0; i < numStrings; ++i)
+            {
+                auto expected = threads[0]->results[i].getCharPointer();
+                expect (expected == pool.getPooledString ("thread test " + String (i)).getCharPointer());
+
+                for (auto* t : threads)
+                    expect (t->results[i].getCharPointer() == expected);
+            }
+        }
+
+        beginTest ("Retired tables are deleted while other threads keep reading");
+        {
+            StringPool pool;
+            auto kept = pool.getPooledString ("kept");
+
+            struct ReaderThread  : public Thread
+            {
+                ReaderThread (StringPool& p)  : Thread ("StringPool test"), pool (p) {}
+
+                void run() override
+                {
+                    while (! threadShouldExit())
+                        pool.getPooledString ("kept");
+                }
+
+                StringPool& pool;
+            };
+
+            OwnedArray<ReaderThread> readers;
+
+            for (int i = 0; i < 4; ++i)
+                readers.add (new ReaderThread (pool))->startThread();
+
+            // this replaces the table several times as it grows
+            for (int i = 0; i < 20000; ++i)
+                pool.getPooledString ("added " + String (i));
+
+            // A reader that gets pre-empted can hold on to an old table for a while, but the
+            // next few changes should free them, even though the readers never all stop.
+            int numWaiting = 0;
+
+            for (int i = 0; i < 200; ++i)
+            {
+                pool.getPooledString ("later " + String (i));
+
+                {
+                    const ScopedLock sl (pool.lock);
+                    numWaiting = pool.retiredTables.size() + pool.expiringTables.size();
+                }
+
+                if (numWaiting == 0)
+                    break;
+
+                Thread::sleep (5);
+            }
+
+            for (auto* r : readers)
+                r->stopThread (-1);
+
+            expectEquals (numWaiting, 0);
+            expect (pool.getPooledString ("kept").getCharPointer() == kept.getCharPointer());
+        }
+    }
+};
+
+static StringPoolTests stringPoolTests;
+
+#endif
+
 } // namespace juce
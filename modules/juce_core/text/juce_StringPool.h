@@ -34,6 +34,10 @@ namespace juce
     compare two pooled strings for equality, as you can simply compare their pointers. It
     also cuts down on storage if you're using many copies of the same string.
 
+    The strings are kept in a hash table which can be searched by any number of threads
+    at once without taking a lock, so only the first request for a particular string
+    has to wait for other threads.
+
     @tags{Core}
 */
 class JUCE_API  StringPool
@@ -67,6 +71,16 @@ public:
     */
     String getPooledString (String::CharPointerType start, String::CharPointerType end);
 
+    /** Returns a pointer to a shared copy of the string that is passed in, and also sets
+        hashCode to the value that String::hashCode() would return for it.
+    */
+    String getPooledString (StringRef original, int& hashCode);
+
+    /** Returns a pointer to a copy of the string that is passed in, and also sets
+        hashCode to the value that String::hashCode() would return for it.
+    */
+    String getPooledString (String::CharPointerType start, String::CharPointerType end, int& hashCode);
+
     //==============================================================================
     /** Scans the pool, and removes any strings that are unreferenced.
         You don't generally need to call this - it'll be called automatically when the pool grows
@@ -78,10 +92,34 @@ public:
     static StringPool& getGlobalPool() noexcept;
 
 private:
-    Array<String> strings;
+    struct Entry;
+    struct Table;
+    struct ScopedReader;
+    friend class StringPoolTests;
+
+    // Readers count themselves in one of these, picked by their thread, so that they don't
+    // all contend for the same cache line. Each one has a count for odd and even epochs.
+    struct ReaderCount
+    {
+        std::atomic<int> numReaders[2];
+        char padding[64 - 2 * sizeof (std::atomic<int>)];
+    };
+
+    enum { numReaderCounts = 16 };
+
+    std::atomic<Table*> table { nullptr };
+    std::atomic<uint32> epoch { 0 };
+    ReaderCount readerCounts[numReaderCounts];
+    OwnedArray<Entry> entries, retiredEntries, expiringEntries;
+    OwnedArray<Table> retiredTables, expiringTables;
     CriticalSection lock;
     uint32 lastGarbageCollectionTime;
 
+    template <typename NewStringType>
+    String getPooled (const NewStringType&, uint32 hash);
+    Table* rebuildTable();
+    void deleteRetiredObjectsIfUnused();
+    bool hasReadersInPreviousEpoch() const noexcept;
     void garbageCollectIfNeeded();
 
     JUCE_DECLARE_NON_COPYABLE (StringPool)
@@ -103,6 +103,10 @@ public:
     bool isNotEmpty() const noexcept                                    { return ! text.isEmpty(); }
     /** Returns the number of characters in the string. */
     int length() const noexcept                                         { return (int) text.length(); }
+    /** Generates a hash code for the string.
+        This is the same value that String::hashCode() returns for a String containing the same text.
+    */
+    int hashCode() const noexcept;
 
     /** Retrieves a character by index. */
     juce_wchar operator[] (int index) const noexcept                    { return text[index]; }
@@ -23,6 +23,90 @@
 namespace juce
 {
 
+struct ThreadPool::Task
+{
+    std::function<void()> function;
+    TaskGroup* group;
+};
+
+//==============================================================================
+/*  A fixed-size work-stealing deque, as described by Chase and Lev. The thread that
+    owns it pushes and pops tasks at the bottom, and other threads can steal tasks
+    from the top, without any of them needing to take a lock.
+*/
+struct ThreadPool::TaskDeque
+{
+    TaskDeque() noexcept {}
+
+    enum { capacity = 4096 };
+
+    // (only called by the owner thread)
+    bool push (Task* task) noexcept
+    {
+        auto b = bottom.load (std::memory_order_relaxed);
+        auto t = top.load (std::memory_order_acquire);
+
+        if (b - t >= capacity)
+            return false;
+
+        slots[b & (capacity - 1)].store (task, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        bottom.store (b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // (only called by the owner thread)
+    Task* pop() noexcept
+    {
+        auto b = bottom.load (std::memory_order_relaxed) - 1;
+        bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        auto t = top.load (std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store (b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto* task = slots[b & (capacity - 1)].load (std::memory_order_relaxed);
+
+        if (t == b)
+        {
+            // this is the last task, so there might be a thief trying to take it too
+            if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                task = nullptr;
+
+            bottom.store (b + 1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    Task* steal() noexcept
+    {
+        auto t = top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        auto b = bottom.load (std::memory_order_acquire);
+
+        if (t >= b)
+            return nullptr;
+
+        auto* task = slots[t & (capacity - 1)].load (std::memory_order_relaxed);
+
+        if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return task;
+    }
+
+    std::atomic<int64> top { 0 }, bottom { 0 };
+    std::atomic<Task*> slots[capacity];
+
+    JUCE_DECLARE_NON_COPYABLE (TaskDeque)
+};
+
+//==============================================================================
 struct ThreadPool::ThreadPoolThread  : public Thread
 {
     ThreadPoolThread (ThreadPool& p, size_t stackSize)
@@ -33,11 +117,22 @@ struct ThreadPool::ThreadPoolThread  : public Thread
     void run() override
     {
         while (! threadShouldExit())
-            if (! pool.runNextJob (*this))
+        {
+            if (pool.runNextTask (this) || pool.runNextJob (*this))
+                continue;
+
+            isIdle = true;
+
+            if (pool.numTasksWaiting.load() <= 0)
                 wait (500);
+
+            isIdle = false;
+        }
     }
 
     std::atomic<ThreadPoolJob*> currentJob { nullptr };
+    std::atomic<bool> isIdle { false };
+    TaskDeque tasks;
     ThreadPool& pool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolThread)
@@ -105,6 +200,7 @@ ThreadPool::ThreadPool()
 ThreadPool::~ThreadPool()
 {
     removeAllJobs (true, 5000);
+    waitForAllTasks();
     stopThreads();
 }
 
@@ -340,6 +436,250 @@ bool ThreadPool::setThreadPriorities (int newPriority)
     return ok;
 }
 
+//==============================================================================
+ThreadPool::TaskGroup::TaskGroup (ThreadPool& p)  : pool (p) {}
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+void ThreadPool::TaskGroup::run (std::function<void()> task)
+{
+    ++numPending;
+    pool.submitTask (new Task { std::move (task), this });
+}
+
+void ThreadPool::TaskGroup::runAfter (TaskGroup& groupToWaitFor, std::function<void()> task)
+{
+    jassert (&groupToWaitFor != this); // a group can't wait for itself!
+
+    ++numPending;
+    auto* group = this;
+
+    if (! groupToWaitFor.addContinuation ([group, task] { group->pool.submitTask (new Task { task, group }); }))
+        pool.submitTask (new Task { std::move (task), this });
+}
+
+void ThreadPool::TaskGroup::runWhenFinished (std::function<void()> task)
+{
+    auto* p = &pool;
+
+    if (! addContinuation ([p, task] { p->addTask (task); }))
+        pool.addTask (std::move (task));
+}
+
+bool ThreadPool::TaskGroup::isFinished() const noexcept
+{
+    return numPending.load() == 0 && numFinishing.load() == 0;
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+    auto* currentThread = pool.getCurrentPoolThread();
+
+    while (! isFinished())
+        if (! pool.runNextTask (currentThread))
+            finishedEvent.wait (1);
+}
+
+bool ThreadPool::TaskGroup::addContinuation (std::function<void()> continuation)
+{
+    const ScopedLock sl (continuationLock);
+
+    if (numPending.load() == 0)
+        return false;
+
+    continuations.add (std::move (continuation));
+    return true;
+}
+
+void ThreadPool::TaskGroup::taskFinished()
+{
+    // numFinishing stops wait() returning (and the group being deleted) until
+    // this method has stopped using the group
+    ++numFinishing;
+
+    if (--numPending == 0)
+    {
+        Array<std::function<void()>> continuationsToRun;
+
+        {
+            const ScopedLock sl (continuationLock);
+
+            if (numPending.load() == 0)
+                continuationsToRun.swapWith (continuations);
+        }
+
+        for (auto& c : continuationsToRun)
+            c();
+
+        finishedEvent.signal();
+    }
+
+    --numFinishing;
+}
+
+//==============================================================================
+void ThreadPool::addTask (std::function<void()> task)
+{
+    submitTask (new Task { std::move (task), nullptr });
+}
+
+void ThreadPool::parallelFor (int startIndex, int endIndex, const std::function<void (int)>& function, int grainSize)
+{
+    if (endIndex <= startIndex)
+        return;
+
+    grainSize = jmax (1, grainSize);
+    std::atomic<int64> nextIndex { startIndex };
+
+    auto runChunks = [&]
+    {
+        for (;;)
+        {
+            auto first = nextIndex.fetch_add (grainSize);
+
+            if (first >= endIndex)
+                break;
+
+            for (auto i = (int) first, end = (int) jmin ((int64) endIndex, first + grainSize); i < end; ++i)
+                function (i);
+        }
+    };
+
+    auto numChunks = (int) (((int64) endIndex - startIndex + grainSize - 1) / grainSize);
+    TaskGroup group (*this);
+
+    // (the calling thread takes a share of the work too)
+    for (int i = jmin (numChunks, getNumThreads() + 1); --i > 0;)
+        group.run (runChunks);
+
+    runChunks();
+    group.wait();
+}
+
+void ThreadPool::submitTask (Task* task)
+{
+    ++numTasksUnfinished;
+
+    auto* currentThread = getCurrentPoolThread();
+
+    if (currentThread == nullptr || ! currentThread->tasks.push (task))
+    {
+        const ScopedLock sl (sharedTaskLock);
+        sharedTasks.add (task);
+        ++numSharedTasks;
+    }
+
+    ++numTasksWaiting;
+    wakeIdleThread();
+}
+
+ThreadPool::Task* ThreadPool::takeNextTask (ThreadPoolThread* currentThread)
+{
+    if (numTasksWaiting.load() <= 0)
+        return nullptr;
+
+    Task* task = nullptr;
+
+    if (currentThread != nullptr)
+        task = currentThread->tasks.pop();
+
+    if (task == nullptr && numSharedTasks.load() > 0)
+    {
+        const ScopedLock sl (sharedTaskLock);
+
+        if (nextSharedTask < sharedTasks.size())
+        {
+            task = sharedTasks.getUnchecked (nextSharedTask++);
+            --numSharedTasks;
+
+            if (nextSharedTask == sharedTasks.size())
+            {
+                sharedTasks.clearQuick();
+                nextSharedTask = 0;
+            }
+        }
+    }
+
+    if (task == nullptr)
+    {
+        auto numThreads = threads.size();
+        auto start = currentThread != nullptr ? threads.indexOf (currentThread) + 1 : 0;
+
+        for (int i = 0; i < numThreads && task == nullptr; ++i)
+        {
+            auto* victim = threads.getUnchecked ((start + i) % numThreads);
+
+            if (victim != currentThread)
+                task = victim->tasks.steal();
+        }
+    }
+
+    if (task != nullptr)
+        --numTasksWaiting;
+
+    return task;
+}
+
+bool ThreadPool::runNextTask (ThreadPoolThread* currentThread)
+{
+    if (auto* task = takeNextTask (currentThread))
+    {
+        try
+        {
+            task->function();
+        }
+        catch (...)
+        {
+            jassertfalse; // Your task mustn't throw any exceptions!
+        }
+
+        auto* group = task->group;
+        delete task;
+
+        if (group != nullptr)
+            group->taskFinished();
+
+        --numTasksUnfinished;
+        return true;
+    }
+
+    return false;
+}
+
+ThreadPool::ThreadPoolThread* ThreadPool::getCurrentPoolThread() const
+{
+    if (auto* t = dynamic_cast<ThreadPoolThread*> (Thread::getCurrentThread()))
+        if (&t->pool == this)
+            return t;
+
+    return nullptr;
+}
+
+void ThreadPool::wakeIdleThread()
+{
+    for (auto* t : threads)
+    {
+        bool wasIdle = true;
+
+        if (t->isIdle.compare_exchange_strong (wasIdle, false))
+        {
+            t->notify();
+            break;
+        }
+    }
+}
+
+void ThreadPool::waitForAllTasks()
+{
+    while (numTasksUnfinished.load() > 0)
+        if (! runNextTask (getCurrentPoolThread()))
+            Thread::sleep (1);
+}
+
+//==============================================================================
 ThreadPoolJob* ThreadPool::pickNextJobToRun()
 {
     OwnedArray<ThreadPoolJob> deletionList;
@@ -428,4 +768,120 @@ void ThreadPool::addToDeleteList (OwnedArray<ThreadPoolJob>& deletionList, Threa
         deletionList.add (job);
 }
 
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ThreadPoolTaskTests  : public UnitTest
+{
+public:
+    ThreadPoolTaskTests()  : UnitTest ("ThreadPool tasks", "Threads") {}
+
+    void runTest() override
+    {
+        ThreadPool pool (4);
+
+        beginTest ("addTask");
+        {
+            std::atomic<int> count { 0 };
+            const int numTasks = 10000;
+
+            for (int i = 0; i < numTasks; ++i)
+                pool.addTask ([&count] { ++count; });
+
+            for (int i = 0; i < 5000 && count.load() < numTasks; ++i)
+                Thread::sleep (1);
+
+            expectEquals (count.load(), numTasks);
+        }
+
+        beginTest ("parallelFor");
+        {
+            Array<int> values;
+            values.resize (10000);
+
+            pool.parallelFor (0, values.size(), [&values] (int i) { values.setUnchecked (i, i * 2); }, 7);
+
+            bool allOk = true;
+
+            for (int i = 0; i < values.size(); ++i)
+                allOk = allOk && values[i] == i * 2;
+
+            expect (allOk);
+        }
+
+        beginTest ("Nested parallelFor");
+        {
+            std::atomic<int64> total { 0 };
+
+            pool.parallelFor (0, 20, [&] (int i)
+            {
+                pool.parallelFor (0, 100, [&] (int j) { total += i * 100 + j; });
+            });
+
+            expectEquals (total.load(), (int64) (1999 * 2000 / 2));
+        }
+
+        beginTest ("parallelInvoke");
+        {
+            std::atomic<int> a { 0 }, b { 0 }, c { 0 };
+            pool.parallelInvoke ([&] { a = 1; }, [&] { b = 2; }, [&] { c = 3; });
+            expect (a.load() == 1 && b.load() == 2 && c.load() == 3);
+        }
+
+        beginTest ("Dependencies");
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                std::atomic<int> numFirstFinished { 0 }, numSeenTooEarly { 0 }, numContinuations { 0 };
+
+                ThreadPool::TaskGroup first (pool), second (pool);
+
+                for (int i = 0; i < 50; ++i)
+                    first.run ([&] { Thread::yield(); ++numFirstFinished; });
+
+                for (int i = 0; i < 10; ++i)
+                    second.runAfter (first, [&] { if (numFirstFinished.load() != 50) ++numSeenTooEarly; });
+
+                second.runWhenFinished ([&] { ++numContinuations; });
+                second.wait();
+
+                expect (first.isFinished());
+                expectEquals (numSeenTooEarly.load(), 0);
+
+                for (int i = 0; i < 1000 && numContinuations.load() == 0; ++i)
+                    Thread::sleep (1);
+
+                expectEquals (numContinuations.load(), 1);
+            }
+        }
+
+        beginTest ("Jobs and tasks together");
+        {
+            std::atomic<int> numJobs { 0 }, numTasks { 0 };
+            ThreadPool::TaskGroup group (pool);
+
+            for (int i = 0; i < 100; ++i)
+            {
+                pool.addJob ([&numJobs] { ++numJobs; });
+                group.run ([&numTasks] { ++numTasks; });
+            }
+
+            group.wait();
+            expectEquals (numTasks.load(), 100);
+
+            for (int i = 0; i < 5000 && pool.getNumJobs() > 0; ++i)
+                Thread::sleep (1);
+
+            expectEquals (numJobs.load(), 100);
+        }
+    }
+};
+
+static ThreadPoolTaskTests threadPoolTaskTests;
+
+#endif
+
 } // namespace juce
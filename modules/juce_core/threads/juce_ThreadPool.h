@@ -148,6 +148,12 @@ private:
     When a ThreadPoolJob object is added to the ThreadPool's list, its runJob() method
     will be called by the next pooled thread that becomes free.
 
+    For lots of small pieces of work, the pool can also run plain functions as tasks,
+    using addTask(), parallelFor(), parallelInvoke() or a TaskGroup. These are much
+    cheaper than jobs: each thread keeps its own queue of tasks which it can add to and
+    take from without locking, and threads that run out of work take tasks from the
+    other threads' queues.
+
     @see ThreadPoolJob, Thread
 
     @tags{Core}
@@ -315,18 +321,149 @@ public:
     */
     bool setThreadPriorities (int newPriority);
 
+    //==============================================================================
+    /** A set of tasks that can be waited for together.
+
+        Tasks that are added to a group are run by the pool's threads in the same way as
+        the ones passed to ThreadPool::addTask(). A group can also hold tasks back until
+        another group has finished, or start some follow-on tasks once it has finished
+        itself, which lets you build up a graph of tasks that depend on each other.
+
+        @code
+        ThreadPool::TaskGroup loading (pool), processing (pool);
+
+        for (auto& f : files)
+            loading.run ([&f] { f.load(); });
+
+        processing.runAfter (loading, [&] { processAll (files); });
+        processing.wait();
+        @endcode
+    */
+    class JUCE_API  TaskGroup
+    {
+    public:
+        /** Creates an empty group that runs its tasks on the given pool. */
+        explicit TaskGroup (ThreadPool& poolToUse);
+
+        /** Destructor.
+            This waits for all the group's tasks to finish.
+        */
+        ~TaskGroup();
+
+        /** Adds a task to the group, which will be run as soon as a thread is free. */
+        void run (std::function<void()> task);
+
+        /** Adds a task to the group which won't start until all the tasks that are
+            currently in another group have finished.
+        */
+        void runAfter (TaskGroup& groupToWaitFor, std::function<void()> task);
+
+        /** Adds a task to the pool which will be run when all the tasks that are currently
+            in this group have finished. If the group has nothing left to do, it'll be
+            started straight away. The task doesn't become part of the group.
+        */
+        void runWhenFinished (std::function<void()> task);
+
+        /** Returns true if all the tasks in the group have finished. */
+        bool isFinished() const noexcept;
+
+        /** Waits for all the tasks in the group to finish.
+            While it waits, the calling thread helps by running any of the pool's
+            tasks that haven't started yet, so this can safely be called from inside
+            another task.
+        */
+        void wait();
+
+    private:
+        friend class ThreadPool;
+        ThreadPool& pool;
+        std::atomic<int> numPending { 0 }, numFinishing { 0 };
+        CriticalSection continuationLock;
+        Array<std::function<void()>> continuations;
+        WaitableEvent finishedEvent;
+
+        bool addContinuation (std::function<void()>);
+        void taskFinished();
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TaskGroup)
+    };
+
+    //==============================================================================
+    /** Adds a function to be called by one of the pool's threads.
+
+        This is a much cheaper way to run lots of small pieces of work than addJob().
+        Tasks take priority over ThreadPoolJobs, aren't counted by getNumJobs(), and can't
+        be removed once they've been added. The pool's destructor waits for any tasks that
+        are still queued to finish.
+
+        @see TaskGroup, parallelFor
+    */
+    void addTask (std::function<void()> task);
+
+    /** Calls a function once for each index in a range, using the pool's threads to make
+        the calls in parallel.
+
+        The calling thread helps out, and this won't return until all the calls have
+        finished. It can safely be called from inside another task.
+
+        @param startIndex   the first index to call the function with
+        @param endIndex     the index after the last one to call the function with
+        @param function     the function to call
+        @param grainSize    the number of indexes that a thread takes each time it looks
+                            for more work. If the function is very quick, making this
+                            bigger will reduce the overhead
+    */
+    void parallelFor (int startIndex, int endIndex,
+                      const std::function<void (int)>& function,
+                      int grainSize = 1);
+
+    /** Calls a set of functions in parallel, and waits for them all to finish.
+        The calling thread runs the last of the functions itself.
+    */
+    template <typename... Functions>
+    void parallelInvoke (Functions&&... functions)
+    {
+        TaskGroup group (*this);
+        invokeAll (group, std::forward<Functions> (functions)...);
+        group.wait();
+    }
+
 
 private:
     //==============================================================================
     Array<ThreadPoolJob*> jobs;
 
     struct ThreadPoolThread;
+    struct Task;
+    struct TaskDeque;
     friend class ThreadPoolJob;
     OwnedArray<ThreadPoolThread> threads;
 
     CriticalSection lock;
     WaitableEvent jobFinishedSignal;
 
+    CriticalSection sharedTaskLock;
+    Array<Task*> sharedTasks;
+    int nextSharedTask = 0;
+    std::atomic<int> numSharedTasks { 0 }, numTasksWaiting { 0 }, numTasksUnfinished { 0 };
+
+    template <typename Function>
+    void invokeAll (TaskGroup&, Function&& f)         { f(); }
+
+    template <typename Function, typename... Others>
+    void invokeAll (TaskGroup& group, Function&& f, Others&&... others)
+    {
+        group.run (std::forward<Function> (f));
+        invokeAll (group, std::forward<Others> (others)...);
+    }
+
+    void submitTask (Task*);
+    Task* takeNextTask (ThreadPoolThread*);
+    bool runNextTask (ThreadPoolThread*);
+    ThreadPoolThread* getCurrentPoolThread() const;
+    void wakeIdleThread();
+    void waitForAllTasks();
+
     bool runNextJob (ThreadPoolThread&);
     ThreadPoolJob* pickNextJobToRun();
     void addToDeleteList (OwnedArray<ThreadPoolJob>&, ThreadPoolJob*) const;
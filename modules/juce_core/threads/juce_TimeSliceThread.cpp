@@ -23,6 +23,44 @@
 namespace juce
 {
 
+class TimeSliceThread::HelperThread  : public Thread
+{
+public:
+    HelperThread (TimeSliceThread& t, int index)
+        : Thread (t.getThreadName() + " " + String (index + 1)), owner (t)
+    {
+    }
+
+    ~HelperThread()
+    {
+        // a negative timeout waits for as long as the current callback takes, rather
+        // than killing the thread
+        stopThread (-1);
+    }
+
+    void run() override
+    {
+        int index = 0;
+
+        while (! threadShouldExit())
+        {
+            auto timeToWait = owner.callNextClient (index, callbackLock, clientBeingCalled);
+
+            if (timeToWait > 0)
+                wait (timeToWait);
+        }
+    }
+
+    CriticalSection callbackLock;
+    TimeSliceClient* clientBeingCalled = nullptr;
+
+private:
+    TimeSliceThread& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (HelperThread)
+};
+
+//==============================================================================
 TimeSliceThread::TimeSliceThread (const String& name)  : Thread (name)
 {
 }
@@ -30,6 +68,7 @@ TimeSliceThread::TimeSliceThread (const String& name)  : Thread (name)
 TimeSliceThread::~TimeSliceThread()
 {
     stopThread (2000);
+    stopHelperThreads();
 }
 
 //==============================================================================
@@ -40,12 +79,13 @@ void TimeSliceThread::addTimeSliceClient (TimeSliceClient* const client, int mil
         const ScopedLock sl (listLock);
         client->nextCallTime = Time::getCurrentTime() + RelativeTime::milliseconds (millisecondsBeforeStarting);
         clients.addIfNotAlreadyThere (client);
-        notify();
+        notifyAllThreads();
     }
 }
 
 void TimeSliceThread::removeTimeSliceClient (TimeSliceClient* const client)
 {
+    const ScopedLock hl (helperLock);
     const ScopedLock sl1 (listLock);
 
     // if there's a chance we're in the middle of calling this client, we need to
@@ -63,6 +103,17 @@ void TimeSliceThread::removeTimeSliceClient (TimeSliceClient* const client)
     {
         clients.removeFirstMatchingValue (client);
     }
+
+    // once it's out of the list, none of the helper threads can start calling it, but
+    // one of them might still be in the middle of a call
+    for (auto* helper : helperThreads)
+    {
+        if (helper->clientBeingCalled == client)
+        {
+            const ScopedUnlock ul (listLock);
+            const ScopedLock sl2 (helper->callbackLock);
+        }
+    }
 }
 
 void TimeSliceThread::removeAllClients()
@@ -83,7 +134,7 @@ void TimeSliceThread::moveToFrontOfQueue (TimeSliceClient* client)
     if (clients.contains (client))
     {
         client->nextCallTime = Time::getCurrentTime();
-        notify();
+        notifyAllThreads();
     }
 }
 
@@ -98,7 +149,26 @@ TimeSliceClient* TimeSliceThread::getClient (const int i) const
     return clients[i];
 }
 
+void TimeSliceThread::setNumThreads (int newNumThreads)
+{
+    jassert (newNumThreads > 0);
+    numThreads = jmax (1, newNumThreads);
+    notify();
+}
+
 //==============================================================================
+bool TimeSliceThread::isBeingCalled (TimeSliceClient* c) const
+{
+    if (c == clientBeingCalled)
+        return true;
+
+    for (auto* helper : helperThreads)
+        if (c == helper->clientBeingCalled)
+            return true;
+
+    return false;
+}
+
 TimeSliceClient* TimeSliceThread::getNextClient (int index) const
 {
     Time soonest;
@@ -108,7 +178,8 @@ TimeSliceClient* TimeSliceThread::getNextClient (int index) const
     {
         auto* c = clients.getUnchecked ((i + index) % clients.size());
 
-        if (client == nullptr || c->nextCallTime < soonest)
+        if ((client == nullptr || c->nextCallTime < soonest)
+             && (helperThreads.isEmpty() || ! isBeingCalled (c)))
         {
             client = c;
             soonest = c->nextCallTime;
@@ -118,67 +189,237 @@ TimeSliceClient* TimeSliceThread::getNextClient (int index) const
     return client;
 }
 
-void TimeSliceThread::run()
+int TimeSliceThread::callNextClient (int& index, CriticalSection& lockToUse, TimeSliceClient*& clientToSet)
 {
-    int index = 0;
+    int timeToWait = 500;
 
-    while (! threadShouldExit())
+    Time nextClientTime;
+    int numClients = 0;
+
+    {
+        const ScopedLock sl2 (listLock);
+
+        numClients = clients.size();
+        index = numClients > 0 ? ((index + 1) % numClients) : 0;
+
+        if (auto* firstClient = getNextClient (index))
+            nextClientTime = firstClient->nextCallTime;
+        else
+            numClients = 0;
+    }
+
+    if (numClients > 0)
     {
-        int timeToWait = 500;
+        auto now = Time::getCurrentTime();
 
+        if (nextClientTime > now)
+        {
+            timeToWait = (int) jmin ((int64) 500, (nextClientTime - now).inMilliseconds());
+        }
+        else
         {
-            Time nextClientTime;
-            int numClients = 0;
+            timeToWait = index == 0 ? 1 : 0;
+
+            const ScopedLock sl (lockToUse);
 
             {
                 const ScopedLock sl2 (listLock);
-
-                numClients = clients.size();
-                index = numClients > 0 ? ((index + 1) % numClients) : 0;
-
-                if (auto* firstClient = getNextClient (index))
-                    nextClientTime = firstClient->nextCallTime;
+                clientToSet = getNextClient (index);
             }
 
-            if (numClients > 0)
+            if (clientToSet != nullptr)
             {
-                auto now = Time::getCurrentTime();
+                const int msUntilNextCall = clientToSet->useTimeSlice();
+
+                const ScopedLock sl2 (listLock);
 
-                if (nextClientTime > now)
-                {
-                    timeToWait = (int) jmin ((int64) 500, (nextClientTime - now).inMilliseconds());
-                }
+                if (msUntilNextCall >= 0)
+                    clientToSet->nextCallTime = now + RelativeTime::milliseconds (msUntilNextCall);
                 else
-                {
-                    timeToWait = index == 0 ? 1 : 0;
+                    clients.removeFirstMatchingValue (clientToSet);
+
+                clientToSet = nullptr;
+            }
+        }
+    }
+
+    return timeToWait;
+}
+
+void TimeSliceThread::notifyAllThreads()
+{
+    notify();
 
-                    const ScopedLock sl (callbackLock);
+    for (auto* helper : helperThreads)
+        helper->notify();
+}
 
-                    {
-                        const ScopedLock sl2 (listLock);
-                        clientBeingCalled = getNextClient (index);
-                    }
+// The helpers are only started and stopped by this thread. The other threads look at
+// the array to see which clients are being called, so listLock has to be held while it
+// changes, and removeTimeSliceClient() holds helperLock to stop a helper being deleted
+// while it's waiting for one of its callbacks to finish.
+void TimeSliceThread::updateHelperThreads()
+{
+    auto numHelpersNeeded = numThreads.load() - 1;
 
-                    if (clientBeingCalled != nullptr)
-                    {
-                        const int msUntilNextCall = clientBeingCalled->useTimeSlice();
+    while (helperThreads.size() > numHelpersNeeded)
+    {
+        helperThreads.getLast()->stopThread (-1);
 
-                        const ScopedLock sl2 (listLock);
+        const ScopedLock hl (helperLock);
+        const ScopedLock sl (listLock);
+        helperThreads.removeLast();
+    }
 
-                        if (msUntilNextCall >= 0)
-                            clientBeingCalled->nextCallTime = now + RelativeTime::milliseconds (msUntilNextCall);
-                        else
-                            clients.removeFirstMatchingValue (clientBeingCalled);
+    while (helperThreads.size() < numHelpersNeeded)
+    {
+        auto* helper = new HelperThread (*this, helperThreads.size());
 
-                        clientBeingCalled = nullptr;
-                    }
-                }
-            }
+        {
+            const ScopedLock hl (helperLock);
+            const ScopedLock sl (listLock);
+            helperThreads.add (helper);
         }
 
+        helper->startThread();
+    }
+}
+
+void TimeSliceThread::stopHelperThreads()
+{
+    for (auto* helper : helperThreads)
+        helper->signalThreadShouldExit();
+
+    for (auto* helper : helperThreads)
+        helper->stopThread (-1);
+
+    const ScopedLock hl (helperLock);
+    const ScopedLock sl (listLock);
+    helperThreads.clear();
+}
+
+void TimeSliceThread::run()
+{
+    int index = 0;
+
+    while (! threadShouldExit())
+    {
+        updateHelperThreads();
+
+        auto timeToWait = callNextClient (index, callbackLock, clientBeingCalled);
+
         if (timeToWait > 0)
             wait (timeToWait);
     }
+
+    stopHelperThreads();
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TimeSliceThreadTests  : public UnitTest
+{
+public:
+    TimeSliceThreadTests() : UnitTest ("TimeSliceThread", "Threads") {}
+
+    struct Client  : public TimeSliceClient
+    {
+        Client (std::atomic<int>& active, std::atomic<int>& peak)
+            : numActive (active), peakActive (peak)
+        {
+        }
+
+        int useTimeSlice() override
+        {
+            if (isInCallback.exchange (true))
+                wasCalledByTwoThreads = true;
+
+            auto n = ++numActive;
+
+            for (auto peak = peakActive.load(); n > peak && ! peakActive.compare_exchange_weak (peak, n);)
+            {}
+
+            Thread::sleep (2);
+            ++numCalls;
+
+            --numActive;
+            isInCallback = false;
+            return 0;
+        }
+
+        std::atomic<int>& numActive;
+        std::atomic<int>& peakActive;
+        std::atomic<bool> isInCallback { false }, wasCalledByTwoThreads { false };
+        std::atomic<int> numCalls { 0 };
+    };
+
+    void runTest() override
+    {
+        std::atomic<int> numActive { 0 }, peakActive { 0 };
+        OwnedArray<Client> clients;
+
+        for (int i = 0; i < 8; ++i)
+            clients.add (new Client (numActive, peakActive));
+
+        TimeSliceThread thread ("TimeSliceThread test");
+        thread.setNumThreads (4);
+        thread.startThread();
+
+        for (auto* c : clients)
+            thread.addTimeSliceClient (c);
+
+        beginTest ("The clients are shared between the threads");
+        {
+            Thread::sleep (200);
+            expect (peakActive > 1);
+            expect (peakActive <= 4);
+
+            for (auto* c : clients)
+                expect (c->numCalls > 0);
+        }
+
+        beginTest ("Reducing the number of threads stops the extra ones");
+        {
+            thread.setNumThreads (1);
+            Thread::sleep (100);
+
+            peakActive = 0;
+            Thread::sleep (100);
+            expectEquals (peakActive.load(), 1);
+        }
+
+        beginTest ("Removing a client waits for any call that's in progress");
+        {
+            thread.setNumThreads (4);
+            Thread::sleep (100);
+
+            for (auto* c : clients)
+            {
+                thread.removeTimeSliceClient (c);
+                expect (! c->isInCallback);
+            }
+
+            Array<int> numCalls;
+
+            for (auto* c : clients)
+                numCalls.add (c->numCalls);
+
+            Thread::sleep (20);
+
+            for (int i = 0; i < clients.size(); ++i)
+                expectEquals (clients[i]->numCalls.load(), numCalls[i]);
+        }
+
+        for (auto* c : clients)
+            expect (! c->wasCalledByTwoThreads);
+
+        thread.stopThread (2000);
+    }
+};
+
+static TimeSliceThreadTests timeSliceThreadTests;
+
+#endif
+
 } // namespace juce
@@ -75,6 +75,13 @@ private:
     A thread that keeps a list of clients, and calls each one in turn, giving them
     all a chance to run some sort of short task.
 
+    The client whose requested call time is the earliest always gets called next,
+    so a client can make itself more or less urgent by the value it returns from
+    TimeSliceClient::useTimeSlice().
+
+    If there are too many clients for one thread to keep up with, setNumThreads()
+    can be used to add extra threads that share the work.
+
     @see TimeSliceClient, Thread
 
     @tags{Core}
@@ -131,6 +138,24 @@ public:
     /** Returns one of the registered clients. */
     TimeSliceClient* getClient (int index) const;
 
+    //==============================================================================
+    /** Sets the number of threads that call the clients.
+
+        By default there's just one, but if you ask for more, the extra threads will
+        be started and stopped along with this one. Whichever thread becomes free first
+        calls the client that's due soonest, and a client is never called by more than
+        one of the threads at a time, so clients don't need to do anything different.
+
+        The extra threads run at the default priority. When the number of threads
+        is reduced, or this thread is stopped, the extra threads are never killed:
+        each one is allowed to finish the callback that it's in, however long that
+        takes, so a client that never returns will stop them from exiting.
+    */
+    void setNumThreads (int numThreads);
+
+    /** Returns the number of threads that was set with setNumThreads(). */
+    int getNumThreads() const noexcept                  { return numThreads; }
+
     //==============================================================================
    #ifndef DOXYGEN
     void run() override;
@@ -138,11 +163,19 @@ public:
 
     //==============================================================================
 private:
-    CriticalSection callbackLock, listLock;
+    class HelperThread;
+    CriticalSection callbackLock, listLock, helperLock;
     Array<TimeSliceClient*> clients;
     TimeSliceClient* clientBeingCalled = nullptr;
+    OwnedArray<HelperThread> helperThreads;
+    std::atomic<int> numThreads { 1 };
 
     TimeSliceClient* getNextClient (int index) const;
+    bool isBeingCalled (TimeSliceClient*) const;
+    int callNextClient (int& index, CriticalSection& lockToUse, TimeSliceClient*& clientToSet);
+    void notifyAllThreads();
+    void updateHelperThreads();
+    void stopHelperThreads();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeSliceThread)
 };
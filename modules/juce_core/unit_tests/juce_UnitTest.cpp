@@ -113,6 +113,30 @@ Random UnitTest::getRandom() const
     return runner->randomForTest;
 }
 
+//==============================================================================
+UnitTestBenchmark::UnitTestBenchmark (const String& nm)
+    : UnitTest (nm, getBenchmarkCategory())
+{
+}
+
+String UnitTestBenchmark::getBenchmarkCategory()
+{
+    return "Benchmarks";
+}
+
+void UnitTestBenchmark::logTime (const String& label, double seconds)
+{
+    if (seconds < 1.0e-6)       logResult (label, seconds * 1.0e9, "ns");
+    else if (seconds < 1.0e-3)  logResult (label, seconds * 1.0e6, "us");
+    else if (seconds < 1.0)     logResult (label, seconds * 1.0e3, "ms");
+    else                        logResult (label, seconds, "s");
+}
+
+void UnitTestBenchmark::logResult (const String& label, double value, const String& units)
+{
+    logMessage (label.paddedRight (' ', jmax (48, label.length() + 2)) + String (value, value < 10.0 ? 3 : 1) + " " + units);
+}
+
 //==============================================================================
 UnitTestRunner::UnitTestRunner() {}
 UnitTestRunner::~UnitTestRunner() {}
@@ -176,7 +200,14 @@ void UnitTestRunner::runTests (const Array<UnitTest*>& tests, int64 randomSeed)
 
 void UnitTestRunner::runAllTests (int64 randomSeed)
 {
-    runTests (UnitTest::getAllTests(), randomSeed);
+    auto benchmarkCategory = UnitTestBenchmark::getBenchmarkCategory();
+    Array<UnitTest*> tests;
+
+    for (auto* test : UnitTest::getAllTests())
+        if (test->getCategory() != benchmarkCategory)
+            tests.add (test);
+
+    runTests (tests, randomSeed);
 }
 
 void UnitTestRunner::runTestsInCategory (const String& category, int64 randomSeed)
@@ -307,6 +307,107 @@ private:
 };
 
 
+//==============================================================================
+/**
+    A UnitTest that measures how quickly some code runs, rather than checking that it works.
+
+    All benchmarks are placed in the category returned by getBenchmarkCategory(), and
+    UnitTestRunner::runAllTests() skips that category, so they don't slow down ordinary
+    test runs. To run them, call UnitTestRunner::runTestsInCategory() with that category,
+    or pass "--category Benchmarks" to the UnitTestRunner console app. The timings are
+    only meaningful in a release build!
+
+    Inside runTest(), use beginTest() to group the measurements, and timeCalls() to
+    measure each operation, e.g.
+
+    @code
+    class MyBenchmark  : public UnitTestBenchmark
+    {
+    public:
+        MyBenchmark() : UnitTestBenchmark ("Foobar") {}
+
+        void runTest() override
+        {
+            beginTest ("Lookups");
+
+            timeCalls ("Foobar::find", [&] { return foobar.find (someKey); });
+            timeCalls ("std::find",    [&] { return *std::find (values.begin(), values.end(), someKey); });
+        }
+    };
+
+    static MyBenchmark benchmark;
+    @endcode
+
+    @see UnitTest, UnitTestRunner
+
+    @tags{Core}
+*/
+class JUCE_API  UnitTestBenchmark  : public UnitTest
+{
+public:
+    //==============================================================================
+    /** Creates a benchmark with the given name, in the benchmark category. */
+    explicit UnitTestBenchmark (const String& name);
+
+    /** Returns the category that all UnitTestBenchmark objects are placed in. */
+    static String getBenchmarkCategory();
+
+protected:
+    //==============================================================================
+    /** Calls a function repeatedly for at least the given number of seconds, logs the
+        average time that each call took, and returns that time in seconds.
+
+        If the function returns a value, the values are accumulated so that the compiler
+        can't optimise away the work that produced them.
+    */
+    template <typename Function>
+    double timeCalls (const String& label, Function&& function, double minimumSeconds = 0.1)
+    {
+        using ReturnsVoid = std::is_void<decltype (function())>;
+
+        callAndKeepResult (function, ReturnsVoid());
+
+        int64 numCalls = 0;
+        auto startTicks = Time::getHighResolutionTicks();
+        auto elapsedSeconds = 0.0;
+
+        for (int batchSize = 1;; batchSize = jmin (batchSize * 2, 1 << 16))
+        {
+            for (int i = 0; i < batchSize; ++i)
+                callAndKeepResult (function, ReturnsVoid());
+
+            numCalls += batchSize;
+            elapsedSeconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+
+            if (elapsedSeconds >= minimumSeconds)
+                break;
+        }
+
+        auto secondsPerCall = elapsedSeconds / (double) numCalls;
+        logTime (label, secondsPerCall);
+        return secondsPerCall;
+    }
+
+    /** Logs a duration, in whatever units suit its size. */
+    void logTime (const String& label, double seconds);
+
+    /** Logs a measured value along with its units. */
+    void logResult (const String& label, double value, const String& units);
+
+private:
+    //==============================================================================
+    template <typename Function>
+    void callAndKeepResult (Function& function, std::true_type)    { function(); }
+
+    template <typename Function>
+    void callAndKeepResult (Function& function, std::false_type)   { resultAccumulator = resultAccumulator + (int64) function(); }
+
+    volatile int64 resultAccumulator = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (UnitTestBenchmark)
+};
+
+
 //==============================================================================
 /**
     Runs a set of unit tests.
@@ -342,7 +443,9 @@ public:
     void runTests (const Array<UnitTest*>& tests, int64 randomSeed = 0);
 
     /** Runs all the UnitTest objects that currently exist.
-        This calls runTests() for all the objects listed in UnitTest::getAllTests().
+        This calls runTests() for all the objects listed in UnitTest::getAllTests(),
+        apart from the UnitTestBenchmark objects, which must be run explicitly with
+        runTestsInCategory().
 
         If you want to run the tests with a predetermined seed, you can pass that into
         the randomSeed argument, or pass 0 to have a randomly-generated seed chosen.
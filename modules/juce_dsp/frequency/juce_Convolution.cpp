@@ -62,6 +62,7 @@ struct ConvolutionEngine
         bool wantsStereo = true;
         bool wantsTrimming = true;
         bool wantsNormalization = true;
+        bool wantsNonUniformPartitioning = false;
         int64 wantedSize = 0;
         int finalSize = 0;
 
@@ -81,6 +82,15 @@ struct ConvolutionEngine
 
         currentSegment = 0;
         inputDataPos = 0;
+
+        bufferTailInput.clear();
+        bufferTailOutput.clear();
+
+        for (auto* stage : tailStages)
+            stage->reset();
+
+        tailInputPos = 0;
+        tailOutputPos = 0;
     }
 
     /** Initalize all the states and objects to perform the convolution. */
@@ -91,7 +101,14 @@ struct ConvolutionEngine
         FFTSize = blockSize > 128 ? 2 * blockSize
                                   : 4 * blockSize;
 
-        numSegments = ((size_t) info.finalSize) / (FFTSize - blockSize) + 1u;
+        // In non-uniform mode, the head only covers the start of the impulse response,
+        // and the rest of it is handled by the tail stages with bigger partitions
+        auto headSize = (size_t) info.finalSize;
+
+        if (info.wantsNonUniformPartitioning)
+            headSize = jmin (headSize, 8 * blockSize);
+
+        numSegments = headSize / (FFTSize - blockSize) + 1u;
 
         numInputSegments = (blockSize > 128 ? numSegments : 3 * numSegments);
 
@@ -134,13 +151,15 @@ struct ConvolutionEngine
                 impulseResponse[0] = 1.0f;
 
             for (size_t i = 0; i < FFTSize - blockSize; ++i)
-                if (i + n * (FFTSize - blockSize) < (size_t) info.finalSize)
+                if (i + n * (FFTSize - blockSize) < headSize)
                     impulseResponse[i] = channelData[i + n * (FFTSize - blockSize)];
 
             FFTTempObject->performRealOnlyForwardTransform (impulseResponse);
-            prepareForConvolution (impulseResponse);
+            prepareForConvolution (impulseResponse, FFTSize);
         }
 
+        initializeTailStages (channelData, (size_t) info.finalSize, headSize);
+
         reset();
 
         isReady = true;
@@ -169,15 +188,79 @@ struct ConvolutionEngine
         buffersImpulseSegments  = other.buffersImpulseSegments;
         bufferOverlap           = other.bufferOverlap;
 
+        while (tailStages.size() > other.tailStages.size())
+            tailStages.removeLast();
+
+        while (tailStages.size() < other.tailStages.size())
+            tailStages.add (new TailStage());
+
+        for (auto i = 0; i < tailStages.size(); ++i)
+            tailStages.getUnchecked (i)->copyStateFrom (*other.tailStages.getUnchecked (i));
+
+        tailInputPos        = other.tailInputPos;
+        tailOutputPos       = other.tailOutputPos;
+        tailOutputMask      = other.tailOutputMask;
+
+        bufferTailInput     = other.bufferTailInput;
+        bufferTailOutput    = other.bufferTailOutput;
+
         isReady = true;
     }
 
-    /** Performs the uniform partitioned convolution using FFT. */
+    /** Performs the convolution, adding the output of the tail stages to the output
+        of the head when non-uniform partitioning is being used.
+    */
     void processSamples (const float* input, float* output, size_t numSamples)
     {
         if (! isReady)
             return;
 
+        if (tailStages.isEmpty())
+        {
+            processHeadSamples (input, output, numSamples);
+            return;
+        }
+
+        auto* tailInputData  = bufferTailInput.getWritePointer (0);
+        auto* tailOutputData = bufferTailOutput.getWritePointer (0);
+
+        size_t numSamplesProcessed = 0;
+
+        while (numSamplesProcessed < numSamples)
+        {
+            auto numSamplesToProcess = jmin (numSamples - numSamplesProcessed, blockSize - tailInputPos);
+
+            // the input must be stored before the head runs, as it may be processing in place
+            FloatVectorOperations::copy (tailInputData + tailInputPos, input + numSamplesProcessed, static_cast<int> (numSamplesToProcess));
+
+            processHeadSamples (input + numSamplesProcessed, output + numSamplesProcessed, numSamplesToProcess);
+
+            for (size_t i = 0; i < numSamplesToProcess; ++i)
+            {
+                auto& tailSample = tailOutputData[tailOutputPos];
+
+                output[i + numSamplesProcessed] += tailSample;
+                tailSample = 0.0f;
+                tailOutputPos = (tailOutputPos + 1) & tailOutputMask;
+            }
+
+            tailInputPos += numSamplesToProcess;
+
+            if (tailInputPos == blockSize)
+            {
+                tailInputPos = 0;
+
+                for (auto* stage : tailStages)
+                    stage->processBlock (tailInputData, tailOutputData, tailOutputMask, tailOutputPos + blockSize);
+            }
+
+            numSamplesProcessed += numSamplesToProcess;
+        }
+    }
+
+    /** Performs the uniform partitioned convolution of the head using FFT. */
+    void processHeadSamples (const float* input, float* output, size_t numSamples)
+    {
         // Overlap-add, zero latency convolution algorithm with uniform partitioning
         size_t numSamplesProcessed = 0;
 
@@ -201,7 +284,7 @@ struct ConvolutionEngine
 
             // Forward FFT
             FFTobject->performRealOnlyForwardTransform (inputSegmentData);
-            prepareForConvolution (inputSegmentData);
+            prepareForConvolution (inputSegmentData, FFTSize);
 
             // Complex multiplication
             if (inputDataWasEmpty)
@@ -219,7 +302,7 @@ struct ConvolutionEngine
 
                     convolutionProcessingAndAccumulate (buffersInputSegments.getReference (static_cast<int> (index)).getWritePointer (0),
                                                         buffersImpulseSegments.getReference (static_cast<int> (i)).getWritePointer (0),
-                                                        outputTempData);
+                                                        outputTempData, FFTSize);
                 }
             }
 
@@ -227,10 +310,10 @@ struct ConvolutionEngine
 
             convolutionProcessingAndAccumulate (buffersInputSegments.getReference (static_cast<int> (currentSegment)).getWritePointer (0),
                                                 buffersImpulseSegments.getReference (0).getWritePointer (0),
-                                                outputData);
+                                                outputData, FFTSize);
 
             // Inverse FFT
-            updateSymmetricFrequencyDomainData (outputData);
+            updateSymmetricFrequencyDomainData (outputData, FFTSize);
             FFTobject->performRealOnlyInverseTransform (outputData);
 
             // Add overlap
@@ -261,10 +344,202 @@ struct ConvolutionEngine
         }
     }
 
+    //==============================================================================
+    /** One stage of the tail used for non-uniform partitioning.
+
+        A stage with a partition size of N handles the part of the impulse response
+        which starts 2 * N samples after its beginning. This leaves a whole partition
+        of time between the moment an input block is complete and the moment its
+        output is needed, so the forward FFT is done when the block is complete, and
+        the spectral products and the inverse FFT are spread over the following
+        head blocks, instead of being done in a single audio callback.
+    */
+    struct TailStage
+    {
+        TailStage() = default;
+
+        void initialise (const float* impulseData, size_t impulseStart, size_t impulseEnd,
+                         size_t newPartitionSize, size_t newHeadBlockSize)
+        {
+            partitionSize = newPartitionSize;
+            headBlockSize = newHeadBlockSize;
+            FFTSize = 2 * partitionSize;
+            numSegments = (impulseEnd - impulseStart + partitionSize - 1) / partitionSize;
+
+            jassert (partitionSize >= 4 * headBlockSize);
+
+            FFTobject.reset (new FFT (roundToInt (std::log2 (FFTSize))));
+
+            bufferInput.setSize  (1, static_cast<int> (partitionSize));
+            bufferOutput.setSize (1, static_cast<int> (FFTSize * 2));
+
+            buffersInputSegments.clear();
+            buffersImpulseSegments.clear();
+
+            for (size_t n = 0; n < numSegments; ++n)
+            {
+                AudioBuffer<float> newInputSegment;
+                newInputSegment.setSize (1, static_cast<int> (FFTSize * 2));
+                buffersInputSegments.add (newInputSegment);
+
+                AudioBuffer<float> newImpulseSegment;
+                newImpulseSegment.setSize (1, static_cast<int> (FFTSize * 2));
+                newImpulseSegment.clear();
+
+                auto* impulseResponse = newImpulseSegment.getWritePointer (0);
+                auto segmentStart = impulseStart + n * partitionSize;
+
+                FloatVectorOperations::copy (impulseResponse, impulseData + segmentStart,
+                                             static_cast<int> (jmin (partitionSize, impulseEnd - segmentStart)));
+
+                FFTobject->performRealOnlyForwardTransform (impulseResponse);
+                prepareForConvolution (impulseResponse, FFTSize);
+
+                buffersImpulseSegments.add (newImpulseSegment);
+            }
+
+            reset();
+        }
+
+        void reset()
+        {
+            bufferInput.clear();
+            bufferOutput.clear();
+
+            for (auto i = 0; i < buffersInputSegments.size(); ++i)
+                buffersInputSegments.getReference (i).clear();
+
+            currentSegment = 0;
+            inputDataPos = 0;
+        }
+
+        void copyStateFrom (const TailStage& other)
+        {
+            if (FFTSize != other.FFTSize || FFTobject == nullptr)
+            {
+                FFTobject.reset (new FFT (roundToInt (std::log2 (other.FFTSize))));
+                FFTSize = other.FFTSize;
+            }
+
+            partitionSize   = other.partitionSize;
+            headBlockSize   = other.headBlockSize;
+            numSegments     = other.numSegments;
+            currentSegment  = other.currentSegment;
+            inputDataPos    = other.inputDataPos;
+
+            bufferInput     = other.bufferInput;
+            bufferOutput    = other.bufferOutput;
+
+            buffersInputSegments    = other.buffersInputSegments;
+            buffersImpulseSegments  = other.buffersImpulseSegments;
+        }
+
+        /** Called each time the head has consumed a full block of input. The result of
+            the stage is added to the circular output buffer, starting at outputPos.
+        */
+        void processBlock (const float* input, float* outputRing, size_t outputMask, size_t outputPos)
+        {
+            FloatVectorOperations::copy (bufferInput.getWritePointer (0) + inputDataPos, input, static_cast<int> (headBlockSize));
+            inputDataPos += headBlockSize;
+
+            auto* outputData = bufferOutput.getWritePointer (0);
+
+            if (inputDataPos == partitionSize)
+            {
+                inputDataPos = 0;
+                currentSegment = (currentSegment > 0) ? (currentSegment - 1) : (numSegments - 1);
+
+                // Forward FFT
+                auto* inputSegmentData = buffersInputSegments.getReference (static_cast<int> (currentSegment)).getWritePointer (0);
+
+                FloatVectorOperations::copy (inputSegmentData, bufferInput.getReadPointer (0), static_cast<int> (partitionSize));
+                FloatVectorOperations::clear (inputSegmentData + partitionSize, static_cast<int> (FFTSize - partitionSize));
+
+                FFTobject->performRealOnlyForwardTransform (inputSegmentData);
+                prepareForConvolution (inputSegmentData, FFTSize);
+
+                FloatVectorOperations::fill (outputData, 0, static_cast<int> (FFTSize + 1));
+                return;
+            }
+
+            // Complex multiplication, spread over the remaining blocks of the partition
+            auto numBlocksForWork = partitionSize / headBlockSize - 1;
+            auto block = inputDataPos / headBlockSize;
+
+            for (auto i = (block - 1) * numSegments / numBlocksForWork; i < block * numSegments / numBlocksForWork; ++i)
+            {
+                auto index = currentSegment + i;
+
+                if (index >= numSegments)
+                    index -= numSegments;
+
+                convolutionProcessingAndAccumulate (buffersInputSegments.getReference (static_cast<int> (index)).getReadPointer (0),
+                                                    buffersImpulseSegments.getReference (static_cast<int> (i)).getReadPointer (0),
+                                                    outputData, FFTSize);
+            }
+
+            if (block == numBlocksForWork)
+            {
+                // Inverse FFT, and overlap-add of the result in the output buffer
+                updateSymmetricFrequencyDomainData (outputData, FFTSize);
+                FFTobject->performRealOnlyInverseTransform (outputData);
+
+                for (size_t i = 0; i < FFTSize; ++i)
+                    outputRing[(outputPos + i) & outputMask] += outputData[i];
+            }
+        }
+
+        //==============================================================================
+        std::unique_ptr<FFT> FFTobject;
+
+        size_t FFTSize = 0, partitionSize = 0, headBlockSize = 0;
+        size_t currentSegment = 0, numSegments = 0, inputDataPos = 0;
+
+        AudioBuffer<float> bufferInput, bufferOutput;
+        Array<AudioBuffer<float>> buffersInputSegments, buffersImpulseSegments;
+
+        JUCE_DECLARE_NON_COPYABLE (TailStage)
+    };
+
+    /** Creates the tail stages needed to process the part of the impulse response
+        which isn't handled by the head. Each stage has a partition size four times
+        bigger than the previous one, until the biggest size is reached.
+    */
+    void initializeTailStages (const float* impulseData, size_t impulseSize, size_t headSize)
+    {
+        tailStages.clear();
+
+        auto partitionSize = 4 * blockSize;
+        auto maximumPartitionSize = jmax ((size_t) maximumTailPartitionSize, partitionSize);
+        auto start = headSize;
+
+        while (start < impulseSize)
+        {
+            jassert (start == 2 * partitionSize);
+
+            auto end = impulseSize;
+
+            if (4 * partitionSize <= maximumPartitionSize)
+                end = jmin (end, 8 * partitionSize);
+
+            auto* stage = tailStages.add (new TailStage());
+            stage->initialise (impulseData, start, end, partitionSize, blockSize);
+
+            start = end;
+            partitionSize *= 4;
+        }
+
+        auto outputSize = tailStages.isEmpty() ? 0 : nextPowerOfTwo (static_cast<int> (2 * tailStages.getLast()->partitionSize + blockSize));
+
+        bufferTailInput.setSize  (1, static_cast<int> (blockSize));
+        bufferTailOutput.setSize (1, outputSize);
+        tailOutputMask = (size_t) jmax (0, outputSize - 1);
+    }
+
     /** After each FFT, this function is called to allow convolution to be performed with only 4 SIMD functions calls. */
-    void prepareForConvolution (float *samples) noexcept
+    static void prepareForConvolution (float *samples, size_t fftSize) noexcept
     {
-        auto FFTSizeDiv2 = FFTSize / 2;
+        auto FFTSizeDiv2 = fftSize / 2;
 
         for (size_t i = 0; i < FFTSizeDiv2; i++)
             samples[i] = samples[2 * i];
@@ -272,13 +547,13 @@ struct ConvolutionEngine
         samples[FFTSizeDiv2] = 0;
 
         for (size_t i = 1; i < FFTSizeDiv2; i++)
-            samples[i + FFTSizeDiv2] = -samples[2 * (FFTSize - i) + 1];
+            samples[i + FFTSizeDiv2] = -samples[2 * (fftSize - i) + 1];
     }
 
     /** Does the convolution operation itself only on half of the frequency domain samples. */
-    void convolutionProcessingAndAccumulate (const float *input, const float *impulse, float *output)
+    static void convolutionProcessingAndAccumulate (const float *input, const float *impulse, float *output, size_t fftSize)
     {
-        auto FFTSizeDiv2 = FFTSize / 2;
+        auto FFTSizeDiv2 = fftSize / 2;
 
         FloatVectorOperations::addWithMultiply      (output, input, impulse, static_cast<int> (FFTSizeDiv2));
         FloatVectorOperations::subtractWithMultiply (output, &(input[FFTSizeDiv2]), &(impulse[FFTSizeDiv2]), static_cast<int> (FFTSizeDiv2));
@@ -286,29 +561,29 @@ struct ConvolutionEngine
         FloatVectorOperations::addWithMultiply      (&(output[FFTSizeDiv2]), input, &(impulse[FFTSizeDiv2]), static_cast<int> (FFTSizeDiv2));
         FloatVectorOperations::addWithMultiply      (&(output[FFTSizeDiv2]), &(input[FFTSizeDiv2]), impulse, static_cast<int> (FFTSizeDiv2));
 
-        output[FFTSize] += input[FFTSize] * impulse[FFTSize];
+        output[fftSize] += input[fftSize] * impulse[fftSize];
     }
 
     /** Undo the re-organization of samples from the function prepareForConvolution.
         Then, takes the conjugate of the frequency domain first half of samples, to fill the
         second half, so that the inverse transform will return real samples in the time domain.
     */
-    void updateSymmetricFrequencyDomainData (float* samples) noexcept
+    static void updateSymmetricFrequencyDomainData (float* samples, size_t fftSize) noexcept
     {
-        auto FFTSizeDiv2 = FFTSize / 2;
+        auto FFTSizeDiv2 = fftSize / 2;
 
         for (size_t i = 1; i < FFTSizeDiv2; i++)
         {
-            samples[2 * (FFTSize - i)] = samples[i];
-            samples[2 * (FFTSize - i) + 1] = -samples[FFTSizeDiv2 + i];
+            samples[2 * (fftSize - i)] = samples[i];
+            samples[2 * (fftSize - i) + 1] = -samples[FFTSizeDiv2 + i];
         }
 
         samples[1] = 0.f;
 
         for (size_t i = 1; i < FFTSizeDiv2; i++)
         {
-            samples[2 * i] = samples[2 * (FFTSize - i)];
-            samples[2 * i + 1] = -samples[2 * (FFTSize - i) + 1];
+            samples[2 * i] = samples[2 * (fftSize - i)];
+            samples[2 * i + 1] = -samples[2 * (fftSize - i) + 1];
         }
     }
 
@@ -321,6 +596,12 @@ struct ConvolutionEngine
     AudioBuffer<float> bufferInput, bufferOutput, bufferTempOutput, bufferOverlap;
     Array<AudioBuffer<float>> buffersInputSegments, buffersImpulseSegments;
 
+    static constexpr int maximumTailPartitionSize = 4096;
+
+    OwnedArray<TailStage> tailStages;
+    size_t tailInputPos = 0, tailOutputPos = 0, tailOutputMask = 0;
+    AudioBuffer<float> bufferTailInput, bufferTailOutput;
+
     bool isReady = false;
 
     //==============================================================================
@@ -346,6 +627,7 @@ struct Convolution::Pimpl  : private Thread
         changeStereo,
         changeTrimming,
         changeNormalization,
+        changeNonUniformPartitioning,
         changeIgnore,
         numChangeRequestTypes
     };
@@ -635,6 +917,17 @@ struct Convolution::Pimpl  : private Thread
                 }
                 break;
 
+                case ChangeRequest::changeNonUniformPartitioning:
+                {
+                    bool newWantsNonUniformPartitioning = requestsParameter[n];
+
+                    if (currentInfo.wantsNonUniformPartitioning != newWantsNonUniformPartitioning)
+                        changeLevel = jmax (1, changeLevel);
+
+                    currentInfo.wantsNonUniformPartitioning = newWantsNonUniformPartitioning;
+                }
+                break;
+
                 case ChangeRequest::changeIgnore:
                     break;
 
@@ -1152,6 +1445,11 @@ void Convolution::copyAndLoadImpulseResponseFromBlock (AudioBlock<float> block,
     pimpl->addToFifo (types, parameters, 5);
 }
 
+void Convolution::setNonUniformPartitioning (bool shouldUseNonUniformPartitioning)
+{
+    pimpl->addToFifo (Pimpl::ChangeRequest::changeNonUniformPartitioning, juce::var (shouldUseNonUniformPartitioning));
+}
+
 void Convolution::prepare (const ProcessSpec& spec)
 {
     jassert (isPositiveAndBelow (spec.numChannels, static_cast<uint32> (3))); // only mono and stereo is supported
@@ -33,6 +33,10 @@ namespace dsp
     Performs stereo uniform-partitioned convolution of an input signal with an
     impulse response in the frequency domain, using the juce FFT class.
 
+    For long impulse responses, a non-uniform partitioned mode is available as
+    well, which still adds no latency but is a lot cheaper to run. See
+    setNonUniformPartitioning().
+
     It provides some thread-safe functions to load impulse responses as well,
     from audio files or memory on the fly without any noticeable artefacts,
     performing resampling and trimming if necessary.
@@ -149,6 +153,20 @@ public:
                                               bool wantsStereo, bool wantsTrimming, bool wantsNormalization,
                                               size_t size);
 
+    /** Enables or disables the non-uniform partitioned convolution mode.
+
+        By default, the impulse response is split into partitions which all have
+        the size of the processing block, which becomes very expensive with long
+        impulse responses and small blocks. In non-uniform mode, only the start of
+        the impulse response uses these small partitions, and the rest of it is split
+        into partitions which get bigger and bigger, with their FFT work being spread
+        over several blocks. There is still no latency added in this mode.
+
+        Like the impulse response loading functions, this is thread-safe and the
+        change is applied smoothly.
+    */
+    void setNonUniformPartitioning (bool shouldUseNonUniformPartitioning);
+
 
 private:
     //==============================================================================
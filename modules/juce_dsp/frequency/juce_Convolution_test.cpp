@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+struct ConvolutionTest  : public UnitTest
+{
+    ConvolutionTest()  : UnitTest ("Convolution", "DSP") {}
+
+    static void fillRandom (Random& random, float* buffer, size_t n, float decay)
+    {
+        auto gain = 1.0f;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            buffer[i] = gain * ((2.0f * random.nextFloat()) - 1.0f);
+            gain *= decay;
+        }
+    }
+
+    static void performReferenceConvolution (const float* input, size_t numInputSamples,
+                                             const float* impulse, size_t numImpulseSamples,
+                                             float* output)
+    {
+        for (size_t n = 0; n < numInputSamples; ++n)
+        {
+            double sum = 0.0;
+
+            for (size_t i = 0; i < numImpulseSamples && i <= n; ++i)
+                sum += (double) input[n - i] * (double) impulse[i];
+
+            output[n] = (float) sum;
+        }
+    }
+
+    void runEngineTest (Random& random, size_t maximumBufferSize, size_t impulseSize, bool nonUniform)
+    {
+        const size_t numSamples = 20000;
+
+        AudioBuffer<float> impulse (2, (int) impulseSize);
+        impulse.clear();
+        fillRandom (random, impulse.getWritePointer (0), impulseSize, 0.9997f);
+
+        ConvolutionEngine::ProcessingInformation info;
+        info.buffer = &impulse;
+        info.finalSize = (int) impulseSize;
+        info.maximumBufferSize = maximumBufferSize;
+        info.wantsNonUniformPartitioning = nonUniform;
+
+        ConvolutionEngine engine;
+        engine.initializeConvolutionEngine (info, 0);
+
+        expect (engine.tailStages.isEmpty() != (nonUniform && impulseSize > 8 * engine.blockSize));
+
+        HeapBlock<float> input (numSamples), expected (numSamples), output (numSamples);
+        fillRandom (random, input.get(), numSamples, 1.0f);
+        performReferenceConvolution (input.get(), numSamples, impulse.getReadPointer (0), impulseSize, expected.get());
+
+        for (auto pass = 0; pass < 2; ++pass)
+        {
+            // in place processing, with random block sizes
+            FloatVectorOperations::copy (output.get(), input.get(), (int) numSamples);
+
+            for (size_t pos = 0; pos < numSamples;)
+            {
+                auto numToProcess = jmin (numSamples - pos, (size_t) random.nextInt ((int) maximumBufferSize) + 1);
+                engine.processSamples (output.get() + pos, output.get() + pos, numToProcess);
+                pos += numToProcess;
+            }
+
+            auto maxError = 0.0f;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                maxError = jmax (maxError, std::abs (output[i] - expected[i]));
+
+            expectLessThan (maxError, 1.0e-3f);
+
+            engine.reset();
+        }
+    }
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Uniform partitioning matches direct convolution");
+        runEngineTest (random, 64, 12000, false);
+        runEngineTest (random, 100, 3000, false);
+
+        beginTest ("Non-uniform partitioning matches direct convolution");
+        runEngineTest (random, 64, 12000, true);
+        runEngineTest (random, 16, 12000, true);
+        runEngineTest (random, 100, 3000, true);
+        runEngineTest (random, 512, 1000, true);
+    }
+};
+
+static ConvolutionTest convolutionUnitTest;
+
+} // namespace dsp
+} // namespace juce
@@ -35,6 +35,25 @@ struct FFT::Instance
     virtual void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept = 0;
     virtual void performRealOnlyForwardTransform (float*, bool) const noexcept = 0;
     virtual void performRealOnlyInverseTransform (float*) const noexcept = 0;
+
+    // Engines which can do something smarter than transforming the channels one by one can override these
+    virtual void performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs, int numChannels, bool inverse) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            perform (inputs[i], outputs[i], inverse);
+    }
+
+    virtual void performRealOnlyForwardTransformBatch (float* const* channels, int numChannels, bool ignoreNegativeFreqs) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            performRealOnlyForwardTransform (channels[i], ignoreNegativeFreqs);
+    }
+
+    virtual void performRealOnlyInverseTransformBatch (float* const* channels, int numChannels) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            performRealOnlyInverseTransform (channels[i]);
+    }
 };
 
 struct FFT::Engine
@@ -80,25 +99,57 @@ struct FFT::EngineImpl  : public FFT::Engine
 
 //==============================================================================
 //==============================================================================
-struct FFTFallback  : public FFT::Instance
+#if JUCE_USE_SIMD
+/*  A complex number whose real and imaginary parts are SIMD registers, which is used
+    by the fallback engine to transform several channels at once, one in each lane.
+*/
+template <typename FloatType>
+struct SIMDComplex
 {
-    // this should have the least priority of all engines
-    static constexpr int priority = -1;
+    using Register = SIMDRegister<FloatType>;
 
-    static FFTFallback* create (int order)
-    {
-        return new FFTFallback (order);
-    }
+    SIMDComplex() = default;
+    SIMDComplex (Register r, Register i) noexcept  : re (r), im (i) {}
+
+    Register real() const noexcept      { return re; }
+    Register imag() const noexcept      { return im; }
+
+    SIMDComplex operator+ (SIMDComplex other) const noexcept          { return { re + other.re, im + other.im }; }
+    SIMDComplex operator- (SIMDComplex other) const noexcept          { return { re - other.re, im - other.im }; }
+    SIMDComplex operator* (Complex<FloatType> w) const noexcept       { return { re * w.real() - im * w.imag(), re * w.imag() + im * w.real() }; }
+    SIMDComplex operator* (FloatType s) const noexcept                { return { re * s, im * s }; }
+
+    SIMDComplex& operator+= (SIMDComplex other) noexcept              { re += other.re; im += other.im; return *this; }
+    SIMDComplex& operator-= (SIMDComplex other) noexcept              { re -= other.re; im -= other.im; return *this; }
+    SIMDComplex& operator*= (Complex<FloatType> w) noexcept           { return *this = *this * w; }
+
+    SIMDComplex conj() const noexcept                                 { return { re, Register::expand (0) - im }; }
+
+    Register re, im;
+};
+#endif
 
-    FFTFallback (int order)
+//==============================================================================
+template <typename FloatType>
+struct FFTFallbackImpl
+{
+    using ComplexType = Complex<FloatType>;
+
+    FFTFallbackImpl (int order)  : size (1 << order)
     {
-        configForward.reset (new FFTConfig (1 << order, false));
-        configInverse.reset (new FFTConfig (1 << order, true));
+        configForward.reset (new FFTConfig (size, false));
+        configInverse.reset (new FFTConfig (size, true));
 
-        size = 1 << order;
+        // The real-only transforms are done with a complex FFT of half the size, whose
+        // twiddle factors are every other element of the full-size tables
+        if (size > 2)
+        {
+            halfSizeConfigForward.reset (new FFTConfig (size / 2, *configForward));
+            halfSizeConfigInverse.reset (new FFTConfig (size / 2, *configInverse));
+        }
     }
 
-    void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept override
+    void perform (const ComplexType* input, ComplexType* output, bool inverse) const noexcept
     {
         if (size == 1)
         {
@@ -113,11 +164,7 @@ struct FFTFallback  : public FFT::Instance
         if (inverse)
         {
             configInverse->perform (input, output);
-
-            const float scaleFactor = 1.0f / size;
-
-            for (int i = 0; i < size; ++i)
-                output[i] *= scaleFactor;
+            FloatVectorOperations::multiply (reinterpret_cast<FloatType*> (output), static_cast<FloatType> (1) / static_cast<FloatType> (size), size * 2);
         }
         else
         {
@@ -127,71 +174,326 @@ struct FFTFallback  : public FFT::Instance
 
     const size_t maxFFTScratchSpaceToAlloca = 256 * 1024;
 
-    void performRealOnlyForwardTransform (float* d, bool) const noexcept override
+    void performRealOnlyForwardTransform (FloatType* d, bool dontCalculateNegativeFrequencies) const noexcept
     {
         if (size == 1)
             return;
 
-        const size_t scratchSize = 16 + sizeof (Complex<float>) * (size_t) size;
+        const size_t scratchSize = 16 + sizeof (ComplexType) * (size_t) (size / 2);
 
         if (scratchSize < maxFFTScratchSpaceToAlloca)
         {
-            performRealOnlyForwardTransform (static_cast<Complex<float>*> (alloca (scratchSize)), d);
+            performRealOnlyForwardTransform (static_cast<ComplexType*> (alloca (scratchSize)), d, dontCalculateNegativeFrequencies);
         }
         else
         {
             HeapBlock<char> heapSpace (scratchSize);
-            performRealOnlyForwardTransform (reinterpret_cast<Complex<float>*> (heapSpace.getData()), d);
+            performRealOnlyForwardTransform (reinterpret_cast<ComplexType*> (heapSpace.getData()), d, dontCalculateNegativeFrequencies);
         }
     }
 
-    void performRealOnlyInverseTransform (float* d) const noexcept override
+    void performRealOnlyInverseTransform (FloatType* d) const noexcept
     {
         if (size == 1)
             return;
 
-        const size_t scratchSize = 16 + sizeof (Complex<float>) * (size_t) size;
+        const size_t scratchSize = 16 + sizeof (ComplexType) * (size_t) (size / 2);
 
         if (scratchSize < maxFFTScratchSpaceToAlloca)
         {
-            performRealOnlyInverseTransform (static_cast<Complex<float>*> (alloca (scratchSize)), d);
+            performRealOnlyInverseTransform (static_cast<ComplexType*> (alloca (scratchSize)), d);
         }
         else
         {
             HeapBlock<char> heapSpace (scratchSize);
-            performRealOnlyInverseTransform (reinterpret_cast<Complex<float>*> (heapSpace.getData()), d);
+            performRealOnlyInverseTransform (reinterpret_cast<ComplexType*> (heapSpace.getData()), d);
+        }
+    }
+
+    /*  The N real samples are transformed as N/2 complex numbers, the even samples being
+        the real parts and the odd samples the imaginary parts. The spectra of the even and
+        odd samples are then separated using the symmetry of the spectrum of a real signal,
+        and combined into the N-point spectrum using the full-size twiddle factors.
+    */
+    void performRealOnlyForwardTransform (ComplexType* scratch, FloatType* d, bool dontCalculateNegativeFrequencies) const noexcept
+    {
+        auto halfSize = size / 2;
+        auto* data = reinterpret_cast<ComplexType*> (d);
+        auto* twiddles = configForward->twiddleTable;
+        const FloatType half (0.5);
+
+        performHalfSize (data, scratch, false);
+
+        data[0]        = { scratch[0].real() + scratch[0].imag(), 0 };
+        data[halfSize] = { scratch[0].real() - scratch[0].imag(), 0 };
+
+        for (int i = 1; i < halfSize; ++i)
+        {
+            auto a = scratch[i];
+            auto b = std::conj (scratch[halfSize - i]);
+
+            auto even = (a + b) * half;
+            auto odd  = (a - b) * half;
+
+            data[i] = even + twiddles[i] * ComplexType (odd.imag(), -odd.real());
+        }
+
+        if (! dontCalculateNegativeFrequencies)
+            for (auto i = halfSize + 1; i < size; ++i)
+                data[i] = std::conj (data[size - i]);
+    }
+
+    void performRealOnlyInverseTransform (ComplexType* scratch, FloatType* d) const noexcept
+    {
+        auto halfSize = size / 2;
+        auto* data = reinterpret_cast<ComplexType*> (d);
+        auto* twiddles = configInverse->twiddleTable;
+        const FloatType half (0.5);
+
+        scratch[0] = { (data[0].real() + data[halfSize].real()) * half,
+                       (data[0].real() - data[halfSize].real()) * half };
+
+        for (int i = 1; i < halfSize; ++i)
+        {
+            auto a = data[i];
+            auto b = std::conj (data[halfSize - i]);
+
+            auto even = (a + b) * half;
+            auto odd  = (a - b) * twiddles[i] * half;
+
+            scratch[i] = even + ComplexType (-odd.imag(), odd.real());
+        }
+
+        performHalfSize (scratch, data, true);
+    }
+
+    void performHalfSize (const ComplexType* input, ComplexType* output, bool inverse) const noexcept
+    {
+        auto halfSize = size / 2;
+
+        if (halfSize == 1)
+        {
+            *output = *input;
+            return;
+        }
+
+        const SpinLock::ScopedLockType sl(processLock);
+
+        if (inverse)
+        {
+            halfSizeConfigInverse->perform (input, output);
+            FloatVectorOperations::multiply (reinterpret_cast<FloatType*> (output), static_cast<FloatType> (1) / static_cast<FloatType> (halfSize), halfSize * 2);
+        }
+        else
+        {
+            halfSizeConfigForward->perform (input, output);
+        }
+    }
+
+    //==============================================================================
+    void performBatch (const ComplexType* const* inputs, ComplexType* const* outputs, int numChannels, bool inverse) const noexcept
+    {
+        int channel = 0;
+
+       #if JUCE_USE_SIMD
+        if (size > 1)
+            for (; channel + numLanes <= numChannels; channel += numLanes)
+                withInterleavedScratch (size, [&] (SIMDComplexType* in, SIMDComplexType* out)
+                {
+                    interleave (in, inputs + channel, size);
+
+                    const SpinLock::ScopedLockType sl (processLock);
+
+                    if (inverse)
+                    {
+                        configInverse->perform (in, out);
+
+                        for (int i = 0; i < size; ++i)
+                            out[i] = out[i] * (static_cast<FloatType> (1) / static_cast<FloatType> (size));
+                    }
+                    else
+                    {
+                        configForward->perform (in, out);
+                    }
+
+                    deinterleave (outputs + channel, out, size);
+                });
+       #endif
+
+        for (; channel < numChannels; ++channel)
+            perform (inputs[channel], outputs[channel], inverse);
+    }
+
+    void performRealOnlyForwardTransformBatch (FloatType* const* channels, int numChannels, bool dontCalculateNegativeFrequencies) const noexcept
+    {
+        int channel = 0;
+
+       #if JUCE_USE_SIMD
+        if (size > 2)
+        {
+            auto halfSize = size / 2;
+            auto* twiddles = configForward->twiddleTable;
+            const FloatType half (0.5);
+
+            for (; channel + numLanes <= numChannels; channel += numLanes)
+                withInterleavedScratch (halfSize, [&] (SIMDComplexType* in, SIMDComplexType* out)
+                {
+                    auto* data = reinterpret_cast<ComplexType* const*> (channels + channel);
+
+                    interleave (in, data, halfSize);
+
+                    {
+                        const SpinLock::ScopedLockType sl (processLock);
+                        halfSizeConfigForward->perform (in, out);
+                    }
+
+                    // see performRealOnlyForwardTransform() for the details of this step
+                    in[0] = { out[0].re + out[0].im, SIMDRegister<FloatType>::expand (0) };
+                    in[halfSize] = { out[0].re - out[0].im, SIMDRegister<FloatType>::expand (0) };
+
+                    for (int i = 1; i < halfSize; ++i)
+                    {
+                        auto a = out[i];
+                        auto b = out[halfSize - i].conj();
+
+                        auto even = (a + b) * half;
+                        auto odd  = (a - b) * half;
+
+                        in[i] = even + SIMDComplexType (odd.im, SIMDRegister<FloatType>::expand (0) - odd.re) * twiddles[i];
+                    }
+
+                    deinterleave (data, in, halfSize + 1);
+
+                    if (! dontCalculateNegativeFrequencies)
+                        for (int lane = 0; lane < numLanes; ++lane)
+                            for (auto i = halfSize + 1; i < size; ++i)
+                                data[lane][i] = std::conj (data[lane][size - i]);
+                }, 1);
+        }
+       #endif
+
+        for (; channel < numChannels; ++channel)
+            performRealOnlyForwardTransform (channels[channel], dontCalculateNegativeFrequencies);
+    }
+
+    void performRealOnlyInverseTransformBatch (FloatType* const* channels, int numChannels) const noexcept
+    {
+        int channel = 0;
+
+       #if JUCE_USE_SIMD
+        if (size > 2)
+        {
+            auto halfSize = size / 2;
+            auto* twiddles = configInverse->twiddleTable;
+            const FloatType half (0.5);
+
+            for (; channel + numLanes <= numChannels; channel += numLanes)
+                withInterleavedScratch (halfSize, [&] (SIMDComplexType* in, SIMDComplexType* out)
+                {
+                    auto* data = reinterpret_cast<ComplexType* const*> (channels + channel);
+
+                    interleave (out, data, halfSize + 1);
+
+                    // see performRealOnlyInverseTransform() for the details of this step
+                    in[0] = { (out[0].re + out[halfSize].re) * half,
+                              (out[0].re - out[halfSize].re) * half };
+
+                    for (int i = 1; i < halfSize; ++i)
+                    {
+                        auto a = out[i];
+                        auto b = out[halfSize - i].conj();
+
+                        auto even = (a + b) * half;
+                        auto odd  = (a - b) * twiddles[i] * half;
+
+                        in[i] = even + SIMDComplexType (SIMDRegister<FloatType>::expand (0) - odd.im, odd.re);
+                    }
+
+                    {
+                        const SpinLock::ScopedLockType sl (processLock);
+                        halfSizeConfigInverse->perform (in, out);
+                    }
+
+                    auto scale = static_cast<FloatType> (1) / static_cast<FloatType> (halfSize);
+
+                    for (int i = 0; i < halfSize; ++i)
+                        out[i] = out[i] * scale;
+
+                    deinterleave (data, out, halfSize);
+                }, 1);
         }
+       #endif
+
+        for (; channel < numChannels; ++channel)
+            performRealOnlyInverseTransform (channels[channel]);
     }
 
-    void performRealOnlyForwardTransform (Complex<float>* scratch, float* d) const noexcept
+   #if JUCE_USE_SIMD
+    using SIMDComplexType = SIMDComplex<FloatType>;
+    static constexpr int numLanes = (int) SIMDRegister<FloatType>::SIMDNumElements;
+
+    /*  Calls the given function with two aligned scratch arrays of the given number of
+        SIMD complex numbers (plus some extra ones), allocated on the stack if possible.
+    */
+    template <typename Fn>
+    void withInterleavedScratch (int numElements, Fn&& fn, int numExtraElements = 0) const noexcept
     {
-        for (int i = 0; i < size; ++i)
-            scratch[i] = { d[i], 0 };
+        auto numPerArray = (size_t) (numElements + numExtraElements);
+        const size_t scratchSize = sizeof (SIMDComplexType) * 2 * numPerArray + sizeof (SIMDRegister<FloatType>);
+
+        auto call = [&] (void* scratch)
+        {
+            auto* aligned = reinterpret_cast<SIMDComplexType*> (SIMDRegister<FloatType>::getNextSIMDAlignedPtr (static_cast<FloatType*> (scratch)));
+            fn (aligned, aligned + numPerArray);
+        };
 
-        perform (scratch, reinterpret_cast<Complex<float>*> (d), false);
+        if (scratchSize < maxFFTScratchSpaceToAlloca)
+        {
+            call (alloca (scratchSize));
+        }
+        else
+        {
+            HeapBlock<char> heapSpace (scratchSize);
+            call (heapSpace.getData());
+        }
     }
 
-    void performRealOnlyInverseTransform (Complex<float>* scratch, float* d) const noexcept
+    // Each SIMD complex number is stored as the real parts of all the lanes, followed by the imaginary ones
+    static void interleave (SIMDComplexType* dest, const ComplexType* const* sources, int num) noexcept
     {
-        auto* input = reinterpret_cast<Complex<float>*> (d);
+        auto* d = reinterpret_cast<FloatType*> (dest);
 
-        for (auto i = size >> 1; i < size; ++i)
-            input[i] = std::conj (input[size - i]);
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto* src = sources[lane];
+
+            for (int i = 0; i < num; ++i)
+            {
+                d[i * 2 * numLanes + lane]            = src[i].real();
+                d[i * 2 * numLanes + numLanes + lane] = src[i].imag();
+            }
+        }
+    }
 
-        perform (input, scratch, true);
+    static void deinterleave (ComplexType* const* dests, const SIMDComplexType* source, int num) noexcept
+    {
+        auto* s = reinterpret_cast<const FloatType*> (source);
 
-        for (int i = 0; i < size; ++i)
+        for (int lane = 0; lane < numLanes; ++lane)
         {
-            d[i] = scratch[i].real();
-            d[i + size] = scratch[i].imag();
+            auto* dest = dests[lane];
+
+            for (int i = 0; i < num; ++i)
+                dest[i] = { s[i * 2 * numLanes + lane], s[i * 2 * numLanes + numLanes + lane] };
         }
     }
+   #endif
 
     //==============================================================================
     struct FFTConfig
     {
         FFTConfig (int sizeOfFFT, bool isInverse)
-            : fftSize (sizeOfFFT), inverse (isInverse), twiddleTable ((size_t) sizeOfFFT)
+            : fftSize (sizeOfFFT), inverse (isInverse), twiddleStorage ((size_t) sizeOfFFT)
         {
             auto inverseFactor = (inverse ? 2.0 : -2.0) * MathConstants<double>::pi / (double) fftSize;
 
@@ -201,8 +503,8 @@ struct FFTFallback  : public FFT::Instance
                 {
                     auto phase = i * inverseFactor;
 
-                    twiddleTable[i] = { (float) std::cos (phase),
-                                        (float) std::sin (phase) };
+                    twiddleStorage[i] = { (FloatType) std::cos (phase),
+                                          (FloatType) std::sin (phase) };
                 }
             }
             else
@@ -211,28 +513,44 @@ struct FFTFallback  : public FFT::Instance
                 {
                     auto phase = i * inverseFactor;
 
-                    twiddleTable[i] = { (float) std::cos (phase),
-                                        (float) std::sin (phase) };
+                    twiddleStorage[i] = { (FloatType) std::cos (phase),
+                                          (FloatType) std::sin (phase) };
                 }
 
                 for (int i = fftSize / 4; i < fftSize / 2; ++i)
                 {
-                    auto other = twiddleTable[i - fftSize / 4];
+                    auto other = twiddleStorage[i - fftSize / 4];
 
-                    twiddleTable[i] = { inverse ? -other.imag() :  other.imag(),
-                                        inverse ?  other.real() : -other.real() };
+                    twiddleStorage[i] = { inverse ? -other.imag() :  other.imag(),
+                                          inverse ?  other.real() : -other.real() };
                 }
 
-                twiddleTable[fftSize / 2].real (-1.0f);
-                twiddleTable[fftSize / 2].imag (0.0f);
+                twiddleStorage[fftSize / 2].real (-1.0f);
+                twiddleStorage[fftSize / 2].imag (0.0f);
 
                 for (int i = fftSize / 2; i < fftSize; ++i)
                 {
                     auto index = fftSize / 2 - (i - fftSize / 2);
-                    twiddleTable[i] = conj(twiddleTable[index]);
+                    twiddleStorage[i] = conj(twiddleStorage[index]);
                 }
             }
 
+            twiddleTable = twiddleStorage.getData();
+            initialiseFactors();
+        }
+
+        /** Creates a config which uses the twiddle table of a bigger one. */
+        FFTConfig (int sizeOfFFT, const FFTConfig& configToShareTwiddlesWith)
+            : fftSize (sizeOfFFT), inverse (configToShareTwiddlesWith.inverse),
+              twiddleTable (configToShareTwiddlesWith.twiddleTable),
+              twiddleStep (configToShareTwiddlesWith.twiddleStep * (configToShareTwiddlesWith.fftSize / sizeOfFFT))
+        {
+            jassert (sizeOfFFT > 0 && configToShareTwiddlesWith.fftSize % sizeOfFFT == 0);
+            initialiseFactors();
+        }
+
+        void initialiseFactors()
+        {
             auto root = (int) std::sqrt ((double) fftSize);
             int divisor = 4, n = fftSize;
 
@@ -256,7 +574,8 @@ struct FFTFallback  : public FFT::Instance
             }
         }
 
-        void perform (const Complex<float>* input, Complex<float>* output) const noexcept
+        template <typename DataType>
+        void perform (const DataType* input, DataType* output) const noexcept
         {
             perform (input, output, 1, 1, factors);
         }
@@ -266,9 +585,12 @@ struct FFTFallback  : public FFT::Instance
 
         struct Factor { int radix, length; };
         Factor factors[32];
-        HeapBlock<Complex<float>> twiddleTable;
+        HeapBlock<ComplexType> twiddleStorage;
+        const ComplexType* twiddleTable = nullptr;
+        const int twiddleStep = 1;
 
-        void perform (const Complex<float>* input, Complex<float>* output, int stride, int strideIn, const Factor* facs) const noexcept
+        template <typename DataType>
+        void perform (const DataType* input, DataType* output, int stride, int strideIn, const Factor* facs) const noexcept
         {
             auto factor = *facs++;
             auto* originalOutput = output;
@@ -306,17 +628,18 @@ struct FFTFallback  : public FFT::Instance
             butterfly (factor, originalOutput, stride);
         }
 
-        void butterfly (const Factor factor, Complex<float>* data, int stride) const noexcept
+        template <typename DataType>
+        void butterfly (const Factor factor, DataType* data, int stride) const noexcept
         {
             switch (factor.radix)
             {
                 case 1:   break;
-                case 2:   butterfly2 (data, stride, factor.length); return;
-                case 4:   butterfly4 (data, stride, factor.length); return;
+                case 2:   butterfly2 (data, stride * twiddleStep, factor.length); return;
+                case 4:   butterfly4 (data, stride * twiddleStep, factor.length); return;
                 default:  jassertfalse; break;
             }
 
-            auto* scratch = static_cast<Complex<float>*> (alloca (sizeof (Complex<float>) * (size_t) factor.radix));
+            auto* scratch = static_cast<DataType*> (alloca (sizeof (DataType) * (size_t) factor.radix));
 
             for (int i = 0; i < factor.length; ++i)
             {
@@ -338,7 +661,7 @@ struct FFTFallback  : public FFT::Instance
                         if (twiddleIndex >= fftSize)
                             twiddleIndex -= fftSize;
 
-                        data[k] += scratch[q] * twiddleTable[twiddleIndex];
+                        data[k] += scratch[q] * twiddleTable[twiddleIndex * twiddleStep];
                     }
 
                     k += factor.length;
@@ -346,10 +669,11 @@ struct FFTFallback  : public FFT::Instance
             }
         }
 
-        void butterfly2 (Complex<float>* data, const int stride, const int length) const noexcept
+        template <typename DataType>
+        void butterfly2 (DataType* data, const int stride, const int length) const noexcept
         {
             auto* dataEnd = data + length;
-            auto* tw = twiddleTable.getData();
+            auto* tw = twiddleTable;
 
             for (int i = length; --i >= 0;)
             {
@@ -361,7 +685,8 @@ struct FFTFallback  : public FFT::Instance
             }
         }
 
-        void butterfly4 (Complex<float>* data, const int stride, const int length) const noexcept
+        template <typename DataType>
+        void butterfly4 (DataType* data, const int stride, const int length) const noexcept
         {
             auto lengthX2 = length * 2;
             auto lengthX3 = length * 3;
@@ -369,7 +694,7 @@ struct FFTFallback  : public FFT::Instance
             auto strideX2 = stride * 2;
             auto strideX3 = stride * 3;
 
-            auto* twiddle1 = twiddleTable.getData();
+            auto* twiddle1 = twiddleTable;
             auto* twiddle2 = twiddle1;
             auto* twiddle3 = twiddle1;
 
@@ -416,12 +741,69 @@ struct FFTFallback  : public FFT::Instance
 
     //==============================================================================
     SpinLock processLock;
-    std::unique_ptr<FFTConfig> configForward, configInverse;
+    std::unique_ptr<FFTConfig> configForward, configInverse, halfSizeConfigForward, halfSizeConfigInverse;
     int size;
 };
 
+//==============================================================================
+struct FFTFallback  : public FFT::Instance
+{
+    // this should have the least priority of all engines
+    static constexpr int priority = -1;
+
+    static FFTFallback* create (int order)
+    {
+        return new FFTFallback (order);
+    }
+
+    FFTFallback (int order)  : fallback (order)
+    {
+    }
+
+    void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept override
+    {
+        fallback.perform (input, output, inverse);
+    }
+
+    void performRealOnlyForwardTransform (float* d, bool dontCalculateNegativeFrequencies) const noexcept override
+    {
+        fallback.performRealOnlyForwardTransform (d, dontCalculateNegativeFrequencies);
+    }
+
+    void performRealOnlyInverseTransform (float* d) const noexcept override
+    {
+        fallback.performRealOnlyInverseTransform (d);
+    }
+
+    void performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs, int numChannels, bool inverse) const noexcept override
+    {
+        fallback.performBatch (inputs, outputs, numChannels, inverse);
+    }
+
+    void performRealOnlyForwardTransformBatch (float* const* channels, int numChannels, bool dontCalculateNegativeFrequencies) const noexcept override
+    {
+        fallback.performRealOnlyForwardTransformBatch (channels, numChannels, dontCalculateNegativeFrequencies);
+    }
+
+    void performRealOnlyInverseTransformBatch (float* const* channels, int numChannels) const noexcept override
+    {
+        fallback.performRealOnlyInverseTransformBatch (channels, numChannels);
+    }
+
+    FFTFallbackImpl<float> fallback;
+};
+
 FFT::EngineImpl<FFTFallback> fftFallback;
 
+//==============================================================================
+/*  None of the platform-specific engines are used for double precision, so these
+    transforms always use the fallback implementation.
+*/
+struct FFT::DoublePrecisionInstance  : public FFTFallbackImpl<double>
+{
+    DoublePrecisionInstance (int order)  : FFTFallbackImpl<double> (order) {}
+};
+
 //==============================================================================
 //==============================================================================
 #if (JUCE_MAC || JUCE_IOS) && JUCE_USE_VDSP_FRAMEWORK
@@ -806,8 +1188,9 @@ FFT::EngineImpl<IntelFFT> fftwEngine;
 
 //==============================================================================
 //==============================================================================
-FFT::FFT (int order)
+FFT::FFT (int order, bool supportDoublePrecision)
     : engine (FFT::Engine::createBestEngineForPlatform (order)),
+      doublePrecisionEngine (supportDoublePrecision ? new DoublePrecisionInstance (order) : nullptr),
       size (1 << order)
 {
 }
@@ -833,17 +1216,75 @@ void FFT::performRealOnlyInverseTransform (float* inputOutputData) const noexcep
 }
 
 void FFT::performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept
+{
+    performFrequencyOnlyForwardTransformInternal (inputOutputData);
+}
+
+//==============================================================================
+void FFT::perform (const Complex<float>* const* inputs, Complex<float>* const* outputs, int numChannels, bool inverse) const noexcept
+{
+    if (engine != nullptr)
+        engine->performBatch (inputs, outputs, numChannels, inverse);
+}
+
+void FFT::performRealOnlyForwardTransform (float* const* inputOutputChannels, int numChannels, bool ignoreNegativeFreqs) const noexcept
+{
+    if (engine != nullptr)
+        engine->performRealOnlyForwardTransformBatch (inputOutputChannels, numChannels, ignoreNegativeFreqs);
+}
+
+void FFT::performRealOnlyInverseTransform (float* const* inputOutputChannels, int numChannels) const noexcept
+{
+    if (engine != nullptr)
+        engine->performRealOnlyInverseTransformBatch (inputOutputChannels, numChannels);
+}
+
+//==============================================================================
+const FFT::DoublePrecisionInstance* FFT::getDoublePrecisionEngine() const noexcept
+{
+    // To use the double precision functions, you need to ask for them when creating the FFT!
+    jassert (doublePrecisionEngine != nullptr);
+
+    return doublePrecisionEngine.get();
+}
+
+void FFT::perform (const Complex<double>* input, Complex<double>* output, bool inverse) const noexcept
+{
+    if (auto* e = getDoublePrecisionEngine())
+        e->perform (input, output, inverse);
+}
+
+void FFT::performRealOnlyForwardTransform (double* inputOutputData, bool ignoreNegativeFreqs) const noexcept
+{
+    if (auto* e = getDoublePrecisionEngine())
+        e->performRealOnlyForwardTransform (inputOutputData, ignoreNegativeFreqs);
+}
+
+void FFT::performRealOnlyInverseTransform (double* inputOutputData) const noexcept
+{
+    if (auto* e = getDoublePrecisionEngine())
+        e->performRealOnlyInverseTransform (inputOutputData);
+}
+
+void FFT::performFrequencyOnlyForwardTransform (double* inputOutputData) const noexcept
+{
+    performFrequencyOnlyForwardTransformInternal (inputOutputData);
+}
+
+//==============================================================================
+template <typename FloatType>
+void FFT::performFrequencyOnlyForwardTransformInternal (FloatType* inputOutputData) const noexcept
 {
     if (size == 1)
         return;
 
     performRealOnlyForwardTransform (inputOutputData);
-    auto* out = reinterpret_cast<Complex<float>*> (inputOutputData);
+    auto* out = reinterpret_cast<Complex<FloatType>*> (inputOutputData);
 
     for (auto i = 0; i < size; ++i)
         inputOutputData[i] = std::abs (out[i]);
 
-    zeromem (&inputOutputData[size], sizeof (float) * static_cast<size_t> (size));
+    zeromem (&inputOutputData[size], sizeof (FloatType) * static_cast<size_t> (size));
 }
 
 } // namespace dsp
@@ -32,9 +32,13 @@ namespace dsp
 /**
     Performs a fast fourier transform.
 
-    This is only a simple low-footprint implementation and isn't tuned for speed - it may
-    be useful for simple applications where one of the more complex FFT libraries would be
-    overkill. (But in the future it may end up becoming optimised of course...)
+    Depending on the platform and the build settings, this will use vDSP, FFTW or Intel
+    MKL if they are available, or else a simple low-footprint fallback implementation.
+
+    The transforms can be done in single or double precision. The double precision
+    versions always use the fallback implementation, and are only available if you
+    ask for them when constructing the FFT, so that their lookup tables can be
+    allocated up-front rather than on the audio thread.
 
     The FFT class itself contains lookup tables, so there's some overhead in creating
     one, you should create and cache an FFT object for each size/direction of transform
@@ -48,8 +52,11 @@ public:
     //==============================================================================
     /** Initialises an object for performing forward and inverse FFT with the given size.
         The number of points the FFT will operate on will be 2 ^ order.
+
+        If supportDoublePrecision is true, the tables needed by the double precision
+        functions are also created, otherwise calling those functions will do nothing.
     */
-    FFT (int order);
+    FFT (int order, bool supportDoublePrecision = false);
 
     /** Destructor. */
     ~FFT();
@@ -60,6 +67,13 @@ public:
     */
     void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept;
 
+    /** Performs an out-of-place FFT in double precision, either forward or inverse.
+        The arrays must contain at least getSize() elements.
+
+        The FFT must have been constructed with supportDoublePrecision set to true.
+    */
+    void perform (const Complex<double>* input, Complex<double>* output, bool inverse) const noexcept;
+
     /** Performs an in-place forward transform on a block of real data.
 
         As the coefficients of the negative frequences (frequencies higher than
@@ -67,9 +81,8 @@ public:
         it may not be necessary to calculate them for your particular application.
         You can use dontCalculateNegativeFrequencies to let the FFT
         engine know that you do not plan on using them. Note that this is only a
-        hint: some FFT engines (currently only the Fallback engine), will still
-        calculate the negative frequencies even if dontCalculateNegativeFrequencies
-        is true.
+        hint: some FFT engines may still calculate the negative frequencies even
+        if dontCalculateNegativeFrequencies is true.
 
         The size of the array passed in must be 2 * getSize(), and the first half
         should contain your raw input sample data. On return, if
@@ -82,6 +95,12 @@ public:
     void performRealOnlyForwardTransform (float* inputOutputData,
                                           bool dontCalculateNegativeFrequencies = false) const noexcept;
 
+    /** Performs an in-place forward transform on a block of real data, in double precision.
+        @see performRealOnlyForwardTransform
+    */
+    void performRealOnlyForwardTransform (double* inputOutputData,
+                                          bool dontCalculateNegativeFrequencies = false) const noexcept;
+
     /** Performs a reverse operation to data created in performRealOnlyForwardTransform().
 
         Although performRealOnlyInverseTransform will only use the first ((size / 2) + 1)
@@ -91,15 +110,59 @@ public:
     */
     void performRealOnlyInverseTransform (float* inputOutputData) const noexcept;
 
+    /** Performs a reverse operation to data created in performRealOnlyForwardTransform(),
+        in double precision.
+        @see performRealOnlyInverseTransform
+    */
+    void performRealOnlyInverseTransform (double* inputOutputData) const noexcept;
+
     /** Takes an array and simply transforms it to the magnitude frequency response
         spectrum. This may be handy for things like frequency displays or analysis.
         The size of the array passed in must be 2 * getSize().
     */
     void performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept;
 
+    /** Takes an array and simply transforms it to the magnitude frequency response
+        spectrum, in double precision.
+        The size of the array passed in must be 2 * getSize().
+    */
+    void performFrequencyOnlyForwardTransform (double* inputOutputData) const noexcept;
+
+    //==============================================================================
+    /** Performs out-of-place FFTs on several channels of data in one go.
+
+        This gives the same results as calling perform() on each channel, but
+        it may be faster, as some FFT engines can transform several channels at
+        the same time.
+
+        @param inputs       an array of numChannels pointers to the input arrays
+        @param outputs      an array of numChannels pointers to the output arrays
+        @param numChannels  the number of channels to transform
+        @param inverse      whether to perform the forward or the inverse FFT
+    */
+    void perform (const Complex<float>* const* inputs, Complex<float>* const* outputs,
+                  int numChannels, bool inverse) const noexcept;
+
+    /** Performs in-place forward transforms on several channels of real data in one go.
+
+        Each channel must have the size and layout described for the single channel
+        version of performRealOnlyForwardTransform(), which gives the same results.
+    */
+    void performRealOnlyForwardTransform (float* const* inputOutputChannels, int numChannels,
+                                          bool dontCalculateNegativeFrequencies = false) const noexcept;
+
+    /** Performs the reverse operation to the multi-channel version of
+        performRealOnlyForwardTransform().
+    */
+    void performRealOnlyInverseTransform (float* const* inputOutputChannels, int numChannels) const noexcept;
+
+    //==============================================================================
     /** Returns the number of data points that this FFT was created to work with. */
     int getSize() const noexcept            { return size; }
 
+    /** Returns true if this FFT was created with support for double precision transforms. */
+    bool supportsDoublePrecision() const noexcept       { return doublePrecisionEngine != nullptr; }
+
     //==============================================================================
    #ifndef DOXYGEN
     /* internal */
@@ -110,10 +173,17 @@ public:
 private:
     //==============================================================================
     struct Engine;
+    struct DoublePrecisionInstance;
 
     std::unique_ptr<Instance> engine;
+    std::unique_ptr<DoublePrecisionInstance> doublePrecisionEngine;
     int size;
 
+    const DoublePrecisionInstance* getDoublePrecisionEngine() const noexcept;
+
+    template <typename FloatType>
+    void performFrequencyOnlyForwardTransformInternal (FloatType*) const noexcept;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FFT)
 };
@@ -33,51 +33,56 @@ struct FFTUnitTest  : public UnitTest
 {
     FFTUnitTest()  : UnitTest ("FFT", "DSP") {}
 
-    static void fillRandom (Random& random, Complex<float>* buffer, size_t n)
+    template <typename FloatType>
+    static void fillRandom (Random& random, Complex<FloatType>* buffer, size_t n)
     {
         for (size_t i = 0; i < n; ++i)
-            buffer[i] = Complex<float> ((2.0f * random.nextFloat()) - 1.0f,
-                                             (2.0f * random.nextFloat()) - 1.0f);
+            buffer[i] = Complex<FloatType> ((FloatType) ((2.0f * random.nextFloat()) - 1.0f),
+                                            (FloatType) ((2.0f * random.nextFloat()) - 1.0f));
     }
 
-    static void fillRandom (Random& random, float* buffer, size_t n)
+    template <typename FloatType>
+    static void fillRandom (Random& random, FloatType* buffer, size_t n)
     {
         for (size_t i = 0; i < n; ++i)
-            buffer[i] = (2.0f * random.nextFloat()) - 1.0f;
+            buffer[i] = (FloatType) ((2.0f * random.nextFloat()) - 1.0f);
     }
 
-    static Complex<float> freqConvolution (const Complex<float>* in, float freq, size_t n)
+    template <typename FloatType>
+    static Complex<FloatType> freqConvolution (const Complex<FloatType>* in, FloatType freq, size_t n)
     {
-        Complex<float> sum (0.0, 0.0);
+        Complex<FloatType> sum (0.0, 0.0);
         for (size_t i = 0; i < n; ++i)
-            sum += in[i] * exp (Complex<float> (0, static_cast<float> (i) * freq));
+            sum += in[i] * exp (Complex<FloatType> (0, static_cast<FloatType> (i) * freq));
 
         return sum;
     }
 
-    static void performReferenceFourier (const Complex<float>* in, Complex<float>* out,
+    template <typename FloatType>
+    static void performReferenceFourier (const Complex<FloatType>* in, Complex<FloatType>* out,
                                          size_t n, bool reverse)
     {
-        auto base_freq = static_cast<float> (((reverse ? 1.0 : -1.0) * MathConstants<double>::twoPi)
-                                               / static_cast<float> (n));
+        auto base_freq = static_cast<FloatType> (((reverse ? 1.0 : -1.0) * MathConstants<double>::twoPi)
+                                                   / static_cast<FloatType> (n));
 
         for (size_t i = 0; i < n; ++i)
-            out[i] = freqConvolution (in, static_cast<float>(i) * base_freq, n);
+            out[i] = freqConvolution (in, static_cast<FloatType>(i) * base_freq, n);
     }
 
-    static void performReferenceFourier (const float* in, Complex<float>* out,
+    template <typename FloatType>
+    static void performReferenceFourier (const FloatType* in, Complex<FloatType>* out,
                                          size_t n, bool reverse)
     {
-        HeapBlock<Complex<float>> buffer (n);
+        HeapBlock<Complex<FloatType>> buffer (n);
 
         for (size_t i = 0; i < n; ++i)
-            buffer.getData()[i] = Complex<float> (in[i], 0.0f);
+            buffer.getData()[i] = Complex<FloatType> (in[i], 0.0f);
 
-        float base_freq = static_cast<float> (((reverse ? 1.0 : -1.0) * MathConstants<double>::twoPi)
-                                                / static_cast<float> (n));
+        auto base_freq = static_cast<FloatType> (((reverse ? 1.0 : -1.0) * MathConstants<double>::twoPi)
+                                                   / static_cast<FloatType> (n));
 
         for (size_t i = 0; i < n; ++i)
-            out[i] = freqConvolution (buffer.getData(), static_cast<float>(i) * base_freq, n);
+            out[i] = freqConvolution (buffer.getData(), static_cast<FloatType>(i) * base_freq, n);
     }
 
 
@@ -92,6 +97,7 @@ struct FFTUnitTest  : public UnitTest
         return true;
     }
 
+    template <typename FloatType>
     struct RealTest
     {
         static void run (FFTUnitTest& u)
@@ -102,36 +108,37 @@ struct FFTUnitTest  : public UnitTest
             {
                 auto n = (1u << order);
 
-                FFT fft ((int) order);
+                FFT fft ((int) order, true);
 
-                HeapBlock<float> input (n);
-                HeapBlock<Complex<float>> reference (n), output (n);
+                HeapBlock<FloatType> input (n);
+                HeapBlock<Complex<FloatType>> reference (n), output (n);
 
                 fillRandom (random, input.getData(), n);
                 performReferenceFourier (input.getData(), reference.getData(), n, false);
 
                 // fill only first half with real numbers
-                zeromem (output.getData(), n * sizeof (Complex<float>));
-                memcpy (reinterpret_cast<float*> (output.getData()), input.getData(), n * sizeof (float));
+                zeromem (output.getData(), n * sizeof (Complex<FloatType>));
+                memcpy (reinterpret_cast<FloatType*> (output.getData()), input.getData(), n * sizeof (FloatType));
 
-                fft.performRealOnlyForwardTransform ((float*) output.getData());
+                fft.performRealOnlyForwardTransform ((FloatType*) output.getData());
                 u.expect (checkArrayIsSimilar (reference.getData(), output.getData(), n));
 
                 // fill only first half with real numbers
-                zeromem (output.getData(), n * sizeof (Complex<float>));
-                memcpy (reinterpret_cast<float*> (output.getData()), input.getData(), n * sizeof (float));
+                zeromem (output.getData(), n * sizeof (Complex<FloatType>));
+                memcpy (reinterpret_cast<FloatType*> (output.getData()), input.getData(), n * sizeof (FloatType));
 
-                fft.performRealOnlyForwardTransform ((float*) output.getData(), true);
-                std::fill (reference.getData() + ((n >> 1) + 1), reference.getData() + n, std::complex<float> (0.0f));
+                fft.performRealOnlyForwardTransform ((FloatType*) output.getData(), true);
+                std::fill (reference.getData() + ((n >> 1) + 1), reference.getData() + n, std::complex<FloatType> (0.0f));
                 u.expect (checkArrayIsSimilar (reference.getData(), output.getData(), (n >> 1) + 1));
 
-                memcpy (output.getData(), reference.getData(), n * sizeof (Complex<float>));
-                fft.performRealOnlyInverseTransform ((float*) output.getData());
-                u.expect (checkArrayIsSimilar ((float*) output.getData(), input.getData(), n));
+                memcpy (output.getData(), reference.getData(), n * sizeof (Complex<FloatType>));
+                fft.performRealOnlyInverseTransform ((FloatType*) output.getData());
+                u.expect (checkArrayIsSimilar ((FloatType*) output.getData(), input.getData(), n));
             }
         }
     };
 
+    template <typename FloatType>
     struct FrequencyOnlyTest
     {
         static void run(FFTUnitTest& u)
@@ -141,13 +148,13 @@ struct FFTUnitTest  : public UnitTest
             {
                 auto n = (1u << order);
 
-                FFT fft ((int) order);
+                FFT fft ((int) order, true);
 
-                HeapBlock<float> inout (n << 1), reference (n << 1);
-                HeapBlock<Complex<float>> frequency (n);
+                HeapBlock<FloatType> inout (n << 1), reference (n << 1);
+                HeapBlock<Complex<FloatType>> frequency (n);
 
                 fillRandom (random, inout.getData(), n);
-                zeromem (reference.getData(), sizeof (float) * (n << 1));
+                zeromem (reference.getData(), sizeof (FloatType) * (n << 1));
                 performReferenceFourier (inout.getData(), frequency.getData(), n, false);
 
                 for (size_t i = 0; i < n; ++i)
@@ -160,6 +167,7 @@ struct FFTUnitTest  : public UnitTest
         }
     };
 
+    template <typename FloatType>
     struct ComplexTest
     {
         static void run(FFTUnitTest& u)
@@ -170,19 +178,19 @@ struct FFTUnitTest  : public UnitTest
             {
                 auto n = (1u << order);
 
-                FFT fft ((int) order);
+                FFT fft ((int) order, true);
 
-                HeapBlock<Complex<float>> input (n), buffer (n), output (n), reference (n);
+                HeapBlock<Complex<FloatType>> input (n), buffer (n), output (n), reference (n);
 
                 fillRandom (random, input.getData(), n);
                 performReferenceFourier (input.getData(), reference.getData(), n, false);
 
-                memcpy (buffer.getData(), input.getData(), sizeof (Complex<float>) * n);
+                memcpy (buffer.getData(), input.getData(), sizeof (Complex<FloatType>) * n);
                 fft.perform (buffer.getData(), output.getData(), false);
 
                 u.expect (checkArrayIsSimilar (output.getData(), reference.getData(), n));
 
-                memcpy (buffer.getData(), reference.getData(), sizeof (Complex<float>) * n);
+                memcpy (buffer.getData(), reference.getData(), sizeof (Complex<FloatType>) * n);
                 fft.perform (buffer.getData(), output.getData(), true);
 
 
@@ -191,12 +199,117 @@ struct FFTUnitTest  : public UnitTest
         }
     };
 
-    template <class TheTest>
+    struct PrecisionTest
+    {
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+
+            for (size_t order = 1; order <= 12; ++order)
+            {
+                auto n = (1u << order);
+
+                FFT fft ((int) order, true);
+
+                HeapBlock<double> input (n), output (n << 1);
+                fillRandom (random, input.getData(), n);
+
+                memcpy (output.getData(), input.getData(), n * sizeof (double));
+                fft.performRealOnlyForwardTransform (output.getData());
+                fft.performRealOnlyInverseTransform (output.getData());
+
+                auto maxError = 0.0;
+
+                for (size_t i = 0; i < n; ++i)
+                    maxError = jmax (maxError, std::abs (output[i] - input[i]));
+
+                u.expectLessThan (maxError, 1.0e-12);
+            }
+        }
+    };
+
+    struct BatchTest
+    {
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+
+            for (size_t order = 0; order <= 8; ++order)
+            {
+                auto n = (1u << order);
+
+                FFT fft ((int) order);
+
+                for (auto numChannels : { 1, 3, 8, 11 })
+                {
+                    HeapBlock<Complex<float>> input (n * (size_t) numChannels), output (n * (size_t) numChannels), reference (n);
+                    HeapBlock<Complex<float>*> inputs ((size_t) numChannels), outputs ((size_t) numChannels);
+                    HeapBlock<float*> realChannels ((size_t) numChannels);
+
+                    for (int ch = 0; ch < numChannels; ++ch)
+                    {
+                        inputs[ch]  = input.getData() + (size_t) ch * n;
+                        outputs[ch] = output.getData() + (size_t) ch * n;
+                        realChannels[ch] = reinterpret_cast<float*> (outputs[ch]);
+                    }
+
+                    // complex transforms
+                    fillRandom (random, input.getData(), n * (size_t) numChannels);
+
+                    for (auto inverse : { false, true })
+                    {
+                        fft.perform (inputs.getData(), outputs.getData(), numChannels, inverse);
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                        {
+                            fft.perform (inputs[ch], reference.getData(), inverse);
+                            u.expect (checkArrayIsSimilar (outputs[ch], reference.getData(), n));
+                        }
+                    }
+
+                    // real-only transforms, done in-place on the output arrays
+                    for (auto ignoreNegativeFreqs : { false, true })
+                    {
+                        for (int ch = 0; ch < numChannels; ++ch)
+                        {
+                            auto* originalSamples = reinterpret_cast<float*> (inputs[ch]);
+                            fillRandom (random, originalSamples, n);
+
+                            zeromem (outputs[ch], n * sizeof (Complex<float>));
+                            memcpy (realChannels[ch], originalSamples, n * sizeof (float));
+                        }
+
+                        fft.performRealOnlyForwardTransform (realChannels.getData(), numChannels, ignoreNegativeFreqs);
+
+                        auto numToCheck = ignoreNegativeFreqs ? (n >> 1) + 1 : n;
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                        {
+                            zeromem (reference.getData(), n * sizeof (Complex<float>));
+                            memcpy (reference.getData(), inputs[ch], n * sizeof (float));
+                            fft.performRealOnlyForwardTransform (reinterpret_cast<float*> (reference.getData()), ignoreNegativeFreqs);
+
+                            u.expect (checkArrayIsSimilar (outputs[ch], reference.getData(), numToCheck));
+                        }
+
+                        fft.performRealOnlyInverseTransform (realChannels.getData(), numChannels);
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                            u.expect (checkArrayIsSimilar (realChannels[ch], reinterpret_cast<float*> (inputs[ch]), n));
+                    }
+                }
+            }
+        }
+    };
+
+    template <template <typename> class TheTest>
     void runTestForAllTypes (const char* unitTestName)
     {
-        beginTest (unitTestName);
+        beginTest (String (unitTestName) + " (float)");
+        TheTest<float>::run (*this);
 
-        TheTest::run (*this);
+        beginTest (String (unitTestName) + " (double)");
+        TheTest<double>::run (*this);
     }
 
     void runTest() override
@@ -204,10 +317,81 @@ struct FFTUnitTest  : public UnitTest
         runTestForAllTypes<RealTest> ("Real input numbers Test");
         runTestForAllTypes<FrequencyOnlyTest> ("Frequency only Test");
         runTestForAllTypes<ComplexTest> ("Complex input numbers Test");
+
+        beginTest ("Double precision round trip Test");
+        PrecisionTest::run (*this);
+
+        beginTest ("Multi-channel Test");
+        BatchTest::run (*this);
     }
 };
 
 static FFTUnitTest fftUnitTest;
 
+//==============================================================================
+struct FFTBenchmark  : public UnitTestBenchmark
+{
+    FFTBenchmark()  : UnitTestBenchmark ("FFT") {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        for (auto order : { 8, 10, 12 })
+        {
+            FFT fft (order);
+            auto n = (size_t) fft.getSize();
+
+            for (auto numChannels : { 8, 64 })
+            {
+                beginTest ("Size " + String ((int) n) + ", " + String (numChannels) + " channels");
+
+                HeapBlock<Complex<float>> input (n * (size_t) numChannels), output (n * (size_t) numChannels);
+                HeapBlock<Complex<float>*> inputs ((size_t) numChannels), outputs ((size_t) numChannels);
+                HeapBlock<float*> realChannels ((size_t) numChannels);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    inputs[ch]  = input.getData() + (size_t) ch * n;
+                    outputs[ch] = output.getData() + (size_t) ch * n;
+                    realChannels[ch] = reinterpret_cast<float*> (outputs[ch]);
+                }
+
+                FFTUnitTest::fillRandom (random, input.getData(), n * (size_t) numChannels);
+
+                timeCalls ("perform, per channel", [&]
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        fft.perform (inputs[ch], outputs[ch], false);
+                });
+
+                timeCalls ("perform, batched", [&]
+                {
+                    fft.perform (inputs.getData(), outputs.getData(), numChannels, false);
+                });
+
+                timeCalls ("performRealOnlyForwardTransform, per channel", [&]
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                    {
+                        memcpy (realChannels[ch], inputs[ch], n * sizeof (float));
+                        fft.performRealOnlyForwardTransform (realChannels[ch], true);
+                    }
+                });
+
+                timeCalls ("performRealOnlyForwardTransform, batched", [&]
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        memcpy (realChannels[ch], inputs[ch], n * sizeof (float));
+
+                    fft.performRealOnlyForwardTransform (realChannels.getData(), numChannels, true);
+                });
+            }
+        }
+    }
+};
+
+static FFTBenchmark fftBenchmark;
+
 } // namespace dsp
 } // namespace juce
@@ -59,6 +59,7 @@
 #include "processors/juce_IIRFilter.cpp"
 #include "processors/juce_LadderFilter.cpp"
 #include "processors/juce_Oversampling.cpp"
+#include "processors/juce_Resampler.cpp"
 #include "maths/juce_SpecialFunctions.cpp"
 #include "maths/juce_Matrix.cpp"
 #include "maths/juce_LookupTable.cpp"
@@ -69,7 +70,9 @@
 
 #if JUCE_USE_SIMD
 #if defined(__i386__) || defined(__amd64__) || defined(_M_X64) || defined(_X86_) || defined(_M_IX86)
- #ifdef __AVX2__
+ #if defined (__AVX512F__) && defined (__AVX512BW__) && defined (__AVX512DQ__)
+  #include "native/juce_avx512_SIMDNativeOps.cpp"
+ #elif defined (__AVX2__)
   #include "native/juce_avx_SIMDNativeOps.cpp"
  #else
   #include "native/juce_sse_SIMDNativeOps.cpp"
@@ -87,6 +90,12 @@
 #include "containers/juce_SIMDRegister_test.cpp"
 #endif
 #include "frequency/juce_FFT_test.cpp"
+#include "frequency/juce_Convolution_test.cpp"
 #include "processors/juce_FIRFilter_test.cpp"
+#include "processors/juce_Oversampling_test.cpp"
+#include "processors/juce_Resampler_test.cpp"
+#if JUCE_USE_SIMD
+#include "processors/juce_SIMDProcessorDuplicator_test.cpp"
+#endif
 #endif
 #endif
@@ -231,7 +231,9 @@ namespace juce
 
  // include the correct native file for this build target CPU
  #if defined(__i386__) || defined(__amd64__) || defined(_M_X64) || defined(_X86_) || defined(_M_IX86)
-  #ifdef __AVX2__
+  #if defined (__AVX512F__) && defined (__AVX512BW__) && defined (__AVX512DQ__)
+   #include "native/juce_avx512_SIMDNativeOps.h"
+  #elif defined (__AVX2__)
    #include "native/juce_avx_SIMDNativeOps.h"
   #else
    #include "native/juce_sse_SIMDNativeOps.h"
@@ -256,6 +258,9 @@ namespace juce
 #include "processors/juce_ProcessorWrapper.h"
 #include "processors/juce_ProcessorChain.h"
 #include "processors/juce_ProcessorDuplicator.h"
+#if JUCE_USE_SIMD
+ #include "processors/juce_SIMDProcessorDuplicator.h"
+#endif
 #include "processors/juce_Bias.h"
 #include "processors/juce_Gain.h"
 #include "processors/juce_WaveShaper.h"
@@ -265,6 +270,7 @@ namespace juce
 #include "processors/juce_LadderFilter.h"
 #include "processors/juce_StateVariableFilter.h"
 #include "processors/juce_Oversampling.h"
+#include "processors/juce_Resampler.h"
 #include "processors/juce_Reverb.h"
 #include "frequency/juce_FFT.h"
 #include "frequency/juce_Convolution.h"
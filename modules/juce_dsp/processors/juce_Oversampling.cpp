@@ -104,159 +104,6 @@ struct OversamplingDummy   : public Oversampling<SampleType>::OversamplingStage
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingDummy)
 };
 
-//===============================================================================
-/** Oversampling stage class performing 2 times oversampling using the Filter
-    Design FIR Equiripple method. The resulting filter is linear phase,
-    symmetric, and has every two samples but the middle one equal to zero,
-    leading to specific processing optimizations.
-*/
-template <typename SampleType>
-struct Oversampling2TimesEquirippleFIR  : public Oversampling<SampleType>::OversamplingStage
-{
-    using ParentType = typename Oversampling<SampleType>::OversamplingStage;
-
-    Oversampling2TimesEquirippleFIR (size_t numChans,
-                                     SampleType normalizedTransitionWidthUp,
-                                     SampleType stopbandAttenuationdBUp,
-                                     SampleType normalizedTransitionWidthDown,
-                                     SampleType stopbandAttenuationdBDown)
-        : ParentType (numChans, 2)
-    {
-        coefficientsUp   = *dsp::FilterDesign<SampleType>::designFIRLowpassHalfBandEquirippleMethod (normalizedTransitionWidthUp,   stopbandAttenuationdBUp);
-        coefficientsDown = *dsp::FilterDesign<SampleType>::designFIRLowpassHalfBandEquirippleMethod (normalizedTransitionWidthDown, stopbandAttenuationdBDown);
-
-        auto N = coefficientsUp.getFilterOrder() + 1;
-        stateUp.setSize (static_cast<int> (this->numChannels), static_cast<int> (N));
-
-        N = coefficientsDown.getFilterOrder() + 1;
-        auto Ndiv2 = N / 2;
-        auto Ndiv4 = Ndiv2 / 2;
-
-        stateDown.setSize  (static_cast<int> (this->numChannels), static_cast<int> (N));
-        stateDown2.setSize (static_cast<int> (this->numChannels), static_cast<int> (Ndiv4 + 1));
-
-        position.resize (static_cast<int> (this->numChannels));
-    }
-
-    //===============================================================================
-    SampleType getLatencyInSamples() override
-    {
-        return static_cast<SampleType> (coefficientsUp.getFilterOrder() + coefficientsDown.getFilterOrder()) * 0.5f;
-    }
-
-    void reset() override
-    {
-        ParentType::reset();
-
-        stateUp.clear();
-        stateDown.clear();
-        stateDown2.clear();
-
-        position.fill (0);
-    }
-
-    void processSamplesUp (dsp::AudioBlock<SampleType>& inputBlock) override
-    {
-        jassert (inputBlock.getNumChannels() <= static_cast<size_t> (ParentType::buffer.getNumChannels()));
-        jassert (inputBlock.getNumSamples() * ParentType::factor <= static_cast<size_t> (ParentType::buffer.getNumSamples()));
-
-        // Initialization
-        auto fir = coefficientsUp.getRawCoefficients();
-        auto N = coefficientsUp.getFilterOrder() + 1;
-        auto Ndiv2 = N / 2;
-        auto numSamples = inputBlock.getNumSamples();
-
-        // Processing
-        for (size_t channel = 0; channel < inputBlock.getNumChannels(); ++channel)
-        {
-            auto bufferSamples = ParentType::buffer.getWritePointer (static_cast<int> (channel));
-            auto buf = stateUp.getWritePointer (static_cast<int> (channel));
-            auto samples = inputBlock.getChannelPointer (channel);
-
-            for (size_t i = 0; i < numSamples; ++i)
-            {
-                // Input
-                buf[N - 1] = 2 * samples[i];
-
-                // Convolution
-                auto out = static_cast<SampleType> (0.0);
-
-                for (size_t k = 0; k < Ndiv2; k += 2)
-                    out += (buf[k] + buf[N - k - 1]) * fir[k];
-
-                // Outputs
-                bufferSamples[i << 1] = out;
-                bufferSamples[(i << 1) + 1] = buf[Ndiv2 + 1] * fir[Ndiv2];
-
-                // Shift data
-                for (size_t k = 0; k < N - 2; k += 2)
-                    buf[k] = buf[k + 2];
-            }
-        }
-    }
-
-    void processSamplesDown (dsp::AudioBlock<SampleType>& outputBlock) override
-    {
-        jassert (outputBlock.getNumChannels() <= static_cast<size_t> (ParentType::buffer.getNumChannels()));
-        jassert (outputBlock.getNumSamples() * ParentType::factor <= static_cast<size_t> (ParentType::buffer.getNumSamples()));
-
-        // Initialization
-        auto fir = coefficientsDown.getRawCoefficients();
-        auto N = coefficientsDown.getFilterOrder() + 1;
-        auto Ndiv2 = N / 2;
-        auto Ndiv4 = Ndiv2 / 2;
-        auto numSamples = outputBlock.getNumSamples();
-
-        // Processing
-        for (size_t channel = 0; channel < outputBlock.getNumChannels(); ++channel)
-        {
-            auto bufferSamples = ParentType::buffer.getWritePointer (static_cast<int> (channel));
-            auto buf = stateDown.getWritePointer (static_cast<int> (channel));
-            auto buf2 = stateDown2.getWritePointer (static_cast<int> (channel));
-            auto samples = outputBlock.getChannelPointer (channel);
-            auto pos = position.getUnchecked (static_cast<int> (channel));
-
-            for (size_t i = 0; i < numSamples; ++i)
-            {
-                // Input
-                buf[N - 1] = bufferSamples[i << 1];
-
-                // Convolution
-                auto out = static_cast<SampleType> (0.0);
-
-                for (size_t k = 0; k < Ndiv2; k += 2)
-                    out += (buf[k] + buf[N - k - 1]) * fir[k];
-
-                // Output
-                out += buf2[pos] * fir[Ndiv2];
-                buf2[pos] = bufferSamples[(i << 1) + 1];
-
-                samples[i] = out;
-
-                // Shift data
-                for (size_t k = 0; k < N - 2; ++k)
-                    buf[k] = buf[k + 2];
-
-                // Circular buffer
-                pos = (pos == 0 ? Ndiv4 : pos - 1);
-            }
-
-            position.setUnchecked (static_cast<int> (channel), pos);
-        }
-
-    }
-
-private:
-    //===============================================================================
-    dsp::FIR::Coefficients<SampleType> coefficientsUp, coefficientsDown;
-    AudioBuffer<SampleType> stateUp, stateDown, stateDown2;
-    Array<size_t> position;
-
-    //===============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Oversampling2TimesEquirippleFIR)
-};
-
-
 //===============================================================================
 /** Oversampling stage class performing 2 times oversampling using the Filter
     Design IIR Polyphase Allpass Cascaded method. The resulting filter is minimum
@@ -527,6 +374,338 @@ private:
 };
 
 
+//===============================================================================
+/** Oversampling stage class performing any integer factor of oversampling with
+    linear phase FIR filters, processed in polyphase form.
+
+    Instead of convolving a zero-stuffed signal, the upsampling filter is split into
+    one sub-filter per output phase, and the downsampling filter into one sub-filter
+    per input phase, so that only the taps which meet non-zero samples get computed,
+    and the decimated outputs are the only ones calculated. The zero coefficients at
+    the ends of each sub-filter are skipped as well, which turns the phase containing
+    the centre of a half-band (or more generally Nyquist) filter into a single tap.
+
+    The channels are processed in groups, one per SIMDRegister, so that a group of
+    channels is filtered for the cost of one.
+*/
+template <typename SampleType>
+struct OversamplingPolyphaseFIR  : public Oversampling<SampleType>::OversamplingStage
+{
+    using ParentType = typename Oversampling<SampleType>::OversamplingStage;
+
+   #if JUCE_USE_SIMD
+    using VectorType = SIMDRegister<SampleType>;
+   #else
+    using VectorType = SampleType;
+   #endif
+
+    static constexpr size_t numLanes = sizeof (VectorType) / sizeof (SampleType);
+
+    /** Creates the stage.
+
+        The downsampling keeps the most recent of each group of oversampled samples. Passing
+        a decimationDelay of newFactor - 1 keeps the oldest one instead, which is what the
+        direct form half-band stages used to do, so that they report the same latency as
+        before. The delay is added as leading zero taps, which the kernel skips.
+    */
+    OversamplingPolyphaseFIR (size_t numChans, size_t newFactor,
+                              const dsp::FIR::Coefficients<SampleType>& newCoefficientsUp,
+                              const dsp::FIR::Coefficients<SampleType>& newCoefficientsDown,
+                              size_t decimationDelay = 0)
+        : ParentType (numChans, newFactor),
+          numGroups ((numChans + numLanes - 1) / numLanes)
+    {
+        jassert (newFactor > 1);
+
+        auto numTapsDown = newCoefficientsDown.getFilterOrder() + 1;
+        dsp::FIR::Coefficients<SampleType> delayedCoefficientsDown (numTapsDown + decimationDelay);
+
+        for (size_t i = 0; i < numTapsDown; ++i)
+            delayedCoefficientsDown.getRawCoefficients()[decimationDelay + i] = newCoefficientsDown.getRawCoefficients()[i];
+
+        kernelUp.design   (newCoefficientsUp,       newFactor, static_cast<SampleType> (newFactor));
+        kernelDown.design (delayedCoefficientsDown, newFactor, static_cast<SampleType> (1));
+
+        latency = static_cast<SampleType> (newCoefficientsUp.getFilterOrder() + newCoefficientsDown.getFilterOrder()) * static_cast<SampleType> (0.5)
+                    + static_cast<SampleType> (decimationDelay) - static_cast<SampleType> (newFactor - 1);
+
+        groupSize = 2 * (kernelUp.tapsPerPhase + newFactor * kernelDown.tapsPerPhase);
+        historyData.calloc (numGroups * groupSize * sizeof (VectorType) + alignof (VectorType));
+        histories = reinterpret_cast<VectorType*> (snapPointerToAlignment (historyData.getData(), alignof (VectorType)));
+
+        positionUp.calloc (numGroups);
+        positionDown.calloc (numGroups);
+    }
+
+    //===============================================================================
+    SampleType getLatencyInSamples() override
+    {
+        return latency;
+    }
+
+    void initProcessing (size_t maximumNumberOfSamplesBeforeOversampling) override
+    {
+        ParentType::initProcessing (maximumNumberOfSamplesBeforeOversampling);
+
+        // room for a block of samples at both rates, with the channels interleaved
+        auto scratchSize = maximumNumberOfSamplesBeforeOversampling * (1 + ParentType::factor);
+        scratchData.calloc (scratchSize * sizeof (VectorType) + alignof (VectorType));
+        scratch = reinterpret_cast<VectorType*> (snapPointerToAlignment (scratchData.getData(), alignof (VectorType)));
+    }
+
+    void reset() override
+    {
+        ParentType::reset();
+
+        zeromem (histories, numGroups * groupSize * sizeof (VectorType));
+        positionUp.clear (numGroups);
+        positionDown.clear (numGroups);
+    }
+
+    void processSamplesUp (dsp::AudioBlock<SampleType>& inputBlock) override
+    {
+        jassert (inputBlock.getNumChannels() <= static_cast<size_t> (ParentType::buffer.getNumChannels()));
+        jassert (inputBlock.getNumSamples() * ParentType::factor <= static_cast<size_t> (ParentType::buffer.getNumSamples()));
+
+        // Initialization
+        auto numChans = inputBlock.getNumChannels();
+        auto numSamples = inputBlock.getNumSamples();
+        auto numPhases = ParentType::factor;
+        auto K = kernelUp.tapsPerPhase;
+
+        auto* inputs = scratch;
+        auto* outputs = scratch + numSamples;
+
+        // Processing
+        for (size_t group = 0; group * numLanes < numChans; ++group)
+        {
+            auto firstChannel = group * numLanes;
+            auto numGroupLanes = jmin (numLanes, numChans - firstChannel);
+
+            const SampleType* samples[numLanes];
+            SampleType* bufferSamples[numLanes];
+
+            for (size_t lane = 0; lane < numGroupLanes; ++lane)
+            {
+                samples[lane] = inputBlock.getChannelPointer (firstChannel + lane);
+                bufferSamples[lane] = ParentType::buffer.getWritePointer (static_cast<int> (firstChannel + lane));
+            }
+
+            interleave (samples, numGroupLanes, inputs, numSamples);
+
+            auto* history = getHistoryUp (group);
+            auto pos = positionUp[group];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                // Input
+                history[pos] = history[pos + K] = inputs[i];
+                pos = (pos + 1 == K ? 0 : pos + 1);
+
+                // Convolution, one phase per output sample
+                for (size_t phase = 0; phase < numPhases; ++phase)
+                    outputs[i * numPhases + phase] = kernelUp.process (history + pos, phase);
+            }
+
+            positionUp[group] = pos;
+
+            deinterleave (outputs, bufferSamples, numGroupLanes, numSamples * numPhases);
+        }
+    }
+
+    void processSamplesDown (dsp::AudioBlock<SampleType>& outputBlock) override
+    {
+        jassert (outputBlock.getNumChannels() <= static_cast<size_t> (ParentType::buffer.getNumChannels()));
+        jassert (outputBlock.getNumSamples() * ParentType::factor <= static_cast<size_t> (ParentType::buffer.getNumSamples()));
+
+        // Initialization
+        auto numChans = outputBlock.getNumChannels();
+        auto numSamples = outputBlock.getNumSamples();
+        auto numPhases = ParentType::factor;
+        auto K = kernelDown.tapsPerPhase;
+
+        auto* inputs = scratch;
+        auto* outputs = scratch + numSamples * numPhases;
+
+        // Processing
+        for (size_t group = 0; group * numLanes < numChans; ++group)
+        {
+            auto firstChannel = group * numLanes;
+            auto numGroupLanes = jmin (numLanes, numChans - firstChannel);
+
+            const SampleType* bufferSamples[numLanes];
+            SampleType* samples[numLanes];
+
+            for (size_t lane = 0; lane < numGroupLanes; ++lane)
+            {
+                bufferSamples[lane] = ParentType::buffer.getReadPointer (static_cast<int> (firstChannel + lane));
+                samples[lane] = outputBlock.getChannelPointer (firstChannel + lane);
+            }
+
+            interleave (bufferSamples, numGroupLanes, inputs, numSamples * numPhases);
+
+            auto* phaseHistories = getHistoriesDown (group);
+            auto pos = positionDown[group];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                // Inputs, the most recent one going to the first phase
+                for (size_t phase = 0; phase < numPhases; ++phase)
+                {
+                    auto* history = phaseHistories + phase * 2 * K;
+                    history[pos] = history[pos + K] = inputs[i * numPhases + (numPhases - 1 - phase)];
+                }
+
+                pos = (pos + 1 == K ? 0 : pos + 1);
+
+                // Convolution, summing the phases
+                auto output = kernelDown.process (phaseHistories + pos, 0);
+
+                for (size_t phase = 1; phase < numPhases; ++phase)
+                    output += kernelDown.process (phaseHistories + phase * 2 * K + pos, phase);
+
+                outputs[i] = output;
+            }
+
+            positionDown[group] = pos;
+
+            deinterleave (outputs, samples, numGroupLanes, numSamples);
+        }
+    }
+
+private:
+    //===============================================================================
+    /** The filter coefficients, split into one sub-filter per phase. Each sub-filter
+        is stored in reverse, so that it lines up with a history buffer which holds
+        the oldest sample first, and only the range of taps between its first and last
+        non-zero coefficients gets used.
+    */
+    struct PolyphaseKernel
+    {
+        void design (const dsp::FIR::Coefficients<SampleType>& coefficients, size_t numPhases, SampleType gain)
+        {
+            auto* h = coefficients.getRawCoefficients();
+            auto N = coefficients.getFilterOrder() + 1;
+
+            tapsPerPhase = (N + numPhases - 1) / numPhases;
+            phases.calloc (numPhases * tapsPerPhase);
+            ranges.resize (static_cast<int> (numPhases));
+
+            auto peak = static_cast<SampleType> (0);
+
+            for (size_t i = 0; i < N; ++i)
+                peak = jmax (peak, std::abs (h[i]));
+
+            auto threshold = peak * std::numeric_limits<SampleType>::epsilon();
+
+            for (size_t phase = 0; phase < numPhases; ++phase)
+            {
+                auto* c = phases + phase * tapsPerPhase;
+                int start = (int) tapsPerPhase, end = 0;
+
+                for (size_t j = 0; j < tapsPerPhase; ++j)
+                {
+                    auto index = (tapsPerPhase - 1 - j) * numPhases + phase;
+
+                    if (index < N && std::abs (h[index]) > threshold)
+                    {
+                        c[j] = h[index] * gain;
+                        start = jmin (start, (int) j);
+                        end   = jmax (end, (int) j + 1);
+                    }
+                }
+
+                ranges.setUnchecked (static_cast<int> (phase), { jmin (start, end), end });
+            }
+        }
+
+        VectorType process (const VectorType* window, size_t phase) const noexcept
+        {
+            auto range = ranges.getUnchecked (static_cast<int> (phase));
+            auto* c = phases + phase * tapsPerPhase;
+
+            auto j = range.getStart(), end = range.getEnd();
+
+            // several accumulators, so that the additions don't have to wait for each other
+            auto out1 = broadcast (0), out2 = broadcast (0), out3 = broadcast (0), out4 = broadcast (0);
+
+            for (; j + 3 < end; j += 4)
+            {
+                out1 = multiplyAdd (out1, window[j],     c[j]);
+                out2 = multiplyAdd (out2, window[j + 1], c[j + 1]);
+                out3 = multiplyAdd (out3, window[j + 2], c[j + 2]);
+                out4 = multiplyAdd (out4, window[j + 3], c[j + 3]);
+            }
+
+            for (; j < end; ++j)
+                out1 = multiplyAdd (out1, window[j], c[j]);
+
+            return (out1 + out2) + (out3 + out4);
+        }
+
+        HeapBlock<SampleType> phases;
+        Array<Range<int>> ranges;
+        size_t tapsPerPhase = 0;
+    };
+
+    static VectorType broadcast (SampleType value) noexcept
+    {
+       #if JUCE_USE_SIMD
+        return VectorType::expand (value);
+       #else
+        return value;
+       #endif
+    }
+
+    static VectorType multiplyAdd (VectorType a, VectorType b, SampleType c) noexcept
+    {
+       #if JUCE_USE_SIMD
+        return VectorType::multiplyAdd (a, b, VectorType::expand (c));
+       #else
+        return a + b * c;
+       #endif
+    }
+
+    static void interleave (const SampleType* const* source, size_t numGroupLanes, VectorType* dest, size_t numSamples) noexcept
+    {
+        auto* dst = reinterpret_cast<SampleType*> (dest);
+
+        // The lanes which aren't used by a channel are left alone, and just carry along
+        // whichever finite values they were last given, as they never reach the output.
+        for (size_t lane = 0; lane < numGroupLanes; ++lane)
+            for (size_t i = 0; i < numSamples; ++i)
+                dst[i * numLanes + lane] = source[lane][i];
+    }
+
+    static void deinterleave (const VectorType* source, SampleType* const* dest, size_t numGroupLanes, size_t numSamples) noexcept
+    {
+        auto* src = reinterpret_cast<const SampleType*> (source);
+
+        for (size_t lane = 0; lane < numGroupLanes; ++lane)
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[lane][i] = src[i * numLanes + lane];
+    }
+
+    VectorType* getHistoryUp (size_t group) noexcept         { return histories + group * groupSize; }
+    VectorType* getHistoriesDown (size_t group) noexcept     { return histories + group * groupSize + 2 * kernelUp.tapsPerPhase; }
+
+    //===============================================================================
+    PolyphaseKernel kernelUp, kernelDown;
+    SampleType latency;
+
+    size_t numGroups, groupSize;
+    HeapBlock<char> historyData;
+    VectorType* histories = nullptr;
+    HeapBlock<size_t> positionUp, positionDown;
+
+    HeapBlock<char> scratchData;
+    VectorType* scratch = nullptr;
+
+    //===============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingPolyphaseFIR)
+};
+
+
 //===============================================================================
 template <typename SampleType>
 Oversampling<SampleType>::Oversampling (size_t newNumChannels)
@@ -612,14 +791,68 @@ void Oversampling<SampleType>::addOversamplingStage (FilterType type,
     }
     else
     {
-        stages.add (new Oversampling2TimesEquirippleFIR<SampleType> (numChannels,
-                                                                     normalizedTransitionWidthUp, stopbandAttenuationdBUp,
-                                                                     normalizedTransitionWidthDown, stopbandAttenuationdBDown));
+        // The half-band filters are processed in polyphase form too, which skips their zero taps.
+        // The decimation keeps the older sample of each pair, as the direct form used to, so
+        // that the latency stays (orderUp + orderDown) / 2 oversampled samples.
+        auto coefficientsUp   = dsp::FilterDesign<SampleType>::designFIRLowpassHalfBandEquirippleMethod (static_cast<SampleType> (normalizedTransitionWidthUp),
+                                                                                                        static_cast<SampleType> (stopbandAttenuationdBUp));
+        auto coefficientsDown = dsp::FilterDesign<SampleType>::designFIRLowpassHalfBandEquirippleMethod (static_cast<SampleType> (normalizedTransitionWidthDown),
+                                                                                                        static_cast<SampleType> (stopbandAttenuationdBDown));
+
+        stages.add (new OversamplingPolyphaseFIR<SampleType> (numChannels, 2, *coefficientsUp, *coefficientsDown, 1));
     }
 
     factorOversampling *= 2;
 }
 
+/** Designs the low-pass filter for a polyphase stage, with the Kaiser window method.
+
+    This is what FilterDesign::designFIRLowpassKaiserMethod does, except that the order
+    is rounded up to an even number. The transition band is centred on the Nyquist
+    frequency of the lower sample rate, so with an even order every factor-th tap away
+    from the centre is a zero of the sinc, and the phase holding the centre of the filter
+    shrinks to a single tap.
+*/
+template <typename SampleType>
+static typename dsp::FIR::Coefficients<SampleType>::Ptr designPolyphaseFilter (size_t factor, float normalizedTransitionWidth, float attenuationdB)
+{
+    jassert (normalizedTransitionWidth > 0 && normalizedTransitionWidth < 1.0f / static_cast<float> (factor));
+    jassert (attenuationdB >= -100 && attenuationdB <= 0);
+
+    auto beta = 0.0;
+
+    if (attenuationdB < -50)
+        beta = 0.1102 * (-attenuationdB - 8.7);
+    else if (attenuationdB < -21)
+        beta = 0.5842 * std::pow (-attenuationdB - 21, 0.4) + 0.07886 * (-attenuationdB - 21);
+
+    auto order = attenuationdB < -21 ? roundToInt (std::ceil ((-attenuationdB - 7.95) / (2.285 * normalizedTransitionWidth * MathConstants<double>::twoPi)))
+                                     : roundToInt (std::ceil (5.79 / (normalizedTransitionWidth * MathConstants<double>::twoPi)));
+
+    order += (order & 1);
+
+    return dsp::FilterDesign<SampleType>::designFIRLowpassWindowMethod (static_cast<SampleType> (0.5), static_cast<double> (factor),
+                                                                        static_cast<size_t> (order), dsp::WindowingFunction<SampleType>::kaiser,
+                                                                        static_cast<SampleType> (beta));
+}
+
+template <typename SampleType>
+void Oversampling<SampleType>::addPolyphaseOversamplingStage (size_t factor,
+                                                              float normalizedTransitionWidthUp,
+                                                              float stopbandAttenuationdBUp,
+                                                              float normalizedTransitionWidthDown,
+                                                              float stopbandAttenuationdBDown)
+{
+    jassert (factor > 1);
+
+    auto coefficientsUp   = designPolyphaseFilter<SampleType> (factor, normalizedTransitionWidthUp,   stopbandAttenuationdBUp);
+    auto coefficientsDown = designPolyphaseFilter<SampleType> (factor, normalizedTransitionWidthDown, stopbandAttenuationdBDown);
+
+    stages.add (new OversamplingPolyphaseFIR<SampleType> (numChannels, factor, *coefficientsUp, *coefficientsDown));
+
+    factorOversampling *= factor;
+}
+
 template <typename SampleType>
 void Oversampling<SampleType>::clearOversamplingStages()
 {
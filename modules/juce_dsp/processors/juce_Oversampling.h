@@ -36,7 +36,14 @@ namespace dsp
     It can be configured to do 2 times, 4 times, 8 times or 16 times oversampling
     using a multi-stage approach, either polyphase allpass IIR filters or FIR
     filters for the filtering, and reports successfully the latency added by the
-    filter stages.
+    filter stages. Other integer factors, such as 3 or 6 times, can be obtained by
+    adding stages with addPolyphaseOversamplingStage().
+
+    The FIR filters are processed in polyphase form, so that no time is spent
+    multiplying the zeros of the upsampled signal or computing samples which are
+    discarded when downsampling, and several channels are processed at once using
+    SIMD instructions where they are available. The half-band FIR stages give the
+    same output, and report the same latency, as the direct form ones used to.
 
     The principle of oversampling is to increase the sample rate of a given
     non-linear process, to prevent it from creating aliasing. Oversampling works
@@ -138,6 +145,34 @@ public:
                                float normalizedTransitionWidthUp, float stopbandAttenuationdBUp,
                                float normalizedTransitionWidthDown, float stopbandAttenuationdBDown);
 
+    /** Adds an oversampling stage of any integer factor, which isn't restricted to
+        powers of two like the half-band stages are, e.g. a 2 times stage followed by
+        a 3 times stage gives 6 times oversampling.
+
+        The filtering is done with linear phase FIR filters designed with the Kaiser
+        window method, and processed in polyphase form, so that the multiplications
+        by the zeros of the upsampled signal and the samples which are thrown away
+        when downsampling are never computed.
+
+        The transition widths are normalized to the oversampled sample rate, as they
+        are for the other stages, and the transition bands are centred on the Nyquist
+        frequency of the lower sample rate.
+
+        Unlike the half-band stages, the downsampling keeps the most recent of each
+        group of oversampled samples, which takes factor - 1 oversampled samples off
+        the latency of the stage, i.e. it's (orderUp + orderDown) / 2 - (factor - 1)
+        samples at the oversampled rate. getLatencyInSamples() takes this into account.
+
+        @param factor                           the oversampling factor of this stage, which must be 2 or more
+        @param normalizedTransitionWidthUp      the width of the transition band of the upsampling filter
+        @param stopbandAttenuationdBUp          the stop band attenuation of the upsampling filter, in dB
+        @param normalizedTransitionWidthDown    the width of the transition band of the downsampling filter
+        @param stopbandAttenuationdBDown        the stop band attenuation of the downsampling filter, in dB
+    */
+    void addPolyphaseOversamplingStage (size_t factor,
+                                        float normalizedTransitionWidthUp, float stopbandAttenuationdBUp,
+                                        float normalizedTransitionWidthDown, float stopbandAttenuationdBDown);
+
     void addDummyOversamplingStage();
 
     void clearOversamplingStages();
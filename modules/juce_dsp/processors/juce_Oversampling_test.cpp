@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+class OversamplingTest : public UnitTest
+{
+public:
+    OversamplingTest() : UnitTest ("Oversampling", "DSP") {}
+
+    static double getFrequency (size_t channel)     { return 0.01 + 0.004 * (double) channel; }
+
+    template <typename FloatType>
+    static void addPolyphaseStages (Oversampling<FloatType>& oversampling, std::initializer_list<size_t> factors)
+    {
+        oversampling.clearOversamplingStages();
+
+        for (auto factor : factors)
+        {
+            auto isFirst = (oversampling.getOversamplingFactor() == 1);
+
+            oversampling.addPolyphaseOversamplingStage (factor,
+                                                        (isFirst ? 0.1f : 0.3f) / (float) factor, -90.0f,
+                                                        (isFirst ? 0.1f : 0.3f) / (float) factor, -90.0f);
+        }
+    }
+
+    // Runs sine waves up and straight back down through the oversampling, in blocks
+    // of random sizes, and checks that they come out delayed by the reported latency.
+    template <typename FloatType>
+    void checkRoundTrip (Oversampling<FloatType>& oversampling, size_t expectedFactor, FloatType tolerance)
+    {
+        expectEquals ((int) oversampling.getOversamplingFactor(), (int) expectedFactor);
+
+        Random random (3351);
+        const size_t maxBlockSize = 256, numSamples = 4096;
+        auto numChannels = oversampling.numChannels;
+
+        oversampling.initProcessing (maxBlockSize);
+        auto latency = (double) oversampling.getLatencyInSamples();
+
+        HeapBlock<char> data;
+        AudioBlock<FloatType> block (data, numChannels, maxBlockSize);
+        FloatType maxError = 0;
+
+        for (size_t start = 0; start < numSamples;)
+        {
+            auto num = jmin ((size_t) random.nextInt ({ 1, (int) maxBlockSize + 1 }), numSamples - start);
+            auto subBlock = block.getSubBlock (0, num);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                for (size_t i = 0; i < num; ++i)
+                    subBlock.getChannelPointer (ch)[i] = (FloatType) std::sin (MathConstants<double>::twoPi * getFrequency (ch) * (double) (start + i));
+
+            auto oversampledBlock = oversampling.processSamplesUp (subBlock);
+            expectEquals ((int) oversampledBlock.getNumSamples(), (int) (num * expectedFactor));
+
+            oversampling.processSamplesDown (subBlock);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                for (size_t i = 0; i < num; ++i)
+                {
+                    auto t = (double) (start + i) - latency;
+
+                    if (t > 1024.0)
+                    {
+                        auto expected = std::sin (MathConstants<double>::twoPi * getFrequency (ch) * t);
+                        maxError = jmax (maxError, (FloatType) std::abs (subBlock.getChannelPointer (ch)[i] - expected));
+                    }
+                }
+            }
+
+            start += num;
+        }
+
+        expectLessThan (maxError, tolerance);
+    }
+
+    // Puts a tone above the original Nyquist frequency into the oversampled signal,
+    // and checks that the downsampling filters get rid of it.
+    template <typename FloatType>
+    void checkDownsamplingRejection (Oversampling<FloatType>& oversampling, FloatType maxLeveldB)
+    {
+        const size_t blockSize = 4096;
+        auto factor = oversampling.getOversamplingFactor();
+
+        oversampling.initProcessing (blockSize);
+
+        HeapBlock<char> data;
+        AudioBlock<FloatType> block (data, oversampling.numChannels, blockSize);
+        block.clear();
+
+        auto oversampledBlock = oversampling.processSamplesUp (block);
+
+        for (size_t ch = 0; ch < oversampledBlock.getNumChannels(); ++ch)
+            for (size_t i = 0; i < oversampledBlock.getNumSamples(); ++i)
+                oversampledBlock.getChannelPointer (ch)[i] = (FloatType) std::sin (MathConstants<double>::twoPi * 0.7 * (double) i / (double) factor);
+
+        oversampling.processSamplesDown (block);
+
+        FloatType peak = 0;
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            for (size_t i = blockSize / 2; i < blockSize; ++i)
+                peak = jmax (peak, std::abs (block.getChannelPointer (ch)[i]));
+
+        expectLessThan (Decibels::gainToDecibels (peak), maxLeveldB);
+    }
+
+    template <typename FloatType>
+    void runPolyphaseTests()
+    {
+        for (auto numChannels : { 1, 2, 3, 9 })
+        {
+            Oversampling<FloatType> oversampling ((size_t) numChannels);
+
+            addPolyphaseStages (oversampling, { 2 });
+            checkRoundTrip (oversampling, 2, (FloatType) 1.0e-3);
+
+            addPolyphaseStages (oversampling, { 3 });
+            checkRoundTrip (oversampling, 3, (FloatType) 1.0e-3);
+            checkDownsamplingRejection (oversampling, (FloatType) -80);
+
+            addPolyphaseStages (oversampling, { 2, 3 });
+            checkRoundTrip (oversampling, 6, (FloatType) 1.0e-3);
+
+            addPolyphaseStages (oversampling, { 8 });
+            checkRoundTrip (oversampling, 8, (FloatType) 1.0e-3);
+            checkDownsamplingRejection (oversampling, (FloatType) -80);
+        }
+    }
+
+    template <typename FloatType>
+    void runHalfBandTests()
+    {
+        for (auto type : { Oversampling<FloatType>::filterHalfBandFIREquiripple, Oversampling<FloatType>::filterHalfBandPolyphaseIIR })
+        {
+            for (size_t factor = 1; factor <= 3; ++factor)
+            {
+                Oversampling<FloatType> oversampling (2, factor, type);
+
+                // the IIR filters aren't linear phase, so only their FIR cousins can match a delay
+                if (type == Oversampling<FloatType>::filterHalfBandFIREquiripple)
+                    checkRoundTrip (oversampling, (size_t) 1 << factor, (FloatType) 1.0e-3);
+
+                checkDownsamplingRejection (oversampling, (FloatType) -60);
+            }
+        }
+
+        // the FIR stages must keep the latency which they've always reported
+        {
+            Oversampling<FloatType> oversampling (2);
+            oversampling.addOversamplingStage (Oversampling<FloatType>::filterHalfBandFIREquiripple, 0.1f, -70.0f, 0.12f, -60.0f);
+
+            auto orderUp   = FilterDesign<FloatType>::designFIRLowpassHalfBandEquirippleMethod ((FloatType) 0.1,  (FloatType) -70)->getFilterOrder();
+            auto orderDown = FilterDesign<FloatType>::designFIRLowpassHalfBandEquirippleMethod ((FloatType) 0.12, (FloatType) -60)->getFilterOrder();
+
+            expectEquals ((double) oversampling.getLatencyInSamples(), (double) (orderUp + orderDown) * 0.5 / 2.0);
+            checkRoundTrip (oversampling, 2, (FloatType) 1.0e-3);
+        }
+    }
+
+    void runTest() override
+    {
+        beginTest ("Polyphase FIR stages");
+        runPolyphaseTests<float>();
+        runPolyphaseTests<double>();
+
+        beginTest ("Half-band stages");
+        runHalfBandTests<float>();
+        runHalfBandTests<double>();
+    }
+};
+
+static OversamplingTest oversamplingTest;
+
+} // namespace dsp
+} // namespace juce
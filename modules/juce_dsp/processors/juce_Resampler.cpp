@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+Resampler::Resampler (Quality q, double maxSpeedRatio)
+    : quality (q), maximumSpeedRatio (maxSpeedRatio)
+{
+}
+
+Resampler::~Resampler() {}
+
+void Resampler::prepare (const ProcessSpec& spec)
+{
+    resamplers.clear();
+
+    for (uint32 i = 0; i < spec.numChannels; ++i)
+        resamplers.add (new PolyphaseResampler (quality, maximumSpeedRatio));
+}
+
+void Resampler::reset() noexcept
+{
+    for (auto* r : resamplers)
+        r->reset();
+}
+
+void Resampler::prepareForSpeedRatio (double speedRatio)
+{
+    for (auto* r : resamplers)
+        r->prepareForSpeedRatio (speedRatio);
+}
+
+int Resampler::getLatencyInSamples() const noexcept
+{
+    if (auto* r = resamplers.getFirst())
+        return r->getLatencyInSamples();
+
+    return PolyphaseResampler::getLatencyInSamples (quality, maximumSpeedRatio);
+}
+
+size_t Resampler::getNumInputSamplesNeeded (double speedRatio, size_t numOutputSamples) const noexcept
+{
+    jassert (! resamplers.isEmpty()); // you need to call prepare() first!
+
+    if (auto* r = resamplers.getFirst())
+        return (size_t) r->getNumInputSamplesNeeded (speedRatio, (int) numOutputSamples);
+
+    return 0;
+}
+
+size_t Resampler::process (double speedRatio, const AudioBlock<float>& inputBlock, AudioBlock<float>& outputBlock) noexcept
+{
+    auto numChannels = jmin (inputBlock.getNumChannels(), outputBlock.getNumChannels(), (size_t) resamplers.size());
+    auto numOutputSamples = (int) outputBlock.getNumSamples();
+
+    jassert (inputBlock.getNumChannels() <= (size_t) resamplers.size());
+    jassert (inputBlock.getNumSamples() >= getNumInputSamplesNeeded (speedRatio, (size_t) numOutputSamples));
+
+    int numUsed = 0;
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        numUsed = resamplers.getUnchecked ((int) ch)->process (speedRatio, inputBlock.getChannelPointer (ch),
+                                                                outputBlock.getChannelPointer (ch), numOutputSamples);
+
+    return (size_t) numUsed;
+}
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+/**
+    Changes the sample rate of a multi-channel signal by an arbitrary ratio, using
+    a windowed-sinc PolyphaseResampler for each channel.
+
+    Because the input and output blocks hold different numbers of samples, this
+    doesn't take a ProcessContext like most processors. Instead, process() is given
+    the input and output blocks separately. It fills the whole output block and
+    returns the number of input samples it used. getNumInputSamplesNeeded() tells
+    you in advance how many input samples that will be.
+
+    process() can be called on the audio thread, and the speed ratio can change on
+    every call, but see prepareForSpeedRatio() for how to get the best quality when
+    the ratio changes.
+
+    @see PolyphaseResampler, Oversampling
+
+    @tags{DSP}
+*/
+class JUCE_API  Resampler
+{
+public:
+    /** The quality settings, which are the same as the ones used by PolyphaseResampler. */
+    using Quality = PolyphaseResampler::Quality;
+
+    //==============================================================================
+    /** Creates a Resampler.
+
+        @param quality              the length and accuracy of the filters to use
+        @param maximumSpeedRatio    the largest number of input samples per output sample
+                                    that you expect to use. Above 1.0, the filters are made
+                                    longer so that downsampling doesn't reduce the quality.
+    */
+    Resampler (Quality quality = Quality::high, double maximumSpeedRatio = 1.0);
+
+    /** Destructor. */
+    ~Resampler();
+
+    //==============================================================================
+    /** Creates a resampler for each channel in the spec. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Clears the resamplers' internal state. */
+    void reset() noexcept;
+
+    /** Builds the filters that a given speed ratio needs.
+
+        process() never allocates, so if it's given a downsampling ratio that hasn't
+        been prepared, it uses filters with a lower cutoff than necessary. Call this
+        from a non-realtime thread before switching to a new ratio to avoid that.
+        The filters for 1.0 and for the maximum speed ratio are always prepared.
+
+        @see PolyphaseResampler::prepareForSpeedRatio
+    */
+    void prepareForSpeedRatio (double speedRatio);
+
+    /** Returns the delay added by the filters, in input samples. */
+    int getLatencyInSamples() const noexcept;
+
+    /** Returns the number of input samples that the next call to process() will use
+        to produce a given number of output samples.
+    */
+    size_t getNumInputSamplesNeeded (double speedRatio, size_t numOutputSamples) const noexcept;
+
+    /** Resamples the input block to fill the whole of the output block.
+
+        @param speedRatio   the number of input samples to use for each output sample
+        @param inputBlock   the samples to read. This must contain at least
+                            getNumInputSamplesNeeded() samples.
+        @param outputBlock  the block to fill with the results
+        @returns the number of input samples that were used
+    */
+    size_t process (double speedRatio, const AudioBlock<float>& inputBlock, AudioBlock<float>& outputBlock) noexcept;
+
+private:
+    //==============================================================================
+    const Quality quality;
+    const double maximumSpeedRatio;
+    OwnedArray<PolyphaseResampler> resamplers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Resampler)
+};
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+class ResamplerTest  : public UnitTest
+{
+public:
+    ResamplerTest()  : UnitTest ("Resampler", "DSP") {}
+
+    using Quality = Resampler::Quality;
+
+    static double getFrequency (size_t channel)     { return 0.015 + 0.005 * (double) channel; }
+
+    struct Segment
+    {
+        double speedRatio;
+        int numOutputSamples;
+        bool prepareFirst;
+    };
+
+    // Resamples a sine wave on each channel through a series of segments, each with its
+    // own speed ratio, in blocks of random sizes, and returns the largest difference
+    // between the output and the ideal sine at the position that each output represents.
+    double getMaxError (Resampler& resampler, const std::vector<Segment>& segments)
+    {
+        const size_t numChannels = 2, maxBlockSize = 256;
+        int totalOutput = 0;
+        double totalInput = 0;
+
+        for (auto& s : segments)
+        {
+            totalOutput += s.numOutputSamples;
+            totalInput += s.numOutputSamples * s.speedRatio;
+        }
+
+        AudioBuffer<float> input ((int) numChannels, (int) totalInput + 1024);
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample ((int) ch, i, (float) (0.5 * std::sin (MathConstants<double>::twoPi * getFrequency (ch) * i)));
+
+        AudioBuffer<float> output ((int) numChannels, (int) maxBlockSize);
+        AudioBlock<float> inputBlock (input), outputBlock (output);
+
+        resampler.prepare ({ 48000.0, (uint32) maxBlockSize, (uint32) numChannels });
+        auto latency = (double) resampler.getLatencyInSamples();
+
+        Random random (7621);
+        size_t inputPos = 0;
+        double outputPosition = 0, maxError = 0;
+
+        for (auto& s : segments)
+        {
+            if (s.prepareFirst)
+                resampler.prepareForSpeedRatio (s.speedRatio);
+
+            for (int done = 0; done < s.numOutputSamples;)
+            {
+                auto num = jmin ((size_t) random.nextInt ({ 1, (int) maxBlockSize + 1 }), (size_t) (s.numOutputSamples - done));
+                auto outputSubBlock = outputBlock.getSubBlock (0, num);
+                auto numNeeded = resampler.getNumInputSamplesNeeded (s.speedRatio, num);
+
+                expectEquals ((int) resampler.process (s.speedRatio, inputBlock.getSubBlock (inputPos, numNeeded), outputSubBlock),
+                              (int) numNeeded);
+                inputPos += numNeeded;
+
+                for (size_t i = 0; i < num; ++i)
+                {
+                    // skip the outputs whose filters overlap the start of the input
+                    if (outputPosition >= 2.0 * latency)
+                    {
+                        for (size_t ch = 0; ch < numChannels; ++ch)
+                        {
+                            auto expected = 0.5 * std::sin (MathConstants<double>::twoPi * getFrequency (ch) * (outputPosition - latency));
+                            maxError = jmax (maxError, std::abs (expected - outputSubBlock.getSample ((int) ch, (int) i)));
+                        }
+                    }
+
+                    outputPosition += s.speedRatio;
+                }
+
+                done += (int) num;
+            }
+        }
+
+        expect (totalOutput > 0);
+        return maxError;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Each quality setting matches the ideal result");
+        {
+            for (auto quality : { Quality::low, Quality::medium, Quality::high, Quality::best })
+            {
+                for (auto ratio : { 44100.0 / 48000.0, 48000.0 / 44100.0, 0.5, 1.0, 1.75 })
+                {
+                    Resampler resampler (quality, jmax (1.0, ratio));
+                    auto maxError = getMaxError (resampler, { { ratio, 6000, false } });
+
+                    expectLessThan (maxError, quality == Quality::low ? 2.0e-3 : 2.0e-4,
+                                    "ratio " + String (ratio));
+                }
+            }
+        }
+
+        beginTest ("Changing the ratio between blocks keeps the output continuous");
+        {
+            std::vector<Segment> segments { { 1.0, 3000, false }, { 0.8, 2000, true }, { 1.5, 2500, true },
+                                            { 1.0, 1500, true }, { 1.9, 2000, true }, { 0.6, 1000, true } };
+
+            Resampler resampler (Quality::high, 2.0);
+            expectLessThan (getMaxError (resampler, segments), 2.0e-4);
+        }
+
+        beginTest ("Ratios that haven't been prepared fall back to filters with a lower cutoff");
+        {
+            std::vector<Segment> segments { { 1.0, 2000, false }, { 1.3, 3000, false }, { 1.05, 2000, false } };
+
+            Resampler resampler (Quality::high, 2.0);
+            expectLessThan (getMaxError (resampler, segments), 2.0e-4);
+        }
+
+        beginTest ("Downsampling removes frequencies above the new Nyquist frequency");
+        {
+            for (auto prepareFirst : { false, true })
+            {
+                const double ratio = 1.5;
+                Resampler resampler (Quality::high, 2.0);
+                resampler.prepare ({ 48000.0, 4096, 1 });
+
+                if (prepareFirst)
+                    resampler.prepareForSpeedRatio (ratio);
+
+                // 0.4 cycles per input sample is above the output's Nyquist frequency of 1 / 3
+                AudioBuffer<float> input (1, 8192), output (1, 4096);
+
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample (0, i, (float) std::sin (MathConstants<double>::twoPi * 0.4 * i));
+
+                AudioBlock<float> inputBlock (input), outputBlock (output);
+                resampler.process (ratio, inputBlock, outputBlock);
+
+                auto settled = outputBlock.getSubBlock (512);
+                expectLessThan (jmax (std::abs (settled.findMinAndMax().getStart()), std::abs (settled.findMinAndMax().getEnd())),
+                                Decibels::decibelsToGain (-80.0f));
+            }
+        }
+    }
+};
+
+static ResamplerTest resamplerTest;
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+/**
+    Converts a mono processor class which works on SIMDRegister samples into a
+    multi-channel processor for ordinary float or double buffers.
+
+    This works like ProcessorDuplicator, but instead of running one instance per
+    channel, it gathers up to SIMDRegister<NumericType>::size() channels into the
+    lanes of a SIMDRegister and runs a single instance on them, so that a group of
+    4, 8 or 16 channels (depending on the CPU and sample type) gets filtered for the
+    cost of one. The transposition in and out of the SIMD lanes happens internally,
+    so the processor can be used on any normal AudioBlock, e.g.
+
+    @code
+    using MultiChannelIIR = SIMDProcessorDuplicator<IIR::Filter<SIMDRegister<float>>,
+                                                    IIR::Coefficients<float>>;
+    @endcode
+
+    All the channels share the same state object, so the coefficients or parameters
+    are the same for every channel, just as they are with ProcessorDuplicator.
+
+    The gain comes from filling the lanes, so this is best suited to buses with at least
+    as many channels as a SIMDRegister has lanes; for mono or stereo signals a plain
+    ProcessorDuplicator will usually be just as fast.
+
+    @see ProcessorDuplicator, SIMDRegister
+
+    @tags{DSP}
+*/
+template <typename MonoProcessorType, typename StateType>
+struct SIMDProcessorDuplicator
+{
+    /** The primitive sample type of the buffers that this processor works on. */
+    using NumericType = typename MonoProcessorType::NumericType;
+
+    /** The vector type that the duplicated processors work on. */
+    using VectorType = SIMDRegister<NumericType>;
+
+    SIMDProcessorDuplicator() : state (new StateType()) {}
+    SIMDProcessorDuplicator (StateType* stateToUse) : state (stateToUse) {}
+    SIMDProcessorDuplicator (typename StateType::Ptr stateToUse) : state (static_cast<typename StateType::Ptr&&> (stateToUse)) {}
+
+    ~SIMDProcessorDuplicator()  { destroyProcessors(); }
+
+    void prepare (const ProcessSpec& spec)
+    {
+        auto numGroups = (spec.numChannels + VectorType::size() - 1) / VectorType::size();
+
+        if (numGroups != numProcessors)
+        {
+            destroyProcessors();
+
+            // The processors hold SIMDRegister members, so they need more alignment
+            // than operator new can be relied on to give them.
+            processorData.malloc (numGroups * sizeof (MonoProcessorType) + alignof (MonoProcessorType));
+            auto* storage = snapPointerToAlignment (processorData.getData(), alignof (MonoProcessorType));
+
+            for (; numProcessors < numGroups; ++numProcessors)
+                new (storage + numProcessors * sizeof (MonoProcessorType)) MonoProcessorType (state);
+
+            processors = reinterpret_cast<MonoProcessorType*> (storage);
+        }
+
+        auto monoSpec = spec;
+        monoSpec.numChannels = 1;
+
+        for (size_t i = 0; i < numProcessors; ++i)
+            processors[i].prepare (monoSpec);
+
+        maxBlockSize = jmax ((size_t) 1, (size_t) spec.maximumBlockSize);
+        interleaved = AudioBlock<VectorType> (interleavedData, 1, maxBlockSize);
+    }
+
+    void reset() noexcept      { for (size_t i = 0; i < numProcessors; ++i) processors[i].reset(); }
+
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        static_assert (std::is_same<typename ProcessContext::SampleType, NumericType>::value,
+                       "The sample-type of the processor must match the sample-type supplied to this process callback");
+
+        auto&& inputBlock  = context.getInputBlock();
+        auto&& outputBlock = context.getOutputBlock();
+
+        auto numChannels = jmin (inputBlock.getNumChannels(), outputBlock.getNumChannels());
+        auto numSamples  = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumSamples() == numSamples);
+        jassert ((numChannels + VectorType::size() - 1) / VectorType::size() <= numProcessors);
+
+        if (numProcessors == 0)
+            return;
+
+        for (size_t start = 0; start < numSamples; start += maxBlockSize)
+        {
+            auto num = jmin (maxBlockSize, numSamples - start);
+            auto block = interleaved.getSubBlock (0, num);
+
+            for (size_t firstChannel = 0; firstChannel < numChannels; firstChannel += VectorType::size())
+            {
+                auto numLanes = jmin (VectorType::size(), numChannels - firstChannel);
+
+                interleave (inputBlock, firstChannel, numLanes, start, num);
+
+                ProcessContextReplacing<VectorType> groupContext (block);
+                groupContext.isBypassed = context.isBypassed;
+                processors[firstChannel / VectorType::size()].process (groupContext);
+
+                deinterleave (outputBlock, firstChannel, numLanes, start, num);
+            }
+        }
+    }
+
+    typename StateType::Ptr state;
+
+private:
+    //==============================================================================
+    void interleave (const AudioBlock<NumericType>& source, size_t firstChannel, size_t numLanes,
+                     size_t startSample, size_t numSamples) noexcept
+    {
+        auto* dst = reinterpret_cast<NumericType*> (interleaved.getChannelPointer (0));
+        constexpr auto stride = VectorType::SIMDNumElements;
+
+        const NumericType* src[stride];
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            src[lane] = source.getChannelPointer (firstChannel + lane) + startSample;
+
+        for (size_t i = 0; i < numSamples; ++i, dst += stride)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                dst[lane] = src[lane][i];
+
+            for (size_t lane = numLanes; lane < stride; ++lane)
+                dst[lane] = NumericType();
+        }
+    }
+
+    void deinterleave (AudioBlock<NumericType>& dest, size_t firstChannel, size_t numLanes,
+                       size_t startSample, size_t numSamples) const noexcept
+    {
+        auto* src = reinterpret_cast<const NumericType*> (interleaved.getChannelPointer (0));
+        constexpr auto stride = VectorType::SIMDNumElements;
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            auto* dst = dest.getChannelPointer (firstChannel + lane) + startSample;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                dst[i] = src[i * stride + lane];
+        }
+    }
+
+    void destroyProcessors() noexcept
+    {
+        for (size_t i = 0; i < numProcessors; ++i)
+            processors[i].~MonoProcessorType();
+
+        processors = nullptr;
+        numProcessors = 0;
+    }
+
+    //==============================================================================
+    HeapBlock<char> processorData;
+    MonoProcessorType* processors = nullptr;
+    size_t numProcessors = 0;
+
+    HeapBlock<char> interleavedData;
+    AudioBlock<VectorType> interleaved;
+    size_t maxBlockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (SIMDProcessorDuplicator)
+};
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+class SIMDProcessorDuplicatorTest : public UnitTest
+{
+public:
+    SIMDProcessorDuplicatorTest() : UnitTest ("SIMDProcessorDuplicator", "DSP") {}
+
+    template <typename FloatType>
+    static void fillRandom (Random& random, AudioBlock<FloatType>& block)
+    {
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+                block.getChannelPointer (ch)[i] = (FloatType) ((2.0f * random.nextFloat()) - 1.0f);
+    }
+
+    template <typename FloatType>
+    static FloatType getMaxDifference (const AudioBlock<FloatType>& a, const AudioBlock<FloatType>& b)
+    {
+        FloatType maxDifference = 0;
+
+        for (size_t ch = 0; ch < a.getNumChannels(); ++ch)
+            for (size_t i = 0; i < a.getNumSamples(); ++i)
+                maxDifference = jmax (maxDifference, std::abs (a.getChannelPointer (ch)[i] - b.getChannelPointer (ch)[i]));
+
+        return maxDifference;
+    }
+
+    // Runs the same signal through a ProcessorDuplicator and a SIMDProcessorDuplicator
+    // that share the same state, and checks that every channel comes out the same.
+    template <typename ScalarProcessor, typename SIMDProcessor, typename StatePtr>
+    void checkMatchesScalarVersion (StatePtr sharedState)
+    {
+        using FloatType = typename SIMDProcessor::NumericType;
+
+        Random random (8721);
+
+        for (auto numChannels : { 1, 2, 3, 8, 13, 20 })
+        {
+            ProcessSpec spec { 44100.0, 128, (uint32) numChannels };
+
+            ScalarProcessor scalar (sharedState);
+            SIMDProcessor simd (sharedState);
+            scalar.prepare (spec);
+            simd.prepare (spec);
+
+            HeapBlock<char> inputData, scalarData, simdData;
+            AudioBlock<FloatType> input (inputData, (size_t) numChannels, 300);
+            AudioBlock<FloatType> scalarOutput (scalarData, (size_t) numChannels, 300);
+            AudioBlock<FloatType> simdOutput (simdData, (size_t) numChannels, 300);
+
+            for (int iteration = 0; iteration < 10; ++iteration)
+            {
+                // deliberately longer than the maximum block size some of the time
+                auto numSamples = (size_t) random.nextInt ({ 1, 300 });
+
+                auto in        = input.getSubBlock (0, numSamples);
+                auto scalarOut = scalarOutput.getSubBlock (0, numSamples);
+                auto simdOut   = simdOutput.getSubBlock (0, numSamples);
+
+                fillRandom (random, in);
+
+                scalar.process (ProcessContextNonReplacing<FloatType> (in, scalarOut));
+                simd.process (ProcessContextNonReplacing<FloatType> (in, simdOut));
+
+                expectLessThan (getMaxDifference (scalarOut, simdOut), (FloatType) 1.0e-5);
+            }
+
+            // the replacing context and bypassing should work too
+            auto in = input.getSubBlock (0, 64);
+            fillRandom (random, in);
+            scalarOutput.copy (input);
+
+            ProcessContextReplacing<FloatType> bypassedContext (in);
+            bypassedContext.isBypassed = true;
+            simd.process (bypassedContext);
+
+            expectEquals ((double) getMaxDifference (in, scalarOutput.getSubBlock (0, 64)), 0.0);
+        }
+    }
+
+    template <typename FloatType>
+    void runIIRTest()
+    {
+        using Scalar = ProcessorDuplicator<IIR::Filter<FloatType>, IIR::Coefficients<FloatType>>;
+        using SIMD   = SIMDProcessorDuplicator<IIR::Filter<SIMDRegister<FloatType>>, IIR::Coefficients<FloatType>>;
+
+        checkMatchesScalarVersion<Scalar, SIMD>
+            (IIR::Coefficients<FloatType>::makePeakFilter (44100.0, (FloatType) 1000, (FloatType) 0.7, (FloatType) 2));
+
+        checkMatchesScalarVersion<Scalar, SIMD>
+            (IIR::Coefficients<FloatType>::makeFirstOrderHighPass (44100.0, (FloatType) 200));
+    }
+
+    template <typename FloatType>
+    void runSVFTest()
+    {
+        using Parameters = StateVariableFilter::Parameters<FloatType>;
+        using Scalar = ProcessorDuplicator<StateVariableFilter::Filter<FloatType>, Parameters>;
+        using SIMD   = SIMDProcessorDuplicator<StateVariableFilter::Filter<SIMDRegister<FloatType>>, Parameters>;
+
+        typename Parameters::Ptr parameters (new Parameters());
+        parameters->type = Parameters::Type::bandPass;
+        parameters->setCutOffFrequency (44100.0, (FloatType) 2000, (FloatType) 2);
+
+        checkMatchesScalarVersion<Scalar, SIMD> (parameters);
+    }
+
+    void runTest() override
+    {
+        beginTest ("IIR filters");
+        runIIRTest<float>();
+        runIIRTest<double>();
+
+        beginTest ("State variable filters");
+        runSVFTest<float>();
+        runSVFTest<double>();
+    }
+};
+
+static SIMDProcessorDuplicatorTest simdProcessorDuplicatorTest;
+
+} // namespace dsp
+} // namespace juce